@@ -0,0 +1,105 @@
+/** @file benchmarks/InstantBenchmark.h
+    @brief Minimal helpers shared by InstantRTOS benchmarks
+
+    Benchmarks are plain host programs (each one has its own main()),
+    they are not part of the library and are not registered with CTest,
+    run them manually from the build directory.
+
+    Usage:
+    @code
+        auto res = InstantBenchmark::Measure("name", iterations, [&]{
+            // code being measured (single iteration)
+        });
+    @endcode
+*/
+
+#ifndef InstantBenchmark_INCLUDED_H
+#define InstantBenchmark_INCLUDED_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace InstantBenchmark {
+
+/// Results of single measurement
+struct Result{
+    double totalSeconds;  ///< Wall time for all iterations
+    double nsPerIteration; ///< Average time for single iteration
+};
+
+/// Prevent compiler from optimizing away value computed by benchmark
+template<class T>
+inline void DoNotOptimize(const T& value){
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+/// Run body() iterations times, print and return results
+template<class Body>
+Result Measure(const char* name, unsigned long iterations, Body&& body){
+    using Clock = std::chrono::steady_clock;
+    // warm up caches and branch predictors
+    for(unsigned long i = 0; i < iterations / 16 + 1; ++i){
+        body();
+    }
+
+    auto start = Clock::now();
+    for(unsigned long i = 0; i < iterations; ++i){
+        body();
+    }
+    auto finish = Clock::now();
+
+    Result res;
+    res.totalSeconds = std::chrono::duration<double>(finish - start).count();
+    res.nsPerIteration = res.totalSeconds * 1e9 / double(iterations);
+    std::printf("%-48s %12lu iterations %12.2f ns/iteration\n",
+        name, iterations, res.nsPerIteration);
+    return res;
+}
+
+/// Collect latency samples and print distribution summary
+class LatencySamples{
+public:
+    /// Remember single measured latency (nanoseconds)
+    void Add(double ns){
+        samples.push_back(ns);
+    }
+
+    /// Number of samples collected so far
+    std::size_t Count() const{
+        return samples.size();
+    }
+
+    /// Print mean/percentiles/max (samples get sorted)
+    void Print(const char* name){
+        if( samples.empty() ){
+            std::printf("%-48s no samples\n", name);
+            return;
+        }
+        std::sort(samples.begin(), samples.end());
+        double sum = 0;
+        for(double s: samples){
+            sum += s;
+        }
+        std::printf("%-48s n=%-8zu mean=%10.1f p50=%10.1f p99=%10.1f max=%10.1f ns\n",
+            name, samples.size(), sum / double(samples.size()),
+            percentile(0.50), percentile(0.99), samples.back());
+    }
+
+private:
+    std::vector<double> samples;
+
+    double percentile(double p) const{
+        return samples[std::size_t(p * double(samples.size() - 1))];
+    }
+};
+
+} // namespace InstantBenchmark
+
+#endif
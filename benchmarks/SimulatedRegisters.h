@@ -0,0 +1,229 @@
+/** @file benchmarks/SimulatedRegisters.h
+    @brief Host harness emulating memory mapped input registers (POSIX only)
+
+    SimulatedRegisterBlock maps anonymous memory (or a file, so that
+    other process can poke "hardware" as well) to be used in place of
+    real registers, BounceGenerator runs a thread changing bits of
+    that block the same way mechanical contacts do: each event is a burst
+    of random toggles (bounces) followed by the stable level.
+    The time when each channel settled is recorded, so consumer can
+    measure end to end detection latency and detect lost/false events.
+
+    Usage:
+    @code
+        SimulatedRegisterBlock<std::uint32_t> block(1);
+        BounceGenerator<std::uint32_t> generator(block, settings);
+        generator.Start();
+        ... poll block.Registers()[0] and debounce ...
+        generator.Stop();
+    @endcode
+*/
+
+#ifndef SimulatedRegisters_INCLUDED_H
+#define SimulatedRegisters_INCLUDED_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+
+/// Block of Word registers placed into mapped memory
+template<class Word>
+class SimulatedRegisterBlock{
+public:
+    /// Map registersCount registers (anonymous or file backed memory)
+    explicit SimulatedRegisterBlock(
+        unsigned registersCount, ///< Number of Word registers in the block
+        const char* filePath = nullptr ///< File to map, nullptr means anonymous
+    ) : count(registersCount), size(registersCount * sizeof(Word))
+    {
+        int fd = -1;
+        int flags = MAP_SHARED | MAP_ANONYMOUS;
+        if( filePath ){
+            fd = open(filePath, O_RDWR | O_CREAT, 0600);
+            if( fd < 0 || ftruncate(fd, static_cast<off_t>(size)) != 0 ){
+                std::perror("SimulatedRegisterBlock: cannot prepare file");
+                std::abort();
+            }
+            flags = MAP_SHARED;
+        }
+        void* mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, fd, 0);
+        if( fd >= 0 ){
+            close(fd); // mapping stays valid
+        }
+        if( mapped == MAP_FAILED ){
+            std::perror("SimulatedRegisterBlock: mmap failed");
+            std::abort();
+        }
+        registers = static_cast<volatile Word*>(mapped);
+        for(unsigned i = 0; i < count; ++i){
+            registers[i] = 0;
+        }
+    }
+
+    SimulatedRegisterBlock(const SimulatedRegisterBlock&) = delete;
+    SimulatedRegisterBlock& operator=(const SimulatedRegisterBlock&) = delete;
+
+    ~SimulatedRegisterBlock(){
+        munmap(const_cast<Word*>(registers), size);
+    }
+
+    /// Registers as seen by the code under test
+    volatile Word* Registers() const{
+        return registers;
+    }
+
+    /// Number of registers in the block
+    unsigned Count() const{
+        return count;
+    }
+
+private:
+    unsigned count;
+    std::size_t size;
+    volatile Word* registers;
+};
+
+
+/// Parameters of the bounce patterns being generated
+struct BounceSettings{
+    /// Average pause between events (on any channel), microseconds
+    unsigned eventPeriodUs = 2000;
+    /// Maximal number of toggles before the level becomes stable
+    unsigned maxBounces = 8;
+    /// Maximal interval between toggles while bouncing, microseconds
+    unsigned maxBounceGapUs = 200;
+    /// Minimal time each channel stays stable after the event, microseconds
+    /** shall be larger than debounce time, otherwise events merge */
+    unsigned minStableUs = 20000;
+    /// Seed for pseudo random patterns (the same seed means the same pattern)
+    unsigned seed = 42;
+};
+
+
+/// Thread injecting bounce patterns into SimulatedRegisterBlock
+template<class Word>
+class BounceGenerator{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// Number of channels in single register
+    static constexpr unsigned BitsPerWord = sizeof(Word) * 8;
+
+    BounceGenerator(SimulatedRegisterBlock<Word>& targetBlock, const BounceSettings& bounceSettings)
+        : block(targetBlock)
+        , settings(bounceSettings)
+        , channels(targetBlock.Count() * BitsPerWord)
+        , settled(new std::atomic<long long>[channels])
+        , events(0)
+        , running(false)
+    {
+        for(unsigned c = 0; c < channels; ++c){
+            settled[c].store(0);
+        }
+    }
+
+    ~BounceGenerator(){
+        Stop();
+        delete[] settled;
+    }
+
+    /// Start generating in the separate thread
+    void Start(){
+        running = true;
+        worker = std::thread([this]{ run(); });
+    }
+
+    /// Stop generating (level of all channels stays as is)
+    /** The burst in progress is completed, so each counted event
+     * is the real level change, but the last one can be younger than
+     * minStableUs, keep polling that long to see it debounced */
+    void Stop(){
+        if( worker.joinable() ){
+            running = false;
+            worker.join();
+        }
+    }
+
+    /// Time (nanoseconds of Clock) when the channel became stable last time
+    long long SettledAt(unsigned channel) const{
+        return settled[channel].load(std::memory_order_acquire);
+    }
+
+    /// Number of (stable) level changes generated so far
+    unsigned long Events() const{
+        return events.load();
+    }
+
+    /// Parameters the patterns are generated with
+    const BounceSettings& Settings() const{
+        return settings;
+    }
+
+    /// Current time in the same units as SettledAt
+    static long long Now(){
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            Clock::now().time_since_epoch()
+        ).count();
+    }
+
+private:
+    SimulatedRegisterBlock<Word>& block;
+    const BounceSettings settings;
+    const unsigned channels;
+
+    std::atomic<long long>* settled;
+    std::atomic<unsigned long> events;
+    std::atomic<bool> running;
+    std::thread worker;
+
+    static void sleepUs(unsigned us){
+        std::this_thread::sleep_for(std::chrono::microseconds(us));
+    }
+
+    void toggle(unsigned channel){
+        __atomic_fetch_xor(
+            block.Registers() + channel / BitsPerWord,
+            static_cast<Word>(Word(1) << (channel % BitsPerWord)),
+            __ATOMIC_RELEASE
+        );
+    }
+
+    void run(){
+        std::mt19937 rnd(settings.seed);
+        std::vector<long long> busyUntil(channels, 0);
+
+        while( running ){
+            sleepUs(1 + rnd() % (2 * settings.eventPeriodUs));
+
+            const unsigned channel = rnd() % channels;
+            if( Now() < busyUntil[channel] ){
+                continue; // let debouncer see previous level first
+            }
+
+            // odd number of toggles in total changes the level
+            // (burst is never interrupted by Stop, otherwise level returns back)
+            const unsigned bounces = 2 * (rnd() % (settings.maxBounces / 2 + 1));
+            for(unsigned b = 0; b < bounces; ++b){
+                toggle(channel);
+                sleepUs(1 + rnd() % settings.maxBounceGapUs);
+            }
+            toggle(channel);
+
+            const long long now = Now();
+            settled[channel].store(now, std::memory_order_release);
+            busyUntil[channel] = now + 1000LL * settings.minStableUs;
+            ++events;
+        }
+    }
+};
+
+#endif
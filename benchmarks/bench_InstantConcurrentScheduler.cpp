@@ -0,0 +1,104 @@
+/** @file benchmarks/bench_InstantConcurrentScheduler.cpp
+    @brief ConcurrentScheduler against Scheduler protected by std::mutex
+
+    1..maxProducers threads schedule own nodes with delays spread over
+    DelaySpread ticks (every CancelEach-th schedule is cancelled right away),
+    while the main thread is the consumer calling ExecuteAll with growing
+    time until everything is executed. Printed is the rate of schedule
+    requests (including cancels) for the whole run, and the share of
+    the run spent by producers (the rest is the consumer draining).
+
+    Usage: bench_InstantConcurrentScheduler [maxProducers] [schedulesPerProducer]
+*/
+
+#include "InstantCriticalSectionHost.h"
+#include "InstantConcurrentScheduler.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/// Delays are 0..DelaySpread-1 ticks, so there is always a pending set
+constexpr unsigned DelaySpread = 64;
+/// Every CancelEach-th schedule is cancelled just after it is made
+constexpr unsigned CancelEach = 8;
+
+template<class Node, class SchedulerType>
+void Run(const char* name, unsigned producersCount, unsigned long perProducer){
+    SchedulerType scheduler;
+    scheduler.Start(0);
+
+    unsigned long executed = 0; // consumer only (callbacks run there)
+    auto onExecute = [&executed]{ ++executed; };
+
+    // each schedule uses own node (ActionNode callback is one shot)
+    std::vector<Node> nodes(producersCount * perProducer);
+    for(auto& node : nodes){
+        node.Set(onExecute);
+    }
+
+    std::atomic<bool> go(false);
+    std::atomic<unsigned> done(0);
+    std::vector<std::thread> producers;
+    for(unsigned p = 0; p < producersCount; ++p){
+        producers.emplace_back([&, p]{
+            Node* mine = &nodes[p * perProducer];
+            while( !go.load(std::memory_order_acquire) ){}
+            for(unsigned long i = 0; i < perProducer; ++i){
+                mine[i].ScheduleAfter(scheduler, (i * 7 + p) % DelaySpread);
+                if( i % CancelEach == 0 ){
+                    mine[i].Cancel();
+                }
+            }
+            ++done;
+        });
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    go = true;
+    typename SchedulerType::Ticks now = 0;
+    while( done.load(std::memory_order_acquire) < producersCount ){
+        scheduler.ExecuteAll(++now);
+    }
+    const auto producersDone = std::chrono::steady_clock::now();
+    typename SchedulerType::Ticks next;
+    while( scheduler.HasNextTicks(&next) ){
+        scheduler.ExecuteAll(++now);
+    }
+    const auto end = std::chrono::steady_clock::now();
+    for(auto& producer : producers){
+        producer.join();
+    }
+
+    const double seconds = std::chrono::duration<double>(end - start).count();
+    const double producersSeconds = std::chrono::duration<double>(producersDone - start).count();
+    const unsigned long requests = producersCount * perProducer;
+    std::printf("%-40s producers=%-2u %8.2f M requests/s (producers %3.0f%%, executed %lu)\n",
+        name, producersCount,
+        double(requests + requests / CancelEach) / seconds / 1e6,
+        100.0 * producersSeconds / seconds, executed);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]){
+    const unsigned maxProducers = argc > 1 ? unsigned(std::atoi(argv[1])) : 16;
+    const unsigned long perProducer = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 20000;
+
+    std::printf("%u hardware threads, delays over %u ticks, each %u-th schedule cancelled\n",
+        std::thread::hardware_concurrency(), DelaySpread, CancelEach);
+
+    for(unsigned producers = 1; producers <= maxProducers; producers *= 2){
+        Run<ConcurrentActionNode, ConcurrentScheduler>(
+            "ConcurrentScheduler (inbox + heap)", producers, perProducer);
+        Run<ActionNode, SchedulerWithCriticalSection<CriticalSectionStdMutex>>(
+            "Scheduler + CriticalSectionStdMutex", producers, perProducer);
+        std::printf("\n");
+    }
+    return 0;
+}
@@ -0,0 +1,124 @@
+/** @file benchmarks/bench_InstantCriticalSection.cpp
+    @brief Cost of critical section policies alone and under contention
+
+    First the uncontended Enter/Leave pair is measured for each policy
+    (also through CriticalSectionReference, as Scheduler/CommonBlockPool do),
+    then 1..maxThreads threads hammer the same policy instance:
+     - "counter": short section incrementing shared counter
+     - "BlockPool": AllocateRaw/FreeRaw on the pool protected by the policy
+    Throughput (sections per second) is printed for each thread count.
+
+    Usage: bench_InstantCriticalSection [maxThreads] [sectionsPerThread]
+*/
+
+#include "InstantCriticalSectionHost.h"
+#include "InstantMemory.h"
+#include "InstantBenchmark.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/// Measure single Enter/Leave pair without other threads
+template<class CriticalSection>
+void MeasureUncontended(const char* name){
+    CriticalSection criticalSection;
+    unsigned long counter = 0;
+    InstantBenchmark::Measure(name, 10000000, [&]{
+        criticalSection.Enter();
+        ++counter;
+        criticalSection.Leave();
+    });
+    InstantBenchmark::DoNotOptimize(counter);
+}
+
+/// Run body(threadIndex) perThread times in each of threadsCount threads
+template<class Body>
+double RunThreads(unsigned threadsCount, unsigned long perThread, Body&& body){
+    std::atomic<bool> go(false);
+    std::vector<std::thread> threads;
+    for(unsigned t = 0; t < threadsCount; ++t){
+        threads.emplace_back([&, t]{
+            while( !go.load(std::memory_order_acquire) ){}
+            for(unsigned long i = 0; i < perThread; ++i){
+                body(t);
+            }
+        });
+    }
+    const auto start = std::chrono::steady_clock::now();
+    go = true;
+    for(auto& thread : threads){
+        thread.join();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return double(threadsCount * perThread) / seconds / 1e6;
+}
+
+template<class CriticalSection>
+void MeasureContended(const char* name, unsigned threadsCount, unsigned long perThread){
+    {
+        CriticalSection criticalSection;
+        unsigned long counter = 0;
+        const double rate = RunThreads(threadsCount, perThread, [&](unsigned){
+            criticalSection.Enter();
+            ++counter;
+            criticalSection.Leave();
+        });
+        std::printf("%-28s counter   threads=%-2u %8.2f M sections/s%s\n",
+            name, threadsCount, rate,
+            counter == threadsCount * perThread ? "" : "  <-- BROKEN");
+    }
+    {
+        BlockPool<64, 64, CommonBlockPool::Metadata, CriticalSection> pool;
+        const double rate = RunThreads(threadsCount, perThread, [&](unsigned){
+            void* block = pool.AllocateRaw();
+            InstantBenchmark::DoNotOptimize(block);
+            CommonBlockPool::FreeRaw(block);
+        });
+        std::printf("%-28s BlockPool threads=%-2u %8.2f M alloc+free/s\n",
+            name, threadsCount, rate);
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]){
+    const unsigned maxThreads = argc > 1 ? unsigned(std::atoi(argv[1])) : 16;
+    const unsigned long perThread = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 200000;
+
+    std::printf("%u hardware threads\n\n", std::thread::hardware_concurrency());
+
+    MeasureUncontended<CriticalSectionNone>("CriticalSectionNone");
+    MeasureUncontended<CriticalSectionSpinLock>("CriticalSectionSpinLock");
+#ifdef InstantCriticalSection_HasFutex
+    MeasureUncontended<CriticalSectionFutex>("CriticalSectionFutex");
+#endif
+    MeasureUncontended<CriticalSectionStdMutex>("CriticalSectionStdMutex");
+    {
+        CriticalSectionSpinLock spinLock;
+        CriticalSectionReference reference(spinLock);
+        unsigned long counter = 0;
+        InstantBenchmark::Measure("CriticalSectionReference(SpinLock)", 10000000, [&]{
+            reference.Enter();
+            ++counter;
+            reference.Leave();
+        });
+        InstantBenchmark::DoNotOptimize(counter);
+    }
+    std::printf("\n");
+
+    for(unsigned threads = 1; threads <= maxThreads; threads *= 2){
+        MeasureContended<CriticalSectionSpinLock>("CriticalSectionSpinLock", threads, perThread);
+#ifdef InstantCriticalSection_HasFutex
+        MeasureContended<CriticalSectionFutex>("CriticalSectionFutex", threads, perThread);
+#endif
+        MeasureContended<CriticalSectionStdMutex>("CriticalSectionStdMutex", threads, perThread);
+        std::printf("\n");
+    }
+    return 0;
+}
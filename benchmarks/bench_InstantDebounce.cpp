@@ -0,0 +1,81 @@
+/** @file benchmarks/bench_InstantDebounce.cpp
+    @brief Compare SimpleDebounceBank with separate SimpleDebounce instances
+
+    256 inputs are polled in a continuous loop,
+    a few of them chatter from time to time.
+*/
+
+#include "InstantDebounce.h"
+#include "InstantBenchmark.h"
+
+#include <cstdio>
+
+namespace {
+
+constexpr unsigned NumChannels = 256;
+using Bank = SimpleDebounceBank<NumChannels>;
+using Ticks = SimpleDebounce::Ticks;
+
+constexpr unsigned long Iterations = 200000;
+
+/// Pseudo random input where roughly one channel of "rarity" flips each poll
+struct InputGenerator{
+    unsigned long raw[Bank::WordsCount] = {};
+    unsigned seed = 1;
+
+    void Next(unsigned rarity){
+        seed = seed * 1103515245u + 12345u;
+        if( (seed >> 16) % rarity == 0 ){
+            unsigned channel = (seed >> 8) % NumChannels;
+            raw[channel / Bank::BitsPerWord] ^= 1UL << (channel % Bank::BitsPerWord);
+        }
+    }
+    bool Bit(unsigned channel) const {
+        return (raw[channel / Bank::BitsPerWord] >> (channel % Bank::BitsPerWord)) & 1;
+    }
+};
+
+void RunScenario(const char* title, unsigned rarity){
+    std::printf("\n%s\n", title);
+
+    {
+        static SimpleDebounce* singles[NumChannels];
+        for(auto& s: singles){
+            s = new SimpleDebounce(false, 20);
+        }
+        InputGenerator input;
+        Ticks now = 0;
+        unsigned long changes = 0;
+        InstantBenchmark::Measure("256 x SimpleDebounce", Iterations, [&]{
+            input.Next(rarity);
+            ++now;
+            for(unsigned i = 0; i < NumChannels; ++i){
+                changes += singles[i]->Discover(now, input.Bit(i));
+            }
+        });
+        InstantBenchmark::DoNotOptimize(changes);
+        for(auto s: singles){
+            delete s;
+        }
+    }
+    {
+        Bank bank(0, 20); // each scenario starts from the initial state
+        InputGenerator input;
+        Ticks now = 0;
+        unsigned long changes = 0;
+        InstantBenchmark::Measure("SimpleDebounceBank<256>", Iterations, [&]{
+            input.Next(rarity);
+            ++now;
+            changes += bank.Discover(now, input.raw);
+        });
+        InstantBenchmark::DoNotOptimize(changes);
+    }
+}
+
+} // namespace
+
+int main(){
+    RunScenario("Quiet inputs (rare changes):", 64);
+    RunScenario("Busy inputs (change on each poll):", 1);
+    return 0;
+}
@@ -0,0 +1,140 @@
+/** @file benchmarks/bench_InstantIntrusiveHashTable.cpp
+    @brief IntrusiveHashTable lookup/insert/remove from 1k to 1M items
+
+    For each size the same items are linked into IntrusiveHashTable
+    (starting small and growing into the second bucket array incrementally),
+    IntrusiveTree and (for small sizes only) IntrusiveList,
+    then lookup of random existing key and remove + insert
+    of random item are measured.
+
+    Usage: bench_InstantIntrusiveHashTable [maxItems]
+*/
+
+#include "InstantIntrusiveHashTable.h"
+#include "InstantIntrusiveTree.h"
+#include "InstantBenchmark.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+struct ItemHash;
+struct ItemLess;
+
+/// Maximal number of items benchmarked
+constexpr unsigned MaxItems = 1u << 20;
+
+using Table = IntrusiveHashTable<struct Item, unsigned, ItemHash, MaxItems / 4, MaxItems>;
+
+/// Item can be linked into all containers at the same time
+struct Item:
+    public Table::Node,
+    public IntrusiveTree<Item, ItemLess>::Node,
+    public IntrusiveList<Item>::Node
+{
+    unsigned key = 0;
+};
+
+struct ItemHash{
+    unsigned long operator()(unsigned key) const { return key * 2654435761UL; }
+    unsigned operator()(const Item& item) const { return item.key; }
+};
+
+struct ItemLess{
+    bool operator()(const Item& a, const Item& b) const { return a.key < b.key; }
+    bool operator()(const Item& a, unsigned key) const { return a.key < key; }
+    bool operator()(unsigned key, const Item& b) const { return key < b.key; }
+};
+
+using Tree = IntrusiveTree<Item, ItemLess>;
+using List = IntrusiveList<Item>;
+
+/// Unique keys in "random" order (odd multiplier permutes 32 bit values)
+unsigned NextKey(){
+    static unsigned counter = 0;
+    return counter++ * 2246822519u;
+}
+
+void RunSize(unsigned itemsCount){
+    std::mt19937 rnd(itemsCount);
+    std::vector<Item> items(itemsCount);
+    for(auto& item : items){
+        item.key = NextKey();
+    }
+
+    const unsigned long iterations = 2000000;
+    char name[64];
+
+    {
+        // table is too large for the stack
+        Table* table = new Table;
+        for(auto& item : items){
+            table->Insert(&item);
+        }
+        std::snprintf(name, sizeof(name), "IntrusiveHashTable find     n=%u", itemsCount);
+        InstantBenchmark::Measure(name, iterations, [&]{
+            InstantBenchmark::DoNotOptimize(table->Find(items[rnd() % itemsCount].key));
+        });
+        std::snprintf(name, sizeof(name), "IntrusiveHashTable reinsert n=%u", itemsCount);
+        InstantBenchmark::Measure(name, iterations, [&]{
+            Item& item = items[rnd() % itemsCount];
+            table->Remove(&item);
+            item.key = NextKey();
+            table->Insert(&item);
+        });
+        table->Clear();
+        delete table;
+    }
+    {
+        Tree tree;
+        for(auto& item : items){
+            tree.Insert(&item);
+        }
+        std::snprintf(name, sizeof(name), "IntrusiveTree find          n=%u", itemsCount);
+        InstantBenchmark::Measure(name, iterations, [&]{
+            InstantBenchmark::DoNotOptimize(tree.Find(items[rnd() % itemsCount].key));
+        });
+        std::snprintf(name, sizeof(name), "IntrusiveTree reinsert      n=%u", itemsCount);
+        InstantBenchmark::Measure(name, iterations, [&]{
+            Item& item = items[rnd() % itemsCount];
+            tree.Remove(&item);
+            item.key = NextKey();
+            tree.Insert(&item);
+        });
+        while( tree.RemoveFirst() ){}
+    }
+    if( itemsCount <= 10000 ){
+        List list;
+        for(auto& item : items){
+            list.InsertAtBack(&item);
+        }
+        std::snprintf(name, sizeof(name), "IntrusiveList scan          n=%u", itemsCount);
+        InstantBenchmark::Measure(name, iterations / itemsCount + 100, [&]{
+            const unsigned key = items[rnd() % itemsCount].key;
+            for(auto& item : list){
+                if( item.key == key ){
+                    InstantBenchmark::DoNotOptimize(&item);
+                    break;
+                }
+            }
+        });
+        while( list.RemoveAtFront() ){}
+    }
+    std::printf("\n");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]){
+    unsigned maxItems = argc > 1 ? unsigned(std::atoi(argv[1])) : MaxItems;
+    if( maxItems > MaxItems ){
+        maxItems = MaxItems;
+    }
+    for(unsigned n = 1000; n <= maxItems; n *= 10){
+        RunSize(n);
+    }
+    return 0;
+}
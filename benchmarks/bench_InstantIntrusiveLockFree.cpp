@@ -0,0 +1,132 @@
+/** @file benchmarks/bench_InstantIntrusiveLockFree.cpp
+    @brief Thread scaling of IntrusiveMpscQueue and IntrusiveLockFreeStack
+
+    1..maxProducers producer threads hand over preallocated nodes
+    to the single consumer thread (the main one), which takes them
+    in batches, throughput (handovers per second) is printed
+    for each structure and for mutex guarded IntrusiveSList
+    used as the baseline.
+
+    Usage: bench_InstantIntrusiveLockFree [maxProducers] [itemsPerProducer]
+*/
+
+#include "InstantIntrusiveLockFree.h"
+#include "InstantIntrusiveList.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Message:
+    public IntrusiveMpscQueue<Message>::Node,
+    public IntrusiveLockFreeStack<Message>::Node,
+    public IntrusiveSList<Message>::Node
+{
+    unsigned long payload = 0;
+};
+
+/// Run producers and consumer, consume(sum&) shall return taken count
+template<class Produce, class Consume>
+void Run(const char* name, unsigned producers, unsigned long perProducer,
+         Produce&& produce, Consume&& consume)
+{
+    std::vector<Message> messages(producers * perProducer);
+    std::atomic<bool> go(false);
+
+    std::vector<std::thread> threads;
+    for(unsigned p = 0; p < producers; ++p){
+        threads.emplace_back([&, p]{
+            while( !go.load(std::memory_order_acquire) ){}
+            Message* first = &messages[p * perProducer];
+            for(unsigned long i = 0; i < perProducer; ++i){
+                first[i].payload = i;
+                produce(first + i);
+            }
+        });
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    go = true;
+    const unsigned long total = producers * perProducer;
+    unsigned long taken = 0;
+    unsigned long sum = 0;
+    while( taken < total ){
+        const unsigned long now = consume(sum);
+        if( !now ){
+            std::this_thread::yield(); // let producers run on busy hosts
+        }
+        taken += now;
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for(auto& thread : threads){
+        thread.join();
+    }
+
+    const unsigned long expectedSum = producers * (perProducer * (perProducer - 1) / 2);
+    std::printf("%-34s producers=%-2u %8.2f M handovers/s%s\n",
+        name, producers, double(total) / seconds / 1e6,
+        sum == expectedSum ? "" : "  <-- LOST ITEMS");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]){
+    const unsigned maxProducers = argc > 1 ? unsigned(std::atoi(argv[1])) : 16;
+    const unsigned long perProducer = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 200000;
+
+    std::printf("%u hardware threads\n", std::thread::hardware_concurrency());
+
+    for(unsigned producers = 1; producers <= maxProducers; producers *= 2){
+        {
+            IntrusiveMpscQueue<Message> queue;
+            Run("IntrusiveMpscQueue PopBatch", producers, perProducer,
+                [&](Message* m){ queue.Push(m); },
+                [&](unsigned long& sum){
+                    return queue.PopBatch([&](Message* m){ sum += m->payload; });
+                });
+        }
+        {
+            IntrusiveLockFreeStack<Message> stack;
+            Run("IntrusiveLockFreeStack PopAll", producers, perProducer,
+                [&](Message* m){ stack.Push(m); },
+                [&](unsigned long& sum){
+                    unsigned long count = 0;
+                    for(Message* m = stack.PopAll(); m; m = m->NextLockFreeStackNode()){
+                        sum += m->payload;
+                        ++count;
+                    }
+                    return count;
+                });
+        }
+        {
+            IntrusiveSList<Message> list;
+            std::mutex mutex;
+            Run("std::mutex + IntrusiveSList", producers, perProducer,
+                [&](Message* m){
+                    std::lock_guard<std::mutex> lock(mutex);
+                    list.InsertAtBack(m);
+                },
+                [&](unsigned long& sum){
+                    IntrusiveSList<Message> taken;
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        taken.SpliceAtBack(list);
+                    }
+                    unsigned long count = 0;
+                    while( Message* m = taken.RemoveAtFront() ){
+                        sum += m->payload;
+                        ++count;
+                    }
+                    return count;
+                });
+        }
+        std::printf("\n");
+    }
+    return 0;
+}
@@ -0,0 +1,141 @@
+/** @file benchmarks/bench_InstantIntrusiveSkipList.cpp
+    @brief IntrusiveSkipList against std::mutex guarded IntrusiveTree
+
+    Each thread owns a ring of nodes: it inserts the next node of the ring
+    with random key, removes the node inserted RingSize/2 steps ago
+    (so each removed node waits long before reuse, see quiescence note
+    for IntrusiveSkipList) and looks up two random keys per step.
+    Total operations per second are printed for 1..maxThreads threads.
+
+    Usage: bench_InstantIntrusiveSkipList [maxThreads] [stepsPerThread]
+*/
+
+#include "InstantIntrusiveLockFree.h"
+#include "InstantIntrusiveTree.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct ItemLess;
+
+struct Item:
+    public IntrusiveSkipList<Item, ItemLess>::Node,
+    public IntrusiveTree<Item, ItemLess>::Node
+{
+    unsigned key = 0;
+};
+
+struct ItemLess{
+    bool operator()(const Item& a, const Item& b) const { return a.key < b.key; }
+    bool operator()(const Item& a, unsigned key) const { return a.key < key; }
+    bool operator()(unsigned key, const Item& b) const { return key < b.key; }
+};
+
+/// Nodes owned by each thread
+constexpr unsigned RingSize = 4096;
+
+template<class Insert, class Remove, class Lookup>
+void Run(const char* name, unsigned threadsCount, unsigned long steps,
+         Insert&& insert, Remove&& remove, Lookup&& lookup)
+{
+    std::vector<std::vector<Item>> rings;
+    for(unsigned t = 0; t < threadsCount; ++t){
+        rings.emplace_back(RingSize);
+    }
+    // prefill half of each ring, so the structure holds RingSize/2 per thread
+    for(unsigned t = 0; t < threadsCount; ++t){
+        std::mt19937 rnd(t);
+        for(unsigned i = 0; i < RingSize / 2; ++i){
+            rings[t][i].key = rnd();
+            insert(&rings[t][i]);
+        }
+    }
+
+    std::atomic<bool> go(false);
+    std::vector<std::thread> threads;
+    for(unsigned t = 0; t < threadsCount; ++t){
+        threads.emplace_back([&, t]{
+            std::mt19937 rnd(1000 + t);
+            std::vector<Item>& ring = rings[t];
+            unsigned position = RingSize / 2;
+            while( !go.load(std::memory_order_acquire) ){}
+            for(unsigned long s = 0; s < steps; ++s){
+                Item& fresh = ring[position % RingSize];
+                fresh.key = rnd();
+                insert(&fresh);
+                remove(&ring[(position + RingSize / 2) % RingSize]);
+                ++position;
+                lookup(static_cast<unsigned>(rnd()));
+                lookup(static_cast<unsigned>(rnd()));
+            }
+        });
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    go = true;
+    for(auto& thread : threads){
+        thread.join();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // cleanup what is left
+    for(auto& ring : rings){
+        for(auto& item : ring){
+            if( item.IntrusiveSkipList<Item, ItemLess>::Node::IsInSkipList()
+                || item.IntrusiveTree<Item, ItemLess>::Node::IsInTree() )
+            {
+                remove(&item);
+            }
+        }
+    }
+
+    std::printf("%-36s threads=%-2u %8.2f M ops/s\n",
+        name, threadsCount, double(4 * steps * threadsCount) / seconds / 1e6);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]){
+    const unsigned maxThreads = argc > 1 ? unsigned(std::atoi(argv[1])) : 8;
+    const unsigned long steps = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 200000;
+
+    std::printf("%u hardware threads, mix: 1 insert + 1 remove + 2 lookups\n",
+        std::thread::hardware_concurrency());
+
+    for(unsigned threads = 1; threads <= maxThreads; threads *= 2){
+        {
+            IntrusiveSkipList<Item, ItemLess> skipList;
+            Run("IntrusiveSkipList (lock-free)", threads, steps,
+                [&](Item* item){ skipList.Insert(item); },
+                [&](Item* item){ skipList.Remove(item); },
+                [&](unsigned key){ return skipList.LowerBound(key); });
+        }
+        {
+            IntrusiveTree<Item, ItemLess> tree;
+            std::mutex mutex;
+            Run("std::mutex + IntrusiveTree", threads, steps,
+                [&](Item* item){
+                    std::lock_guard<std::mutex> lock(mutex);
+                    tree.Insert(item);
+                },
+                [&](Item* item){
+                    std::lock_guard<std::mutex> lock(mutex);
+                    tree.Remove(item);
+                },
+                [&](unsigned key){
+                    std::lock_guard<std::mutex> lock(mutex);
+                    return tree.LowerBound(key);
+                });
+        }
+        std::printf("\n");
+    }
+    return 0;
+}
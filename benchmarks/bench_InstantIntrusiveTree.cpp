@@ -0,0 +1,121 @@
+/** @file benchmarks/bench_InstantIntrusiveTree.cpp
+    @brief IntrusiveTree against ordered IntrusiveList
+
+    Both containers keep the same items ordered by key,
+    for each size the benchmark measures ordered insertion + removal
+    of a random item (the way timers/sessions are rescheduled)
+    and lower bound search of a random key.
+    IntrusiveList has to walk linearly, IntrusiveTree needs O(log n).
+
+    Usage: bench_InstantIntrusiveTree [maxItems]
+*/
+
+#include "InstantIntrusiveTree.h"
+#include "InstantIntrusiveList.h"
+#include "InstantBenchmark.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+struct ItemLess;
+
+/// Item can be linked into both containers at the same time
+class Item:
+    public IntrusiveTree<Item, ItemLess>::Node,
+    public IntrusiveList<Item>::Node
+{
+public:
+    unsigned key = 0;
+};
+
+struct ItemLess{
+    bool operator()(const Item& a, const Item& b) const { return a.key < b.key; }
+    bool operator()(const Item& a, unsigned key) const { return a.key < key; }
+    bool operator()(unsigned key, const Item& b) const { return key < b.key; }
+};
+
+using Tree = IntrusiveTree<Item, ItemLess>;
+using List = IntrusiveList<Item>;
+
+/// Ordered insertion into the list (linear search for the place)
+void ListInsert(List& list, Item* item){
+    for(auto& existing : list){
+        if( item->key < existing.key ){
+            existing.InsertPrevChainElement(item);
+            return;
+        }
+    }
+    list.InsertAtBack(item);
+}
+
+Item* ListLowerBound(List& list, unsigned key){
+    for(auto& existing : list){
+        if( !(existing.key < key) ){
+            return &existing;
+        }
+    }
+    return nullptr;
+}
+
+void RunSize(unsigned itemsCount){
+    std::mt19937 rnd(itemsCount);
+    std::vector<Item> items(itemsCount);
+    for(auto& item : items){
+        item.key = rnd();
+    }
+
+    const unsigned long iterations = 4000000UL / itemsCount + 1000;
+    char name[64];
+
+    {
+        Tree tree;
+        for(auto& item : items){
+            tree.Insert(&item);
+        }
+        std::snprintf(name, sizeof(name), "IntrusiveTree reinsert     n=%u", itemsCount);
+        InstantBenchmark::Measure(name, iterations, [&]{
+            Item& item = items[rnd() % itemsCount];
+            tree.Remove(&item);
+            item.key = rnd();
+            tree.Insert(&item);
+        });
+        std::snprintf(name, sizeof(name), "IntrusiveTree lower bound  n=%u", itemsCount);
+        InstantBenchmark::Measure(name, iterations, [&]{
+            InstantBenchmark::DoNotOptimize(tree.LowerBound(static_cast<unsigned>(rnd())));
+        });
+        while( tree.RemoveFirst() ){}
+    }
+    {
+        List list;
+        for(auto& item : items){
+            ListInsert(list, &item);
+        }
+        std::snprintf(name, sizeof(name), "IntrusiveList reinsert     n=%u", itemsCount);
+        InstantBenchmark::Measure(name, iterations, [&]{
+            Item& item = items[rnd() % itemsCount];
+            item.RemoveFromChain();
+            item.key = rnd();
+            ListInsert(list, &item);
+        });
+        std::snprintf(name, sizeof(name), "IntrusiveList lower bound  n=%u", itemsCount);
+        InstantBenchmark::Measure(name, iterations, [&]{
+            InstantBenchmark::DoNotOptimize(ListLowerBound(list, static_cast<unsigned>(rnd())));
+        });
+        while( list.RemoveAtFront() ){}
+    }
+    std::printf("\n");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]){
+    const unsigned maxItems = argc > 1 ? unsigned(std::atoi(argv[1])) : 10000;
+    for(unsigned n = 10; n <= maxItems; n *= 10){
+        RunSize(n);
+    }
+    return 0;
+}
@@ -0,0 +1,156 @@
+/** @file benchmarks/bench_InstantLatency.cpp
+    @brief Event to callback latency on Linux host (pinned threads)
+
+    Producer thread (pinned to the last CPU) emulates interrupt:
+    it captures timestamp with LatencyProbe::Mark and raises "IRQ flag".
+    Main thread (pinned to CPU 0) emulates firmware loop:
+    it picks the flag up, triggers MulticastToActions, ActionNode
+    listening there resolves Thenable being awaited by the Task,
+    and latency is recorded at each stage:
+        0 - loop noticed the event (before MulticastToActions trigger)
+        1 - ActionNode callback executes
+        2 - Task resumes after await
+    Histograms for each stage are printed at the end.
+
+    Usage: bench_InstantLatency [events] [maxPauseUs]
+*/
+
+#include "InstantLatency.h"
+#include "InstantScheduler.h"
+#include "InstantTask.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+namespace {
+
+using Probe = LatencyProbe<3, 32>;
+Probe probe("producer thread");
+
+const auto startTime = std::chrono::steady_clock::now();
+
+/// Nanoseconds since start (fits Ticks on 64 bit hosts)
+Probe::Ticks Now(){
+    return static_cast<Probe::Ticks>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - startTime
+        ).count()
+    );
+}
+
+void PinToCpu(unsigned cpu){
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if( pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0 ){
+        std::printf("NOTE: cannot pin thread to CPU %u\n", cpu);
+    }
+}
+
+std::atomic<bool> irqFlag(false);
+std::atomic<bool> producing(true);
+
+/// Resolved by ActionNode, awaited by the Task
+ThenableToResolve<void> eventArrived;
+
+/// Listens to the multicast triggered by the loop
+ActionNode listener;
+
+void OnEvent(){
+    // ActionNode callback is "one shot", attach again for the next event
+    listener.Set(&OnEvent);
+    probe.Stage(1, Now());
+    eventArrived();
+}
+
+TaskDefine(EventTask){
+    TaskBegin(void){
+        for(;;){
+            TaskAwaitForCompletion(eventArrived);
+            probe.Complete(Now());
+        }
+    }
+    TaskEnd();
+};
+
+void PrintHistogram(const char* stageName, const Probe::Histogram& histogram){
+    std::printf("\n%s: samples=%lu min=%lu avg=%lu p50<=%lu p99<=%lu max=%lu ns\n",
+        stageName, histogram.Samples(),
+        histogram.Min(), histogram.Average(),
+        histogram.Percentile(50), histogram.Percentile(99), histogram.Max());
+
+    Probe::Histogram::Counter largest = 1;
+    for(unsigned b = 0; b < histogram.BucketsCount; ++b){
+        if( histogram.Count(b) > largest ){
+            largest = histogram.Count(b);
+        }
+    }
+    for(unsigned b = 0; b < histogram.BucketsCount; ++b){
+        if( !histogram.Count(b) ){
+            continue;
+        }
+        std::printf("  <= %12lu ns %10lu |", histogram.BucketUpperBound(b), histogram.Count(b));
+        const unsigned bar = static_cast<unsigned>(50 * histogram.Count(b) / largest);
+        for(unsigned i = 0; i < bar; ++i){
+            std::putchar('#');
+        }
+        std::putchar('\n');
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]){
+    const unsigned long events = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+    const unsigned maxPauseUs = argc > 2 ? unsigned(std::atoi(argv[2])) : 200;
+
+    const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if( cpus < 2 ){
+        std::printf("NOTE: single CPU, producer and loop share it (latency includes preemption)\n");
+    }
+
+    std::thread producer([&]{
+        PinToCpu(static_cast<unsigned>(cpus > 1 ? cpus - 1 : 0));
+        std::mt19937 rnd(7);
+        for(unsigned long i = 0; i < events; ++i){
+            std::this_thread::sleep_for(std::chrono::microseconds(1 + rnd() % maxPauseUs));
+            // "interrupt" happens here
+            probe.Mark(Now());
+            irqFlag.store(true, std::memory_order_release);
+        }
+        producing = false;
+    });
+
+    PinToCpu(0);
+
+    MulticastToActions eventMulticast;
+    listener.Set(&OnEvent).ListenSubscribe(eventMulticast);
+
+    EventTask task;
+    task.StartAndExplicitlyIgnore();
+
+    // firmware like loop
+    while( producing || irqFlag.load(std::memory_order_acquire) ){
+        if( irqFlag.exchange(false, std::memory_order_acq_rel) ){
+            probe.Stage(0, Now());
+            eventMulticast();
+        }
+    }
+    producer.join();
+    listener.Cancel(); // shall not be destroyed while listening
+
+    std::printf("Event source \"%s\": %lu events, %lu overruns\n",
+        probe.Name(), events, probe.Overruns());
+    PrintHistogram("Stage 0 (loop noticed)", probe.StageHistogram(0));
+    PrintHistogram("Stage 1 (ActionNode executed)", probe.StageHistogram(1));
+    PrintHistogram("Stage 2 (Task resumed)", probe.StageHistogram(2));
+    return 0;
+}
@@ -0,0 +1,141 @@
+/** @file benchmarks/bench_InstantSignals.cpp
+    @brief End to end debouncing of simulated bouncing registers
+
+    32 channels of the SimulatedRegisterBlock register are driven
+    by BounceGenerator, the main thread polls the register in a loop
+    the same way firmware does, and every debouncing strategy is measured
+    for detection latency (from the moment the level became stable
+    till the change is reported) and CPU cost per poll.
+    Each strategy sees the same pseudo random pattern.
+
+    Usage: bench_InstantSignals [secondsPerStrategy] [fileToMap]
+*/
+
+#include "InstantSignals.h"
+#include "InstantDebounce.h"
+#include "InstantBenchmark.h"
+#include "SimulatedRegisters.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <time.h>
+
+namespace {
+
+using Word = std::uint32_t;
+constexpr unsigned NumChannels = 32;
+
+/// Debounce time all strategies try to provide, microseconds
+constexpr unsigned DebounceUs = 4000;
+
+double secondsPerStrategy = 2.0;
+const char* fileToMap = nullptr;
+
+double threadCpuNs(){
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return double(ts.tv_sec) * 1e9 + double(ts.tv_nsec);
+}
+
+/// Run single strategy: poll(time, raw) shall return mask of changed channels
+template<class Poll>
+void RunStrategy(const char* name, Poll&& poll){
+    SimulatedRegisterBlock<Word> block(1, fileToMap);
+    BounceGenerator<Word> generator(block, BounceSettings());
+    const volatile Word* reg = block.Registers();
+
+    InstantBenchmark::LatencySamples latencies;
+    unsigned long detected = 0;
+    unsigned long polls = 0;
+
+    auto pollOnce = [&]{
+        const long long now = BounceGenerator<Word>::Now();
+        Word changed = poll(static_cast<SimpleDebounce::Ticks>(now / 1000), *reg);
+        ++polls;
+        while( changed ){
+            const unsigned channel = __builtin_ctz(changed);
+            changed &= changed - 1;
+            latencies.Add(double(now - generator.SettledAt(channel)));
+            ++detected;
+        }
+    };
+
+    const double cpuStart = threadCpuNs();
+    generator.Start();
+    const long long finish = BounceGenerator<Word>::Now() + (long long)(secondsPerStrategy * 1e9);
+    while( BounceGenerator<Word>::Now() < finish ){
+        pollOnce();
+    }
+    generator.Stop();
+    // let the last event stay stable long enough to complete debouncing
+    const long long drain = BounceGenerator<Word>::Now()
+        + 1000LL * generator.Settings().minStableUs;
+    while( BounceGenerator<Word>::Now() < drain ){
+        pollOnce();
+    }
+    const double cpuNs = threadCpuNs() - cpuStart;
+
+    latencies.Print(name);
+    std::printf("%-48s events=%lu detected=%lu polls=%lu cpu=%.1f ns/poll%s\n\n",
+        "", generator.Events(), detected, polls, cpuNs / double(polls),
+        generator.Events() == detected ? "" : "  <-- MISMATCH");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]){
+    if( argc > 1 ){
+        secondsPerStrategy = std::atof(argv[1]);
+    }
+    if( argc > 2 ){
+        fileToMap = argv[2];
+    }
+
+    std::printf("%u channels, debounce %u us, %.1f s per strategy\n\n",
+        NumChannels, DebounceUs, secondsPerStrategy);
+
+    {
+        // vertical counters need SamplesToAccept stable samples
+        constexpr unsigned SampleUs = DebounceUs / BitsDebounce<Word>::SamplesToAccept;
+        BitsDebounce<Word> debounce;
+        SimpleDebounce::Ticks nextSample = 0;
+        bool first = true;
+        RunStrategy("BitsDebounce (sampling by time)", [&](SimpleDebounce::Ticks now, Word raw) -> Word{
+            if( first ){
+                nextSample = now;
+                first = false;
+            }
+            if( (now - nextSample) > SimpleTimer::DeltaMax ){
+                return 0;
+            }
+            nextSample += SampleUs;
+            return debounce.Discover(raw);
+        });
+    }
+    {
+        SimpleDebounceBank<NumChannels, Word> bank(0, DebounceUs);
+        RunStrategy("SimpleDebounceBank<32>", [&](SimpleDebounce::Ticks now, Word raw) -> Word{
+            return bank.Discover(now, raw);
+        });
+    }
+    {
+        static SimpleDebounce* singles[NumChannels];
+        for(auto& s: singles){
+            s = new SimpleDebounce(false, DebounceUs);
+        }
+        RunStrategy("32 x SimpleDebounce", [&](SimpleDebounce::Ticks now, Word raw) -> Word{
+            Word changed = 0;
+            for(unsigned i = 0; i < NumChannels; ++i){
+                if( singles[i]->Discover(now, (raw >> i) & 1) ){
+                    changed |= Word(1) << i;
+                }
+            }
+            return changed;
+        });
+        for(auto s: singles){
+            delete s;
+        }
+    }
+    return 0;
+}
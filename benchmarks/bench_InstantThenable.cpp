@@ -0,0 +1,196 @@
+/** @file benchmarks/bench_InstantThenable.cpp
+    @brief ThenableLockFree handshake against Thenable with critical sections
+
+    Ping-pong: the main thread resolves "ping" and awaits "pong" via Then,
+    the other thread awaits "ping" and resolves "pong", so each round trip
+    is two cross-thread handshakes where resolve races with subscribe.
+    Waiting for the callback spins a little and then yields
+    (so it also works on a single core).
+    Then the same thenable is resolved and subscribed from one thread
+    in both orders to show the uncontended cost of the handshake.
+    Finally parse -> filter -> convert -> handle pipeline is called
+    through ThenableChain and through hand chained Delegate stages.
+
+    Usage: bench_InstantThenable [roundTrips] [singleThreadIterations]
+*/
+
+#include "InstantCriticalSectionHost.h"
+#include "InstantThenable.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+namespace {
+
+/// Spin that long before yielding to other threads
+constexpr int SpinsBeforeYield = 1000;
+
+/// Wait until the callback has reported the round
+void WaitFor(const std::atomic<unsigned long>& received, unsigned long round){
+    int spins = 0;
+    while( received.load(std::memory_order_acquire) < round ){
+        if( ++spins < SpinsBeforeYield ){
+            InstantCriticalSection_CpuRelax();
+        }
+        else{
+            std::this_thread::yield();
+        }
+    }
+}
+
+template<class Policy>
+void PingPong(const char* name, unsigned long roundTrips){
+    ThenableToResolve<unsigned long, Policy> ping;
+    ThenableToResolve<unsigned long, Policy> pong;
+
+    std::atomic<unsigned long> pingsReceived(0);
+    std::atomic<unsigned long> pongsReceived(0);
+    auto onPing = [&](const unsigned long& value){
+        pingsReceived.store(value, std::memory_order_release);
+    };
+    auto onPong = [&](const unsigned long& value){
+        pongsReceived.store(value, std::memory_order_release);
+    };
+
+    std::thread other([&]{
+        for(unsigned long round = 1; round <= roundTrips; ++round){
+            ping.Then(onPing);
+            WaitFor(pingsReceived, round);
+            pong(round);
+        }
+    });
+
+    const auto start = std::chrono::steady_clock::now();
+    for(unsigned long round = 1; round <= roundTrips; ++round){
+        pong.Then(onPong);
+        ping(round);
+        WaitFor(pongsReceived, round);
+    }
+    const auto end = std::chrono::steady_clock::now();
+    other.join();
+
+    const double seconds = std::chrono::duration<double>(end - start).count();
+    std::printf("%-40s %8.2f M round trips/s %8.1f ns/round trip\n",
+        name, double(roundTrips) / seconds / 1e6, seconds * 1e9 / double(roundTrips));
+}
+
+template<class Policy>
+void SingleThread(const char* name, unsigned long iterations){
+    ThenableToResolve<unsigned long, Policy> thenable;
+    unsigned long sum = 0;
+    auto add = [&](const unsigned long& value){ sum += value; };
+
+    const auto start = std::chrono::steady_clock::now();
+    for(unsigned long i = 0; i < iterations; ++i){
+        if( i & 1 ){
+            thenable.Then(add);
+            thenable(i);
+        }
+        else{
+            thenable(i);
+            thenable.Then(add);
+        }
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    const double seconds = std::chrono::duration<double>(end - start).count();
+    std::printf("%-40s %8.2f ns/(resolve + Then) (sum %lu)\n",
+        name, seconds * 1e9 / double(iterations), sum);
+}
+
+
+/// Pipeline stages shared by both chain variants
+int Parse(const unsigned long& raw){ return int(raw % 1000) - 500; }
+bool IsPositive(const int& value){ return value > 0; }
+long Convert(const int& value){ return long(value) * 3 + 1; }
+
+/// Hand written stages, each calls the next one via Delegate
+class ParseStage{
+public:
+    explicit ParseStage(const Delegate<void(const int&)>& next): next(next) {}
+    void operator()(const unsigned long& raw){ next(Parse(raw)); }
+private:
+    Delegate<void(const int&)> next;
+};
+class FilterStage{
+public:
+    explicit FilterStage(const Delegate<void(const int&)>& next): next(next) {}
+    void operator()(const int& value){ if( IsPositive(value) ){ next(value); } }
+private:
+    Delegate<void(const int&)> next;
+};
+class ConvertStage{
+public:
+    explicit ConvertStage(const Delegate<void(const long&)>& next): next(next) {}
+    void operator()(const int& value){ next(Convert(value)); }
+private:
+    Delegate<void(const long&)> next;
+};
+
+/// Call the pipeline via Delegate (as Thenable would do) for every event
+template<class Pipeline>
+void Measure(const char* name, Pipeline& pipeline, long& sum, unsigned long iterations){
+    Delegate<void(const unsigned long&)> callback(pipeline);
+    sum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for(unsigned long i = 0; i < iterations; ++i){
+        callback(i * 7919);
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    const double seconds = std::chrono::duration<double>(end - start).count();
+    std::printf("%-40s %8.2f ns/event (sum %ld)\n",
+        name, seconds * 1e9 / double(iterations), sum);
+}
+
+void Chains(unsigned long iterations){
+    long sum = 0;
+    auto handle = [&](const long& value){ sum += value; };
+
+    // lambdas are distinct types, so the compiler sees every stage
+    auto fused = ThenableChain<>()
+        .Map([](const unsigned long& raw){ return Parse(raw); })
+        .Filter([](const int& value){ return IsPositive(value); })
+        .Map([](const int& value){ return Convert(value); })
+        .Then(handle);
+    Measure("ThenableChain of lambdas (fused)", fused, sum, iterations);
+
+    // function pointers are stored as values, calls stay indirect
+    auto pointers = ThenableChain<>()
+        .Map(Parse)
+        .Filter(IsPositive)
+        .Map(Convert)
+        .Then(handle);
+    Measure("ThenableChain of function pointers", pointers, sum, iterations);
+
+    ConvertStage convertStage{ Delegate<void(const long&)>(handle) };
+    FilterStage filterStage{ Delegate<void(const int&)>(convertStage) };
+    ParseStage parseStage{ Delegate<void(const int&)>(filterStage) };
+    Measure("Delegate per stage (hand chained)", parseStage, sum, iterations);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]){
+    const unsigned long roundTrips = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    const unsigned long iterations = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 10000000;
+
+    std::printf("%u hardware threads, %lu round trips\n",
+        std::thread::hardware_concurrency(), roundTrips);
+    PingPong<ThenableLockFree>("ThenableLockFree", roundTrips);
+    PingPong<CriticalSectionSpinLock>("CriticalSectionSpinLock", roundTrips);
+    PingPong<CriticalSectionStdMutex>("CriticalSectionStdMutex", roundTrips);
+
+    std::printf("\nsingle thread, %lu iterations\n", iterations);
+    SingleThread<ThenableLockFree>("ThenableLockFree", iterations);
+    SingleThread<CriticalSectionSpinLock>("CriticalSectionSpinLock", iterations);
+    SingleThread<CriticalSectionStdMutex>("CriticalSectionStdMutex", iterations);
+    SingleThread<CriticalSectionNone>("CriticalSectionNone", iterations);
+
+    std::printf("\nparse -> filter -> convert -> handle, %lu events\n", iterations);
+    Chains(iterations);
+    return 0;
+}
@@ -323,6 +323,11 @@ SOFTWARE.
 #   endif
 #endif
 
+//______________________________________________________________________________
+// All dependencies are only internal inside InstantRTOS
+
+#include "InstantTrace.h"
+
 
 //______________________________________________________________________________
 // Handle C++ versions (just skip to "Classes for handling tasks" below))
@@ -593,6 +598,7 @@ namespace InternalTrampolineDetails{
         template<LambdaListNodeType* obj>
         struct For{
             static Res apply(Args... args){
+                InstantTrace_Count(CallbackTrampoline);
                 // copy is needed to allow recursive allocation
                 auto copyOfLambda = static_cast<LambdaType&&>(obj->lambda);
                 // corresponding lambda moved from but still needs to be destructed
@@ -618,6 +624,7 @@ namespace InternalTrampolineDetails{
         template<LambdaListNodeType* obj>
         struct For{
             static Res apply(Args... args){
+                InstantTrace_Count(CallbackTrampoline);
                 CallbackExtendLifetimeImpl extendLifetime;
                 Res res = obj->lambda(extendLifetime, static_cast<Args&&>(args)...);
                 
@@ -640,6 +647,7 @@ namespace InternalTrampolineDetails{
         template<LambdaListNodeType* obj>
         struct For{
             static void apply(Args... args){
+                InstantTrace_Count(CallbackTrampoline);
                 CallbackExtendLifetimeImpl extendLifetime;
                 obj->lambda(extendLifetime, static_cast<Args&&>(args)...);
                 
@@ -0,0 +1,578 @@
+/** @file InstantConcurrentScheduler.h
+    @brief Scheduler mode where many threads/interrupts schedule and cancel
+           while single consumer executes, no lock shared between them
+
+Scheduler from InstantScheduler.h keeps all the items in one sorted list,
+so when it is protected (InstantScheduler_EnterCritical mapped to mutex or
+per instance critical section) every ScheduleAfter, Cancel and ExecuteOne
+from any thread contends on the same lock, and holds it during the
+linear search for the place in the list.
+
+ConcurrentScheduler splits that:
+ - producers (any thread/interrupt) only write the request into the
+   ConcurrentActionNode and push it to lock-free inbox (IntrusiveMpscQueue)
+ - cancellation is a flag in the node, the node is pushed again only when
+   consumer has to take it out of the pending set
+ - the single consumer thread (the one calling ExecuteOne/ExecuteAll)
+   drains the inbox and is the only one touching the pending set
+   (IntrusivePairingHeap ordered by time) and the ready list (IntrusiveList)
+
+Each node has own tiny spin lock bit guarding the request fields,
+it is held only for a few stores, so producers touching different nodes
+never wait for each other, and never wait for the consumer sorting items.
+
+Example usage:
+ @code
+    ConcurrentScheduler scheduler;
+
+    void Blink(){ ... }
+    ConcurrentActionNode blinkAction(Blink);
+
+    // any thread or interrupt
+    blinkAction.ScheduleAfter(scheduler, 100);
+    ...
+    blinkAction.Cancel();
+
+    // the consumer thread
+    scheduler.Start(GetTicks());
+    for(;;){
+        scheduler.ExecuteAll(GetTicks());
+    }
+ @endcode
+
+NOTE: callbacks run on the consumer thread, ConcurrentActionNode
+      can be set, moved to other ConcurrentScheduler or destroyed only
+      when it is not IsInScheduler (cancel is asynchronous, so wait for the
+      consumer to drop the node, like by checking IsInScheduler).
+
+MIT License
+
+Copyright (c) 2023 Pavlo M, see https://github.com/olvap80/InstantRTOS
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef InstantConcurrentScheduler_INCLUDED_H
+#define InstantConcurrentScheduler_INCLUDED_H
+
+//______________________________________________________________________________
+// Configurable error handling
+
+/* Common configuration to be included only if available
+   (you can separate file and/or configure individually
+    or just skip that to stick with defaults) */
+#if defined(__has_include) && __has_include("InstantRTOS.Config.h")
+#   include "InstantRTOS.Config.h"
+#endif
+
+#ifndef InstantConcurrentScheduler_Panic
+#   ifdef InstantRTOS_Panic
+#       define InstantConcurrentScheduler_Panic() InstantRTOS_Panic('R')
+#   else
+#       define InstantConcurrentScheduler_Panic() /* you can customize here! */ do{}while(true)
+#   endif
+#endif
+
+
+//______________________________________________________________________________
+// All dependencies are only internal inside InstantRTOS
+
+#include "InstantScheduler.h"
+#include "InstantIntrusiveLockFree.h"
+#include "InstantIntrusiveHeap.h"
+
+
+//______________________________________________________________________________
+// Public API
+
+class ConcurrentScheduler;
+
+/// Internal helpers for ConcurrentScheduler
+namespace InstantConcurrentSchedulerDetails{
+    /// Order of the pending set: by time, then FIFO for the same time
+    struct EarlierSchedule;
+}
+
+
+/// Item to be scheduled with ConcurrentScheduler from any thread/interrupt
+/** Unlike ActionNode the callback is persistent (executes on each schedule),
+ * there is no Then/ListenOnce, only scheduling and cancel. */
+class ConcurrentActionNode:
+    private IntrusiveMpscQueue<ConcurrentActionNode>::Node, // inbox
+    private IntrusivePairingHeap<
+        ConcurrentActionNode,
+        InstantConcurrentSchedulerDetails::EarlierSchedule
+    >::Node, // pending set (in the future)
+    private IntrusiveList<ConcurrentActionNode>::Node // ready (already due)
+{
+public:
+    //all the copying is banned (this ensures pointers are valid)
+    constexpr ConcurrentActionNode(const ConcurrentActionNode&) = delete;
+    ConcurrentActionNode& operator =(const ConcurrentActionNode&) = delete;
+
+    /// Type of the callback executed by the ConcurrentScheduler
+    using Callback = Delegate<void()>;
+
+    /// The time measurement unit (the same as for Scheduler)
+    using Ticks = ActionNode::Ticks;
+
+
+    /// Empty (do nothing) callback (use Set to assign callback later)
+    ConcurrentActionNode();
+
+    /// Wrap specified callback
+    ConcurrentActionNode(const Callback& callbackToExecute);
+
+    /// Destructor asserts node is not used by ConcurrentScheduler any more
+    ~ConcurrentActionNode();
+
+    /// Set new callback (allowed only when not IsInScheduler)
+    ConcurrentActionNode& Set(const Callback& callbackToExecute);
+
+
+    /// Schedule for execution "in next iteration" (any thread/interrupt)
+    /** Actually synonym to ScheduleAfter(targetScheduler, 1) */
+    ConcurrentActionNode& ScheduleLater(ConcurrentScheduler& targetScheduler);
+
+    /// Schedule for execution "in same iteration" (any thread/interrupt)
+    /** Actually synonym to ScheduleAfter(targetScheduler, 0) */
+    ConcurrentActionNode& ScheduleNow(ConcurrentScheduler& targetScheduler);
+
+    /// Schedule for execution after all items of the same time
+    /** Replaces previous request (if any), the ticksToWaitFirstTime is
+     * counted from the time currently known to targetScheduler.
+     * Node being in other ConcurrentScheduler cannot be scheduled
+     * (it is panic, Cancel and wait for !IsInScheduler first).
+     * Producers never wait for the consumer, it sorts the item later. */
+    ConcurrentActionNode& ScheduleAfter(
+        ConcurrentScheduler& targetScheduler,
+        Ticks ticksToWaitFirstTime,
+        Ticks periodTicks = 0
+    );
+
+    /// Prevent following executions (any thread/interrupt)
+    /** Once Cancel returns the callback is not started any more
+     * (but the one already running on the consumer thread completes),
+     * the node leaves the scheduler asynchronously, see IsInScheduler */
+    void Cancel();
+
+    /// Returns true if there is execution request not cancelled so far
+    bool IsScheduled() const;
+
+    /// Returns true while the ConcurrentScheduler still references the node
+    /** Node cannot be destroyed, Set or moved to other scheduler
+     * while this is true (false after cancel is handled by the consumer) */
+    bool IsInScheduler() const;
+
+private:
+    // Nodes must see ConcurrentActionNode as derived from self
+    friend class IntrusiveMpscQueue<ConcurrentActionNode>;
+    friend class IntrusiveMpscQueue<ConcurrentActionNode>::Node;
+    friend class IntrusivePairingHeap<
+        ConcurrentActionNode, InstantConcurrentSchedulerDetails::EarlierSchedule>;
+    friend class IntrusivePairingHeap<
+        ConcurrentActionNode, InstantConcurrentSchedulerDetails::EarlierSchedule>::Node;
+    friend class IntrusiveList<ConcurrentActionNode>;
+    friend class IntrusiveList<ConcurrentActionNode>::Node;
+
+    friend class ConcurrentScheduler;
+    friend struct InstantConcurrentSchedulerDetails::EarlierSchedule;
+
+    using Atomic = InstantIntrusiveLockFreeDetails::AtomicLink<unsigned>;
+
+    /// Bits of the state word
+    enum : unsigned{
+        LockFlag = 1,      ///< request fields are being changed
+        PostedFlag = 2,    ///< node is in the inbox (or is going to be pushed)
+        CancelledFlag = 4, ///< no executions any more
+        PendingFlag = 8,   ///< node is in the pending set or ready list
+        RunningFlag = 16,  ///< callback is running on the consumer thread
+        InSchedulerFlags = PostedFlag | PendingFlag | RunningFlag
+    };
+
+    /// What to execute (persistent)
+    Callback callback;
+
+    /// State bits (any thread)
+    unsigned volatile state = 0;
+
+    /// Scheduler the node goes to (written under LockFlag)
+    ConcurrentScheduler* scheduledWith = nullptr;
+    /// Absolute time requested by producer (written under LockFlag)
+    Ticks requestedTime = 0;
+    /// Period requested by producer (written under LockFlag)
+    Ticks requestedPeriod = 0;
+
+    /// Absolute schedule time as it is tracked by the consumer
+    Ticks absoluteScheduleTime = 0;
+    /// Period to reschedule again after execution (consumer only)
+    Ticks periodTicksAgain = 0;
+    /// Insertion order to keep FIFO for the same time (consumer only)
+    Ticks insertionOrder = 0;
+
+    /// Take LockFlag, @returns state bits before locking
+    unsigned lockState();
+    /// Publish new state bits and release LockFlag
+    void unlockState(unsigned newState);
+
+    /// Default callback
+    static void doNothing();
+};
+
+
+/// Scheduler where only ExecuteOne/ExecuteAll run on single consumer thread
+/** ConcurrentActionNode::ScheduleAfter and Cancel can be called from any
+ * thread/interrupt, all the sorting happens on the consumer thread,
+ * due items go to ready list (FIFO), future ones wait in pending set.
+ * Use HasNextTicks on the consumer to find when to wake up next time. */
+class ConcurrentScheduler{
+public:
+    //all the copying is banned (this ensures pointers are valid)
+    constexpr ConcurrentScheduler(const ConcurrentScheduler&) = delete;
+    ConcurrentScheduler& operator =(const ConcurrentScheduler&) = delete;
+
+    using Ticks = ConcurrentActionNode::Ticks;
+
+    /// Create initial empty ConcurrentScheduler
+    ConcurrentScheduler() = default;
+
+    /// Destructor asserts there is no node referencing this scheduler
+    ~ConcurrentScheduler();
+
+    /// Prepare initial time (consumer, before any schedule)
+    void Start(Ticks currentTicks);
+
+    /// Execute single due item (consumer only)
+    /** @return true if some item was executed */
+    bool ExecuteOne(
+        Ticks currentTicks ///< Current ticks that overflow
+    );
+
+    /// Execute all items that are due so far (consumer only)
+    /** @return true if at least one item was executed */
+    bool ExecuteAll(
+        Ticks currentTicks ///< Current ticks that overflow
+    );
+
+    /// Obtain when next event is going to happen (consumer only)
+    /** Requests posted so far are taken into account too
+     * @returns true if there is next time moment known
+     *          false if there is no scheduled moment at all */
+    bool HasNextTicks(Ticks* writeTo);
+
+    /// Obtain absolute ticks currently known to the scheduler (any thread)
+    Ticks KnownAbsoluteTicks() const;
+
+private:
+    friend class ConcurrentActionNode;
+
+    using AtomicTicks = InstantIntrusiveLockFreeDetails::AtomicLink<Ticks>;
+
+    /// Requests from producers (schedules and cancels of pending items)
+    IntrusiveMpscQueue<ConcurrentActionNode> inbox;
+
+    /// Items waiting for their time (consumer only)
+    IntrusivePairingHeap<
+        ConcurrentActionNode, InstantConcurrentSchedulerDetails::EarlierSchedule
+    > pendingSet;
+
+    /// Items already due, in execution order (consumer only)
+    IntrusiveList<ConcurrentActionNode> readyList;
+
+    /// Current absolute ticks (written by consumer, read by producers)
+    Ticks volatile knownAbsoluteTicks = 0;
+
+    /// Source of ConcurrentActionNode::insertionOrder (consumer only)
+    Ticks insertionCounter = 0;
+
+    /// Move items from pending set that are due now to the ready list
+    void moveDueToReady();
+    /// Apply all requests from inbox
+    void drainInbox();
+    /// Apply single request (node is locked by caller)
+    void applyRequest(ConcurrentActionNode* node, unsigned& newState);
+    /// Take node out of the pending set/ready list
+    void removeFromPending(ConcurrentActionNode* node);
+    /// Place node to the ready list or pending set depending on time
+    void placeByTime(ConcurrentActionNode* node);
+};
+
+
+
+//______________________________________________________________________________
+//##############################################################################
+/*==============================================================================
+*  Implementation details follow                                               *
+*=============================================================================*/
+//##############################################################################
+
+
+//______________________________________________________________________________
+// Implementing InstantConcurrentSchedulerDetails
+
+struct InstantConcurrentSchedulerDetails::EarlierSchedule{
+    bool operator()(const ConcurrentActionNode& a, const ConcurrentActionNode& b) const{
+        if( a.absoluteScheduleTime != b.absoluteScheduleTime ){
+            return ActionNode::TicksIsLess(a.absoluteScheduleTime, b.absoluteScheduleTime);
+        }
+        return ActionNode::TicksIsLess(a.insertionOrder, b.insertionOrder);
+    }
+};
+
+
+//______________________________________________________________________________
+// Implementing ConcurrentActionNode
+
+inline ConcurrentActionNode::ConcurrentActionNode()
+    : callback(&doNothing) {}
+
+inline ConcurrentActionNode::ConcurrentActionNode(const Callback& callbackToExecute)
+    : callback(callbackToExecute) {}
+
+inline ConcurrentActionNode::~ConcurrentActionNode(){
+    if( IsInScheduler() ){
+        // scheduler would reference destroyed node
+        InstantConcurrentScheduler_Panic();
+    }
+}
+
+inline ConcurrentActionNode& ConcurrentActionNode::Set(const Callback& callbackToExecute){
+    if( IsInScheduler() ){
+        // consumer may be reading the callback right now
+        InstantConcurrentScheduler_Panic();
+    }
+    callback = callbackToExecute;
+    return *this;
+}
+
+inline ConcurrentActionNode& ConcurrentActionNode::ScheduleLater(ConcurrentScheduler& targetScheduler){
+    return ScheduleAfter(targetScheduler, 1);
+}
+
+inline ConcurrentActionNode& ConcurrentActionNode::ScheduleNow(ConcurrentScheduler& targetScheduler){
+    return ScheduleAfter(targetScheduler, 0);
+}
+
+inline ConcurrentActionNode& ConcurrentActionNode::ScheduleAfter(
+    ConcurrentScheduler& targetScheduler,
+    Ticks ticksToWaitFirstTime,
+    Ticks periodTicks
+){
+    InstantTrace_Count(SchedulerSchedule);
+    const unsigned previousState = lockState();
+    if( (previousState & InSchedulerFlags) && scheduledWith != &targetScheduler ){
+        unlockState(previousState);
+        // the other consumer still owns links of this node
+        InstantConcurrentScheduler_Panic();
+        return *this;
+    }
+    scheduledWith = &targetScheduler;
+    requestedTime = targetScheduler.KnownAbsoluteTicks() + ticksToWaitFirstTime;
+    requestedPeriod = periodTicks;
+    unlockState( (previousState | PostedFlag) & ~unsigned(CancelledFlag) );
+
+    // already posted request will see new values once consumer takes it
+    if( !(previousState & PostedFlag) ){
+        targetScheduler.inbox.Push(this);
+    }
+    return *this;
+}
+
+inline void ConcurrentActionNode::Cancel(){
+    const unsigned previousState = lockState();
+    if( !(previousState & InSchedulerFlags) ){
+        unlockState(previousState);
+        return;
+    }
+    InstantTrace_Count(SchedulerCancel);
+    // pending item has to be taken out of the pending set by the consumer
+    const bool needPush = (previousState & PendingFlag) && !(previousState & PostedFlag);
+    unlockState( previousState | CancelledFlag | (needPush ? unsigned(PostedFlag) : 0u) );
+    if( needPush ){
+        scheduledWith->inbox.Push(this);
+    }
+}
+
+inline bool ConcurrentActionNode::IsScheduled() const{
+    const unsigned currentState = Atomic::Load(const_cast<unsigned volatile*>(&state));
+    return (currentState & (PostedFlag | PendingFlag)) && !(currentState & CancelledFlag);
+}
+
+inline bool ConcurrentActionNode::IsInScheduler() const{
+    return Atomic::Load(const_cast<unsigned volatile*>(&state)) & InSchedulerFlags;
+}
+
+inline unsigned ConcurrentActionNode::lockState(){
+    unsigned currentState = Atomic::Load(&state);
+    for(;;){
+        if( !(currentState & LockFlag) ){
+            if( Atomic::CompareExchange(&state, currentState, currentState | LockFlag) ){
+                return currentState;
+            }
+        }
+        else{
+            // held only for a few stores
+            InstantCriticalSection_CpuRelax();
+            currentState = Atomic::Load(&state);
+        }
+    }
+}
+
+inline void ConcurrentActionNode::unlockState(unsigned newState){
+    Atomic::Store(&state, newState & ~unsigned(LockFlag));
+}
+
+inline void ConcurrentActionNode::doNothing(){}
+
+
+//______________________________________________________________________________
+// Implementing ConcurrentScheduler
+
+inline ConcurrentScheduler::~ConcurrentScheduler(){
+    drainInbox();
+    if( !pendingSet.IsEmpty() || !readyList.IsEmpty() ){
+        // nodes would keep pointers into the destroyed scheduler
+        InstantConcurrentScheduler_Panic();
+    }
+}
+
+inline void ConcurrentScheduler::Start(Ticks currentTicks){
+    AtomicTicks::Store(&knownAbsoluteTicks, currentTicks);
+}
+
+inline bool ConcurrentScheduler::ExecuteOne(Ticks currentTicks){
+    AtomicTicks::Store(&knownAbsoluteTicks, currentTicks);
+    moveDueToReady();
+    drainInbox();
+
+    while( ConcurrentActionNode* node = readyList.RemoveAtFront() ){
+        unsigned nodeState = node->lockState();
+        if( nodeState & ConcurrentActionNode::CancelledFlag ){
+            /* cancelled after the inbox was drained,
+               the request is in the inbox already (Cancel pushed it) */
+            node->unlockState(nodeState & ~unsigned(ConcurrentActionNode::PendingFlag));
+            continue;
+        }
+        node->unlockState(
+            (nodeState & ~unsigned(ConcurrentActionNode::PendingFlag))
+            | ConcurrentActionNode::RunningFlag
+        );
+        InstantTrace_Count(SchedulerExecute);
+        InstantTrace_Add(SchedulerLateTicks, currentTicks - node->absoluteScheduleTime);
+
+        node->callback();
+
+        nodeState = node->lockState() & ~unsigned(ConcurrentActionNode::RunningFlag);
+        /* posted request (new schedule or cancel) wins over the period,
+           it will be applied from the inbox */
+        if( !(nodeState & (ConcurrentActionNode::PostedFlag | ConcurrentActionNode::CancelledFlag))
+            && node->periodTicksAgain )
+        {
+            node->absoluteScheduleTime = currentTicks + node->periodTicksAgain;
+            placeByTime(node);
+            nodeState |= ConcurrentActionNode::PendingFlag;
+        }
+        node->unlockState(nodeState);
+        return true;
+    }
+    return false;
+}
+
+inline bool ConcurrentScheduler::ExecuteAll(Ticks currentTicks){
+    bool res = false;
+    while( ExecuteOne(currentTicks) ){
+        res = true;
+    }
+    return res;
+}
+
+inline bool ConcurrentScheduler::HasNextTicks(Ticks* writeTo){
+    drainInbox();
+    if( !readyList.IsEmpty() ){
+        *writeTo = KnownAbsoluteTicks();
+        return true;
+    }
+    if( ConcurrentActionNode* top = pendingSet.Top() ){
+        *writeTo = top->absoluteScheduleTime;
+        return true;
+    }
+    return false;
+}
+
+inline ConcurrentScheduler::Ticks ConcurrentScheduler::KnownAbsoluteTicks() const{
+    return AtomicTicks::Load(const_cast<Ticks volatile*>(&knownAbsoluteTicks));
+}
+
+inline void ConcurrentScheduler::moveDueToReady(){
+    const Ticks now = KnownAbsoluteTicks();
+    while( ConcurrentActionNode* top = pendingSet.Top() ){
+        if( ActionNode::TicksIsLess(now, top->absoluteScheduleTime) ){
+            break;
+        }
+        pendingSet.Pop();
+        readyList.InsertAtBack(top);
+    }
+}
+
+inline void ConcurrentScheduler::drainInbox(){
+    inbox.PopBatch([this](ConcurrentActionNode* node){
+        unsigned newState = node->lockState();
+        applyRequest(node, newState);
+        node->unlockState(newState);
+    });
+}
+
+inline void ConcurrentScheduler::applyRequest(ConcurrentActionNode* node, unsigned& newState){
+    newState &= ~unsigned(ConcurrentActionNode::PostedFlag);
+    if( newState & ConcurrentActionNode::PendingFlag ){
+        removeFromPending(node);
+        newState &= ~unsigned(ConcurrentActionNode::PendingFlag);
+    }
+    if( newState & ConcurrentActionNode::CancelledFlag ){
+        return;
+    }
+    node->absoluteScheduleTime = node->requestedTime;
+    node->periodTicksAgain = node->requestedPeriod;
+    placeByTime(node);
+    newState |= ConcurrentActionNode::PendingFlag;
+}
+
+inline void ConcurrentScheduler::removeFromPending(ConcurrentActionNode* node){
+    if( static_cast<IntrusivePairingHeap<
+            ConcurrentActionNode, InstantConcurrentSchedulerDetails::EarlierSchedule
+        >::Node*>(node)->IsInHeap() )
+    {
+        pendingSet.Remove(node);
+    }
+    else{
+        static_cast<IntrusiveList<ConcurrentActionNode>::Node*>(node)->RemoveFromChain();
+    }
+}
+
+inline void ConcurrentScheduler::placeByTime(ConcurrentActionNode* node){
+    if( ActionNode::TicksIsLess(KnownAbsoluteTicks(), node->absoluteScheduleTime) ){
+        node->insertionOrder = insertionCounter++;
+        pendingSet.Insert(node);
+    }
+    else{
+        readyList.InsertAtBack(node);
+    }
+}
+
+#endif
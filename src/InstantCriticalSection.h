@@ -0,0 +1,305 @@
+/** @file InstantCriticalSection.h
+    @brief Critical section policies to be selected per instance
+
+The InstantRTOS_EnterCritical/InstantRTOS_LeaveCritical macros configure
+protection for all the instances of the header at once, here are policy
+classes to pass where per instance choice is needed
+(Scheduler, BlockPool, Thenable can be protected by different policies
+ in the same program):
+    - CriticalSectionNone - no protection at all (compiles to nothing)
+    - CriticalSectionInterrupts - disable interrupts (AVR, Cortex-M, ESP8266)
+    - CriticalSectionSpinLock - test and test-and-set with exponential backoff
+Policies needing system headers (CriticalSectionFutex, CriticalSectionStdMutex)
+live in InstantCriticalSectionHost.h, include it explicitly on host platforms.
+
+Each policy is a class with Enter() and Leave() methods and IsNoOp constant
+(custom policies are welcome, just follow the same pattern).
+CriticalSectionReference refers any policy without knowing the type
+(for non template classes like Scheduler).
+
+Example usage:
+ @code
+    CriticalSectionSpinLock schedulerLock;
+    Scheduler scheduler(schedulerLock); //ScheduleAfter from other threads is safe
+
+    BlockPool<32, 10, CommonBlockPool::Metadata, CriticalSectionSpinLock> pool;
+ @endcode
+
+NOTE: policies are not recursive, the same policy instance
+      shall not be entered twice by the same thread.
+
+MIT License
+
+Copyright (c) 2023 Pavlo M, see https://github.com/olvap80/InstantArduino
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef InstantCriticalSection_INCLUDED_H
+#define InstantCriticalSection_INCLUDED_H
+
+//______________________________________________________________________________
+// Configurable options (InstantCriticalSection specific)
+
+/* Common configuration to be included only if available
+   (you can separate file and/or configure individually
+    or just skip that to stick with defaults) */
+#if defined(__has_include) && __has_include("InstantRTOS.Config.h")
+#   include "InstantRTOS.Config.h"
+#endif
+
+/* Compiler provided atomic builtins are needed for CriticalSectionSpinLock
+   (for AVR builtins are not lock free, use CriticalSectionInterrupts there) */
+#if !defined(InstantCriticalSection_UseBuiltinAtomics) \
+    && !defined(InstantCriticalSection_SuppressBuiltinAtomics) \
+    && (defined(__GNUC__) || defined(__clang__)) && !defined(__AVR__)
+#   define InstantCriticalSection_UseBuiltinAtomics
+#endif
+
+/// Pause instruction to be used by the spinning thread
+#ifndef InstantCriticalSection_CpuRelax
+#   if defined(__i386__) || defined(__x86_64__)
+#       define InstantCriticalSection_CpuRelax() __builtin_ia32_pause()
+#   elif defined(__aarch64__) || (defined(__ARM_ARCH) && __ARM_ARCH >= 7)
+#       define InstantCriticalSection_CpuRelax() __asm__ volatile("yield" ::: "memory")
+#   else
+#       define InstantCriticalSection_CpuRelax() __asm__ volatile("" ::: "memory")
+#   endif
+#endif
+
+/// Give the CPU to other thread once spinning takes too long
+/** (InstantCriticalSectionHost.h sets sched_yield when included first) */
+#ifndef InstantCriticalSection_Yield
+#   define InstantCriticalSection_Yield() InstantCriticalSection_CpuRelax()
+#endif
+
+
+//______________________________________________________________________________
+// Public API
+
+/// No protection at all (the same object is used from single thread/context)
+class CriticalSectionNone{
+public:
+    /// There is no need to enter/leave at all (can be used to skip locking)
+    static constexpr bool IsNoOp = true;
+
+    void Enter(){}
+    void Leave(){}
+};
+
+
+#ifdef InstantRTOS_DisableInterrupts
+
+/// Disable interrupts on Enter, restore previous interrupt state on Leave
+/** The cheapest protection for single core MCU,
+ * keep such sections as short as possible!
+ * Available once InstantRTOS_DisableInterrupts is configured
+ * (see InstantRTOS.Config.CPU.h) */
+class CriticalSectionInterrupts{
+public:
+    static constexpr bool IsNoOp = false;
+
+    void Enter();
+    void Leave();
+
+private:
+    /// State before Enter (nested Enter of the same instance is not allowed)
+    InstantRTOS_InterruptStateType savedState;
+};
+
+#endif
+
+
+#ifdef InstantCriticalSection_UseBuiltinAtomics
+
+/// Spin lock with exponential backoff (for short sections between cores)
+/** The test and test-and-set loop reads the flag without writing while
+ * lock is busy, then waits for 1, 2, 4 ... MaxBackoff pauses between
+ * attempts and yields the CPU once backoff reaches MaxBackoff
+ * (so the owner is not starved on oversubscribed hosts) */
+class CriticalSectionSpinLock{
+public:
+    static constexpr bool IsNoOp = false;
+    /// Maximum number of pause instructions between attempts
+    static constexpr unsigned MaxBackoff = 1024;
+
+    void Enter();
+    void Leave();
+
+    /// Try to Enter without waiting, @returns true if entered
+    bool TryEnter();
+
+private:
+    volatile bool locked = false;
+};
+
+#endif
+
+
+/// Refer any critical section policy instance without knowing its type
+/** Used by non template classes (Scheduler, CommonBlockPool) to select
+ * protection per instance, default constructed one does nothing
+ * (the same as reference to CriticalSectionNone)
+ * REMEMBER: referred policy object shall live as long as the reference */
+class CriticalSectionReference{
+public:
+    /// No protection
+    constexpr CriticalSectionReference() = default;
+
+    /// No protection (nothing to call at all)
+    CriticalSectionReference(CriticalSectionNone&) {}
+
+    /// Copy refers the same policy instance
+    CriticalSectionReference(const CriticalSectionReference&) = default;
+    /// Non const copy shall not go to template constructor below
+    CriticalSectionReference(CriticalSectionReference&) = default;
+    CriticalSectionReference& operator=(const CriticalSectionReference&) = default;
+
+    /// Refer policy instance (policy shall outlive the reference)
+    template<class CriticalSection>
+    CriticalSectionReference(CriticalSection& criticalSectionToUse);
+
+    /// Test there is nothing to do on Enter/Leave
+    bool IsNoOp() const;
+
+    void Enter() const;
+    void Leave() const;
+
+private:
+    /// Table of calls for the referred policy (one per policy type)
+    struct Operations{
+        void (*enter)(void* criticalSection);
+        void (*leave)(void* criticalSection);
+    };
+    template<class CriticalSection>
+    struct OperationsFor{
+        static void Enter(void* criticalSection);
+        static void Leave(void* criticalSection);
+        static const Operations value;
+    };
+
+    void* criticalSection = nullptr;
+    const Operations* operations = nullptr;
+};
+
+
+
+//______________________________________________________________________________
+//##############################################################################
+/*==============================================================================
+*  Implementation details follow                                               *
+*=============================================================================*/
+//##############################################################################
+
+
+#ifdef InstantRTOS_DisableInterrupts
+
+//______________________________________________________________________________
+// Implementing CriticalSectionInterrupts
+
+inline void CriticalSectionInterrupts::Enter(){
+    InstantRTOS_InterruptStateType state;
+    InstantRTOS_DisableInterrupts(state);
+    savedState = state; // written only after interrupts are disabled
+}
+
+inline void CriticalSectionInterrupts::Leave(){
+    InstantRTOS_RestoreInterrupts(savedState);
+}
+
+#endif
+
+
+#ifdef InstantCriticalSection_UseBuiltinAtomics
+
+//______________________________________________________________________________
+// Implementing CriticalSectionSpinLock
+
+inline void CriticalSectionSpinLock::Enter(){
+    unsigned backoff = 1;
+    while( __atomic_exchange_n(&locked, true, __ATOMIC_ACQUIRE) ){
+        // wait with reading only (do not bounce cache line between cores)
+        do{
+            if( backoff < MaxBackoff ){
+                for(unsigned i = 0; i < backoff; ++i){
+                    InstantCriticalSection_CpuRelax();
+                }
+                backoff *= 2;
+            }
+            else{
+                InstantCriticalSection_Yield();
+            }
+        } while( __atomic_load_n(&locked, __ATOMIC_RELAXED) );
+    }
+}
+
+inline void CriticalSectionSpinLock::Leave(){
+    __atomic_store_n(&locked, false, __ATOMIC_RELEASE);
+}
+
+inline bool CriticalSectionSpinLock::TryEnter(){
+    return !__atomic_load_n(&locked, __ATOMIC_RELAXED)
+        && !__atomic_exchange_n(&locked, true, __ATOMIC_ACQUIRE);
+}
+
+#endif
+
+
+//______________________________________________________________________________
+// Implementing CriticalSectionReference
+
+template<class CriticalSection>
+inline CriticalSectionReference::CriticalSectionReference(CriticalSection& criticalSectionToUse)
+    :   criticalSection(&criticalSectionToUse),
+        operations(&OperationsFor<CriticalSection>::value) {}
+
+inline bool CriticalSectionReference::IsNoOp() const{
+    return nullptr == operations;
+}
+
+inline void CriticalSectionReference::Enter() const{
+    if( operations ){
+        operations->enter(criticalSection);
+    }
+}
+
+inline void CriticalSectionReference::Leave() const{
+    if( operations ){
+        operations->leave(criticalSection);
+    }
+}
+
+template<class CriticalSection>
+void CriticalSectionReference::OperationsFor<CriticalSection>::Enter(void* criticalSection){
+    static_cast<CriticalSection*>(criticalSection)->Enter();
+}
+
+template<class CriticalSection>
+void CriticalSectionReference::OperationsFor<CriticalSection>::Leave(void* criticalSection){
+    static_cast<CriticalSection*>(criticalSection)->Leave();
+}
+
+template<class CriticalSection>
+const CriticalSectionReference::Operations
+    CriticalSectionReference::OperationsFor<CriticalSection>::value = {
+        &CriticalSectionReference::OperationsFor<CriticalSection>::Enter,
+        &CriticalSectionReference::OperationsFor<CriticalSection>::Leave
+    };
+
+#endif
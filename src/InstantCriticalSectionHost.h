@@ -0,0 +1,177 @@
+/** @file InstantCriticalSectionHost.h
+    @brief Critical section policies for host (desktop/server OS) platforms
+
+Policies here need system headers, so they are kept apart from
+InstantCriticalSection.h (to be included only explicitly, nothing in
+InstantRTOS includes this file):
+    - CriticalSectionFutex - Linux futex based mutex (sleeps when contended)
+    - CriticalSectionStdMutex - std::mutex wrapper
+
+Include this file before other InstantRTOS headers, then
+CriticalSectionSpinLock also gives the CPU away with sched_yield
+once spinning takes too long.
+
+Example usage:
+ @code
+    #include "InstantCriticalSectionHost.h"
+    #include "InstantScheduler.h"
+
+    SchedulerWithCriticalSection<CriticalSectionStdMutex> scheduler;
+ @endcode
+
+MIT License
+
+Copyright (c) 2023 Pavlo M, see https://github.com/olvap80/InstantArduino
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef InstantCriticalSectionHost_INCLUDED_H
+#define InstantCriticalSectionHost_INCLUDED_H
+
+//______________________________________________________________________________
+// Configurable options (InstantCriticalSectionHost specific)
+
+/// Give the CPU to other thread once spinning takes too long
+#if !defined(InstantCriticalSection_Yield) && defined(__has_include)
+#   if __has_include(<sched.h>)
+#       include <sched.h>
+#       define InstantCriticalSection_Yield() sched_yield()
+#   endif
+#endif
+
+#include "InstantCriticalSection.h"
+
+#include <mutex>
+
+
+//______________________________________________________________________________
+// Public API
+
+#if defined(__linux__) && defined(InstantCriticalSection_UseBuiltinAtomics) \
+    && defined(__has_include) && __has_include(<linux/futex.h>)
+#   define InstantCriticalSection_HasFutex
+
+/// Mutex on top of Linux futex (spins shortly, then sleeps in the kernel)
+/** Three state mutex (free, locked, locked with waiters) from
+ * "Futexes Are Tricky" by Ulrich Drepper, Leave performs system call
+ * only when somebody really waits */
+class CriticalSectionFutex{
+public:
+    static constexpr bool IsNoOp = false;
+    /// Attempts before going to sleep
+    static constexpr unsigned SpinCount = 100;
+
+    void Enter();
+    void Leave();
+
+private:
+    enum: int{ Free = 0, Locked = 1, Contended = 2 };
+    int state = Free;
+
+    static void wait(int* address, int expected);
+    static void wakeOne(int* address);
+};
+
+#endif
+
+
+/// Wrap std::mutex to be used as policy
+class CriticalSectionStdMutex{
+public:
+    static constexpr bool IsNoOp = false;
+
+    void Enter();
+    void Leave();
+
+private:
+    std::mutex mutex;
+};
+
+
+
+//______________________________________________________________________________
+//##############################################################################
+/*==============================================================================
+*  Implementation details follow                                               *
+*=============================================================================*/
+//##############################################################################
+
+
+#ifdef InstantCriticalSection_HasFutex
+
+//______________________________________________________________________________
+// Implementing CriticalSectionFutex
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+inline void CriticalSectionFutex::Enter(){
+    int current = Free;
+    if( __atomic_compare_exchange_n(&state, &current, int(Locked), false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED) ){
+        return; // fast path, no contention
+    }
+    // short spinning pays off when owner leaves soon
+    for(unsigned i = 0; i < SpinCount && current != Contended; ++i){
+        InstantCriticalSection_CpuRelax();
+        current = Free;
+        if( __atomic_compare_exchange_n(&state, &current, int(Locked), false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED) ){
+            return;
+        }
+    }
+    // announce there are waiters, so Leave will wake somebody
+    if( current != Contended ){
+        current = __atomic_exchange_n(&state, int(Contended), __ATOMIC_ACQUIRE);
+    }
+    while( current != Free ){
+        wait(&state, Contended);
+        current = __atomic_exchange_n(&state, int(Contended), __ATOMIC_ACQUIRE);
+    }
+}
+
+inline void CriticalSectionFutex::Leave(){
+    if( __atomic_exchange_n(&state, int(Free), __ATOMIC_RELEASE) == Contended ){
+        wakeOne(&state);
+    }
+}
+
+inline void CriticalSectionFutex::wait(int* address, int expected){
+    syscall(SYS_futex, address, FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+}
+
+inline void CriticalSectionFutex::wakeOne(int* address){
+    syscall(SYS_futex, address, FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+}
+
+#endif
+
+
+//______________________________________________________________________________
+// Implementing CriticalSectionStdMutex
+
+inline void CriticalSectionStdMutex::Enter(){
+    mutex.lock();
+}
+
+inline void CriticalSectionStdMutex::Leave(){
+    mutex.unlock();
+}
+
+#endif
@@ -6,12 +6,16 @@ There are two approaches for debouncing:
 
     - use DebounceAction or ButtonAction detecting new debounced value
         with the help of the scheduler (the preferred way!)
+        DebounceGroup does the same for many inputs sharing the same timing
+        with the help of the single ActionNode (scales for hundreds of inputs)
 
     - "Discover" debounced value with SimpleDebounce 
         by checking for debounced state "manually" in a loop
         (the "straight forward" way of iterative checks without Scheduler
         this time value in ticks/milliseconds/microseconds has to be provided
         "manually" by the user)
+        SimpleDebounceBank does the same for many inputs packed into bits
+        (single Discover call per loop iteration for all the inputs)
     
 
 Both approaches are covered in samples below.
@@ -116,6 +120,25 @@ SOFTWARE.
 #ifndef InstantDebounce_INCLUDED_H
 #define InstantDebounce_INCLUDED_H
 
+//______________________________________________________________________________
+// Configurable error handling
+
+/* Common configuration to be included only if available
+   (you can separate file and/or configure individually
+    or just skip that to stick with defaults) */
+#if defined(__has_include) && __has_include("InstantRTOS.Config.h")
+#   include "InstantRTOS.Config.h"
+#endif
+
+#ifndef InstantDebounce_Panic
+#   ifdef InstantRTOS_Panic
+#       define InstantDebounce_Panic() InstantRTOS_Panic('D')  
+#   else
+#       define InstantDebounce_Panic() /* you can customize here! */ do{}while(true)
+#   endif
+#endif
+
+
 //activate DebounceAction feature only if InstantScheduler dependency is present 
 #if __has_include("InstantScheduler.h") && __has_include("InstantDelegate.h")
 // The simplest possible portable scheduler suitable for embedded 
@@ -151,7 +174,7 @@ public:
 
     /// Current value considered to be filtered (debounced)
     bool Value() const{
-        return successCountCurrent >= successCountExpected;
+        return currentDebouncedVal;
     }
 
     /// Remove from the corresponding scheduler (and so prevent state detection)
@@ -160,6 +183,19 @@ public:
     }
     
 protected:
+    /// Setup initial instance parameters together with raw value checker
+    DebounceBase(
+        bool initialValue, ///< Value considered to be initial from start
+        Ticks checkIntervalTicks, ///< Interval between checks for raw value while debounce
+        IntervalCount totalIntervals, ///< How many intervals before debounce
+        const RawValueChecker& rawValueChecker ///< Read current raw value
+    )
+        : checker(rawValueChecker)
+        , currentDebouncedVal(initialValue)
+        , checkInterval(checkIntervalTicks)
+        , successCountExpected(totalIntervals)
+        {}
+
     /// Set DebounceBase into listening mode according to available settings
     void Schedule(
         Scheduler& targetScheduler,
@@ -167,7 +203,32 @@ protected:
         const ActionNode::Callback& callback
     ){
         checker = rawValueChecker;
-        action.Set(callback).ScheduleAfter(targetScheduler, checkInterval);
+        SchedulePeriodic(targetScheduler, callback);
+    }
+
+    /// Start periodic checks with already known raw value checker
+    void SchedulePeriodic(
+        Scheduler& targetScheduler,
+        const ActionNode::Callback& callback
+    ){
+        action.Set(callback).ScheduleAfter(targetScheduler, checkInterval, checkInterval);
+    }
+
+    /// Stop periodic checks and wait for the multicast call instead
+    /** The same ActionNode is used, so there are no periodic checks
+     *  while listening, callback is issued once multicast is called */
+    void ListenInstead(
+        MulticastToActions& multicast,
+        const ActionNode::Callback& callback
+    ){
+        action.Set(callback).ListenSubscribe(multicast);
+    }
+
+    /// Keep callback for the next periodic check
+    /** ActionNode callback is "one shot" (as with Thenable),
+     *  so handler shall attach self again on each check interval */
+    void Rearm(const ActionNode::Callback& callback){
+        action.Set(callback);
     }
 
     /// To be called from derived class
@@ -176,6 +237,8 @@ protected:
             if( ++successCountCurrent >= successCountExpected ){
                 // new value is the opposite of previous
                 currentDebouncedVal = !currentDebouncedVal;
+                // next change will be counted from scratch
+                successCountCurrent = 0;
                 return true; // Sign we have new value
             }
         }
@@ -185,7 +248,16 @@ protected:
         return false;
     }
 
-    
+    /// Test raw value was equal to debounced one during the last check
+    bool IsSettled() const{
+        return 0 == successCountCurrent;
+    }
+
+    /// Interval between checks for raw value while debounce
+    Ticks CheckInterval() const{
+        return checkInterval;
+    }
+
 private:
     /// Internal action to cooperate with the scheduler
     ActionNode action;
@@ -224,7 +296,7 @@ public:
 
     /// Setup callback to be issued once false value is debounced
     DebounceAction& OnFalse(const Callback& callbackOnFalse){
-        onTrue = callbackOnFalse;
+        onFalse = callbackOnFalse;
         return *this;
     }
 
@@ -233,11 +305,7 @@ public:
         Scheduler& targetScheduler,
         const RawValueChecker& checker
     ){
-        DebounceBase::Schedule(
-            targetScheduler,
-            checker,
-            ActionNode::Callback::From(this).Bind<&DebounceAction::ActionHandler>()
-        );
+        DebounceBase::Schedule(targetScheduler, checker, actionCallback());
     }
 
 
@@ -247,8 +315,14 @@ private:
     /// Called once false value is debounced
     Callback onFalse{ [](){} };
 
+    /// Callback to be attached to the ActionNode
+    ActionNode::Callback actionCallback(){
+        return ActionNode::Callback::From(this).Bind<&DebounceAction::ActionHandler>();
+    }
+
     /// Callback being issued bu the scheduler on each check interval
     void ActionHandler(){
+        Rearm(actionCallback());
         if( Discover() ){
             // New value discovered!
             if( Value() ){
@@ -262,7 +336,129 @@ private:
 };
 
 
+/// Debounce multiple digital values sharing the same timing (to be used with Scheduler)
+/** All channels are sampled from the single periodic ActionNode,
+ * so there is only one Scheduler entry regardless of the number of channels
+ * (with DebounceAction each input has own ActionNode being rescheduled).
+ * Channel state is kept as "structure of arrays" to make sampling loop tight,
+ * callbacks are issued only for those channels that have changed.
+ * @tparam MaxChannels the maximum number of channels to Add
+ * NOTE: all channels share the same checkInterval and totalIntervals */
+template<unsigned MaxChannels>
+class DebounceGroup{
+public:
+    //all the copying is banned (ActionNode inside is tied with this)
+    DebounceGroup(const DebounceGroup&) = delete;
+    DebounceGroup& operator =(const DebounceGroup&) = delete;
+
+    /// Callback used to check for raw value of the channel
+    using RawValueChecker = DebounceBase::RawValueChecker;
+    /// Callback invoked once status of the channel changes
+    using Callback = Delegate< void() >;
+
+    /// Units being used for time measurements 
+    using Ticks = Scheduler::Ticks;
+    /// Type to hold number of checks before considering value as debounced
+    using IntervalCount = DebounceBase::IntervalCount;
+    /// Identify channel inside DebounceGroup (as returned by Add)
+    using ChannelIndex = unsigned;
+
+    /// Setup timing common for all the channels
+    DebounceGroup(
+        Ticks checkIntervalTicks, ///< Interval between checks for raw values
+        IntervalCount totalIntervals ///< How many intervals before debounce
+    )
+        : checkInterval(checkIntervalTicks)
+        , successCountExpected(totalIntervals)
+        {}
+
+    /// Register new channel to be debounced (panic if there is no place)
+    /** @returns index of the channel to be used with other API */
+    ChannelIndex Add(
+        bool initialValue, ///< Value considered to be initial from start
+        const RawValueChecker& rawValueChecker ///< Read current raw value
+    );
+
+    /// Setup callback to be issued once true value is debounced for channel
+    /** Panics if channel was not obtained from Add */
+    DebounceGroup& OnTrue(ChannelIndex channel, const Callback& callbackOnTrue);
+
+    /// Setup callback to be issued once false value is debounced for channel
+    /** Panics if channel was not obtained from Add */
+    DebounceGroup& OnFalse(ChannelIndex channel, const Callback& callbackOnFalse);
+
+    /// Current value of the channel considered to be filtered (debounced)
+    bool Value(ChannelIndex channel) const;
+
+    /// Number of channels registered so far
+    ChannelIndex ChannelsCount() const;
+
+    /// Start periodic sampling of all the channels with targetScheduler
+    void Schedule(Scheduler& targetScheduler);
+
+    /// Remove from the corresponding scheduler (and so prevent state detection)
+    void Cancel();
+
+private:
+    /// Allow arrays of delegates (there is no default Delegate) 
+    template<class DelegateType, typename DelegateType::SimpleCaseCallee* placeholder>
+    class Slot: public DelegateType{
+    public:
+        Slot() : DelegateType(placeholder) {}
+        using DelegateType::operator=;
+    };
+    /// Placeholder for channels not being set yet
+    static bool rawValueFalse(){ return false; }
+    /// Placeholder for callbacks not being set yet
+    static void doNothing(){}
+
+    /// Internal action to cooperate with the scheduler
+    ActionNode action;
+
+    /// Interval between checks for raw values while debounce
+    const Ticks checkInterval;
+    /// Desired number of changed values before accepting a new one!
+    const IntervalCount successCountExpected;
+
+    /// Number of channels added so far
+    ChannelIndex channelsUsed = 0;
+
+    /// The callbacks being used to read current raw (not debounced) values
+    Slot<RawValueChecker, &rawValueFalse> checkers[MaxChannels];
+    /// Called once true value is debounced
+    Slot<Callback, &doNothing> onTrue[MaxChannels];
+    /// Called once false value is debounced
+    Slot<Callback, &doNothing> onFalse[MaxChannels];
+    /// Number of changed values accumulated so far
+    IntervalCount successCountCurrent[MaxChannels] = {};
+    /// Values being already debounced (considered as being current)
+    bool currentDebouncedVal[MaxChannels] = {};
+
+    /// Callback to be attached to the ActionNode
+    ActionNode::Callback actionCallback();
+
+    /// Callback being issued by the scheduler on each check interval
+    void ActionHandler();
+};
+
+
 /// Keep track of the button with the help of Scheduler
+/** Recognizes press, release, long press, repeat (while holding)
+ * and double click from the debounced value (true means "pressed").
+ * The single ActionNode is scheduled only while timing is needed
+ * (debouncing, holding the button, waiting for the second click),
+ * once the button is at rest ButtonAction is idle and costs nothing:
+ * there are no periodic checks until Wake() is called
+ * (or until the multicast passed to Start is called).
+ * Call Wake() (or the multicast) once raw value may have changed,
+ * for example from the "pin change" detection code.
+ * Callbacks are optional, features without timings set are disabled.
+ * @code
+ *      ButtonAction button(IsButtonPressed, 5, 4); //debounce for 20ms
+ *      ...
+ *      button.OnPress(onPress).OnLongPress(onLongPress, 1000);
+ *      button.Start(scheduler, pinChangeMulticast);
+ * @endcode */
 class ButtonAction: public DebounceBase{
 public:
     /// Callback used to check for button status
@@ -271,22 +467,391 @@ public:
     /// Units being used for time measurements 
     using Ticks = Scheduler::Ticks;
 
-    ///
+    /// Callback invoked once gesture is recognized
+    using Callback = Delegate< void() >;
+
+    /// Setup button being initially released (idle)
     ButtonAction(
-        const Checker& testForValue,
-        Ticks checkInterval,
-        unsigned numCheckIntervalsToDebounce = 1
+        const Checker& testForValue, ///< Read raw value, true means "pressed"
+        Ticks checkInterval, ///< Interval between checks while timing is needed
+        unsigned numCheckIntervalsToDebounce = 1 ///< Checks before accepting value
+    );
+
+    /// Setup callback to be issued once press is debounced
+    ButtonAction& OnPress(const Callback& callbackOnPress);
+
+    /// Setup callback to be issued once release is debounced
+    ButtonAction& OnRelease(const Callback& callbackOnRelease);
+
+    /// Setup callback to be issued once button is held long enough
+    ButtonAction& OnLongPress(
+        const Callback& callbackOnLongPress,
+        Ticks holdTicks ///< How long to hold (counted from press)
     );
 
+    /// Setup callback to be issued periodically while button is held
+    /** Repeats start after long press (when OnLongPress is set),
+     *  or after the first period counted from press otherwise */
+    ButtonAction& OnRepeat(
+        const Callback& callbackOnRepeat,
+        Ticks periodTicks ///< Interval between repeats
+    );
 
+    /// Setup callback to be issued on the second press of double click
+    /** Second press shall happen in time after release of short press
+     *  (press being reported as long press does not start double click) */
+    ButtonAction& OnDoubleClick(
+        const Callback& callbackOnDoubleClick,
+        Ticks withinTicks ///< Time from release to the second press
+    );
+
+
+    /// Attach to targetScheduler, stay idle till Wake() is called
+    void Start(Scheduler& targetScheduler);
+
+    /// Attach to targetScheduler, stay idle till rawChangeNotification is called
+    /** While idle, the ActionNode listens to rawChangeNotification,
+     *  it is equal to calling Wake() on each rawChangeNotification call */
+    void Start(Scheduler& targetScheduler, MulticastToActions& rawChangeNotification);
+
+    /// Raw value may have changed, start checks if idle
+    /** Nothing happens if button is tracked right now (cheap to call) */
+    void Wake();
+
+    /// Test there is no timing in progress (no checks are scheduled)
+    bool IsIdle() const;
+
+    /// Stop any checks and listening (Wake() can start checks again)
+    void Cancel();
 
 private:
-    void ActionHandler(){
+    /// Called once press is debounced
+    Callback onPress{ [](){} };
+    /// Called once release is debounced
+    Callback onRelease{ [](){} };
+    /// Called once button is held long enough
+    Callback onLongPress{ [](){} };
+    /// Called periodically while button is held
+    Callback onRepeat{ [](){} };
+    /// Called on the second press of double click
+    Callback onDoubleClick{ [](){} };
+
+    /// Scheduler we are attached to by Start
+    Scheduler* scheduler = nullptr;
+    /// Source of Wake while being idle (if any)
+    MulticastToActions* wakeSource = nullptr;
+
+    /// Hold before long press (0 means long press is not tracked)
+    Ticks longPressTicks = 0;
+    /// Interval between repeats (0 means repeats are not tracked)
+    Ticks repeatTicks = 0;
+    /// Window for the second click (0 means double click is not tracked)
+    Ticks doubleClickTicks = 0;
+
+    /// Time of the last debounced press
+    Ticks pressedAt = 0;
+    /// Time of the last debounced release
+    Ticks releasedAt = 0;
+    /// Holding time when the next repeat happens
+    Ticks nextRepeatAt = 0;
+
+    /// Current phase of the recognition
+    enum class Phase: unsigned char{
+        Idle, ///< Button is at rest, nothing is scheduled
+        Tracking, ///< Periodic checks are in progress
+        WaitingSecondClick ///< Released after short press, double click is possible
+    } phase = Phase::Idle;
+
+    /// Long press was reported for the current press
+    bool longPressReported = false;
+    /// Current press is the second click of double click
+    bool isSecondClick = false;
+
+    /// Callback for periodic checks
+    ActionNode::Callback actionCallback();
+    /// Callback for waking up from the multicast
+    ActionNode::Callback wakeCallback();
+
+    /// Callback being issued by the scheduler on each check interval
+    void ActionHandler();
+    /// Callback being issued by the multicast while idle
+    void WakeHandler();
+
+    /// Nothing more to time, stop checks
+    void becomeIdle();
+    /// Check for timings while holding the button
+    void trackHolding(Ticks now);
+};
+
 
+//______________________________________________________________________________
+// Implementing ButtonAction
+
+inline ButtonAction::ButtonAction(
+    const Checker& testForValue,
+    Ticks checkInterval,
+    unsigned numCheckIntervalsToDebounce
+)
+    : DebounceBase(
+        false,
+        checkInterval,
+        static_cast<IntervalCount>(numCheckIntervalsToDebounce),
+        testForValue
+    )
+    {}
+
+inline ButtonAction& ButtonAction::OnPress(const Callback& callbackOnPress){
+    onPress = callbackOnPress;
+    return *this;
+}
+
+inline ButtonAction& ButtonAction::OnRelease(const Callback& callbackOnRelease){
+    onRelease = callbackOnRelease;
+    return *this;
+}
+
+inline ButtonAction& ButtonAction::OnLongPress(
+    const Callback& callbackOnLongPress, Ticks holdTicks
+){
+    onLongPress = callbackOnLongPress;
+    longPressTicks = holdTicks;
+    return *this;
+}
+
+inline ButtonAction& ButtonAction::OnRepeat(
+    const Callback& callbackOnRepeat, Ticks periodTicks
+){
+    onRepeat = callbackOnRepeat;
+    repeatTicks = periodTicks;
+    return *this;
+}
+
+inline ButtonAction& ButtonAction::OnDoubleClick(
+    const Callback& callbackOnDoubleClick, Ticks withinTicks
+){
+    onDoubleClick = callbackOnDoubleClick;
+    doubleClickTicks = withinTicks;
+    return *this;
+}
+
+inline void ButtonAction::Start(Scheduler& targetScheduler){
+    Cancel();
+    scheduler = &targetScheduler;
+    wakeSource = nullptr;
+    phase = Phase::Idle;
+}
+
+inline void ButtonAction::Start(
+    Scheduler& targetScheduler,
+    MulticastToActions& rawChangeNotification
+){
+    Start(targetScheduler);
+    wakeSource = &rawChangeNotification;
+    ListenInstead(rawChangeNotification, wakeCallback());
+}
+
+inline void ButtonAction::Wake(){
+    if( Phase::Idle == phase && scheduler ){
+        phase = Phase::Tracking;
+        SchedulePeriodic(*scheduler, actionCallback());
+    }
+}
+
+inline bool ButtonAction::IsIdle() const{
+    return Phase::Idle == phase;
+}
+
+inline void ButtonAction::Cancel(){
+    DebounceBase::Cancel();
+    phase = Phase::Idle;
+}
+
+inline ActionNode::Callback ButtonAction::actionCallback(){
+    return ActionNode::Callback::From(this).Bind<&ButtonAction::ActionHandler>();
+}
+
+inline ActionNode::Callback ButtonAction::wakeCallback(){
+    return ActionNode::Callback::From(this).Bind<&ButtonAction::WakeHandler>();
+}
+
+inline void ButtonAction::WakeHandler(){
+    // attach again in case we stay listening
+    Rearm(wakeCallback());
+    Wake();
+}
+
+inline void ButtonAction::ActionHandler(){
+    // ActionNode callback is "one shot", attach again for the next period
+    Rearm(actionCallback());
+
+    const Ticks now = scheduler->KnownAbsoluteTicks();
+
+    if( Discover() ){
+        if( Value() ){
+            // Pressed
+            pressedAt = now;
+            longPressReported = false;
+            isSecondClick = (Phase::WaitingSecondClick == phase);
+            phase = Phase::Tracking;
+            nextRepeatAt = longPressTicks ? longPressTicks + repeatTicks : repeatTicks;
+
+            onPress();
+            if( isSecondClick ){
+                onDoubleClick();
+            }
+        }
+        else{
+            // Released
+            releasedAt = now;
+            if( doubleClickTicks && !longPressReported && !isSecondClick ){
+                // short click, the second one may follow
+                phase = Phase::WaitingSecondClick;
+            }
+            onRelease();
+        }
+    }
+    else if( Value() ){
+        trackHolding(now);
     }
-};
+
+    if(
+            Phase::WaitingSecondClick == phase
+        &&  now - releasedAt >= doubleClickTicks
+    ){
+        // too late for the second click
+        phase = Phase::Tracking;
+    }
+
+    if( Phase::Tracking == phase && !Value() && IsSettled() ){
+        // button is at rest, nothing more to time
+        becomeIdle();
+    }
+}
+
+inline void ButtonAction::becomeIdle(){
+    phase = Phase::Idle;
+    if( wakeSource ){
+        // the same ActionNode goes to listen instead of periodic checks
+        ListenInstead(*wakeSource, wakeCallback());
+    }
+    else{
+        DebounceBase::Cancel();
+    }
+}
+
+inline void ButtonAction::trackHolding(Ticks now){
+    const Ticks heldTicks = now - pressedAt;
+
+    if( longPressTicks && !longPressReported ){
+        if( heldTicks >= longPressTicks ){
+            longPressReported = true;
+            onLongPress();
+        }
+    }
+    else if( repeatTicks && heldTicks >= nextRepeatAt ){
+        nextRepeatAt += repeatTicks;
+        onRepeat();
+    }
+}
 
 
+//______________________________________________________________________________
+// Implementing DebounceGroup
+
+template<unsigned MaxChannels>
+typename DebounceGroup<MaxChannels>::ChannelIndex
+DebounceGroup<MaxChannels>::Add(
+    bool initialValue,
+    const RawValueChecker& rawValueChecker
+){
+    if( channelsUsed >= MaxChannels ){
+        // No place for one more channel, increase MaxChannels
+        InstantDebounce_Panic();
+    }
+    checkers[channelsUsed] = rawValueChecker;
+    currentDebouncedVal[channelsUsed] = initialValue;
+    successCountCurrent[channelsUsed] = 0;
+    return channelsUsed++;
+}
+
+template<unsigned MaxChannels>
+DebounceGroup<MaxChannels>& DebounceGroup<MaxChannels>::OnTrue(
+    ChannelIndex channel, const Callback& callbackOnTrue
+){
+    if( channel >= channelsUsed ){
+        // Such channel was never returned by Add
+        InstantDebounce_Panic();
+    }
+    onTrue[channel] = callbackOnTrue;
+    return *this;
+}
+
+template<unsigned MaxChannels>
+DebounceGroup<MaxChannels>& DebounceGroup<MaxChannels>::OnFalse(
+    ChannelIndex channel, const Callback& callbackOnFalse
+){
+    if( channel >= channelsUsed ){
+        // Such channel was never returned by Add
+        InstantDebounce_Panic();
+    }
+    onFalse[channel] = callbackOnFalse;
+    return *this;
+}
+
+template<unsigned MaxChannels>
+bool DebounceGroup<MaxChannels>::Value(ChannelIndex channel) const{
+    if( channel >= channelsUsed ){
+        // Such channel was never returned by Add
+        InstantDebounce_Panic();
+    }
+    return currentDebouncedVal[channel];
+}
+
+template<unsigned MaxChannels>
+typename DebounceGroup<MaxChannels>::ChannelIndex
+DebounceGroup<MaxChannels>::ChannelsCount() const{
+    return channelsUsed;
+}
+
+template<unsigned MaxChannels>
+void DebounceGroup<MaxChannels>::Schedule(Scheduler& targetScheduler){
+    action.Set(actionCallback()).ScheduleAfter(targetScheduler, checkInterval, checkInterval);
+}
+
+template<unsigned MaxChannels>
+void DebounceGroup<MaxChannels>::Cancel(){
+    action.Cancel();
+}
+
+template<unsigned MaxChannels>
+ActionNode::Callback DebounceGroup<MaxChannels>::actionCallback(){
+    return ActionNode::Callback::From(this).template Bind<&DebounceGroup::ActionHandler>();
+}
+
+template<unsigned MaxChannels>
+void DebounceGroup<MaxChannels>::ActionHandler(){
+    // ActionNode callback is "one shot", attach again for the next period
+    action.Set(actionCallback());
+
+    for(ChannelIndex i = 0; i < channelsUsed; ++i){
+        if( checkers[i]() != currentDebouncedVal[i] ){
+            if( ++successCountCurrent[i] >= successCountExpected ){
+                // New value discovered (opposite of previous)!
+                successCountCurrent[i] = 0;
+                currentDebouncedVal[i] = !currentDebouncedVal[i];
+                if( currentDebouncedVal[i] ){
+                    onTrue[i]();
+                }
+                else{
+                    onFalse[i]();
+                }
+            }
+        }
+        else{
+            successCountCurrent[i] = 0;
+        }
+    }
+}
 
 #endif
 
@@ -368,6 +933,173 @@ private:
     const Ticks debounceInterval;
 };
 
+
+/// Debounce many digital values packed into bits (to be used in continuous loop)
+/** Behaves as NumChannels SimpleDebounce instances, but all the inputs are
+ * passed at once as packed bits with single time measurement.
+ * State is kept as bit masks and the single array of deadlines
+ * (instead of SimpleTimer and flags per input), words where
+ * nothing happens are skipped with a couple of bitwise operations,
+ * deadlines are updated in a branch free loop for the rest.
+ * Bit N of word W (counting from 0) corresponds to channel W*BitsPerWord + N.
+ * @tparam NumChannels total number of inputs being debounced
+ * @tparam Word unsigned type used to pack bits of inputs */
+template<unsigned NumChannels, class Word = unsigned long>
+class SimpleDebounceBank{
+public:
+    /// Units being used for time measurements (same as for SimpleDebounce)
+    using Ticks = SimpleTimer::Ticks;
+
+    /// Number of channels packed into single Word
+    static constexpr unsigned BitsPerWord = sizeof(Word) * 8;
+    /// Number of Word items needed to hold bits of all channels
+    static constexpr unsigned WordsCount = (NumChannels + BitsPerWord - 1) / BitsPerWord;
+
+    /// Setup initial instance parameters
+    SimpleDebounceBank(
+        Word initialValues, ///< Bits considered to be initial for all the words
+        Ticks debounceTicks ///< How long to wait before accepting a new value
+    );
+
+    /// Take the new time and values of all the channels into account
+    /** Called with current values on each iteration,
+     * @returns true if at least one channel has new (different) value
+     *          "discovered" after the debounce cycle was performed,
+     *          use Changed() to obtain mask of changed channels */
+    bool Discover(
+        Ticks time, ///< Current time in the same units as in constructor
+        const Word (&rawBits)[WordsCount] ///< Current values packed into bits
+    );
+
+    /// Take the new time and values into account (all channels in one Word)
+    /** @returns mask of changed channels (0 means nothing has changed) */
+    Word Discover(Ticks time, Word rawBits);
+
+    ///Suppress any "incompatible" timings
+    /** This forces using exact Ticks type */
+    template<class OtherTicks, class Bits>
+    bool Discover(OtherTicks time, const Bits& rawBits) = delete;
+
+    /// Mask of channels changed by the last Discover (for word wordIndex)
+    Word Changed(unsigned wordIndex) const;
+
+    /// Values considered to be filtered (debounced) for word wordIndex
+    Word Values(unsigned wordIndex) const;
+
+    /// Current value of the channel considered to be filtered (debounced)
+    bool Value(unsigned channel) const;
+
+private:
+    /// Timeout used for debounce
+    const Ticks debounceInterval;
+
+    /// Values being already debounced (considered as being current)
+    Word currentDebouncedVal[WordsCount];
+    /// Channels where debouncing is in progress right now
+    Word pending[WordsCount];
+    /// Channels changed by the last Discover
+    Word changed[WordsCount];
+
+    /// Time when debouncing completes for pending channels
+    Ticks deadlines[WordsCount * BitsPerWord];
+
+    /// Update single word, @returns changed bits
+    Word discoverWord(Ticks time, unsigned wordIndex, Word rawBits);
+};
+
+
+//______________________________________________________________________________
+// Implementing SimpleDebounceBank
+
+template<unsigned NumChannels, class Word>
+SimpleDebounceBank<NumChannels, Word>::SimpleDebounceBank(
+    Word initialValues,
+    Ticks debounceTicks
+) : debounceInterval(debounceTicks) {
+    for(unsigned w = 0; w < WordsCount; ++w){
+        currentDebouncedVal[w] = initialValues;
+        pending[w] = 0;
+        changed[w] = 0;
+    }
+    for(unsigned i = 0; i < WordsCount * BitsPerWord; ++i){
+        deadlines[i] = 0;
+    }
+}
+
+template<unsigned NumChannels, class Word>
+bool SimpleDebounceBank<NumChannels, Word>::Discover(
+    Ticks time,
+    const Word (&rawBits)[WordsCount]
+){
+    Word anyChanged = 0;
+    for(unsigned w = 0; w < WordsCount; ++w){
+        anyChanged |= (changed[w] = discoverWord(time, w, rawBits[w]));
+    }
+    return anyChanged != 0;
+}
+
+template<unsigned NumChannels, class Word>
+Word SimpleDebounceBank<NumChannels, Word>::Discover(Ticks time, Word rawBits){
+    static_assert(WordsCount == 1, "Use array of words for more channels");
+    return changed[0] = discoverWord(time, 0, rawBits);
+}
+
+template<unsigned NumChannels, class Word>
+Word SimpleDebounceBank<NumChannels, Word>::Changed(unsigned wordIndex) const{
+    return changed[wordIndex];
+}
+
+template<unsigned NumChannels, class Word>
+Word SimpleDebounceBank<NumChannels, Word>::Values(unsigned wordIndex) const{
+    return currentDebouncedVal[wordIndex];
+}
+
+template<unsigned NumChannels, class Word>
+bool SimpleDebounceBank<NumChannels, Word>::Value(unsigned channel) const{
+    return (currentDebouncedVal[channel / BitsPerWord] >> (channel % BitsPerWord)) & 1;
+}
+
+template<unsigned NumChannels, class Word>
+Word SimpleDebounceBank<NumChannels, Word>::discoverWord(
+    Ticks time, unsigned wordIndex, Word rawBits
+){
+    // 1s where raw value differs from the debounced one
+    const Word differs = static_cast<Word>(rawBits ^ currentDebouncedVal[wordIndex]);
+
+    /* Pending channels having the same value as before debounce again
+       are chattering, value is unstable, so they are not pending any more */
+    const Word stillPending = static_cast<Word>(pending[wordIndex] & differs);
+    // New values detected, start debouncing
+    const Word starting = static_cast<Word>(differs & ~stillPending);
+
+    if( 0 == (stillPending | starting) ){
+        // the most expected case, nothing happens with this word
+        pending[wordIndex] = 0;
+        return 0;
+    }
+
+    // Branch free loop over deadlines of this word (can be vectorized)
+    Ticks* wordDeadlines = deadlines + wordIndex * BitsPerWord;
+    const Ticks startedDeadline = time + debounceInterval;
+    Word expired = 0;
+    for(unsigned bit = 0; bit < BitsPerWord; ++bit){
+        const Ticks isStarting = static_cast<Ticks>((starting >> bit) & 1);
+        // select startedDeadline for starting channels, keep others 
+        wordDeadlines[bit] = 
+            (wordDeadlines[bit] & (isStarting - 1)) | (startedDeadline & (0 - isStarting));
+        // compare unsigned values assuming two's complement (as SimpleTimer does)
+        expired |= static_cast<Word>(
+            static_cast<Word>((time - wordDeadlines[bit]) <= SimpleTimer::DeltaMax) << bit
+        );
+    }
+
+    // Only channels that were debounced before can complete here
+    const Word completed = static_cast<Word>(stillPending & expired);
+    currentDebouncedVal[wordIndex] ^= completed;
+    pending[wordIndex] = static_cast<Word>((stillPending & ~completed) | starting);
+    return completed;
+}
+
 #endif
 
 #endif
\ No newline at end of file
@@ -0,0 +1,431 @@
+/** @file InstantIntrusiveHashTable.h
+    @brief Intrusive hash table with statically sized bucket arrays
+           (no dynamic memory at all, only InstantIntrusiveList.h is needed)
+
+Finding objects by key without scanning IntrusiveList,
+items are "allocated somewhere else" and only linked into buckets,
+lookup, insert and remove are O(1) on average, nothing is allocated.
+
+Buckets are IntrusiveHList heads (one pointer per bucket),
+item embeds the link and the cached hash value of its key.
+
+Hash functor (stateless, default constructed for each use) shall provide
+ - unsigned long operator()(const Key&) const  - hash of the key
+ - Key (or const Key&) operator()(const ItemType&) const - key of the item
+Keys are compared with operator==.
+Hash value is mixed by the table (MurmurHash3 finalizer) before the low bits
+are taken as bucket index, so every bit of the hash affects the bucket
+(even the key itself is fine as hash of the integer key).
+
+Example usage:
+ @code
+    struct SessionHash;
+    class Session: public IntrusiveHashTable<Session, unsigned, SessionHash, 64>::Node{
+    public:
+        Session(unsigned sessionId) : id(sessionId) {}
+        unsigned id;
+        ...
+    };
+
+    struct SessionHash{
+        unsigned long operator()(unsigned id) const { return id; }
+        unsigned operator()(const Session& session) const { return session.id; }
+    };
+
+    IntrusiveHashTable<Session, unsigned, SessionHash, 64> sessions;
+    Session s1(10), s2(42);
+    sessions.Insert(&s1);
+    sessions.Insert(&s2);
+
+    Session* found = sessions.Find(42); // &s2
+    sessions.Remove(&s2);               // O(1), no search
+    sessions.Clear();                   // before items are destroyed
+ @endcode
+
+Optional GrowBuckets parameter (intended for hosts with many items)
+adds the second static bucket array: once Count() exceeds Buckets
+the table migrates items into the larger array incrementally,
+a few buckets per Insert/Remove, so there is no long rehash pause
+(lookups check both arrays while migration is in progress).
+
+NOTE: hash tables are not threadsafe/interrupt safe
+      different tables can be used from different threads without problems.
+
+MIT License
+
+Copyright (c) 2023 Pavlo M, see https://github.com/olvap80/InstantArduino
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef InstantIntrusiveHashTable_INCLUDED_H
+#define InstantIntrusiveHashTable_INCLUDED_H
+
+#include "InstantIntrusiveList.h"
+
+//______________________________________________________________________________
+// Configurable error handling
+
+#ifndef InstantIntrusiveHashTable_Panic
+#   ifdef InstantRTOS_Panic
+#       define InstantIntrusiveHashTable_Panic() InstantRTOS_Panic('H')
+#   else
+#       define InstantIntrusiveHashTable_Panic() /* you can customize here! */ do{}while(true)
+#   endif
+#endif
+
+
+//______________________________________________________________________________
+// Internal helpers
+
+namespace InstantIntrusiveHashTableDetails{
+    /// Make every bit of the hash affect the low bits (MurmurHash3 fmix)
+    template<unsigned HashBytes>
+    struct Finalizer;
+
+    template<>
+    struct Finalizer<4>{
+        static unsigned long Mix(unsigned long h){
+            h ^= h >> 16;
+            h *= 0x85ebca6bUL;
+            h ^= h >> 13;
+            h *= 0xc2b2ae35UL;
+            h ^= h >> 16;
+            return h & 0xFFFFFFFFUL;
+        }
+    };
+
+    template<>
+    struct Finalizer<8>{
+        static unsigned long Mix(unsigned long hash){
+            unsigned long long h = hash;
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            h *= 0xc4ceb9fe1a85ec53ULL;
+            h ^= h >> 33;
+            return static_cast<unsigned long>(h);
+        }
+    };
+}
+
+
+//______________________________________________________________________________
+// Public API
+
+/// Intrusive hash table with Buckets (and optional GrowBuckets) static buckets
+/** Keys are unique, ItemType derives from IntrusiveHashTable<...>::Node
+ * Buckets and GrowBuckets shall be powers of 2 (GrowBuckets can be 0)
+ * REMEMBER: changing the key of the item while it is in the table
+ *           breaks the table, remove item first, then change and insert again */
+template <class ItemType, class Key, class Hash, unsigned Buckets, unsigned GrowBuckets = 0>
+class IntrusiveHashTable{
+public:
+    static_assert(Buckets && !(Buckets & (Buckets - 1)), "Buckets shall be a power of 2");
+    static_assert(!(GrowBuckets & (GrowBuckets - 1)), "GrowBuckets shall be a power of 2 (or 0)");
+    static_assert(!GrowBuckets || GrowBuckets > Buckets, "GrowBuckets shall be larger than Buckets");
+
+    /// Type used to store hash values
+    using HashValue = unsigned long;
+
+    /// Migration to GrowBuckets starts when Count() exceeds Buckets * MaxLoadFactor
+    static constexpr unsigned MaxLoadFactor = 1;
+    /// Buckets migrated on each Insert/Remove while migration is in progress
+    static constexpr unsigned RehashBucketsPerStep = 4;
+
+    //ban copying (this ensures pointers are valid)
+    constexpr IntrusiveHashTable(const IntrusiveHashTable&) = delete;
+    IntrusiveHashTable& operator=(const IntrusiveHashTable&) = delete;
+
+    /// Defaults to empty table
+    IntrusiveHashTable() = default;
+    // Destructor asserts table is empty (each bucket does)
+
+
+    /// The base class for all IntrusiveHashTable items
+    /** NOTE: long method names prevent mixing with class methods */
+    class Node: public IntrusiveHList<ItemType>::Node{
+    protected:
+        //There is no way to create node then from derived class
+        Node() = default;
+
+    public:
+        /// Test node is inserted into some IntrusiveHashTable
+        bool IsInHashTable() const;
+
+    private:
+        friend class IntrusiveHashTable;
+        /// Mixed hash of the key cached when inserted (used for fast compare and migration)
+        HashValue hashValue = 0;
+    };
+
+
+    /// Test table is empty
+    bool IsEmpty() const;
+
+    /// Number of items in the table
+    unsigned long Count() const;
+
+    /// Insert item (it shall not be in other table)
+    /** @returns false (and item is not inserted) if item with equal key exists */
+    bool Insert(ItemType* itemToBeInserted);
+
+    /// Item with the key (nullptr if none)
+    ItemType* Find(const Key& key);
+
+    /// Remove the item being in this table in O(1)
+    void Remove(ItemType* itemToBeRemoved);
+
+    /// Remove the item with the key
+    /** @returns removed item or nullptr if there was no such item */
+    ItemType* RemoveKey(const Key& key);
+
+    /// Remove all items from the table in O(number of buckets)
+    void Clear();
+
+    /// Test migration to GrowBuckets is in progress
+    bool IsRehashing() const;
+
+    /// Number of buckets items are hashed into now
+    unsigned BucketsCount() const;
+
+    /// Number of items in the longest bucket chain
+    /** Walks all the items, intended for checking quality of the Hash */
+    unsigned long LongestChain() const;
+
+private:
+    /// Which bucket arrays hold items
+    enum class State: unsigned char{
+        Primary,    ///< Only buckets are used
+        Rehashing,  ///< Items are moved from buckets to grown
+        Grown       ///< Only grown buckets are used
+    };
+
+    State state = State::Primary;
+    /// Number of buckets already migrated (valid while Rehashing)
+    unsigned migrated = 0;
+    unsigned long count = 0;
+
+    IntrusiveHList<ItemType> buckets[Buckets];
+    /// Second array (single unused bucket when GrowBuckets is 0)
+    IntrusiveHList<ItemType> grown[GrowBuckets ? GrowBuckets : 1];
+
+    static HashValue hashOf(const Key& key);
+    static ItemType* findIn(IntrusiveHList<ItemType>& bucket, HashValue hashValue, const Key& key);
+    ItemType* findWithHash(HashValue hashValue, const Key& key);
+    void rehashStep();
+};
+
+
+
+//______________________________________________________________________________
+//##############################################################################
+/*==============================================================================
+*  Implementation details follow                                               *
+*=============================================================================*/
+//##############################################################################
+
+
+//______________________________________________________________________________
+// Implementing IntrusiveHashTable
+
+template <class ItemType, class Key, class Hash, unsigned Buckets, unsigned GrowBuckets>
+inline bool IntrusiveHashTable<ItemType, Key, Hash, Buckets, GrowBuckets>::Node::IsInHashTable() const{
+    return this->IsInHList();
+}
+
+template <class ItemType, class Key, class Hash, unsigned Buckets, unsigned GrowBuckets>
+inline bool IntrusiveHashTable<ItemType, Key, Hash, Buckets, GrowBuckets>::IsEmpty() const{
+    return 0 == count;
+}
+
+template <class ItemType, class Key, class Hash, unsigned Buckets, unsigned GrowBuckets>
+inline unsigned long IntrusiveHashTable<ItemType, Key, Hash, Buckets, GrowBuckets>::Count() const{
+    return count;
+}
+
+template <class ItemType, class Key, class Hash, unsigned Buckets, unsigned GrowBuckets>
+inline bool IntrusiveHashTable<ItemType, Key, Hash, Buckets, GrowBuckets>::Insert(
+    ItemType* itemToBeInserted
+){
+    Node* node = itemToBeInserted;
+    if( node->IsInHashTable() ){
+        InstantIntrusiveHashTable_Panic();
+    }
+
+    const HashValue hashValue = hashOf(Hash()(*itemToBeInserted));
+    if( findWithHash(hashValue, Hash()(*itemToBeInserted)) ){
+        return false;
+    }
+
+    rehashStep();
+    if( GrowBuckets && State::Primary == state && count >= Buckets * MaxLoadFactor ){
+        state = State::Rehashing;
+        migrated = 0;
+    }
+
+    node->hashValue = hashValue;
+    if( State::Primary == state ){
+        buckets[hashValue & (Buckets - 1)].InsertAtFront(itemToBeInserted);
+    }
+    else{
+        // new items go directly to the larger array
+        grown[hashValue & (GrowBuckets - 1)].InsertAtFront(itemToBeInserted);
+    }
+    ++count;
+    return true;
+}
+
+template <class ItemType, class Key, class Hash, unsigned Buckets, unsigned GrowBuckets>
+inline ItemType* IntrusiveHashTable<ItemType, Key, Hash, Buckets, GrowBuckets>::Find(const Key& key){
+    return findWithHash(hashOf(key), key);
+}
+
+template <class ItemType, class Key, class Hash, unsigned Buckets, unsigned GrowBuckets>
+inline void IntrusiveHashTable<ItemType, Key, Hash, Buckets, GrowBuckets>::Remove(
+    ItemType* itemToBeRemoved
+){
+    Node* node = itemToBeRemoved;
+    if( !node->IsInHashTable() ){
+        InstantIntrusiveHashTable_Panic();
+    }
+    // bucket does not matter, hlist node removes self
+    node->RemoveFromHList();
+    if( 0 == --count ){
+        // all buckets are empty, small array is cheaper to use again
+        state = State::Primary;
+        return;
+    }
+    rehashStep();
+}
+
+template <class ItemType, class Key, class Hash, unsigned Buckets, unsigned GrowBuckets>
+inline ItemType* IntrusiveHashTable<ItemType, Key, Hash, Buckets, GrowBuckets>::RemoveKey(const Key& key){
+    ItemType* res = Find(key);
+    if( res ){
+        Remove(res);
+    }
+    return res;
+}
+
+template <class ItemType, class Key, class Hash, unsigned Buckets, unsigned GrowBuckets>
+inline void IntrusiveHashTable<ItemType, Key, Hash, Buckets, GrowBuckets>::Clear(){
+    for(auto& bucket: buckets){
+        while( bucket.RemoveAtFront() ){}
+    }
+    if( GrowBuckets ){
+        for(auto& bucket: grown){
+            while( bucket.RemoveAtFront() ){}
+        }
+    }
+    count = 0;
+    state = State::Primary;
+}
+
+template <class ItemType, class Key, class Hash, unsigned Buckets, unsigned GrowBuckets>
+inline bool IntrusiveHashTable<ItemType, Key, Hash, Buckets, GrowBuckets>::IsRehashing() const{
+    return State::Rehashing == state;
+}
+
+template <class ItemType, class Key, class Hash, unsigned Buckets, unsigned GrowBuckets>
+inline unsigned IntrusiveHashTable<ItemType, Key, Hash, Buckets, GrowBuckets>::BucketsCount() const{
+    return State::Primary == state ? Buckets : GrowBuckets;
+}
+
+template <class ItemType, class Key, class Hash, unsigned Buckets, unsigned GrowBuckets>
+inline unsigned long IntrusiveHashTable<ItemType, Key, Hash, Buckets, GrowBuckets>::LongestChain() const{
+    unsigned long res = 0;
+    auto measure = [&res](const IntrusiveHList<ItemType>& bucket){
+        unsigned long length = 0;
+        for(auto itr = bucket.begin(); itr != bucket.end(); ++itr){
+            ++length;
+        }
+        if( length > res ){
+            res = length;
+        }
+    };
+    for(auto& bucket: buckets){
+        measure(bucket);
+    }
+    if( GrowBuckets ){
+        for(auto& bucket: grown){
+            measure(bucket);
+        }
+    }
+    return res;
+}
+
+
+template <class ItemType, class Key, class Hash, unsigned Buckets, unsigned GrowBuckets>
+inline typename IntrusiveHashTable<ItemType, Key, Hash, Buckets, GrowBuckets>::HashValue
+IntrusiveHashTable<ItemType, Key, Hash, Buckets, GrowBuckets>::hashOf(const Key& key){
+    return InstantIntrusiveHashTableDetails::Finalizer<sizeof(HashValue)>::Mix(
+        static_cast<HashValue>(Hash()(key))
+    );
+}
+
+template <class ItemType, class Key, class Hash, unsigned Buckets, unsigned GrowBuckets>
+inline ItemType* IntrusiveHashTable<ItemType, Key, Hash, Buckets, GrowBuckets>::findIn(
+    IntrusiveHList<ItemType>& bucket, HashValue hashValue, const Key& key
+){
+    for(auto& item: bucket){
+        // cached hash rejects most of the other keys cheaply
+        if( static_cast<Node&>(item).hashValue == hashValue && Hash()(item) == key ){
+            return &item;
+        }
+    }
+    return nullptr;
+}
+
+template <class ItemType, class Key, class Hash, unsigned Buckets, unsigned GrowBuckets>
+inline ItemType* IntrusiveHashTable<ItemType, Key, Hash, Buckets, GrowBuckets>::findWithHash(
+    HashValue hashValue, const Key& key
+){
+    if( State::Grown != state ){
+        const unsigned index = hashValue & (Buckets - 1);
+        // migrated buckets are empty, no need to look there
+        if( State::Primary == state || index >= migrated ){
+            if( ItemType* res = findIn(buckets[index], hashValue, key) ){
+                return res;
+            }
+        }
+        if( State::Primary == state ){
+            return nullptr;
+        }
+    }
+    return findIn(grown[hashValue & (GrowBuckets - 1)], hashValue, key);
+}
+
+template <class ItemType, class Key, class Hash, unsigned Buckets, unsigned GrowBuckets>
+inline void IntrusiveHashTable<ItemType, Key, Hash, Buckets, GrowBuckets>::rehashStep(){
+    if( State::Rehashing != state ){
+        return;
+    }
+    for(unsigned step = 0; step < RehashBucketsPerStep && migrated < Buckets; ++step){
+        IntrusiveHList<ItemType>& bucket = buckets[migrated++];
+        while( ItemType* item = bucket.RemoveAtFront() ){
+            grown[static_cast<Node*>(item)->hashValue & (GrowBuckets - 1)].InsertAtFront(item);
+        }
+    }
+    if( migrated == Buckets ){
+        state = State::Grown;
+    }
+}
+
+#endif
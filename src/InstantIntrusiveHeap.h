@@ -0,0 +1,373 @@
+/** @file InstantIntrusiveHeap.h
+    @brief Zero overhead intrusive mergeable priority queue (pairing heap)
+           no dependencies at all (does not depend even on standard headers)
+
+Suitable for embedded platforms like Arduino, no dynamic memory usage at all
+(items are "allocated somewhere else" and only linked into the heap),
+handy for retransmit queues, EDF job lists, timer batches:
+ - Insert and Meld (merge two heaps) are O(1)
+ - Pop, DecreaseKey are amortized O(log n)
+ - Remove of arbitrary item (through the item itself) is amortized O(log n)
+
+Example usage:
+ @code
+    struct EarlierDeadline;
+    class Job: public IntrusivePairingHeap<Job, EarlierDeadline>::Node{
+    public:
+        unsigned long deadline;
+        ...
+    };
+    struct EarlierDeadline{
+        bool operator()(const Job& a, const Job& b) const {
+            return a.deadline < b.deadline;
+        }
+    };
+
+    IntrusivePairingHeap<Job, EarlierDeadline> jobs;
+    jobs.Insert(&job1);
+    jobs.Insert(&job2);
+
+    job2.deadline -= 10;        // job2 became more urgent
+    jobs.DecreaseKey(&job2);
+
+    Job* next = jobs.Pop();     // the job with the earliest deadline
+    jobs.Remove(&job1);         // cancel job1 (wherever it is)
+ @endcode
+
+NOTE: heaps are not threadsafe/interrupt safe
+      different heaps can be used from different threads without problems.
+
+MIT License
+
+Copyright (c) 2023 Pavlo M, see https://github.com/olvap80/InstantArduino
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef InstantIntrusiveHeap_INCLUDED_H
+#define InstantIntrusiveHeap_INCLUDED_H
+
+//______________________________________________________________________________
+// Configurable error handling
+
+/* Common configuration to be included only if available
+   (you can separate file and/or configure individually
+    or just skip that to stick with defaults) */
+#if defined(__has_include) && __has_include("InstantRTOS.Config.h")
+#   include "InstantRTOS.Config.h"
+#endif
+
+#ifndef InstantIntrusiveHeap_Panic
+#   ifdef InstantRTOS_Panic
+#       define InstantIntrusiveHeap_Panic() InstantRTOS_Panic('P')
+#   else
+#       define InstantIntrusiveHeap_Panic() /* you can customize here! */ do{}while(true)
+#   endif
+#endif
+
+
+//______________________________________________________________________________
+// Public API
+
+/// Intrusive pairing heap, Top is the item going first with regard to Compare
+/** Compare is stateless functor bool operator()(const ItemType& a, const ItemType& b)
+ * returning true when a shall be taken before b (like "less" for min-heap),
+ * it is default constructed for each comparison, so it can be just
+ * forward declared before the item class.
+ * Items with equal priority are taken in unspecified order.
+ * REMEMBER: changing priority of the item being in the heap is allowed
+ *           only towards "earlier" followed by DecreaseKey,
+ *           for other changes Remove, change, then Insert again */
+template <class ItemType, class Compare>
+class IntrusivePairingHeap{
+public:
+    //ban copying (this ensures pointers are valid)
+    constexpr IntrusivePairingHeap(const IntrusivePairingHeap&) = delete;
+    IntrusivePairingHeap& operator=(const IntrusivePairingHeap&) = delete;
+
+    /// Defaults to empty heap
+    IntrusivePairingHeap() = default;
+    /// Destructor asserts heap is empty
+    ~IntrusivePairingHeap();
+
+
+    /// The base class for all IntrusivePairingHeap items
+    /** NOTE: long method names prevent mixing with class methods */
+    class Node{
+    protected:
+        //There is no way to create node then from derived class
+        Node() = default;
+        /// Destructor asserts we shall remove item from heap first
+        ~Node();
+
+        //ban copying (cannot link moveable elements with pointers!)
+        constexpr Node(const Node&) = delete;
+        Node& operator=(const Node&) = delete;
+
+    public:
+        /// Test node is inserted into some IntrusivePairingHeap
+        bool IsInHeap() const;
+
+        ///Access to entire heap item (derived class)
+        ItemType* CastToHeapNode();
+        ///Access to entire heap item (derived class)
+        const ItemType* CastToHeapNode() const;
+
+    private:
+        friend class IntrusivePairingHeap;
+
+        /// The leftmost child
+        Node* child = nullptr;
+        /// Next sibling (to the right)
+        Node* next = nullptr;
+        /// Parent for the leftmost child, left sibling for others,
+        /// nullptr for the root and this when not in heap
+        Node* prev = this;
+    };
+
+
+    /// Test heap is empty
+    bool IsEmpty() const;
+
+    /// The item to be taken first (nullptr if empty), O(1)
+    ItemType* Top();
+
+    /// Insert item in O(1), the item shall not be in other heap
+    void Insert(ItemType* itemToBeInserted);
+
+    /// Move all items from otherHeap into this one in O(1)
+    void Meld(IntrusivePairingHeap& otherHeap);
+
+    /// Remove and return the Top item (nullptr if empty)
+    ItemType* Pop();
+
+    /// Restore order after the item became "earlier" (with regard to Compare)
+    void DecreaseKey(ItemType* itemBeingChanged);
+
+    /// Remove arbitrary item being in this heap
+    void Remove(ItemType* itemToBeRemoved);
+
+private:
+    Node* root = nullptr;
+
+    /// Make the later of two roots the leftmost child of the earlier one
+    static Node* link(Node* first, Node* second);
+    /// Cut the subtree of non root node from its parent/siblings
+    static void detach(Node* node);
+    /// Combine children list into single tree (two pass pairing)
+    static Node* mergePairs(Node* firstChild);
+};
+
+
+
+//______________________________________________________________________________
+//##############################################################################
+/*==============================================================================
+*  Implementation details follow                                               *
+*=============================================================================*/
+//##############################################################################
+
+
+//______________________________________________________________________________
+// Implementing IntrusivePairingHeap::Node
+
+template <class ItemType, class Compare>
+inline IntrusivePairingHeap<ItemType, Compare>::Node::~Node(){
+    if( IsInHeap() ){
+        /* Destroying before removed from the heap
+           is likely an error (the same as for ChainElement) */
+        InstantIntrusiveHeap_Panic();
+    }
+}
+
+template <class ItemType, class Compare>
+inline bool IntrusivePairingHeap<ItemType, Compare>::Node::IsInHeap() const{
+    return prev != this;
+}
+
+template <class ItemType, class Compare>
+inline ItemType* IntrusivePairingHeap<ItemType, Compare>::Node::CastToHeapNode(){
+    return static_cast<ItemType*>(this);
+}
+template <class ItemType, class Compare>
+inline const ItemType* IntrusivePairingHeap<ItemType, Compare>::Node::CastToHeapNode() const{
+    return static_cast<const ItemType*>(this);
+}
+
+
+//______________________________________________________________________________
+// Implementing IntrusivePairingHeap
+
+template <class ItemType, class Compare>
+inline IntrusivePairingHeap<ItemType, Compare>::~IntrusivePairingHeap(){
+    if( root ){
+        // nodes would keep pointers into the destroyed heap
+        InstantIntrusiveHeap_Panic();
+    }
+}
+
+template <class ItemType, class Compare>
+inline bool IntrusivePairingHeap<ItemType, Compare>::IsEmpty() const{
+    return nullptr == root;
+}
+
+template <class ItemType, class Compare>
+inline ItemType* IntrusivePairingHeap<ItemType, Compare>::Top(){
+    return root ? root->CastToHeapNode() : nullptr;
+}
+
+template <class ItemType, class Compare>
+inline void IntrusivePairingHeap<ItemType, Compare>::Insert(ItemType* itemToBeInserted){
+    Node* node = itemToBeInserted;
+    if( node->IsInHeap() ){
+        InstantIntrusiveHeap_Panic();
+    }
+    node->child = nullptr;
+    node->next = nullptr;
+    node->prev = nullptr;
+    root = root ? link(root, node) : node;
+}
+
+template <class ItemType, class Compare>
+inline void IntrusivePairingHeap<ItemType, Compare>::Meld(IntrusivePairingHeap& otherHeap){
+    if( &otherHeap == this || !otherHeap.root ){
+        return;
+    }
+    root = root ? link(root, otherHeap.root) : otherHeap.root;
+    otherHeap.root = nullptr;
+}
+
+template <class ItemType, class Compare>
+inline ItemType* IntrusivePairingHeap<ItemType, Compare>::Pop(){
+    Node* res = root;
+    if( res ){
+        root = mergePairs(res->child);
+        res->child = nullptr;
+        res->prev = res; // not in heap any more
+        return res->CastToHeapNode();
+    }
+    return nullptr;
+}
+
+template <class ItemType, class Compare>
+inline void IntrusivePairingHeap<ItemType, Compare>::DecreaseKey(ItemType* itemBeingChanged){
+    Node* node = itemBeingChanged;
+    if( !node->IsInHeap() ){
+        InstantIntrusiveHeap_Panic();
+    }
+    if( node != root ){
+        // subtree stays valid (children were already later than node)
+        detach(node);
+        root = link(root, node);
+    }
+}
+
+template <class ItemType, class Compare>
+inline void IntrusivePairingHeap<ItemType, Compare>::Remove(ItemType* itemToBeRemoved){
+    Node* node = itemToBeRemoved;
+    if( !node->IsInHeap() ){
+        InstantIntrusiveHeap_Panic();
+    }
+    if( node == root ){
+        Pop();
+        return;
+    }
+    detach(node);
+    if( Node* children = mergePairs(node->child) ){
+        root = link(root, children);
+    }
+    node->child = nullptr;
+    node->prev = node; // not in heap any more
+}
+
+
+template <class ItemType, class Compare>
+inline typename IntrusivePairingHeap<ItemType, Compare>::Node*
+IntrusivePairingHeap<ItemType, Compare>::link(Node* first, Node* second){
+    if( Compare()(*second->CastToHeapNode(), *first->CastToHeapNode()) ){
+        Node* tmp = first;
+        first = second;
+        second = tmp;
+    }
+    // second becomes the leftmost child of first
+    second->prev = first;
+    second->next = first->child;
+    if( first->child ){
+        first->child->prev = second;
+    }
+    first->child = second;
+    first->next = nullptr;
+    first->prev = nullptr;
+    return first;
+}
+
+template <class ItemType, class Compare>
+inline void IntrusivePairingHeap<ItemType, Compare>::detach(Node* node){
+    if( node->prev->child == node ){
+        node->prev->child = node->next;
+    }
+    else{
+        node->prev->next = node->next;
+    }
+    if( node->next ){
+        node->next->prev = node->prev;
+    }
+    node->next = nullptr;
+    node->prev = nullptr;
+}
+
+template <class ItemType, class Compare>
+inline typename IntrusivePairingHeap<ItemType, Compare>::Node*
+IntrusivePairingHeap<ItemType, Compare>::mergePairs(Node* firstChild){
+    if( !firstChild ){
+        return nullptr;
+    }
+
+    // first pass: link pairs left to right, stack results using next
+    Node* pairs = nullptr;
+    while( firstChild ){
+        Node* first = firstChild;
+        Node* second = first->next;
+        Node* linked;
+        if( second ){
+            firstChild = second->next;
+            linked = link(first, second);
+        }
+        else{
+            firstChild = nullptr;
+            linked = first;
+        }
+        linked->next = pairs;
+        pairs = linked;
+    }
+
+    // second pass: link from the right to the left
+    Node* res = pairs;
+    pairs = pairs->next;
+    while( pairs ){
+        Node* current = pairs;
+        pairs = pairs->next;
+        res = link(res, current);
+    }
+    res->next = nullptr;
+    res->prev = nullptr;
+    return res;
+}
+
+#endif
@@ -2,6 +2,10 @@
     @brief Zero overhead intrusive bidirectional (double linked) list (chain)
            no dependencies at all (does not depend even on standard headers)
 
+Also IntrusiveSList (single pointer per node, stack/queue usage) and
+IntrusiveHList (single pointer list head, handy for hash buckets)
+are available for the cases where bidirectional links are not needed.
+
 Suitable for embedded platforms like Arduino, no dynamic memory usage at all
 (minimalistic implementation to chain existing items into iterable list)
 
@@ -179,6 +183,13 @@ public:
      *  for this and from now our PrevChainElement will point to it) */
     void InsertPrevChainElement(ChainElement* chainElementBeingInserted);
 
+    ///Move consecutive ChainElements [first, last] to be PREVIOUS for this one
+    /** All elements from first to last (inclusive, following by NextChainElement)
+     *  are removed from their chain and inserted BEFORE this ChainElement
+     *  in O(1), the order among them is kept.
+     *  REMEMBER: this shall not be inside [first, last] range! */
+    void InsertPrevChainElements(ChainElement* first, ChainElement* last);
+
     ///Remove item from existing chain and cycle within own chain only
     void RemoveFromChain();
 
@@ -267,6 +278,34 @@ public:
     ItemType* RemoveAtEnd();
 
 
+    /// Move all items of otherList to the end of this list in O(1)
+    /** otherList becomes empty, the order of items is kept */
+    void SpliceAtBack(IntrusiveList& otherList);
+
+    /// Move all items of otherList to the start of this list in O(1)
+    /** otherList becomes empty, the order of items is kept */
+    void SpliceAtFront(IntrusiveList& otherList);
+
+    /// Move items [first, last) to be placed before position in O(1)
+    /** Items can come from any IntrusiveList (including this one),
+     *  position shall belong to this list and be outside [first, last) */
+    template<class Iterator>
+    void Splice(Iterator position, Iterator first, Iterator last);
+
+    /// Merge otherSortedList into this sorted list in O(n + m)
+    /** Both lists shall be sorted with regard to less(const ItemType&, const ItemType&),
+     *  merge is stable: items from this list go before equal items
+     *  from otherSortedList, otherSortedList becomes empty */
+    template<class Less>
+    void Merge(IntrusiveList& otherSortedList, Less less);
+
+    /// Stable sort with regard to less(const ItemType&, const ItemType&)
+    /** Bottom-up merge sort, O(n log n) comparisons, O(1) additional memory
+     *  (items are only relinked, never copied) */
+    template<class Less>
+    void Sort(Less less);
+
+
     ///Iterator pretending to expose API following standard (and range based for support)
     /** Provide operations typically expected from the standard iterators,
      * to make iteration compatible with range based for. 
@@ -354,6 +393,8 @@ public:
         }
 
     private:
+        friend class IntrusiveList;
+
         /// The Node pointed by iterator
         NodeType* currentNode;
     };
@@ -402,6 +443,311 @@ private:
     ///The head of the chain of linked nodes
     /** Also serves as "end" of forward and reverse sequences */
     RootNode listHead;
+
+    /// Stable merge of adjacent sorted runs [first, middle) and [middle, last)
+    template<class Less>
+    static void mergeRuns(Node* first, Node* middle, Node* last, Less& less);
+};
+
+
+/// Intrusive singly linked list (LIFO or FIFO with tail pointer)
+/** Half of the IntrusiveList memory per node (only one pointer),
+ * suitable for free lists, stacks and queues where removal happens
+ * only from the front (or after known item).
+ * REMEMBER: node does not know the list it belongs to, so it is
+ *           responsibility of the user to remove node before destruction
+ *           and not to insert the same node into two lists at once! */
+template <class ItemType>
+class IntrusiveSList{
+public:
+    //ban copying (this ensures pointers are valid)
+    constexpr IntrusiveSList(const IntrusiveSList&) = delete;
+    IntrusiveSList& operator=(const IntrusiveSList&) = delete;
+
+    /// Defaults to empty list
+    IntrusiveSList() = default;
+
+
+    /// The base class for all IntrusiveSList items
+    /** NOTE: long method names prevent mixing with class methods */
+    class Node{
+    protected:
+        //There is no way to create node then from derived class
+        Node() = default;
+        ~Node() = default;
+
+        //ban copying (cannot chain moveable elements with pointers!)
+        constexpr Node(const Node&) = delete;
+        Node& operator=(const Node&) = delete;
+
+    public:
+        /// Next Node in the list (nullptr for the last one)
+        Node* NextSListNode();
+        /// Next Node in the list (nullptr for the last one)
+        const Node* NextSListNode() const;
+
+        ///Access to entire list item (derived class)
+        ItemType* CastToSListNode();
+        ///Access to entire list item (derived class)
+        const ItemType* CastToSListNode() const;
+
+    private:
+        friend class IntrusiveSList;
+        Node* next = nullptr;
+    };
+
+
+    /// Test list is empty
+    bool IsEmpty() const;
+
+    /// The first item (nullptr if empty)
+    ItemType* Front();
+    /// The last item (nullptr if empty)
+    ItemType* Back();
+
+    /// Inserts a nodeToBeInserted at the start of the list (LIFO push)
+    void InsertAtFront(ItemType* nodeToBeInserted);
+
+    /// Inserts a nodeToBeInserted at the end of the list (FIFO push)
+    void InsertAtBack(ItemType* nodeToBeInserted);
+
+    /// Inserts a nodeToBeInserted right after position (already in list)
+    void InsertAfter(ItemType* position, ItemType* nodeToBeInserted);
+
+    /// Removes a node from the start of the list (if any)
+    /** @returns pointer to the removed node, or nullptr if nothing to remove */
+    ItemType* RemoveAtFront();
+
+    /// Removes a node following position (already in list)
+    /** @returns pointer to the removed node, or nullptr if nothing to remove */
+    ItemType* RemoveAfter(ItemType* position);
+
+    /// Search and remove specific node (O(n), there are no back links)
+    /** @returns true if node was found and removed */
+    bool Remove(ItemType* nodeToBeRemoved);
+
+    /// Move all items of other list to the end of this one in O(1)
+    void SpliceAtBack(IntrusiveSList& otherList);
+
+
+    ///Forward iterator (range based for support)
+    /** REMEMBER: removing item currently pointed by iterator invalidates that iterator */
+    template<class NodeType, class ListNodeType>
+    class IteratorSupportedOperations{
+    public:
+        /// Make iterator pointing Node (nullptr is the end)
+        IteratorSupportedOperations(NodeType* nodeToWrap) : currentNode(nodeToWrap) {}
+
+        /// Move to next position
+        IteratorSupportedOperations& operator++(){
+            currentNode = currentNode->NextSListNode();
+            return *this;
+        }
+        /// Move to next position (postfix)
+        IteratorSupportedOperations operator++(int){
+            IteratorSupportedOperations res = *this;
+            currentNode = currentNode->NextSListNode();
+            return res;
+        }
+
+        /// Access Node members
+        ListNodeType* operator->() const{
+            return currentNode->CastToSListNode();
+        }
+        /// Access Node
+        ListNodeType& operator*() const{
+            return *currentNode->CastToSListNode();
+        }
+
+        /// Check two iterators reference to the same item 
+        template<class OtherNodeType, class OtherListNodeType>
+        bool operator==(const IteratorSupportedOperations<OtherNodeType, OtherListNodeType>& other) const{
+            return currentNode == other.currentNode;
+        }
+        /// Check two iterators are referencing different items
+        template<class OtherNodeType, class OtherListNodeType>
+        bool operator!=(const IteratorSupportedOperations<OtherNodeType, OtherListNodeType>& other) const{
+            return currentNode != other.currentNode;
+        }
+
+    private:
+        template<class OtherNodeType, class OtherListNodeType>
+        friend class IteratorSupportedOperations;
+
+        /// The Node pointed by iterator
+        NodeType* currentNode;
+    };
+
+    /// Iterator partially compatible standard
+    using iterator = IteratorSupportedOperations<Node, ItemType>;
+    /// Iterator partially compatible standard
+    using const_iterator = IteratorSupportedOperations<const Node, const ItemType>;
+
+    ///Iterator to the beginning of the sequence
+    iterator begin();
+    ///Iterator to the end of the sequence
+    iterator end();
+    ///Iterator to the beginning of the const sequence
+    const_iterator begin() const;
+    ///Iterator to the end of the const sequence
+    const_iterator end() const;
+    ///Const iterator to the beginning of the sequence
+    const_iterator cbegin() const;
+    ///Const iterator to the end of the sequence
+    const_iterator cend() const;
+
+private:
+    /// The first node (nullptr for empty list)
+    Node* head = nullptr;
+    /// The last node (valid only when head is not nullptr)
+    Node* tail = nullptr;
+};
+
+
+/// Intrusive list with single pointer head (hlist, for hash buckets)
+/** The list head is only one pointer (so arrays of heads are compact),
+ * node has "next" and "pointer to the previous next" so any node
+ * can remove self in O(1) without knowing the list.
+ * Node destructor asserts node was removed from the list first
+ * (the same as ChainElement does). */
+template <class ItemType>
+class IntrusiveHList{
+public:
+    //ban copying (this ensures pointers are valid)
+    constexpr IntrusiveHList(const IntrusiveHList&) = delete;
+    IntrusiveHList& operator=(const IntrusiveHList&) = delete;
+
+    /// Defaults to empty list
+    IntrusiveHList() = default;
+    /// Destructor asserts list is empty
+    ~IntrusiveHList();
+
+
+    /// The base class for all IntrusiveHList items
+    /** NOTE: long method names prevent mixing with class methods */
+    class Node{
+    protected:
+        //There is no way to create node then from derived class
+        Node() = default;
+        /// Destructor asserts we shall remove item from list first
+        ~Node();
+
+        //ban copying (cannot chain moveable elements with pointers!)
+        constexpr Node(const Node&) = delete;
+        Node& operator=(const Node&) = delete;
+
+    public:
+        /// Test node is inserted into some IntrusiveHList
+        bool IsInHList() const;
+
+        /// Remove from the list (if any) in O(1)
+        void RemoveFromHList();
+
+        /// Insert nodeToBeInserted right after this one (this shall be in list)
+        void InsertNextHListNode(ItemType* nodeToBeInserted);
+
+        /// Next Node in the list (nullptr for the last one)
+        Node* NextHListNode();
+        /// Next Node in the list (nullptr for the last one)
+        const Node* NextHListNode() const;
+
+        ///Access to entire list item (derived class)
+        ItemType* CastToHListNode();
+        ///Access to entire list item (derived class)
+        const ItemType* CastToHListNode() const;
+
+    private:
+        friend class IntrusiveHList;
+        Node* next = nullptr;
+        /// Address of the pointer pointing to this node (nullptr if not in list)
+        Node** pprev = nullptr;
+    };
+
+
+    /// Test list is empty
+    bool IsEmpty() const;
+
+    /// The first item (nullptr if empty)
+    ItemType* Front();
+
+    /// Inserts a nodeToBeInserted at the start of the list
+    /** Node is removed from any previous list first */
+    void InsertAtFront(ItemType* nodeToBeInserted);
+
+    /// Removes a node from the start of the list (if any)
+    /** @returns pointer to the removed node, or nullptr if nothing to remove */
+    ItemType* RemoveAtFront();
+
+
+    ///Forward iterator (range based for support)
+    /** REMEMBER: removing item currently pointed by iterator invalidates that iterator */
+    template<class NodeType, class ListNodeType>
+    class IteratorSupportedOperations{
+    public:
+        /// Make iterator pointing Node (nullptr is the end)
+        IteratorSupportedOperations(NodeType* nodeToWrap) : currentNode(nodeToWrap) {}
+
+        /// Move to next position
+        IteratorSupportedOperations& operator++(){
+            currentNode = currentNode->NextHListNode();
+            return *this;
+        }
+        /// Move to next position (postfix)
+        IteratorSupportedOperations operator++(int){
+            IteratorSupportedOperations res = *this;
+            currentNode = currentNode->NextHListNode();
+            return res;
+        }
+
+        /// Access Node members
+        ListNodeType* operator->() const{
+            return currentNode->CastToHListNode();
+        }
+        /// Access Node
+        ListNodeType& operator*() const{
+            return *currentNode->CastToHListNode();
+        }
+
+        /// Check two iterators reference to the same item 
+        template<class OtherNodeType, class OtherListNodeType>
+        bool operator==(const IteratorSupportedOperations<OtherNodeType, OtherListNodeType>& other) const{
+            return currentNode == other.currentNode;
+        }
+        /// Check two iterators are referencing different items
+        template<class OtherNodeType, class OtherListNodeType>
+        bool operator!=(const IteratorSupportedOperations<OtherNodeType, OtherListNodeType>& other) const{
+            return currentNode != other.currentNode;
+        }
+
+    private:
+        template<class OtherNodeType, class OtherListNodeType>
+        friend class IteratorSupportedOperations;
+
+        /// The Node pointed by iterator
+        NodeType* currentNode;
+    };
+
+    /// Iterator partially compatible standard
+    using iterator = IteratorSupportedOperations<Node, ItemType>;
+    /// Iterator partially compatible standard
+    using const_iterator = IteratorSupportedOperations<const Node, const ItemType>;
+
+    ///Iterator to the beginning of the sequence
+    iterator begin();
+    ///Iterator to the end of the sequence
+    iterator end();
+    ///Iterator to the beginning of the const sequence
+    const_iterator begin() const;
+    ///Iterator to the end of the const sequence
+    const_iterator end() const;
+    ///Const iterator to the beginning of the sequence
+    const_iterator cbegin() const;
+    ///Const iterator to the end of the sequence
+    const_iterator cend() const;
+
+private:
+    /// The first node (nullptr for empty list)
+    Node* head = nullptr;
 };
 
 
@@ -469,6 +815,18 @@ inline void ChainElement::InsertPrevChainElement(ChainElement* chainElementBeing
     }
 }
 
+inline void ChainElement::InsertPrevChainElements(ChainElement* first, ChainElement* last){
+    //cut [first, last] out of the chain it belongs to
+    first->prev->next = last->next;
+    last->next->prev = first->prev;
+
+    //insert between previous and this one
+    prev->next = first;
+    first->prev = prev;
+    last->next = this;
+    prev = last;
+}
+
 inline void ChainElement::RemoveFromChain(){
     removeFromOtherChainOnly();
 
@@ -551,6 +909,99 @@ inline ItemType* IntrusiveList<ItemType>::RemoveAtEnd(){
 }
 
 
+template <class ItemType>
+inline void IntrusiveList<ItemType>::SpliceAtBack(IntrusiveList& otherList){
+    if( &otherList != this && !otherList.IsEmpty() ){
+        listHead.InsertPrevChainElements(
+            otherList.listHead.NextChainElement(), otherList.listHead.PrevChainElement()
+        );
+    }
+}
+
+template <class ItemType>
+inline void IntrusiveList<ItemType>::SpliceAtFront(IntrusiveList& otherList){
+    if( &otherList != this && !otherList.IsEmpty() ){
+        listHead.NextChainElement()->InsertPrevChainElements(
+            otherList.listHead.NextChainElement(), otherList.listHead.PrevChainElement()
+        );
+    }
+}
+
+template <class ItemType>
+template<class Iterator>
+inline void IntrusiveList<ItemType>::Splice(Iterator position, Iterator first, Iterator last){
+    if( first.currentNode != last.currentNode ){
+        position.currentNode->InsertPrevChainElements(
+            first.currentNode, last.currentNode->PrevChainElement()
+        );
+    }
+}
+
+template <class ItemType>
+template<class Less>
+inline void IntrusiveList<ItemType>::Merge(IntrusiveList& otherSortedList, Less less){
+    if( &otherSortedList == this || otherSortedList.IsEmpty() ){
+        return;
+    }
+    Node* middle = otherSortedList.listHead.NextListNode();
+    SpliceAtBack(otherSortedList);
+    mergeRuns(listHead.NextListNode(), middle, &listHead, less);
+}
+
+template <class ItemType>
+template<class Less>
+inline void IntrusiveList<ItemType>::Sort(Less less){
+    // merge runs of width items pairwise, doubling width each pass
+    for(unsigned long width = 1; ; width *= 2){
+        unsigned long merges = 0;
+        Node* first = listHead.NextListNode();
+        while( first != &listHead ){
+            Node* middle = first;
+            for(unsigned long i = 0; i < width && middle != &listHead; ++i){
+                middle = middle->NextListNode();
+            }
+            if( middle == &listHead ){
+                break; // the last run has no pair
+            }
+            Node* last = middle;
+            for(unsigned long i = 0; i < width && last != &listHead; ++i){
+                last = last->NextListNode();
+            }
+            mergeRuns(first, middle, last, less);
+            ++merges;
+            first = last; // last is never moved by merge
+        }
+        if( !merges || (1 == merges && first == &listHead) ){
+            return; // single run covers entire list
+        }
+    }
+}
+
+template <class ItemType>
+template<class Less>
+inline void IntrusiveList<ItemType>::mergeRuns(Node* first, Node* middle, Node* last, Less& less){
+    /* Items of the second run are moved (in groups) before items of
+       the first run, first run items are never moved,
+       so first run is done when we reach middle */
+    while( first != middle && middle != last ){
+        if( less(*middle->CastToListNode(), *first->CastToListNode()) ){
+            // take the whole group of second run items less than first
+            Node* groupLast = middle;
+            Node* next = middle->NextListNode();
+            while( next != last && less(*next->CastToListNode(), *first->CastToListNode()) ){
+                groupLast = next;
+                next = next->NextListNode();
+            }
+            first->InsertPrevChainElements(middle, groupLast);
+            middle = next;
+        }
+        else{
+            first = first->NextListNode();
+        }
+    }
+}
+
+
 template <class ItemType>
 inline typename IntrusiveList<ItemType>::iterator IntrusiveList<ItemType>::begin(){
     return listHead.NextListNode();
@@ -578,4 +1029,292 @@ inline typename IntrusiveList<ItemType>::const_iterator IntrusiveList<ItemType>:
     return &listHead;
 }
 
+
+//______________________________________________________________________________
+// Implementing IntrusiveSList
+
+template <class ItemType>
+inline typename IntrusiveSList<ItemType>::Node* IntrusiveSList<ItemType>::Node::NextSListNode(){
+    return next;
+}
+template <class ItemType>
+inline const typename IntrusiveSList<ItemType>::Node* IntrusiveSList<ItemType>::Node::NextSListNode() const{
+    return next;
+}
+
+template <class ItemType>
+inline ItemType* IntrusiveSList<ItemType>::Node::CastToSListNode(){
+    return static_cast<ItemType*>(this);
+}
+template <class ItemType>
+inline const ItemType* IntrusiveSList<ItemType>::Node::CastToSListNode() const{
+    return static_cast<const ItemType*>(this);
+}
+
+template <class ItemType>
+inline bool IntrusiveSList<ItemType>::IsEmpty() const{
+    return nullptr == head;
+}
+
+template <class ItemType>
+inline ItemType* IntrusiveSList<ItemType>::Front(){
+    return head ? head->CastToSListNode() : nullptr;
+}
+
+template <class ItemType>
+inline ItemType* IntrusiveSList<ItemType>::Back(){
+    return head ? tail->CastToSListNode() : nullptr;
+}
+
+template <class ItemType>
+inline void IntrusiveSList<ItemType>::InsertAtFront(ItemType* nodeToBeInserted){
+    Node* node = nodeToBeInserted;
+    node->next = head;
+    if( !head ){
+        tail = node;
+    }
+    head = node;
+}
+
+template <class ItemType>
+inline void IntrusiveSList<ItemType>::InsertAtBack(ItemType* nodeToBeInserted){
+    Node* node = nodeToBeInserted;
+    node->next = nullptr;
+    if( head ){
+        tail->next = node;
+    }
+    else{
+        head = node;
+    }
+    tail = node;
+}
+
+template <class ItemType>
+inline void IntrusiveSList<ItemType>::InsertAfter(ItemType* position, ItemType* nodeToBeInserted){
+    Node* prev = position;
+    Node* node = nodeToBeInserted;
+    node->next = prev->next;
+    prev->next = node;
+    if( tail == prev ){
+        tail = node;
+    }
+}
+
+template <class ItemType>
+inline ItemType* IntrusiveSList<ItemType>::RemoveAtFront(){
+    if( head ){
+        Node* res = head;
+        head = res->next;
+        res->next = nullptr;
+        return res->CastToSListNode();
+    }
+    return nullptr;
+}
+
+template <class ItemType>
+inline ItemType* IntrusiveSList<ItemType>::RemoveAfter(ItemType* position){
+    Node* prev = position;
+    Node* res = prev->next;
+    if( res ){
+        prev->next = res->next;
+        if( tail == res ){
+            tail = prev;
+        }
+        res->next = nullptr;
+        return res->CastToSListNode();
+    }
+    return nullptr;
+}
+
+template <class ItemType>
+inline bool IntrusiveSList<ItemType>::Remove(ItemType* nodeToBeRemoved){
+    Node* node = nodeToBeRemoved;
+    if( !head ){
+        return false;
+    }
+    if( head == node ){
+        RemoveAtFront();
+        return true;
+    }
+    for(Node* prev = head; prev->next; prev = prev->next){
+        if( prev->next == node ){
+            RemoveAfter(prev->CastToSListNode());
+            return true;
+        }
+    }
+    return false;
+}
+
+template <class ItemType>
+inline void IntrusiveSList<ItemType>::SpliceAtBack(IntrusiveSList& otherList){
+    if( &otherList == this || !otherList.head ){
+        return;
+    }
+    if( head ){
+        tail->next = otherList.head;
+    }
+    else{
+        head = otherList.head;
+    }
+    tail = otherList.tail;
+    otherList.head = nullptr;
+}
+
+template <class ItemType>
+inline typename IntrusiveSList<ItemType>::iterator IntrusiveSList<ItemType>::begin(){
+    return head;
+}
+template <class ItemType>
+inline typename IntrusiveSList<ItemType>::iterator IntrusiveSList<ItemType>::end(){
+    return static_cast<Node*>(nullptr);
+}
+
+template <class ItemType>
+inline typename IntrusiveSList<ItemType>::const_iterator IntrusiveSList<ItemType>::begin() const {
+    return head;
+}
+template <class ItemType>
+inline typename IntrusiveSList<ItemType>::const_iterator IntrusiveSList<ItemType>::end() const {
+    return static_cast<const Node*>(nullptr);
+}
+
+template <class ItemType>
+inline typename IntrusiveSList<ItemType>::const_iterator IntrusiveSList<ItemType>::cbegin() const {
+    return head;
+}
+template <class ItemType>
+inline typename IntrusiveSList<ItemType>::const_iterator IntrusiveSList<ItemType>::cend() const {
+    return static_cast<const Node*>(nullptr);
+}
+
+
+//______________________________________________________________________________
+// Implementing IntrusiveHList
+
+template <class ItemType>
+inline IntrusiveHList<ItemType>::~IntrusiveHList(){
+    if( head ){
+        // nodes would keep pointer to the destroyed head
+        InstantIntrusiveListPanic();
+    }
+}
+
+template <class ItemType>
+inline IntrusiveHList<ItemType>::Node::~Node(){
+    if( pprev ){
+        /* Destroying before removed from the list
+           is likely an error (the same as for ChainElement) */
+        InstantIntrusiveListPanic();
+    }
+}
+
+template <class ItemType>
+inline bool IntrusiveHList<ItemType>::Node::IsInHList() const{
+    return nullptr != pprev;
+}
+
+template <class ItemType>
+inline void IntrusiveHList<ItemType>::Node::RemoveFromHList(){
+    if( pprev ){
+        *pprev = next;
+        if( next ){
+            next->pprev = pprev;
+        }
+        next = nullptr;
+        pprev = nullptr;
+    }
+}
+
+template <class ItemType>
+inline void IntrusiveHList<ItemType>::Node::InsertNextHListNode(ItemType* nodeToBeInserted){
+    Node* node = nodeToBeInserted;
+    if( node == this ){
+        return;
+    }
+    node->RemoveFromHList();
+    node->next = next;
+    if( next ){
+        next->pprev = &node->next;
+    }
+    next = node;
+    node->pprev = &next;
+}
+
+template <class ItemType>
+inline typename IntrusiveHList<ItemType>::Node* IntrusiveHList<ItemType>::Node::NextHListNode(){
+    return next;
+}
+template <class ItemType>
+inline const typename IntrusiveHList<ItemType>::Node* IntrusiveHList<ItemType>::Node::NextHListNode() const{
+    return next;
+}
+
+template <class ItemType>
+inline ItemType* IntrusiveHList<ItemType>::Node::CastToHListNode(){
+    return static_cast<ItemType*>(this);
+}
+template <class ItemType>
+inline const ItemType* IntrusiveHList<ItemType>::Node::CastToHListNode() const{
+    return static_cast<const ItemType*>(this);
+}
+
+template <class ItemType>
+inline bool IntrusiveHList<ItemType>::IsEmpty() const{
+    return nullptr == head;
+}
+
+template <class ItemType>
+inline ItemType* IntrusiveHList<ItemType>::Front(){
+    return head ? head->CastToHListNode() : nullptr;
+}
+
+template <class ItemType>
+inline void IntrusiveHList<ItemType>::InsertAtFront(ItemType* nodeToBeInserted){
+    Node* node = nodeToBeInserted;
+    node->RemoveFromHList();
+    node->next = head;
+    if( head ){
+        head->pprev = &node->next;
+    }
+    head = node;
+    node->pprev = &head;
+}
+
+template <class ItemType>
+inline ItemType* IntrusiveHList<ItemType>::RemoveAtFront(){
+    if( head ){
+        Node* res = head;
+        res->RemoveFromHList();
+        return res->CastToHListNode();
+    }
+    return nullptr;
+}
+
+template <class ItemType>
+inline typename IntrusiveHList<ItemType>::iterator IntrusiveHList<ItemType>::begin(){
+    return head;
+}
+template <class ItemType>
+inline typename IntrusiveHList<ItemType>::iterator IntrusiveHList<ItemType>::end(){
+    return static_cast<Node*>(nullptr);
+}
+
+template <class ItemType>
+inline typename IntrusiveHList<ItemType>::const_iterator IntrusiveHList<ItemType>::begin() const {
+    return head;
+}
+template <class ItemType>
+inline typename IntrusiveHList<ItemType>::const_iterator IntrusiveHList<ItemType>::end() const {
+    return static_cast<const Node*>(nullptr);
+}
+
+template <class ItemType>
+inline typename IntrusiveHList<ItemType>::const_iterator IntrusiveHList<ItemType>::cbegin() const {
+    return head;
+}
+template <class ItemType>
+inline typename IntrusiveHList<ItemType>::const_iterator IntrusiveHList<ItemType>::cend() const {
+    return static_cast<const Node*>(nullptr);
+}
+
 #endif
@@ -0,0 +1,929 @@
+/** @file InstantIntrusiveLockFree.h
+    @brief Intrusive lock-free MPSC queue, stack and skip list for sharing
+           nodes between threads/interrupts (no dynamic memory, no dependencies
+           except InstantTrace.h that compiles to nothing by default)
+
+IntrusiveMpscQueue is Vyukov style intrusive multi producer single
+consumer queue: Push is wait-free (single atomic exchange), so it can be
+called from any thread or interrupt, Pop/PopBatch shall be called only
+from the single consumer (like the thread running the Scheduler).
+
+IntrusiveLockFreeStack is Treiber stack: Push from anywhere (CAS loop),
+PopAll takes everything at once (single atomic exchange),
+Pop/PopAll shall be called only from the single consumer
+(this way removed item cannot come back while CAS is prepared, no ABA).
+
+IntrusiveSkipList is concurrent ordered set (shared timer sets, order books)
+that does not serialize on one lock: insert, remove and search are
+O(log n) expected and lock-free, each node embeds fixed size tower of links.
+
+All of them use their own link members (Node classes are separate from
+ChainElement/IntrusiveList::Node), so the same item can be
+IntrusiveList member on the consumer side and travel through the queue.
+
+Example usage:
+ @code
+    class Message:
+        public IntrusiveList<Message>::Node,
+        public IntrusiveMpscQueue<Message>::Node
+    {
+        ...
+    };
+
+    IntrusiveMpscQueue<Message> inbox;
+
+    // any thread or ISR
+    inbox.Push(&someMessage);
+
+    // consumer thread
+    inbox.PopBatch([](Message* message){
+        Handle(message);
+    });
+ @endcode
+
+Compiler provided atomic builtins are used where available,
+otherwise each atomic step goes inside InstantIntrusiveLockFree_EnterCritical
+/InstantIntrusiveLockFree_LeaveCritical (so on single core MCU the same
+code is interrupt safe, but not lock free of course).
+
+NOTE: nodes are not owned, memory of the node shall stay valid
+      while it is inside the queue/stack (and consumer shall not free
+      the node before Pop returns it).
+
+MIT License
+
+Copyright (c) 2023 Pavlo M, see https://github.com/olvap80/InstantArduino
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef InstantIntrusiveLockFree_INCLUDED_H
+#define InstantIntrusiveLockFree_INCLUDED_H
+
+//______________________________________________________________________________
+// Configurable options (InstantIntrusiveLockFree specific)
+
+/* Common configuration to be included only if available
+   (you can separate file and/or configure individually
+    or just skip that to stick with defaults) */
+#if defined(__has_include) && __has_include("InstantRTOS.Config.h")
+#   include "InstantRTOS.Config.h"
+#endif
+
+/* Critical section used only when atomic builtins are not available
+   (just leave as is if interrupts/other RTOS are not used) */
+#ifndef InstantIntrusiveLockFree_EnterCritical
+#   if defined(InstantRTOS_EnterCritical) && !defined(InstantIntrusiveLockFree_SuppressEnterCritical)
+#       define InstantIntrusiveLockFree_EnterCritical InstantRTOS_EnterCritical
+#       define InstantIntrusiveLockFree_LeaveCritical InstantRTOS_LeaveCritical
+#       if defined(InstantRTOS_MutexObjectType)
+#           define InstantIntrusiveLockFree_MutexObjectType InstantRTOS_MutexObjectType
+#           define InstantIntrusiveLockFree_MutexObjectVariable InstantRTOS_MutexObjectVariable
+#       endif
+#   else
+#       define InstantIntrusiveLockFree_EnterCritical
+#       define InstantIntrusiveLockFree_LeaveCritical
+#   endif
+#endif
+
+#ifndef InstantIntrusiveLockFree_Panic
+#   ifdef InstantRTOS_Panic
+#       define InstantIntrusiveLockFree_Panic() InstantRTOS_Panic('F')
+#   else
+#       define InstantIntrusiveLockFree_Panic() /* you can customize here! */ do{}while(true)
+#   endif
+#endif
+
+/* Compiler provided atomic builtins are used for links where available
+   (define InstantIntrusiveLockFree_SuppressBuiltinAtomics to always go with
+    InstantIntrusiveLockFree_EnterCritical/InstantIntrusiveLockFree_LeaveCritical,
+    for AVR builtins are not lock free, so critical section is used) */
+#if !defined(InstantIntrusiveLockFree_UseBuiltinAtomics) \
+    && !defined(InstantIntrusiveLockFree_SuppressBuiltinAtomics) \
+    && (defined(__GNUC__) || defined(__clang__)) && !defined(__AVR__)
+#   define InstantIntrusiveLockFree_UseBuiltinAtomics
+#endif
+
+//______________________________________________________________________________
+// All dependencies are only internal inside InstantRTOS
+
+#include "InstantTrace.h"
+
+
+//______________________________________________________________________________
+// Public API
+
+/// Internal helpers for operating on links shared between threads/interrupts
+namespace InstantIntrusiveLockFreeDetails{
+    /// Atomic operations on pointer links
+    /** Compiler builtins are used where available (InstantIntrusiveLockFree_UseBuiltinAtomics),
+     * otherwise operations go inside the critical section */
+    template<class Pointer>
+    class AtomicLink{
+    public:
+        /// Read link (acquire)
+        static Pointer Load(Pointer volatile* link);
+        /// Write link (release)
+        static void Store(Pointer volatile* link, Pointer value);
+        /// Replace link with value, @returns previous value
+        static Pointer Exchange(Pointer volatile* link, Pointer value);
+        /// Replace link with desired if it is still expected
+        /** @returns true on success, otherwise expected receives actual value */
+        static bool CompareExchange(Pointer volatile* link, Pointer& expected, Pointer desired);
+
+#if !defined(InstantIntrusiveLockFree_UseBuiltinAtomics) && defined(InstantIntrusiveLockFree_MutexObjectType)
+    private:
+        static InstantIntrusiveLockFree_MutexObjectType InstantIntrusiveLockFree_MutexObjectVariable;
+#endif
+    };
+}
+
+
+/// Vyukov intrusive multi producer single consumer queue
+/** Push is wait-free and can be called from any thread/interrupt,
+ * Pop/PopBatch/IsEmpty shall be called only from one consumer thread */
+template <class ItemType>
+class IntrusiveMpscQueue{
+public:
+    //ban copying (this ensures pointers are valid)
+    constexpr IntrusiveMpscQueue(const IntrusiveMpscQueue&) = delete;
+    IntrusiveMpscQueue& operator=(const IntrusiveMpscQueue&) = delete;
+
+    /// Defaults to empty queue
+    IntrusiveMpscQueue() = default;
+
+
+    /// The base class for all IntrusiveMpscQueue items
+    /** NOTE: long method names prevent mixing with class methods */
+    class Node{
+    protected:
+        //There is no way to create node then from derived class
+        Node() = default;
+
+        //ban copying (cannot link moveable elements with pointers!)
+        constexpr Node(const Node&) = delete;
+        Node& operator=(const Node&) = delete;
+
+    public:
+        ///Access to entire queue item (derived class)
+        ItemType* CastToMpscQueueNode();
+
+    private:
+        friend class IntrusiveMpscQueue;
+        /// Link to the next pushed node (written by producers)
+        Node* volatile mpscNext = nullptr;
+    };
+
+
+    /// Add item to the end of the queue (any thread/interrupt, wait-free)
+    /** Item shall not be in the queue already */
+    void Push(ItemType* itemToBePushed);
+
+    /// Take the oldest item (consumer only)
+    /** @returns nullptr if queue is empty
+     *  (or the producer is in the middle of Push, try again later) */
+    ItemType* Pop();
+
+    /// Take up to maxCount items and pass them to handler(ItemType*) in order
+    /** @returns number of items handled (consumer only) */
+    template<class Handler>
+    unsigned long PopBatch(Handler&& handler, unsigned long maxCount = ~0UL);
+
+    /// Test there is nothing to Pop (consumer only)
+    bool IsEmpty() const;
+
+private:
+    using Link = InstantIntrusiveLockFreeDetails::AtomicLink<Node*>;
+
+    /// Placeholder keeping the queue non empty from the producers point of view
+    Node stub;
+    /// The last pushed node (producers exchange that)
+    Node* volatile head = &stub;
+    /// The oldest node (consumer only)
+    Node* tail = &stub;
+
+    void pushNode(Node* node);
+};
+
+
+/// Treiber intrusive stack (LIFO)
+/** Push can be called from any thread/interrupt,
+ * Pop/PopAll shall be called only from one consumer thread
+ * (PopAll alone is safe from any thread if Pop is never used) */
+template <class ItemType>
+class IntrusiveLockFreeStack{
+public:
+    //ban copying (this ensures pointers are valid)
+    constexpr IntrusiveLockFreeStack(const IntrusiveLockFreeStack&) = delete;
+    IntrusiveLockFreeStack& operator=(const IntrusiveLockFreeStack&) = delete;
+
+    /// Defaults to empty stack
+    IntrusiveLockFreeStack() = default;
+
+
+    /// The base class for all IntrusiveLockFreeStack items
+    /** NOTE: long method names prevent mixing with class methods */
+    class Node{
+    protected:
+        //There is no way to create node then from derived class
+        Node() = default;
+
+        //ban copying (cannot link moveable elements with pointers!)
+        constexpr Node(const Node&) = delete;
+        Node& operator=(const Node&) = delete;
+
+    public:
+        /// Next node in the chain returned by PopAll (nullptr for the last one)
+        ItemType* NextLockFreeStackNode();
+
+        ///Access to entire stack item (derived class)
+        ItemType* CastToLockFreeStackNode();
+
+    private:
+        friend class IntrusiveLockFreeStack;
+        Node* volatile stackNext = nullptr;
+    };
+
+
+    /// Put item on top (any thread/interrupt, lock-free)
+    void Push(ItemType* itemToBePushed);
+
+    /// Take item from the top (single consumer only), nullptr if empty
+    ItemType* Pop();
+
+    /// Take all items at once (consumer only, wait-free)
+    /** @returns the most recently pushed item (nullptr if empty),
+     *  walk the rest with NextLockFreeStackNode() */
+    ItemType* PopAll();
+
+    /// Take all items at once in the order they were pushed
+    /** The same as PopAll followed by in place reversal (O(n)) */
+    ItemType* PopAllInPushOrder();
+
+    /// Test stack is empty (snapshot, can change right after)
+    bool IsEmpty() const;
+
+private:
+    using Link = InstantIntrusiveLockFreeDetails::AtomicLink<Node*>;
+
+    Node* volatile top = nullptr;
+};
+
+
+/// Intrusive lock-free skip list ordered by Less
+/** Insert/Remove/LowerBound are O(log n) expected and can run
+ * from any threads concurrently, iteration is lock-free too
+ * (and weakly consistent: items inserted/removed meanwhile may or may not
+ * be seen, removed items are skipped).
+ * Node embeds static capacity tower of MaxLevels links,
+ * height of each node is random (geometric, p = 1/2).
+ * Less is stateless functor like for IntrusiveTree:
+ * (const ItemType&, const ItemType&) and (const ItemType&, const Key&),
+ * (const Key&, const ItemType&) for the Key types used in search.
+ * Equal items are allowed, they are ordered by their addresses.
+ * REMEMBER: the item can be removed only after its Insert has returned,
+ *           and removed item can be inserted again or destroyed only when
+ *           no other thread can still traverse it (use own quiescent
+ *           points, like "all threads completed the operation they were in"),
+ *           there is no garbage collector here, memory belongs to the user! */
+template <class ItemType, class Less, unsigned MaxLevels = 16>
+class IntrusiveSkipList{
+public:
+    static_assert(MaxLevels >= 1 && MaxLevels <= 32, "MaxLevels shall be in 1..32");
+
+    //ban copying (this ensures pointers are valid)
+    constexpr IntrusiveSkipList(const IntrusiveSkipList&) = delete;
+    IntrusiveSkipList& operator=(const IntrusiveSkipList&) = delete;
+
+    /// Defaults to empty skip list
+    IntrusiveSkipList() = default;
+    /// Destructor asserts skip list is empty
+    ~IntrusiveSkipList();
+
+
+    /// The base class for all IntrusiveSkipList items
+    /** NOTE: long method names prevent mixing with class methods */
+    class Node{
+    protected:
+        //There is no way to create node then from derived class
+        Node() = default;
+        /// Destructor asserts we shall remove item from skip list first
+        ~Node();
+
+        //ban copying (cannot link moveable elements with pointers!)
+        constexpr Node(const Node&) = delete;
+        Node& operator=(const Node&) = delete;
+
+    public:
+        /// Test node is inserted into some IntrusiveSkipList
+        bool IsInSkipList() const;
+
+        /// Next not removed Node in order (nullptr for the last one)
+        Node* NextSkipListNode();
+
+        ///Access to entire skip list item (derived class)
+        ItemType* CastToSkipListNode();
+
+    private:
+        friend class IntrusiveSkipList;
+
+        /// Links for each level (bit 0 set means this node is being removed)
+        Node* volatile next[MaxLevels] = {};
+        /// Number of levels in use (0 when not in skip list)
+        volatile unsigned char levels = 0;
+        /// Changes the height each time the node is inserted
+        unsigned char insertions = 0;
+    };
+
+
+    /// Insert item (any thread), the item shall not be in skip list
+    void Insert(ItemType* itemToBeInserted);
+
+    /// Remove item (any thread)
+    /** @returns false if other thread is removing that item right now */
+    bool Remove(ItemType* itemToBeRemoved);
+
+    /// The first (smallest) item, nullptr if empty
+    ItemType* First();
+
+    /// Test skip list is empty (snapshot, can change right after)
+    bool IsEmpty();
+
+    /// The first item that is not less than key (nullptr if none)
+    template<class Key>
+    ItemType* LowerBound(const Key& key);
+
+    /// Some item equal to key (nullptr if none)
+    template<class Key>
+    ItemType* Find(const Key& key);
+
+
+    ///Forward iterator (range based for support)
+    /** end() is represented by nullptr */
+    class iterator{
+    public:
+        /// Make iterator pointing Node (nullptr is the end)
+        iterator(Node* nodeToWrap) : currentNode(nodeToWrap) {}
+
+        /// Move to next position
+        iterator& operator++(){
+            currentNode = currentNode->NextSkipListNode();
+            return *this;
+        }
+        /// Move to next position (postfix)
+        iterator operator++(int){
+            iterator res = *this;
+            currentNode = currentNode->NextSkipListNode();
+            return res;
+        }
+
+        /// Access Node members
+        ItemType* operator->() const{
+            return currentNode->CastToSkipListNode();
+        }
+        /// Access Node
+        ItemType& operator*() const{
+            return *currentNode->CastToSkipListNode();
+        }
+
+        /// Check two iterators reference to the same item
+        bool operator==(const iterator& other) const{
+            return currentNode == other.currentNode;
+        }
+        /// Check two iterators are referencing different items
+        bool operator!=(const iterator& other) const{
+            return currentNode != other.currentNode;
+        }
+
+    private:
+        /// The Node pointed by iterator
+        Node* currentNode;
+    };
+
+    ///Iterator to the beginning of the sequence (the smallest item)
+    iterator begin();
+    ///Iterator to the end of the sequence
+    iterator end();
+
+private:
+    using Link = InstantIntrusiveLockFreeDetails::AtomicLink<Node*>;
+    /// Integer able to hold pointer bits (for marking)
+    using PointerBits = decltype(sizeof(0));
+
+    /// Sentinel having all levels (never removed)
+    Node head;
+
+    static bool isMarked(Node* link);
+    static Node* marked(Node* link);
+    static Node* unmarked(Node* link);
+    static bool isRemoved(Node* node);
+
+    /// Total order among items (equal ones are ordered by address)
+    static bool before(Node* a, Node* b);
+    static unsigned randomLevels(Node* node);
+
+    /// Find neighbours of node on all levels, unlinking removed nodes on the way
+    void find(Node* node, Node** preds, Node** succs);
+};
+
+
+
+//______________________________________________________________________________
+//##############################################################################
+/*==============================================================================
+*  Implementation details follow                                               *
+*=============================================================================*/
+//##############################################################################
+
+
+//______________________________________________________________________________
+// Implementing InstantIntrusiveLockFreeDetails::AtomicLink
+
+#ifdef InstantIntrusiveLockFree_UseBuiltinAtomics
+
+template<class Pointer>
+inline Pointer InstantIntrusiveLockFreeDetails::AtomicLink<Pointer>::Load(Pointer volatile* link){
+    return __atomic_load_n(link, __ATOMIC_ACQUIRE);
+}
+
+template<class Pointer>
+inline void InstantIntrusiveLockFreeDetails::AtomicLink<Pointer>::Store(Pointer volatile* link, Pointer value){
+    __atomic_store_n(link, value, __ATOMIC_RELEASE);
+}
+
+template<class Pointer>
+inline Pointer InstantIntrusiveLockFreeDetails::AtomicLink<Pointer>::Exchange(Pointer volatile* link, Pointer value){
+    return __atomic_exchange_n(link, value, __ATOMIC_ACQ_REL);
+}
+
+template<class Pointer>
+inline bool InstantIntrusiveLockFreeDetails::AtomicLink<Pointer>::CompareExchange(
+    Pointer volatile* link, Pointer& expected, Pointer desired
+){
+    return __atomic_compare_exchange_n(
+        link, &expected, desired, true, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE
+    );
+}
+
+#else
+
+#if defined(InstantIntrusiveLockFree_MutexObjectType)
+template<class Pointer>
+InstantIntrusiveLockFree_MutexObjectType
+    InstantIntrusiveLockFreeDetails::AtomicLink<Pointer>::InstantIntrusiveLockFree_MutexObjectVariable;
+#endif
+
+template<class Pointer>
+inline Pointer InstantIntrusiveLockFreeDetails::AtomicLink<Pointer>::Load(Pointer volatile* link){
+    Pointer res;
+    InstantIntrusiveLockFree_EnterCritical
+        res = *link;
+    InstantIntrusiveLockFree_LeaveCritical
+    return res;
+}
+
+template<class Pointer>
+inline void InstantIntrusiveLockFreeDetails::AtomicLink<Pointer>::Store(Pointer volatile* link, Pointer value){
+    InstantIntrusiveLockFree_EnterCritical
+        *link = value;
+    InstantIntrusiveLockFree_LeaveCritical
+}
+
+template<class Pointer>
+inline Pointer InstantIntrusiveLockFreeDetails::AtomicLink<Pointer>::Exchange(Pointer volatile* link, Pointer value){
+    Pointer res;
+    InstantIntrusiveLockFree_EnterCritical
+        res = *link;
+        *link = value;
+    InstantIntrusiveLockFree_LeaveCritical
+    return res;
+}
+
+template<class Pointer>
+inline bool InstantIntrusiveLockFreeDetails::AtomicLink<Pointer>::CompareExchange(
+    Pointer volatile* link, Pointer& expected, Pointer desired
+){
+    bool res;
+    InstantIntrusiveLockFree_EnterCritical
+        res = (*link == expected);
+        if( res ){
+            *link = desired;
+        }
+        else{
+            expected = *link;
+        }
+    InstantIntrusiveLockFree_LeaveCritical
+    return res;
+}
+
+#endif
+
+
+//______________________________________________________________________________
+// Implementing IntrusiveMpscQueue
+
+template <class ItemType>
+inline ItemType* IntrusiveMpscQueue<ItemType>::Node::CastToMpscQueueNode(){
+    return static_cast<ItemType*>(this);
+}
+
+template <class ItemType>
+inline void IntrusiveMpscQueue<ItemType>::Push(ItemType* itemToBePushed){
+    InstantTrace_Count(QueuePush);
+    pushNode(itemToBePushed);
+}
+
+template <class ItemType>
+inline void IntrusiveMpscQueue<ItemType>::pushNode(Node* node){
+    // node is not visible to others yet, plain write is enough
+    node->mpscNext = nullptr;
+    // serialization point between producers
+    Node* previous = Link::Exchange(&head, node);
+    // consumer can see "broken" chain till this moment (Pop returns nullptr then)
+    Link::Store(&previous->mpscNext, node);
+}
+
+template <class ItemType>
+inline ItemType* IntrusiveMpscQueue<ItemType>::Pop(){
+    Node* oldest = tail;
+    Node* next = Link::Load(&oldest->mpscNext);
+
+    if( &stub == oldest ){
+        if( !next ){
+            return nullptr;
+        }
+        // skip stub
+        tail = next;
+        oldest = next;
+        next = Link::Load(&next->mpscNext);
+    }
+
+    if( next ){
+        tail = next;
+        return oldest->CastToMpscQueueNode();
+    }
+
+    if( oldest != Link::Load(&head) ){
+        // producer has exchanged head, but not linked yet
+        return nullptr;
+    }
+
+    // oldest is the last one, put stub behind to be able to take it
+    pushNode(&stub);
+    next = Link::Load(&oldest->mpscNext);
+    if( next ){
+        tail = next;
+        return oldest->CastToMpscQueueNode();
+    }
+    return nullptr;
+}
+
+template <class ItemType>
+template<class Handler>
+inline unsigned long IntrusiveMpscQueue<ItemType>::PopBatch(Handler&& handler, unsigned long maxCount){
+    unsigned long res = 0;
+    while( res < maxCount ){
+        ItemType* item = Pop();
+        if( !item ){
+            break;
+        }
+        ++res;
+        handler(item);
+    }
+    return res;
+}
+
+template <class ItemType>
+inline bool IntrusiveMpscQueue<ItemType>::IsEmpty() const{
+    // stub stays the only node when everything was taken
+    return tail == &stub && nullptr == Link::Load(const_cast<Node* volatile*>(&stub.mpscNext));
+}
+
+
+//______________________________________________________________________________
+// Implementing IntrusiveLockFreeStack
+
+template <class ItemType>
+inline ItemType* IntrusiveLockFreeStack<ItemType>::Node::NextLockFreeStackNode(){
+    return stackNext ? stackNext->CastToLockFreeStackNode() : nullptr;
+}
+
+template <class ItemType>
+inline ItemType* IntrusiveLockFreeStack<ItemType>::Node::CastToLockFreeStackNode(){
+    return static_cast<ItemType*>(this);
+}
+
+template <class ItemType>
+inline void IntrusiveLockFreeStack<ItemType>::Push(ItemType* itemToBePushed){
+    InstantTrace_Count(StackPush);
+    Node* node = itemToBePushed;
+    Node* expected = Link::Load(&top);
+    do{
+        node->stackNext = expected;
+    } while( !Link::CompareExchange(&top, expected, node) );
+}
+
+template <class ItemType>
+inline ItemType* IntrusiveLockFreeStack<ItemType>::Pop(){
+    Node* expected = Link::Load(&top);
+    /* only this (single) consumer removes items,
+       so expected cannot be removed and pushed back meanwhile (no ABA),
+       concurrent Push just makes CAS fail */
+    while( expected && !Link::CompareExchange(&top, expected, expected->stackNext) ){}
+    if( !expected ){
+        return nullptr;
+    }
+    expected->stackNext = nullptr;
+    return expected->CastToLockFreeStackNode();
+}
+
+template <class ItemType>
+inline ItemType* IntrusiveLockFreeStack<ItemType>::PopAll(){
+    Node* res = Link::Exchange(&top, nullptr);
+    return res ? res->CastToLockFreeStackNode() : nullptr;
+}
+
+template <class ItemType>
+inline ItemType* IntrusiveLockFreeStack<ItemType>::PopAllInPushOrder(){
+    Node* current = Link::Exchange(&top, nullptr);
+    Node* reversed = nullptr;
+    while( current ){
+        Node* next = current->stackNext;
+        current->stackNext = reversed;
+        reversed = current;
+        current = next;
+    }
+    return reversed ? reversed->CastToLockFreeStackNode() : nullptr;
+}
+
+template <class ItemType>
+inline bool IntrusiveLockFreeStack<ItemType>::IsEmpty() const{
+    return nullptr == Link::Load(const_cast<Node* volatile*>(&top));
+}
+
+//______________________________________________________________________________
+// Implementing IntrusiveSkipList
+
+template <class ItemType, class Less, unsigned MaxLevels>
+inline IntrusiveSkipList<ItemType, Less, MaxLevels>::~IntrusiveSkipList(){
+    if( !IsEmpty() ){
+        // nodes would keep pointers into the destroyed skip list
+        InstantIntrusiveLockFree_Panic();
+    }
+}
+
+template <class ItemType, class Less, unsigned MaxLevels>
+inline IntrusiveSkipList<ItemType, Less, MaxLevels>::Node::~Node(){
+    if( IsInSkipList() ){
+        /* Destroying before removed from the skip list
+           is likely an error (the same as for ChainElement) */
+        InstantIntrusiveLockFree_Panic();
+    }
+}
+
+template <class ItemType, class Less, unsigned MaxLevels>
+inline bool IntrusiveSkipList<ItemType, Less, MaxLevels>::Node::IsInSkipList() const{
+    return 0 != levels;
+}
+
+template <class ItemType, class Less, unsigned MaxLevels>
+inline typename IntrusiveSkipList<ItemType, Less, MaxLevels>::Node*
+IntrusiveSkipList<ItemType, Less, MaxLevels>::Node::NextSkipListNode(){
+    Node* node = unmarked(Link::Load(&next[0]));
+    while( node && isRemoved(node) ){
+        node = unmarked(Link::Load(&node->next[0]));
+    }
+    return node;
+}
+
+template <class ItemType, class Less, unsigned MaxLevels>
+inline ItemType* IntrusiveSkipList<ItemType, Less, MaxLevels>::Node::CastToSkipListNode(){
+    return static_cast<ItemType*>(this);
+}
+
+
+template <class ItemType, class Less, unsigned MaxLevels>
+inline void IntrusiveSkipList<ItemType, Less, MaxLevels>::Insert(ItemType* itemToBeInserted){
+    Node* node = itemToBeInserted;
+    if( node->IsInSkipList() ){
+        InstantIntrusiveLockFree_Panic();
+    }
+    const unsigned levels = randomLevels(node);
+    Node* preds[MaxLevels];
+    Node* succs[MaxLevels];
+
+    // linking at level 0 makes node visible (linearization point)
+    for(;;){
+        find(node, preds, succs);
+        for(unsigned level = 0; level < levels; ++level){
+            node->next[level] = succs[level]; // not visible yet
+        }
+        node->levels = static_cast<unsigned char>(levels);
+        Node* expected = succs[0];
+        if( Link::CompareExchange(&preds[0]->next[0], expected, node) ){
+            break;
+        }
+    }
+
+    // upper levels are only shortcuts, link them one by one
+    for(unsigned level = 1; level < levels; ++level){
+        for(;;){
+            Node* expected = succs[level];
+            if( Link::CompareExchange(&preds[level]->next[level], expected, node) ){
+                break;
+            }
+            // neighbourhood changed, find it again and fix own link
+            find(node, preds, succs);
+            Link::Store(&node->next[level], succs[level]);
+        }
+    }
+}
+
+template <class ItemType, class Less, unsigned MaxLevels>
+inline bool IntrusiveSkipList<ItemType, Less, MaxLevels>::Remove(ItemType* itemToBeRemoved){
+    Node* node = itemToBeRemoved;
+    const unsigned levels = node->levels;
+    if( !levels ){
+        InstantIntrusiveLockFree_Panic();
+    }
+
+    // mark upper levels first, so nobody links after the node there
+    for(unsigned level = levels - 1; level > 0; --level){
+        Node* succ = Link::Load(&node->next[level]);
+        while( !isMarked(succ) && !Link::CompareExchange(&node->next[level], succ, marked(succ)) ){}
+    }
+
+    // marking level 0 is the linearization point, only one remover wins
+    Node* succ = Link::Load(&node->next[0]);
+    for(;;){
+        if( isMarked(succ) ){
+            return false;
+        }
+        if( Link::CompareExchange(&node->next[0], succ, marked(succ)) ){
+            break;
+        }
+    }
+
+    // physically unlink from all levels
+    Node* preds[MaxLevels];
+    Node* succs[MaxLevels];
+    find(node, preds, succs);
+    node->levels = 0;
+    return true;
+}
+
+template <class ItemType, class Less, unsigned MaxLevels>
+inline ItemType* IntrusiveSkipList<ItemType, Less, MaxLevels>::First(){
+    Node* res = head.NextSkipListNode();
+    return res ? res->CastToSkipListNode() : nullptr;
+}
+
+template <class ItemType, class Less, unsigned MaxLevels>
+inline bool IntrusiveSkipList<ItemType, Less, MaxLevels>::IsEmpty(){
+    return nullptr == head.NextSkipListNode();
+}
+
+template <class ItemType, class Less, unsigned MaxLevels>
+template<class Key>
+inline ItemType* IntrusiveSkipList<ItemType, Less, MaxLevels>::LowerBound(const Key& key){
+    // read only descent (does not help unlinking, removed nodes are still valid)
+    Node* pred = &head;
+    Node* curr = nullptr;
+    for(unsigned level = MaxLevels; level-- > 0; ){
+        curr = unmarked(Link::Load(&pred->next[level]));
+        while( curr && Less()(*curr->CastToSkipListNode(), key) ){
+            pred = curr;
+            curr = unmarked(Link::Load(&curr->next[level]));
+        }
+    }
+    while( curr && isRemoved(curr) ){
+        curr = unmarked(Link::Load(&curr->next[0]));
+    }
+    return curr ? curr->CastToSkipListNode() : nullptr;
+}
+
+template <class ItemType, class Less, unsigned MaxLevels>
+template<class Key>
+inline ItemType* IntrusiveSkipList<ItemType, Less, MaxLevels>::Find(const Key& key){
+    ItemType* res = LowerBound(key);
+    if( res && !Less()(key, *res) ){
+        return res;
+    }
+    return nullptr;
+}
+
+template <class ItemType, class Less, unsigned MaxLevels>
+inline typename IntrusiveSkipList<ItemType, Less, MaxLevels>::iterator
+IntrusiveSkipList<ItemType, Less, MaxLevels>::begin(){
+    return head.NextSkipListNode();
+}
+
+template <class ItemType, class Less, unsigned MaxLevels>
+inline typename IntrusiveSkipList<ItemType, Less, MaxLevels>::iterator
+IntrusiveSkipList<ItemType, Less, MaxLevels>::end(){
+    return nullptr;
+}
+
+
+template <class ItemType, class Less, unsigned MaxLevels>
+inline bool IntrusiveSkipList<ItemType, Less, MaxLevels>::isMarked(Node* link){
+    return reinterpret_cast<PointerBits>(link) & 1;
+}
+
+template <class ItemType, class Less, unsigned MaxLevels>
+inline typename IntrusiveSkipList<ItemType, Less, MaxLevels>::Node*
+IntrusiveSkipList<ItemType, Less, MaxLevels>::marked(Node* link){
+    return reinterpret_cast<Node*>(reinterpret_cast<PointerBits>(link) | 1);
+}
+
+template <class ItemType, class Less, unsigned MaxLevels>
+inline typename IntrusiveSkipList<ItemType, Less, MaxLevels>::Node*
+IntrusiveSkipList<ItemType, Less, MaxLevels>::unmarked(Node* link){
+    return reinterpret_cast<Node*>(reinterpret_cast<PointerBits>(link) & ~PointerBits(1));
+}
+
+template <class ItemType, class Less, unsigned MaxLevels>
+inline bool IntrusiveSkipList<ItemType, Less, MaxLevels>::isRemoved(Node* node){
+    return isMarked(Link::Load(&node->next[0]));
+}
+
+template <class ItemType, class Less, unsigned MaxLevels>
+inline bool IntrusiveSkipList<ItemType, Less, MaxLevels>::before(Node* a, Node* b){
+    const ItemType& itemA = *a->CastToSkipListNode();
+    const ItemType& itemB = *b->CastToSkipListNode();
+    if( Less()(itemA, itemB) ){
+        return true;
+    }
+    if( Less()(itemB, itemA) ){
+        return false;
+    }
+    return a < b;
+}
+
+template <class ItemType, class Less, unsigned MaxLevels>
+inline unsigned IntrusiveSkipList<ItemType, Less, MaxLevels>::randomLevels(Node* node){
+    // mix address and insertion count (no shared generator to contend on)
+    unsigned long long bits = static_cast<unsigned long long>(reinterpret_cast<PointerBits>(node));
+    bits += 0x9E3779B97F4A7C15ULL * ++node->insertions;
+    bits = (bits ^ (bits >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    bits = (bits ^ (bits >> 27)) * 0x94D049BB133111EBULL;
+    bits ^= bits >> 31;
+
+    unsigned levels = 1;
+    while( levels < MaxLevels && (bits & 1) ){
+        ++levels;
+        bits >>= 1;
+    }
+    return levels;
+}
+
+template <class ItemType, class Less, unsigned MaxLevels>
+inline void IntrusiveSkipList<ItemType, Less, MaxLevels>::find(Node* node, Node** preds, Node** succs){
+retry:
+    Node* pred = &head;
+    for(unsigned level = MaxLevels; level-- > 0; ){
+        Node* curr = unmarked(Link::Load(&pred->next[level]));
+        while( curr ){
+            Node* succ = Link::Load(&curr->next[level]);
+            while( isMarked(succ) ){
+                // curr is being removed, help unlinking it at this level
+                Node* expected = curr;
+                if( !Link::CompareExchange(&pred->next[level], expected, unmarked(succ)) ){
+                    goto retry; // pred changed (or is being removed itself)
+                }
+                curr = unmarked(succ);
+                if( !curr ){
+                    break;
+                }
+                succ = Link::Load(&curr->next[level]);
+            }
+            if( curr && before(curr, node) ){
+                pred = curr;
+                curr = unmarked(succ);
+            }
+            else{
+                break;
+            }
+        }
+        preds[level] = pred;
+        succs[level] = curr;
+    }
+}
+
+#endif
@@ -0,0 +1,756 @@
+/** @file InstantIntrusiveTree.h
+    @brief Zero overhead intrusive balanced (red-black) binary search tree
+           no dependencies at all (does not depend even on standard headers)
+
+Suitable for embedded platforms like Arduino, no dynamic memory usage at all
+(items are "allocated somewhere else" and only linked into the tree),
+ordered containers like sorted timers, keyed sessions, range queries
+get O(log n) insert, erase and search instead of O(n) ordered insertion
+into IntrusiveList.
+
+Ordering is provided by Less functor able to compare items with items
+(for insertion) and items with keys (for search), so the key can be
+just a field of the item:
+ @code
+    class Session: public IntrusiveTree<Session, struct SessionLess>::Node{
+    public:
+        Session(unsigned sessionId) : id(sessionId) {}
+        unsigned id;
+        ...
+    };
+
+    struct SessionLess{
+        bool operator()(const Session& a, const Session& b) const { return a.id < b.id; }
+        bool operator()(const Session& a, unsigned id) const { return a.id < id; }
+        bool operator()(unsigned id, const Session& b) const { return id < b.id; }
+    };
+
+    IntrusiveTree<Session, SessionLess> sessions;
+    Session s1(10), s2(5), s3(42);
+    sessions.Insert(&s1);
+    sessions.Insert(&s2);
+    sessions.Insert(&s3);
+
+    Session* found = sessions.Find(42u);           // s3
+    Session* from = sessions.LowerBound(6u);       // s1
+    for(auto& session : sessions){                 // 5, 10, 42
+        ...
+    }
+    sessions.Remove(&s1);                         // before s1 is destroyed
+ @endcode
+
+Equal items are allowed (multiset semantics), new item goes after
+existing equal items, so insertion order among equal items is preserved.
+
+NOTE: trees are not threadsafe/interrupt safe
+      different trees can be used from different threads without problems.
+
+MIT License
+
+Copyright (c) 2023 Pavlo M, see https://github.com/olvap80/InstantArduino
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef InstantIntrusiveTree_INCLUDED_H
+#define InstantIntrusiveTree_INCLUDED_H
+
+//______________________________________________________________________________
+// Configurable error handling
+
+/* Common configuration to be included only if available
+   (you can separate file and/or configure individually
+    or just skip that to stick with defaults) */
+#if defined(__has_include) && __has_include("InstantRTOS.Config.h")
+#   include "InstantRTOS.Config.h"
+#endif
+
+#ifndef InstantIntrusiveTree_Panic
+#   ifdef InstantRTOS_Panic
+#       define InstantIntrusiveTree_Panic() InstantRTOS_Panic('I')
+#   else
+#       define InstantIntrusiveTree_Panic() /* you can customize here! */ do{}while(true)
+#   endif
+#endif
+
+
+//______________________________________________________________________________
+// Public API
+
+/// Intrusive red-black tree ordered by Less
+/** Items derive from IntrusiveTree<ItemType, Less>::Node,
+ * the tree never copies items, only links them.
+ * Less shall provide bool operator()(const ItemType&, const ItemType&),
+ * and also (const ItemType&, const Key&), (const Key&, const ItemType&)
+ * for every Key type used with LowerBound/UpperBound/Find.
+ * Less is default constructed for each comparison (stateless functor),
+ * this way it can be just forward declared before the item class.
+ * REMEMBER: changing fields used by Less while item is in the tree
+ *           breaks the tree, remove item first, then change and insert again */
+template <class ItemType, class Less>
+class IntrusiveTree{
+public:
+    //ban copying (this ensures pointers are valid)
+    constexpr IntrusiveTree(const IntrusiveTree&) = delete;
+    IntrusiveTree& operator=(const IntrusiveTree&) = delete;
+
+    /// Empty tree
+    IntrusiveTree() = default;
+
+    /// Destructor asserts tree is empty
+    ~IntrusiveTree();
+
+
+    /// The base class for all IntrusiveTree items
+    /** NOTE: long method names prevent mixing with class methods */
+    class Node{
+    protected:
+        //There is no way to create node then from derived class
+        Node() = default;
+        /// Destructor asserts we shall remove item from tree first
+        ~Node();
+
+        //ban copying (cannot link moveable elements with pointers!)
+        constexpr Node(const Node&) = delete;
+        Node& operator=(const Node&) = delete;
+
+    public:
+        /// Test node is inserted into some IntrusiveTree
+        bool IsInTree() const;
+
+        /// Next Node in order (nullptr for the last one)
+        Node* NextTreeNode();
+        /// Previous Node in order (nullptr for the first one)
+        Node* PrevTreeNode();
+        /// Next Node in order (nullptr for the last one)
+        const Node* NextTreeNode() const;
+        /// Previous Node in order (nullptr for the first one)
+        const Node* PrevTreeNode() const;
+
+        ///Access to entire tree item (derived class)
+        ItemType* CastToTreeNode();
+        ///Access to entire tree item (derived class)
+        const ItemType* CastToTreeNode() const;
+
+    private:
+        friend class IntrusiveTree;
+
+        /// Parent node, nullptr for root, this when not in tree
+        Node* parent = this;
+        Node* left = nullptr;
+        Node* right = nullptr;
+        bool red = false;
+    };
+
+
+    /// Test tree is empty
+    bool IsEmpty() const;
+
+    /// Number of items in the tree
+    unsigned long Count() const;
+
+    /// Insert item into the tree in O(log n) (after equal ones)
+    /** Item shall not be in other tree */
+    void Insert(ItemType* itemToBeInserted);
+
+    /// Remove item being in this tree in O(log n)
+    void Remove(ItemType* itemToBeRemoved);
+
+    /// Remove the first (smallest) item, @returns nullptr if empty
+    ItemType* RemoveFirst();
+
+    /// The first (smallest) item, nullptr if empty
+    ItemType* First();
+    /// The last (largest) item, nullptr if empty
+    ItemType* Last();
+
+    /// The first item that is not less than key (nullptr if none)
+    template<class Key>
+    ItemType* LowerBound(const Key& key);
+
+    /// The first item that is greater than key (nullptr if none)
+    template<class Key>
+    ItemType* UpperBound(const Key& key);
+
+    /// The first item equal to key (nullptr if none)
+    template<class Key>
+    ItemType* Find(const Key& key);
+
+
+    ///Bidirectional iterator (range based for support)
+    /** end() is represented by nullptr, so one cannot decrement end()
+     * REMEMBER: removing item currently pointed by iterator invalidates that iterator */
+    template<class NodeType, class TreeNodeType>
+    class IteratorSupportedOperations{
+    public:
+        /// Make iterator pointing Node (nullptr is the end)
+        IteratorSupportedOperations(NodeType* nodeToWrap) : currentNode(nodeToWrap) {}
+
+        /// Move to next position
+        IteratorSupportedOperations& operator++(){
+            currentNode = currentNode->NextTreeNode();
+            return *this;
+        }
+        /// Move to previous position
+        IteratorSupportedOperations& operator--(){
+            currentNode = currentNode->PrevTreeNode();
+            return *this;
+        }
+        /// Move to next position (postfix)
+        IteratorSupportedOperations operator++(int){
+            IteratorSupportedOperations res = *this;
+            currentNode = currentNode->NextTreeNode();
+            return res;
+        }
+        /// Move to previous position (postfix)
+        IteratorSupportedOperations operator--(int){
+            IteratorSupportedOperations res = *this;
+            currentNode = currentNode->PrevTreeNode();
+            return res;
+        }
+
+        /// Access Node members
+        TreeNodeType* operator->() const{
+            return currentNode->CastToTreeNode();
+        }
+        /// Access Node
+        TreeNodeType& operator*() const{
+            return *currentNode->CastToTreeNode();
+        }
+
+        /// Check two iterators reference to the same item
+        template<class OtherNodeType, class OtherTreeNodeType>
+        bool operator==(const IteratorSupportedOperations<OtherNodeType, OtherTreeNodeType>& other) const{
+            return currentNode == other.currentNode;
+        }
+        /// Check two iterators are referencing different items
+        template<class OtherNodeType, class OtherTreeNodeType>
+        bool operator!=(const IteratorSupportedOperations<OtherNodeType, OtherTreeNodeType>& other) const{
+            return currentNode != other.currentNode;
+        }
+
+    private:
+        template<class OtherNodeType, class OtherTreeNodeType>
+        friend class IteratorSupportedOperations;
+
+        /// The Node pointed by iterator
+        NodeType* currentNode;
+    };
+
+    /// Iterator partially compatible standard
+    using iterator = IteratorSupportedOperations<Node, ItemType>;
+    /// Iterator partially compatible standard
+    using const_iterator = IteratorSupportedOperations<const Node, const ItemType>;
+
+    ///Iterator to the beginning of the sequence (the smallest item)
+    iterator begin();
+    ///Iterator to the end of the sequence
+    iterator end();
+    ///Iterator to the beginning of the const sequence
+    const_iterator begin() const;
+    ///Iterator to the end of the const sequence
+    const_iterator end() const;
+    ///Const iterator to the beginning of the sequence
+    const_iterator cbegin() const;
+    ///Const iterator to the end of the sequence
+    const_iterator cend() const;
+
+private:
+    Node* root = nullptr;
+    unsigned long count = 0;
+
+    static bool less(const ItemType& a, const ItemType& b){ return Less()(a, b); }
+    template<class Key>
+    static bool less(const ItemType& a, const Key& b){ return Less()(a, b); }
+    template<class Key>
+    static bool less(const Key& a, const ItemType& b){ return Less()(a, b); }
+
+    static Node* minimum(Node* node);
+    static Node* maximum(Node* node);
+    static bool isRed(const Node* node);
+
+    void replaceChild(Node* parent, Node* oldChild, Node* newChild);
+    void rotateLeft(Node* node);
+    void rotateRight(Node* node);
+    void insertFixup(Node* node);
+    void removeFixup(Node* node, Node* parent);
+};
+
+
+
+//______________________________________________________________________________
+//##############################################################################
+/*==============================================================================
+*  Implementation details follow                                               *
+*=============================================================================*/
+//##############################################################################
+
+
+//______________________________________________________________________________
+// Implementing IntrusiveTree::Node
+
+template <class ItemType, class Less>
+inline IntrusiveTree<ItemType, Less>::Node::~Node(){
+    if( IsInTree() ){
+        /* Destroying before removed from the tree
+           is likely an error (the same as for ChainElement) */
+        InstantIntrusiveTree_Panic();
+    }
+}
+
+template <class ItemType, class Less>
+inline bool IntrusiveTree<ItemType, Less>::Node::IsInTree() const{
+    return parent != this;
+}
+
+template <class ItemType, class Less>
+inline typename IntrusiveTree<ItemType, Less>::Node*
+IntrusiveTree<ItemType, Less>::Node::NextTreeNode(){
+    return const_cast<Node*>(static_cast<const Node*>(this)->NextTreeNode());
+}
+
+template <class ItemType, class Less>
+inline typename IntrusiveTree<ItemType, Less>::Node*
+IntrusiveTree<ItemType, Less>::Node::PrevTreeNode(){
+    return const_cast<Node*>(static_cast<const Node*>(this)->PrevTreeNode());
+}
+
+template <class ItemType, class Less>
+inline const typename IntrusiveTree<ItemType, Less>::Node*
+IntrusiveTree<ItemType, Less>::Node::NextTreeNode() const{
+    const Node* node = this;
+    if( node->right ){
+        node = node->right;
+        while( node->left ){
+            node = node->left;
+        }
+        return node;
+    }
+    // climb while we are the right child
+    const Node* up = node->parent;
+    while( up && node == up->right ){
+        node = up;
+        up = up->parent;
+    }
+    return up;
+}
+
+template <class ItemType, class Less>
+inline const typename IntrusiveTree<ItemType, Less>::Node*
+IntrusiveTree<ItemType, Less>::Node::PrevTreeNode() const{
+    const Node* node = this;
+    if( node->left ){
+        node = node->left;
+        while( node->right ){
+            node = node->right;
+        }
+        return node;
+    }
+    // climb while we are the left child
+    const Node* up = node->parent;
+    while( up && node == up->left ){
+        node = up;
+        up = up->parent;
+    }
+    return up;
+}
+
+template <class ItemType, class Less>
+inline ItemType* IntrusiveTree<ItemType, Less>::Node::CastToTreeNode(){
+    return static_cast<ItemType*>(this);
+}
+template <class ItemType, class Less>
+inline const ItemType* IntrusiveTree<ItemType, Less>::Node::CastToTreeNode() const{
+    return static_cast<const ItemType*>(this);
+}
+
+
+//______________________________________________________________________________
+// Implementing IntrusiveTree
+
+template <class ItemType, class Less>
+inline IntrusiveTree<ItemType, Less>::~IntrusiveTree(){
+    if( root ){
+        // nodes would keep pointers into the destroyed tree
+        InstantIntrusiveTree_Panic();
+    }
+}
+
+template <class ItemType, class Less>
+inline bool IntrusiveTree<ItemType, Less>::IsEmpty() const{
+    return nullptr == root;
+}
+
+template <class ItemType, class Less>
+inline unsigned long IntrusiveTree<ItemType, Less>::Count() const{
+    return count;
+}
+
+template <class ItemType, class Less>
+inline void IntrusiveTree<ItemType, Less>::Insert(ItemType* itemToBeInserted){
+    Node* node = itemToBeInserted;
+    if( node->IsInTree() ){
+        InstantIntrusiveTree_Panic();
+    }
+
+    // find the place (equal items go to the right to keep insertion order)
+    Node* parent = nullptr;
+    Node** link = &root;
+    while( *link ){
+        parent = *link;
+        link = less(*itemToBeInserted, *parent->CastToTreeNode()) ?
+                    &parent->left : &parent->right;
+    }
+
+    node->parent = parent;
+    node->left = nullptr;
+    node->right = nullptr;
+    node->red = true;
+    *link = node;
+    ++count;
+
+    insertFixup(node);
+}
+
+template <class ItemType, class Less>
+inline void IntrusiveTree<ItemType, Less>::Remove(ItemType* itemToBeRemoved){
+    Node* node = itemToBeRemoved;
+    if( !node->IsInTree() ){
+        InstantIntrusiveTree_Panic();
+    }
+
+    Node* child;        // node moving into the place of removed one
+    Node* childParent;  // its parent (child can be nullptr)
+    bool removedRed;    // color of the node physically removed
+
+    if( !node->left || !node->right ){
+        child = node->left ? node->left : node->right;
+        childParent = node->parent;
+        removedRed = node->red;
+        replaceChild(node->parent, node, child);
+        if( child ){
+            child->parent = node->parent;
+        }
+    }
+    else{
+        // replace with successor (it has no left child)
+        Node* successor = minimum(node->right);
+        removedRed = successor->red;
+        child = successor->right;
+
+        if( successor->parent == node ){
+            childParent = successor;
+        }
+        else{
+            childParent = successor->parent;
+            replaceChild(successor->parent, successor, child);
+            if( child ){
+                child->parent = successor->parent;
+            }
+            successor->right = node->right;
+            successor->right->parent = successor;
+        }
+
+        replaceChild(node->parent, node, successor);
+        successor->parent = node->parent;
+        successor->left = node->left;
+        successor->left->parent = successor;
+        successor->red = node->red;
+    }
+
+    if( !removedRed ){
+        removeFixup(child, childParent);
+    }
+
+    // mark as not in tree
+    node->parent = node;
+    node->left = nullptr;
+    node->right = nullptr;
+    --count;
+}
+
+template <class ItemType, class Less>
+inline ItemType* IntrusiveTree<ItemType, Less>::RemoveFirst(){
+    ItemType* res = First();
+    if( res ){
+        Remove(res);
+    }
+    return res;
+}
+
+template <class ItemType, class Less>
+inline ItemType* IntrusiveTree<ItemType, Less>::First(){
+    return root ? minimum(root)->CastToTreeNode() : nullptr;
+}
+
+template <class ItemType, class Less>
+inline ItemType* IntrusiveTree<ItemType, Less>::Last(){
+    return root ? maximum(root)->CastToTreeNode() : nullptr;
+}
+
+template <class ItemType, class Less>
+template<class Key>
+inline ItemType* IntrusiveTree<ItemType, Less>::LowerBound(const Key& key){
+    Node* res = nullptr;
+    Node* node = root;
+    while( node ){
+        if( less(*node->CastToTreeNode(), key) ){
+            node = node->right;
+        }
+        else{
+            res = node;
+            node = node->left;
+        }
+    }
+    return res ? res->CastToTreeNode() : nullptr;
+}
+
+template <class ItemType, class Less>
+template<class Key>
+inline ItemType* IntrusiveTree<ItemType, Less>::UpperBound(const Key& key){
+    Node* res = nullptr;
+    Node* node = root;
+    while( node ){
+        if( less(key, *node->CastToTreeNode()) ){
+            res = node;
+            node = node->left;
+        }
+        else{
+            node = node->right;
+        }
+    }
+    return res ? res->CastToTreeNode() : nullptr;
+}
+
+template <class ItemType, class Less>
+template<class Key>
+inline ItemType* IntrusiveTree<ItemType, Less>::Find(const Key& key){
+    ItemType* res = LowerBound(key);
+    if( res && !less(key, *res) ){
+        return res;
+    }
+    return nullptr;
+}
+
+template <class ItemType, class Less>
+inline typename IntrusiveTree<ItemType, Less>::iterator IntrusiveTree<ItemType, Less>::begin(){
+    return root ? minimum(root) : nullptr;
+}
+template <class ItemType, class Less>
+inline typename IntrusiveTree<ItemType, Less>::iterator IntrusiveTree<ItemType, Less>::end(){
+    return static_cast<Node*>(nullptr);
+}
+
+template <class ItemType, class Less>
+inline typename IntrusiveTree<ItemType, Less>::const_iterator IntrusiveTree<ItemType, Less>::begin() const {
+    return root ? minimum(root) : nullptr;
+}
+template <class ItemType, class Less>
+inline typename IntrusiveTree<ItemType, Less>::const_iterator IntrusiveTree<ItemType, Less>::end() const {
+    return static_cast<const Node*>(nullptr);
+}
+
+template <class ItemType, class Less>
+inline typename IntrusiveTree<ItemType, Less>::const_iterator IntrusiveTree<ItemType, Less>::cbegin() const {
+    return begin();
+}
+template <class ItemType, class Less>
+inline typename IntrusiveTree<ItemType, Less>::const_iterator IntrusiveTree<ItemType, Less>::cend() const {
+    return end();
+}
+
+
+template <class ItemType, class Less>
+inline typename IntrusiveTree<ItemType, Less>::Node*
+IntrusiveTree<ItemType, Less>::minimum(Node* node){
+    while( node->left ){
+        node = node->left;
+    }
+    return node;
+}
+
+template <class ItemType, class Less>
+inline typename IntrusiveTree<ItemType, Less>::Node*
+IntrusiveTree<ItemType, Less>::maximum(Node* node){
+    while( node->right ){
+        node = node->right;
+    }
+    return node;
+}
+
+template <class ItemType, class Less>
+inline bool IntrusiveTree<ItemType, Less>::isRed(const Node* node){
+    // missing leaves are black
+    return node && node->red;
+}
+
+template <class ItemType, class Less>
+inline void IntrusiveTree<ItemType, Less>::replaceChild(
+    Node* parent, Node* oldChild, Node* newChild
+){
+    if( !parent ){
+        root = newChild;
+    }
+    else if( parent->left == oldChild ){
+        parent->left = newChild;
+    }
+    else{
+        parent->right = newChild;
+    }
+}
+
+template <class ItemType, class Less>
+inline void IntrusiveTree<ItemType, Less>::rotateLeft(Node* node){
+    Node* pivot = node->right;
+    node->right = pivot->left;
+    if( pivot->left ){
+        pivot->left->parent = node;
+    }
+    pivot->parent = node->parent;
+    replaceChild(node->parent, node, pivot);
+    pivot->left = node;
+    node->parent = pivot;
+}
+
+template <class ItemType, class Less>
+inline void IntrusiveTree<ItemType, Less>::rotateRight(Node* node){
+    Node* pivot = node->left;
+    node->left = pivot->right;
+    if( pivot->right ){
+        pivot->right->parent = node;
+    }
+    pivot->parent = node->parent;
+    replaceChild(node->parent, node, pivot);
+    pivot->right = node;
+    node->parent = pivot;
+}
+
+template <class ItemType, class Less>
+inline void IntrusiveTree<ItemType, Less>::insertFixup(Node* node){
+    Node* parent;
+    while( (parent = node->parent) != nullptr && parent->red ){
+        // red parent is never root, so grandparent exists
+        Node* grandparent = parent->parent;
+        if( parent == grandparent->left ){
+            Node* uncle = grandparent->right;
+            if( isRed(uncle) ){
+                parent->red = false;
+                uncle->red = false;
+                grandparent->red = true;
+                node = grandparent;
+            }
+            else{
+                if( node == parent->right ){
+                    rotateLeft(parent);
+                    node = parent;
+                    parent = node->parent;
+                }
+                parent->red = false;
+                grandparent->red = true;
+                rotateRight(grandparent);
+            }
+        }
+        else{
+            Node* uncle = grandparent->left;
+            if( isRed(uncle) ){
+                parent->red = false;
+                uncle->red = false;
+                grandparent->red = true;
+                node = grandparent;
+            }
+            else{
+                if( node == parent->left ){
+                    rotateRight(parent);
+                    node = parent;
+                    parent = node->parent;
+                }
+                parent->red = false;
+                grandparent->red = true;
+                rotateLeft(grandparent);
+            }
+        }
+    }
+    root->red = false;
+}
+
+template <class ItemType, class Less>
+inline void IntrusiveTree<ItemType, Less>::removeFixup(Node* node, Node* parent){
+    // node carries "extra black", it can be nullptr (leaf)
+    while( node != root && !isRed(node) ){
+        if( node == parent->left ){
+            Node* sibling = parent->right;
+            if( sibling->red ){
+                sibling->red = false;
+                parent->red = true;
+                rotateLeft(parent);
+                sibling = parent->right;
+            }
+            if( !isRed(sibling->left) && !isRed(sibling->right) ){
+                sibling->red = true;
+                node = parent;
+                parent = node->parent;
+            }
+            else{
+                if( !isRed(sibling->right) ){
+                    sibling->left->red = false;
+                    sibling->red = true;
+                    rotateRight(sibling);
+                    sibling = parent->right;
+                }
+                sibling->red = parent->red;
+                parent->red = false;
+                sibling->right->red = false;
+                rotateLeft(parent);
+                node = root;
+            }
+        }
+        else{
+            Node* sibling = parent->left;
+            if( sibling->red ){
+                sibling->red = false;
+                parent->red = true;
+                rotateRight(parent);
+                sibling = parent->left;
+            }
+            if( !isRed(sibling->left) && !isRed(sibling->right) ){
+                sibling->red = true;
+                node = parent;
+                parent = node->parent;
+            }
+            else{
+                if( !isRed(sibling->left) ){
+                    sibling->right->red = false;
+                    sibling->red = true;
+                    rotateLeft(sibling);
+                    sibling = parent->left;
+                }
+                sibling->red = parent->red;
+                parent->red = false;
+                sibling->left->red = false;
+                rotateRight(parent);
+                node = root;
+            }
+        }
+    }
+    if( node ){
+        node->red = false;
+    }
+}
+
+#endif
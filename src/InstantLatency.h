@@ -0,0 +1,440 @@
+/** @file InstantLatency.h
+ @brief Measure latency from the hardware event to the user callback
+        No dependencies from outside of InstantRTOS, just copy the headers!
+
+(c) see https://github.com/olvap80/InstantRTOS
+
+Proves the path from the event source (interrupt, MulticastToActions
+trigger, etc) to the place where the event is finally handled (ActionNode
+executed by the Scheduler, Task resumed after await, etc) fits the budget.
+LatencyProbe captures timestamp at the source with Mark, then each stage
+of propagation records latency since that Mark into own LatencyHistogram
+(power of two buckets, so no division or floating point is needed).
+Use one probe per event source, ticks are any units provided by the user
+(micros(), cycle counter, etc), the same as for InstantScheduler.h
+
+ @code
+    // Event source: button interrupt handled by the Scheduler and Task
+    LatencyProbe<2> buttonLatency; // 2 stages: ActionNode, Task
+
+    void buttonISR(){
+        buttonLatency.Mark(micros());
+        ...
+    }
+    ...
+    // inside ActionNode callback
+        buttonLatency.Stage(0, micros());
+    ...
+    // inside Task after TaskAwaitForCompletion(...)
+        buttonLatency.Complete(micros()); // the last stage, rearm for next Mark
+    ...
+    // report (for example from time to time in loop)
+    auto& histogram = buttonLatency.StageHistogram(1);
+    for(unsigned b = 0; b < histogram.BucketsCount; ++b){
+        print(histogram.BucketUpperBound(b), histogram.Count(b));
+    }
+    print(histogram.Percentile(99));
+ @endcode
+
+NOTE: Mark is intended to be called from one place (interrupt or thread),
+      and Stage/Complete from the other single place (the main loop),
+      Mark is ignored (counted as overrun) until previous event completes,
+      so timestamp of the oldest event is kept.
+
+
+MIT License
+
+Copyright (c) 2023 Pavlo M, see https://github.com/olvap80/InstantRTOS
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef InstantLatency_INCLUDED_H
+#define InstantLatency_INCLUDED_H
+
+//______________________________________________________________________________
+// Configurable options (InstantLatency specific)
+
+/* Common configuration to be included only if available
+   (you can separate file and/or configure individually
+    or just skip that to stick with defaults) */
+#if defined(__has_include) && __has_include("InstantRTOS.Config.h")
+#   include "InstantRTOS.Config.h"
+#endif
+
+#ifndef InstantLatency_Ticks_Type
+    ///Type to be used for storing time measurements and time calculations
+    /** It is assumed that time grows continuously with unsigned overflow,
+     * (the same as InstantScheduler_Ticks_Type) */
+#   define InstantLatency_Ticks_Type unsigned long
+#endif
+
+#ifndef InstantLatency_Panic
+#   ifdef InstantRTOS_Panic
+#       define InstantLatency_Panic() InstantRTOS_Panic('L')
+#   else
+#       define InstantLatency_Panic() /* you can customize here! */ do{}while(true)
+#   endif
+#endif
+
+
+//______________________________________________________________________________
+// Public API
+
+/// Distribution of latencies with power of two buckets
+/** Bucket 0 holds zero latency, bucket N holds latencies
+ * from 2^(N-1) to 2^N - 1, the last bucket also holds everything above.
+ * Adding is a few bit operations (no division, no floating point),
+ * so it is fine to Add from time critical code */
+template<unsigned NumBuckets = 24>
+class LatencyHistogram{
+public:
+    /// Units used for time measurements
+    using Ticks = InstantLatency_Ticks_Type;
+    /// Counter type for samples
+    using Counter = unsigned long;
+
+    /// Number of buckets in histogram
+    static constexpr unsigned BucketsCount = NumBuckets;
+
+    /// Account single latency measurement
+    void Add(Ticks latency);
+
+    /// Number of samples added to the bucket
+    Counter Count(unsigned bucket) const;
+
+    /// The largest latency that goes into the bucket
+    static Ticks BucketUpperBound(unsigned bucket);
+
+    /// Bucket index for specific latency
+    static unsigned BucketFor(Ticks latency);
+
+    /// Total number of samples added
+    Counter Samples() const;
+    /// Minimal latency added so far (0 if no samples)
+    Ticks Min() const;
+    /// Maximal latency added so far (0 if no samples)
+    Ticks Max() const;
+    /// Average latency (0 if no samples)
+    Ticks Average() const;
+
+    /// Upper bound of the bucket where percent of samples is reached
+    /** For example Percentile(99) means 99% of latencies do not exceed
+     *  returned value (with precision of the bucket) */
+    Ticks Percentile(unsigned percent) const;
+
+    /// Forget all the samples
+    void Reset();
+
+private:
+    Counter buckets[NumBuckets] = {};
+    Counter samples = 0;
+    Ticks minLatency = 0;
+    Ticks maxLatency = 0;
+    /// Sum to calculate average (wide to not overflow)
+    unsigned long long total = 0;
+};
+
+
+/// Track single event source through NumStages stages of propagation
+/** Mark at the source, then Stage for intermediate places
+ * and Complete for the last stage (Complete also rearms for the next Mark) */
+template<unsigned NumStages = 1, unsigned NumBuckets = 24>
+class LatencyProbe{
+public:
+    /// Units used for time measurements
+    using Ticks = InstantLatency_Ticks_Type;
+    /// Histogram type used for each stage
+    using Histogram = LatencyHistogram<NumBuckets>;
+
+    /// Number of stages being tracked
+    static constexpr unsigned StagesCount = NumStages;
+
+    /// Create probe for event source (name is not copied, used for reports)
+    constexpr explicit LatencyProbe(const char* sourceName = "")
+        : name(sourceName) {}
+
+    /// Capture timestamp of the event at the source (interrupt safe)
+    /** If previous event is not completed yet then timestamp
+     *  is not changed (the oldest event is tracked) and overrun is counted */
+    void Mark(Ticks now);
+
+    /// Record latency since Mark for the intermediate stage
+    /** @returns false if there was no Mark (nothing recorded) */
+    bool Stage(unsigned stage, Ticks now);
+
+    /// Record latency since Mark for the last stage and allow the next Mark
+    /** @returns false if there was no Mark (nothing recorded) */
+    bool Complete(Ticks now);
+
+    /// Forget Mark without recording anything (event was dropped)
+    void Abandon();
+
+    /// Test there is Mark waiting for completion
+    bool IsMarked() const;
+
+    /// Histogram of latencies from Mark till the stage
+    const Histogram& StageHistogram(unsigned stage) const;
+
+    /// Number of Mark calls ignored since previous event was not completed
+    unsigned long Overruns() const;
+
+    /// Name of the event source
+    const char* Name() const;
+
+    /// Forget all statistics
+    void Reset();
+
+private:
+    /// Name for reports
+    const char* name;
+
+    /// Timestamp of the event being tracked (valid when marked)
+    volatile Ticks markTicks = 0;
+    /// Mark is present (only Mark sets and only Complete clears it)
+    volatile bool marked = false;
+    /// Marks that happened while previous event was in progress
+    volatile unsigned long overruns = 0;
+
+    /// Statistics for each stage
+    Histogram histograms[NumStages];
+
+    /// Ordering for marked flag (matters on multicore hosts)
+    static bool loadMarked(const volatile bool* flag);
+    static void storeMarked(volatile bool* flag, bool value);
+};
+
+
+
+//______________________________________________________________________________
+//##############################################################################
+/*==============================================================================
+*  Implementation details follow                                               *
+*=============================================================================*/
+//##############################################################################
+
+
+//______________________________________________________________________________
+// Implementing LatencyHistogram
+
+template<unsigned NumBuckets>
+void LatencyHistogram<NumBuckets>::Add(Ticks latency){
+    ++buckets[BucketFor(latency)];
+    if( 0 == samples || latency < minLatency ){
+        minLatency = latency;
+    }
+    if( latency > maxLatency ){
+        maxLatency = latency;
+    }
+    ++samples;
+    total += latency;
+}
+
+template<unsigned NumBuckets>
+typename LatencyHistogram<NumBuckets>::Counter
+LatencyHistogram<NumBuckets>::Count(unsigned bucket) const{
+    if( bucket >= NumBuckets ){
+        InstantLatency_Panic();
+    }
+    return buckets[bucket];
+}
+
+template<unsigned NumBuckets>
+typename LatencyHistogram<NumBuckets>::Ticks
+LatencyHistogram<NumBuckets>::BucketUpperBound(unsigned bucket){
+    if( bucket + 1 >= NumBuckets || bucket >= sizeof(Ticks) * 8 ){
+        return ~Ticks(0); // the last bucket takes everything
+    }
+    return (Ticks(1) << bucket) - 1;
+}
+
+template<unsigned NumBuckets>
+unsigned LatencyHistogram<NumBuckets>::BucketFor(Ticks latency){
+    // number of significant bits is the bucket index
+    unsigned bucket = 0;
+#if defined(__GNUC__) || defined(__clang__)
+    if( latency ){
+        bucket = sizeof(Ticks) * 8 - (
+            sizeof(Ticks) <= sizeof(unsigned) ?
+                __builtin_clz(static_cast<unsigned>(latency))
+                    - (sizeof(unsigned) - sizeof(Ticks)) * 8
+            : sizeof(Ticks) <= sizeof(unsigned long) ?
+                __builtin_clzl(static_cast<unsigned long>(latency))
+                    - (sizeof(unsigned long) - sizeof(Ticks)) * 8
+            :   __builtin_clzll(static_cast<unsigned long long>(latency))
+                    - (sizeof(unsigned long long) - sizeof(Ticks)) * 8
+        );
+    }
+#else
+    while( latency ){
+        latency >>= 1;
+        ++bucket;
+    }
+#endif
+    return bucket < NumBuckets ? bucket : NumBuckets - 1;
+}
+
+template<unsigned NumBuckets>
+typename LatencyHistogram<NumBuckets>::Counter
+LatencyHistogram<NumBuckets>::Samples() const{
+    return samples;
+}
+
+template<unsigned NumBuckets>
+typename LatencyHistogram<NumBuckets>::Ticks
+LatencyHistogram<NumBuckets>::Min() const{
+    return minLatency;
+}
+
+template<unsigned NumBuckets>
+typename LatencyHistogram<NumBuckets>::Ticks
+LatencyHistogram<NumBuckets>::Max() const{
+    return maxLatency;
+}
+
+template<unsigned NumBuckets>
+typename LatencyHistogram<NumBuckets>::Ticks
+LatencyHistogram<NumBuckets>::Average() const{
+    return samples ? static_cast<Ticks>(total / samples) : 0;
+}
+
+template<unsigned NumBuckets>
+typename LatencyHistogram<NumBuckets>::Ticks
+LatencyHistogram<NumBuckets>::Percentile(unsigned percent) const{
+    if( !samples ){
+        return 0;
+    }
+    // samples needed to reach percent (rounded up)
+    const unsigned long long needed =
+        (static_cast<unsigned long long>(samples) * percent + 99) / 100;
+    unsigned long long accumulated = 0;
+    for(unsigned b = 0; b < NumBuckets; ++b){
+        accumulated += buckets[b];
+        if( accumulated >= needed ){
+            // bucket bound can be larger than anything really seen
+            const Ticks bound = BucketUpperBound(b);
+            return bound < maxLatency ? bound : maxLatency;
+        }
+    }
+    return maxLatency;
+}
+
+template<unsigned NumBuckets>
+void LatencyHistogram<NumBuckets>::Reset(){
+    for(auto& bucket: buckets){
+        bucket = 0;
+    }
+    samples = 0;
+    minLatency = 0;
+    maxLatency = 0;
+    total = 0;
+}
+
+
+//______________________________________________________________________________
+// Implementing LatencyProbe
+
+template<unsigned NumStages, unsigned NumBuckets>
+void LatencyProbe<NumStages, NumBuckets>::Mark(Ticks now){
+    if( loadMarked(&marked) ){
+        // previous event is still in progress, keep the oldest timestamp
+        overruns = overruns + 1;
+        return;
+    }
+    markTicks = now;
+    storeMarked(&marked, true); // publish timestamp
+}
+
+template<unsigned NumStages, unsigned NumBuckets>
+bool LatencyProbe<NumStages, NumBuckets>::Stage(unsigned stage, Ticks now){
+    if( stage >= NumStages ){
+        InstantLatency_Panic();
+    }
+    if( !loadMarked(&marked) ){
+        return false;
+    }
+    histograms[stage].Add(static_cast<Ticks>(now - markTicks));
+    return true;
+}
+
+template<unsigned NumStages, unsigned NumBuckets>
+bool LatencyProbe<NumStages, NumBuckets>::Complete(Ticks now){
+    if( !Stage(NumStages - 1, now) ){
+        return false;
+    }
+    storeMarked(&marked, false); // allow the next Mark
+    return true;
+}
+
+template<unsigned NumStages, unsigned NumBuckets>
+void LatencyProbe<NumStages, NumBuckets>::Abandon(){
+    storeMarked(&marked, false);
+}
+
+template<unsigned NumStages, unsigned NumBuckets>
+bool LatencyProbe<NumStages, NumBuckets>::IsMarked() const{
+    return loadMarked(&marked);
+}
+
+template<unsigned NumStages, unsigned NumBuckets>
+const typename LatencyProbe<NumStages, NumBuckets>::Histogram&
+LatencyProbe<NumStages, NumBuckets>::StageHistogram(unsigned stage) const{
+    if( stage >= NumStages ){
+        InstantLatency_Panic();
+    }
+    return histograms[stage];
+}
+
+template<unsigned NumStages, unsigned NumBuckets>
+unsigned long LatencyProbe<NumStages, NumBuckets>::Overruns() const{
+    return overruns;
+}
+
+template<unsigned NumStages, unsigned NumBuckets>
+const char* LatencyProbe<NumStages, NumBuckets>::Name() const{
+    return name;
+}
+
+template<unsigned NumStages, unsigned NumBuckets>
+void LatencyProbe<NumStages, NumBuckets>::Reset(){
+    for(auto& histogram: histograms){
+        histogram.Reset();
+    }
+    overruns = 0;
+}
+
+template<unsigned NumStages, unsigned NumBuckets>
+bool LatencyProbe<NumStages, NumBuckets>::loadMarked(const volatile bool* flag){
+#if defined(__GNUC__) || defined(__clang__)
+    return __atomic_load_n(flag, __ATOMIC_ACQUIRE);
+#else
+    return *flag;
+#endif
+}
+
+template<unsigned NumStages, unsigned NumBuckets>
+void LatencyProbe<NumStages, NumBuckets>::storeMarked(volatile bool* flag, bool value){
+#if defined(__GNUC__) || defined(__clang__)
+    __atomic_store_n(flag, value, __ATOMIC_RELEASE);
+#else
+    *flag = value;
+#endif
+}
+
+#endif
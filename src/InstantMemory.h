@@ -288,6 +288,11 @@ SOFTWARE.
 #   endif
 #endif
 
+//Per instance protection of pools (see BlockPool CriticalSection parameter)
+#include "InstantCriticalSection.h"
+//Trace points
+#include "InstantTrace.h"
+
 
 //______________________________________________________________________________
 // Classes for memory operations - CommonBlockPool and variations
@@ -297,7 +302,9 @@ SOFTWARE.
 /** All various BlockPools reuse the same implementation
  *  to save program space being spent on allocation/deallocation logic.
  *  Use BlockPool, SharedAllocator, or SmartAllocator (TBD) below
- *  (NOTE: single implementation to not duplicate code for each type) */
+ *  (NOTE: single implementation to not duplicate code for each type)
+ *  Allocation and free are protected by critical section being passed
+ *  by the derived class (no protection by default) */
 class CommonBlockPool{
 public:
     //all the copying is banned
@@ -367,7 +374,8 @@ protected:
                               ///< entireBlockSizeUsed*totalBlocksAvailable bytes
         SizeType customBlockSizeUsed, ///Custom part in the block (without metadata)
         SizeType entireBlockSizeUsed, ///<Entire block size (as calculated by EntireBlockSize)
-        SizeType totalBlocksAvailable ///<Total number of full blocks reserved
+        SizeType totalBlocksAvailable, ///<Total number of full blocks reserved
+        CriticalSectionReference criticalSectionToUse = CriticalSectionReference()
     );
 
     /// Helper to use in assertions for type sizes and alignments
@@ -404,6 +412,9 @@ private:
     /// Pointer to the "custom memory" of the first free block
     ByteType* firstFree;
 
+    /// Protection for firstFree and blocksAllocated
+    CriticalSectionReference criticalSection;
+
     /// One must include metadata without spoiling alignment
     static constexpr SizeType entireAlignedBlockSize(
         SizeType customBlockSizeRequested,
@@ -413,18 +424,31 @@ private:
 
 
 ///Simple pool to allocate fixed size blocks
-/** Allow allocation of raw pointer to fixed size memory blocks */
+/** Allow allocation of raw pointer to fixed size memory blocks,
+ * CriticalSection policy (see InstantCriticalSection.h) protects
+ * allocation/free when the pool is shared between threads/interrupts */
 template<
     CommonBlockPool::SizeType SingleBlockSizeRequested,
     CommonBlockPool::SizeType TotalNumBlocks,
-    class AlignAsType = CommonBlockPool::Metadata
+    class AlignAsType = CommonBlockPool::Metadata,
+    class CriticalSection = CriticalSectionNone
 >
-class BlockPool: public CommonBlockPool{
+class BlockPool:
+    private CriticalSection, // goes first to exist before CommonBlockPool
+    public CommonBlockPool
+{
     static_assert(
         SingleBlockSizeRequested % alignof(AlignAsType) == 0,
         "CommonBlockPool: ensure your blocks are of proper size allowing proper alignment"
     );
 public:
+    /// Bytes available in each block for the user (as requested)
+    static constexpr CommonBlockPool::SizeType SingleBlockSize = SingleBlockSizeRequested;
+    /// Alignment guaranteed for each block
+    static constexpr CommonBlockPool::SizeType BlockAlignment = alignof(AlignAsType);
+    /// Policy protecting allocation/free of this pool
+    using CriticalSectionType = CriticalSection;
+
     /// Create ready to use BlockPool
     constexpr BlockPool();
 
@@ -640,6 +664,7 @@ inline constexpr CommonBlockPool::SizeType CommonBlockPool::BlocksAllocated() co
 
 
 inline void* CommonBlockPool::AllocateRaw(){
+    criticalSection.Enter();
     ByteType* res = firstFree;
     if( res ){
         auto metadata = reinterpret_cast<Metadata*>(res - sizeof(Metadata));
@@ -648,10 +673,14 @@ inline void* CommonBlockPool::AllocateRaw(){
         metadata->owner = this; // future free will use this information
         
         ++blocksAllocated;
-        return res;
+        InstantTrace_Count(PoolAllocate);
     }
-    //allow caller to scream for error in the place of call
-    return nullptr;
+    else{
+        InstantTrace_Count(PoolExhausted);
+    }
+    criticalSection.Leave();
+    //nullptr allows caller to scream for error in the place of call
+    return res;
 }
 
 inline void CommonBlockPool::FreeRaw(void* memoryPreviouslyAllocatedByBlockPool){
@@ -662,9 +691,12 @@ inline void CommonBlockPool::FreeRaw(void* memoryPreviouslyAllocatedByBlockPool)
         CommonBlockPool* owner = metadata->owner;
         if( owner->mark == MarkToTest ){
             // valid block, almost for sure))
+            owner->criticalSection.Enter();
             metadata->next = owner->firstFree;
             owner->firstFree = ptr;
             --owner->blocksAllocated;
+            InstantTrace_Count(PoolFree);
+            owner->criticalSection.Leave();
         }
         else{
             // someone wants to free invalid block
@@ -689,11 +721,13 @@ inline CommonBlockPool::CommonBlockPool(
     ByteType* memoryArea,
     SizeType customBlockSizeUsed,
     SizeType entireBlockSizeUsed,
-    SizeType totalBlocksAvailable
+    SizeType totalBlocksAvailable,
+    CriticalSectionReference criticalSectionToUse
 ) :
     customBlockSize(customBlockSizeUsed),
     entireBlockSize(entireBlockSizeUsed),
-    totalBlocks(totalBlocksAvailable)
+    totalBlocks(totalBlocksAvailable),
+    criticalSection(criticalSectionToUse)
 {
     // The first block to be allocated, pointer to custom memory
     firstFree = memoryArea + (entireBlockSizeUsed - customBlockSizeUsed);
@@ -733,31 +767,38 @@ inline constexpr CommonBlockPool::SizeType CommonBlockPool::EntireBlockSize(
 template<
     CommonBlockPool::SizeType SingleBlockSizeRequested,
     CommonBlockPool::SizeType TotalNumBlocks,
-    class AlignAsType
+    class AlignAsType,
+    class CriticalSection
 >
-constexpr BlockPool<SingleBlockSizeRequested, TotalNumBlocks, AlignAsType>
+constexpr BlockPool<SingleBlockSizeRequested, TotalNumBlocks, AlignAsType, CriticalSection>
 ::BlockPool()
 :   CommonBlockPool(
         memoryForBlocks,
         SingleBlockSizeRequested,
         entireBlockSize,
-        TotalNumBlocks
+        TotalNumBlocks,
+        static_cast<CriticalSection&>(*this)
     )
 {}
 
 template<
     CommonBlockPool::SizeType SingleBlockSizeRequested,
     CommonBlockPool::SizeType TotalNumBlocks,
-    class AlignAsType
+    class AlignAsType,
+    class CriticalSection
 >
 template<class TBeingPlacedWhileAllocating, class... Args>
 TBeingPlacedWhileAllocating* 
-BlockPool<SingleBlockSizeRequested, TotalNumBlocks, AlignAsType>::MakePtr(Args&&... args){
+BlockPool<SingleBlockSizeRequested, TotalNumBlocks, AlignAsType, CriticalSection>::MakePtr(Args&&... args){
     //see https://eli.thegreenplace.net/2014/perfect-forwarding-and-universal-references-in-c
     static_assert(
-        sizeof(TBeingPlacedWhileAllocating) <= SingleBlockSizeRequested,
+        sizeof(TBeingPlacedWhileAllocating) <= SingleBlockSize,
          "Cannot create item that does not fit into block"
     );
+    static_assert(
+        alignof(TBeingPlacedWhileAllocating) <= BlockAlignment,
+         "Cannot create item requiring stronger alignment than block has"
+    );
     auto rawMemory = AllocateRaw();
     if( rawMemory ){
         //see https://en.cppreference.com/w/cpp/memory/new/operator_new
@@ -796,6 +837,7 @@ T& LifetimeManager<T>::Force(Args&&... args){
         // destroy old existing instance
         reinterpret_cast<T*>(placeInMemory)->~T();
     }
+    exists = true;
     /* Create new item explicitly.
         Does what std::forward by exploiting reference collapsing */
     return *new( InstantMemoryPlaceholderHelper(placeInMemory) )
@@ -0,0 +1,521 @@
+/** @file InstantPerfProfiler.h
+    @brief Host only (Linux) profiler attributing CPU counters per ActionNode
+           or task: cycles, instructions, cache misses and branch misses
+
+When ActionNode callbacks (or task resumes) run on Linux host,
+PerfProfiler wraps each execution with perf_event_open counters
+and accumulates the difference into PerfStatistics of that ActionNode,
+so one can find which action causes cache misses and branch mispredicts.
+
+Hardware counters are often unavailable (containers, virtual machines,
+perf_event_paranoid), then each metric falls back to the software event
+(task clock, context switches, page faults, CPU migrations), and
+when even those are not allowed cycles are replaced by the thread CPU time.
+Use PerfCounters::Source/Name to find what is actually measured.
+
+Example usage:
+ @code
+    Scheduler scheduler;
+    PerfProfiler profiler; // measures the thread it is created on
+    profiler.Attach(scheduler);
+    ...
+    scheduler.ExecuteAll(now);
+    ...
+    profiler.ForEach([&](const ActionNode& action, const PerfStatistics& statistics){
+        printf("%p executed %llu times, avg %s %llu\n",
+            (const void*)&action, statistics.Executions(),
+            profiler.Counters().Name(PerfMetric::CacheMisses),
+            statistics.Average(PerfMetric::CacheMisses));
+    });
+
+    // tasks or any other code can be measured explicitly
+    PerfStatistics taskStatistics;
+    profiler.Measure(taskStatistics, [&]{ myTask(); });
+ @endcode
+
+NOTE: this header is for Linux host builds only (on other platforms
+      it declares nothing), it is not included by InstantRTOS.h.
+      Define InstantScheduler_ObserveExecutions for the whole project
+      (all the files shall see the same Scheduler layout).
+      Counters measure only the thread that created PerfProfiler,
+      so create it on the thread calling Scheduler::ExecuteOne/ExecuteAll.
+      Each measurement costs two read syscalls, so this is a diagnostic
+      tool, not for production timing.
+
+MIT License
+
+Copyright (c) 2023 Pavlo M, see https://github.com/olvap80/InstantRTOS
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef InstantPerfProfiler_INCLUDED_H
+#define InstantPerfProfiler_INCLUDED_H
+
+//______________________________________________________________________________
+// Configurable options (InstantPerfProfiler specific)
+
+/* Common configuration to be included only if available
+   (you can separate file and/or configure individually
+    or just skip that to stick with defaults) */
+#if defined(__has_include) && __has_include("InstantRTOS.Config.h")
+#   include "InstantRTOS.Config.h"
+#endif
+
+/* Profiler exists only where perf_event_open is expected
+   (define InstantPerfProfiler_Suppress to skip it completely) */
+#if !defined(InstantPerfProfiler_Available) && !defined(InstantPerfProfiler_Suppress) \
+    && defined(__linux__) && defined(__has_include)
+#   if __has_include(<linux/perf_event.h>) && __has_include(<unordered_map>)
+#       define InstantPerfProfiler_Available
+#   endif
+#endif
+
+#ifndef InstantPerfProfiler_MaxNesting
+    /// Nested measurements deeper than that are not attributed
+#   define InstantPerfProfiler_MaxNesting 8
+#endif
+
+#ifdef InstantPerfProfiler_Available
+
+//______________________________________________________________________________
+// Dependencies (host only)
+
+#include "InstantScheduler.h"
+
+#ifndef InstantScheduler_ObserveExecutions
+#   error "PerfProfiler needs InstantScheduler_ObserveExecutions defined for the whole project (e.g. in InstantRTOS.Config.h)"
+#endif
+
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#include <cstring>
+#include <unordered_map>
+
+
+//______________________________________________________________________________
+// Public API
+
+/// What is counted for each execution
+enum class PerfMetric: unsigned char{
+    Cycles,       ///< CPU cycles (fallback: task clock or thread CPU time, ns)
+    Instructions, ///< Retired instructions (fallback: context switches)
+    CacheMisses,  ///< Last level cache misses (fallback: page faults)
+    BranchMisses, ///< Mispredicted branches (fallback: CPU migrations)
+    Count ///< Number of metrics (not a metric)
+};
+
+/// Where the value of the metric comes from
+enum class PerfSource: unsigned char{
+    Hardware,    ///< perf_event_open hardware counter (as named by PerfMetric)
+    Software,    ///< perf_event_open software event (see PerfCounters::Name)
+    ThreadClock, ///< clock_gettime(CLOCK_THREAD_CPUTIME_ID) in ns
+    Unavailable  ///< nothing is counted (always 0)
+};
+
+/// Values of all metrics at some moment (or difference between moments)
+struct PerfSample{
+    unsigned long long values[unsigned(PerfMetric::Count)];
+
+    /// Value of the single metric
+    unsigned long long operator[](PerfMetric metric) const{
+        return values[unsigned(metric)];
+    }
+};
+
+
+/// Counters opened for the calling thread
+/** All available events form single perf group, so one read syscall
+ * obtains all of them consistently */
+class PerfCounters{
+public:
+    //ban copying (file descriptors are owned)
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator =(const PerfCounters&) = delete;
+
+    /// Number of metrics
+    static constexpr unsigned MetricsCount = unsigned(PerfMetric::Count);
+
+    /// Open counters for the calling thread (with fallbacks)
+    PerfCounters();
+    /// Close all the counters
+    ~PerfCounters();
+
+    /// Obtain current values of all metrics (unavailable ones are 0)
+    void Read(PerfSample* writeTo) const;
+
+    /// Where the metric comes from
+    PerfSource Source(PerfMetric metric) const;
+
+    /// Printable name of what is actually measured for the metric
+    const char* Name(PerfMetric metric) const;
+
+    /// Test at least one hardware counter is available
+    bool HasHardwareCounters() const;
+
+private:
+    /// Leader of the perf group (-1 when nothing was opened)
+    int groupFd = -1;
+    /// Descriptor for each metric (-1 when not opened)
+    int fds[MetricsCount];
+    /// Position of the metric inside the group read
+    unsigned groupIndex[MetricsCount];
+    /// Number of events in the group
+    unsigned groupSize = 0;
+
+    PerfSource sources[MetricsCount];
+
+    /// Try to open event and add it to the group
+    bool open(PerfMetric metric, unsigned type, unsigned long long config);
+
+    /// Hardware event and its software replacement for each metric
+    struct EventChoice{
+        unsigned long long hardwareConfig;
+        unsigned long long softwareConfig;
+        const char* hardwareName;
+        const char* softwareName;
+    };
+    static const EventChoice& choiceFor(PerfMetric metric);
+};
+
+
+/// Statistics of executions attributed to single ActionNode or task
+class PerfStatistics{
+public:
+    /// Account single execution (difference of counters)
+    void OnMeasurement(const PerfSample& delta);
+
+    /// Number of executions measured so far
+    unsigned long long Executions() const;
+
+    /// Sum of the metric over all executions
+    unsigned long long Total(PerfMetric metric) const;
+
+    /// Worst single execution with regard to the metric
+    unsigned long long Max(PerfMetric metric) const;
+
+    /// Average per execution
+    unsigned long long Average(PerfMetric metric) const;
+
+    /// Forget all statistics
+    void Reset();
+
+private:
+    unsigned long long executions = 0;
+    unsigned long long totals[PerfCounters::MetricsCount] = {};
+    unsigned long long maximums[PerfCounters::MetricsCount] = {};
+};
+
+
+/// Measure executions on the current thread and attribute them
+/** Attach to Scheduler to have statistics per ActionNode automatically
+ * (through Scheduler::StatisticsObserveExecutions), or use Measure
+ * for tasks and any other code. Nested executions (callback running
+ * other Scheduler attached to the same profiler) are attributed to both. */
+class PerfProfiler{
+public:
+    //ban copying (delegates reference this instance)
+    PerfProfiler(const PerfProfiler&) = delete;
+    PerfProfiler& operator =(const PerfProfiler&) = delete;
+
+    /// Open counters for the calling thread
+    PerfProfiler() = default;
+
+    /// Counters being used (to find what is actually measured)
+    const PerfCounters& Counters() const;
+
+    /// Start attributing executions of scheduler (the same thread!)
+    void Attach(Scheduler& scheduler);
+    /// Stop attributing executions of scheduler
+    void Detach(Scheduler& scheduler);
+
+    /// Observer to be used with Scheduler::StatisticsObserveExecutions
+    Scheduler::ExecutionObserver Observer();
+
+    /// Statistics collected for the action (nullptr if never executed)
+    const PerfStatistics* StatisticsFor(const ActionNode& action) const;
+
+    /// Call visitor(const ActionNode&, const PerfStatistics&) for each action
+    template<class Visitor>
+    void ForEach(Visitor&& visitor) const;
+
+    /// Forget statistics of all actions
+    void Reset();
+
+    /// Execute callable and account it into statistics
+    template<class Callable>
+    void Measure(PerfStatistics& statistics, Callable&& callable);
+
+    /// Start measurement explicitly (pair with End)
+    void Begin();
+    /// Complete measurement started by Begin and account it into statistics
+    void End(PerfStatistics& statistics);
+
+private:
+    PerfCounters counters;
+
+    /// Samples at Begin for nested measurements
+    PerfSample started[InstantPerfProfiler_MaxNesting];
+    /// Number of Begin without End so far
+    unsigned depth = 0;
+
+    std::unordered_map<const ActionNode*, PerfStatistics> perAction;
+
+    /// Handler for Scheduler::ExecutionObserver
+    void onExecution(const ActionNode& action, bool starting);
+};
+
+
+
+//______________________________________________________________________________
+//##############################################################################
+/*==============================================================================
+*  Implementation details follow                                               *
+*=============================================================================*/
+//##############################################################################
+
+
+//______________________________________________________________________________
+// Implementing PerfCounters
+
+inline PerfCounters::PerfCounters(){
+    for(unsigned i = 0; i < MetricsCount; ++i){
+        fds[i] = -1;
+        groupIndex[i] = 0;
+        sources[i] = PerfSource::Unavailable;
+    }
+    for(unsigned i = 0; i < MetricsCount; ++i){
+        const PerfMetric metric = PerfMetric(i);
+        const EventChoice& choice = choiceFor(metric);
+        if( open(metric, PERF_TYPE_HARDWARE, choice.hardwareConfig) ){
+            sources[i] = PerfSource::Hardware;
+        }
+        else if( open(metric, PERF_TYPE_SOFTWARE, choice.softwareConfig) ){
+            sources[i] = PerfSource::Software;
+        }
+        else if( PerfMetric::Cycles == metric ){
+            // at least time is always available
+            sources[i] = PerfSource::ThreadClock;
+        }
+    }
+}
+
+inline PerfCounters::~PerfCounters(){
+    for(unsigned i = 0; i < MetricsCount; ++i){
+        if( fds[i] >= 0 ){
+            close(fds[i]);
+        }
+    }
+}
+
+inline void PerfCounters::Read(PerfSample* writeTo) const{
+    std::memset(writeTo, 0, sizeof(*writeTo));
+    if( groupSize ){
+        // PERF_FORMAT_GROUP layout: number of events followed by values
+        unsigned long long buffer[1 + MetricsCount];
+        const ssize_t expected = ssize_t(sizeof(unsigned long long) * (1 + groupSize));
+        if( read(groupFd, buffer, sizeof(buffer)) == expected ){
+            for(unsigned i = 0; i < MetricsCount; ++i){
+                if( fds[i] >= 0 ){
+                    writeTo->values[i] = buffer[1 + groupIndex[i]];
+                }
+            }
+        }
+    }
+    if( PerfSource::ThreadClock == sources[unsigned(PerfMetric::Cycles)] ){
+        timespec now;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+        writeTo->values[unsigned(PerfMetric::Cycles)] =
+            (unsigned long long)now.tv_sec * 1000000000ull + (unsigned long long)now.tv_nsec;
+    }
+}
+
+inline PerfSource PerfCounters::Source(PerfMetric metric) const{
+    return sources[unsigned(metric)];
+}
+
+inline const char* PerfCounters::Name(PerfMetric metric) const{
+    const EventChoice& choice = choiceFor(metric);
+    switch( sources[unsigned(metric)] ){
+        case PerfSource::Hardware: return choice.hardwareName;
+        case PerfSource::Software: return choice.softwareName;
+        case PerfSource::ThreadClock: return "thread-cpu-time-ns";
+        default: return "unavailable";
+    }
+}
+
+inline bool PerfCounters::HasHardwareCounters() const{
+    for(unsigned i = 0; i < MetricsCount; ++i){
+        if( PerfSource::Hardware == sources[i] ){
+            return true;
+        }
+    }
+    return false;
+}
+
+inline bool PerfCounters::open(PerfMetric metric, unsigned type, unsigned long long config){
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.read_format = PERF_FORMAT_GROUP;
+    // user space only, this works for perf_event_paranoid up to 2
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    const int fd = int(syscall(
+        __NR_perf_event_open, &attr, 0 /*this thread*/, -1 /*any CPU*/,
+        groupFd, PERF_FLAG_FD_CLOEXEC
+    ));
+    if( fd < 0 ){
+        return false;
+    }
+    if( groupFd < 0 ){
+        groupFd = fd;
+    }
+    fds[unsigned(metric)] = fd;
+    groupIndex[unsigned(metric)] = groupSize++;
+    return true;
+}
+
+inline const PerfCounters::EventChoice& PerfCounters::choiceFor(PerfMetric metric){
+    static const EventChoice choices[MetricsCount] = {
+        {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_SW_TASK_CLOCK, "cycles", "task-clock-ns"},
+        {PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_SW_CONTEXT_SWITCHES, "instructions", "context-switches"},
+        {PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_SW_PAGE_FAULTS, "cache-misses", "page-faults"},
+        {PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_SW_CPU_MIGRATIONS, "branch-misses", "cpu-migrations"}
+    };
+    return choices[unsigned(metric)];
+}
+
+
+//______________________________________________________________________________
+// Implementing PerfStatistics
+
+inline void PerfStatistics::OnMeasurement(const PerfSample& delta){
+    ++executions;
+    for(unsigned i = 0; i < PerfCounters::MetricsCount; ++i){
+        totals[i] += delta.values[i];
+        if( delta.values[i] > maximums[i] ){
+            maximums[i] = delta.values[i];
+        }
+    }
+}
+
+inline unsigned long long PerfStatistics::Executions() const{
+    return executions;
+}
+
+inline unsigned long long PerfStatistics::Total(PerfMetric metric) const{
+    return totals[unsigned(metric)];
+}
+
+inline unsigned long long PerfStatistics::Max(PerfMetric metric) const{
+    return maximums[unsigned(metric)];
+}
+
+inline unsigned long long PerfStatistics::Average(PerfMetric metric) const{
+    return executions ? totals[unsigned(metric)] / executions : 0;
+}
+
+inline void PerfStatistics::Reset(){
+    *this = PerfStatistics();
+}
+
+
+//______________________________________________________________________________
+// Implementing PerfProfiler
+
+inline const PerfCounters& PerfProfiler::Counters() const{
+    return counters;
+}
+
+inline void PerfProfiler::Attach(Scheduler& scheduler){
+    scheduler.StatisticsObserveExecutions(Observer());
+}
+
+inline void PerfProfiler::Detach(Scheduler& scheduler){
+    scheduler.StatisticsStopObservingExecutions();
+}
+
+inline Scheduler::ExecutionObserver PerfProfiler::Observer(){
+    return Scheduler::ExecutionObserver::From(this).Bind<&PerfProfiler::onExecution>();
+}
+
+inline const PerfStatistics* PerfProfiler::StatisticsFor(const ActionNode& action) const{
+    auto found = perAction.find(&action);
+    return found != perAction.end() ? &found->second : nullptr;
+}
+
+template<class Visitor>
+inline void PerfProfiler::ForEach(Visitor&& visitor) const{
+    for(const auto& item : perAction){
+        visitor(*item.first, item.second);
+    }
+}
+
+inline void PerfProfiler::Reset(){
+    perAction.clear();
+}
+
+template<class Callable>
+inline void PerfProfiler::Measure(PerfStatistics& statistics, Callable&& callable){
+    Begin();
+    callable();
+    End(statistics);
+}
+
+inline void PerfProfiler::Begin(){
+    if( depth < InstantPerfProfiler_MaxNesting ){
+        counters.Read(&started[depth]);
+    }
+    ++depth;
+}
+
+inline void PerfProfiler::End(PerfStatistics& statistics){
+    if( !depth ){
+        return; // End without Begin
+    }
+    --depth;
+    if( depth < InstantPerfProfiler_MaxNesting ){
+        PerfSample finished;
+        counters.Read(&finished);
+        for(unsigned i = 0; i < PerfCounters::MetricsCount; ++i){
+            finished.values[i] -= started[depth].values[i];
+        }
+        statistics.OnMeasurement(finished);
+    }
+}
+
+inline void PerfProfiler::onExecution(const ActionNode& action, bool starting){
+    if( starting ){
+        perAction[&action]; // insert now, so allocation is not measured
+        Begin();
+    }
+    else{
+        End(perAction[&action]); // only lookup (inserted above)
+    }
+}
+
+#endif // InstantPerfProfiler_Available
+
+#endif
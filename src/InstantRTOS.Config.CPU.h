@@ -24,6 +24,20 @@ OPTION2:
     #define InstantRTOS_LeaveCritical }
  @endcode
 
+Saving and disabling interrupts as separate steps
+(used by CriticalSectionInterrupts from InstantCriticalSection.h,
+ where Enter and Leave are different calls, so block macros above do not fit)
+- InstantRTOS_InterruptStateType - type to save interrupt state
+- InstantRTOS_DisableInterrupts(savedState) - save state and disable interrupts
+- InstantRTOS_RestoreInterrupts(savedState) - revert to saved state
+ @code
+    #define InstantRTOS_InterruptStateType uint8_t
+    #define InstantRTOS_DisableInterrupts(savedState) \
+        do{ savedState = SREG; cli(); }while(false)
+    #define InstantRTOS_RestoreInterrupts(savedState) \
+        do{ SREG = savedState; }while(false)
+ @endcode
+
 The InstantRTOS_MutexObjectType and InstantRTOS_MutexObjectVariable could be
 useful on those plaforms, where there is no "disable interrupts" operation
 to use but mutex is present. The InstantRTOS takes care to place macro
@@ -83,10 +97,32 @@ SOFTWARE.
 #       define InstantRTOS_EnterCritical ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
 #       define InstantRTOS_LeaveCritical }
 #       define InstantRTOS_MutexObject
+#       define InstantRTOS_InterruptStateType uint8_t
+#       define InstantRTOS_DisableInterrupts(savedState) \
+            do{ savedState = SREG; cli(); }while(false)
+#       define InstantRTOS_RestoreInterrupts(savedState) \
+            do{ __asm__ volatile("" ::: "memory"); SREG = savedState; }while(false)
 #   elif defined(xt_rsil)
 #       define InstantRTOS_EnterCritical { uint32_t saved_iterrupts = xt_rsil(15)
 #       define InstantRTOS_LeaveCritical xt_wsr_ps(saved_iterrupts)}
 #       define InstantRTOS_MutexObject
+#       define InstantRTOS_InterruptStateType uint32_t
+#       define InstantRTOS_DisableInterrupts(savedState) \
+            do{ savedState = xt_rsil(15); }while(false)
+#       define InstantRTOS_RestoreInterrupts(savedState) \
+            xt_wsr_ps(savedState)
+#   elif defined(__ARM_ARCH_6M__) || defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) \
+        || defined(__ARM_ARCH_8M_BASE__) || defined(__ARM_ARCH_8M_MAIN__)
+        //Cortex-M: PRIMASK keeps the "interrupts disabled" state
+#       define InstantRTOS_InterruptStateType unsigned long
+#       define InstantRTOS_DisableInterrupts(savedState) \
+            __asm__ volatile("mrs %0, primask\n cpsid i" : "=r"(savedState) :: "memory")
+#       define InstantRTOS_RestoreInterrupts(savedState) \
+            __asm__ volatile("msr primask, %0" :: "r"(savedState) : "memory")
+#       define InstantRTOS_EnterCritical { InstantRTOS_InterruptStateType saved_iterrupts; \
+            InstantRTOS_DisableInterrupts(saved_iterrupts);
+#       define InstantRTOS_LeaveCritical InstantRTOS_RestoreInterrupts(saved_iterrupts);}
+#       define InstantRTOS_MutexObject
 #   elif defined(interrupts)
         /* It is not the best option to always enable interrupts (from interrupt)
            but here we have the last hope to do something meaningful */
@@ -125,4 +125,8 @@ SOFTWARE.
 //#define InstantScheduler_SuppressEnterCritical
 //#define InstantCallback_SuppressEnterCritical
 
+/* Uncomment below to count hot path events of all modules
+   (see InstantTrace.h, TraceRegistry::Dump prints collected counters) */
+//#define InstantTrace_Enable
+
 #endif
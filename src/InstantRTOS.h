@@ -41,19 +41,27 @@ SOFTWARE.
 
 #include "InstantCoroutine.h"
 #include "InstantDelegate.h"
+#include "InstantCriticalSection.h"
+#include "InstantTrace.h"
 //#include "InstantTask.h"
 
 
 // Timing, intervals and scheduling ____________________________________________
 
 #include "InstantScheduler.h"
+#include "InstantConcurrentScheduler.h"
 #include "InstantTimer.h"
+#include "InstantLatency.h"
 
 
 // Memory and queueing _________________________________________________________
 
 #include "InstantMemory.h"
 #include "InstantQueue.h"
+#include "InstantIntrusiveTree.h"
+#include "InstantIntrusiveHashTable.h"
+#include "InstantIntrusiveHeap.h"
+#include "InstantIntrusiveLockFree.h"
 
 
 // Other handy utility stuff ___________________________________________________
@@ -23,7 +23,9 @@ NOTE: InstantScheduler.h is configurable for interrupt (thread) safety.
       It is always safe to use the same object from the same thread.
       (different objects used from different threads will work as well).
       It is safe to use the same object from different threads/interrupts
-      only if that interrupt (thread) safety is configured, see below
+      only if that interrupt (thread) safety is configured, see below,
+      or if Scheduler instance is constructed with own critical section
+      policy from InstantCriticalSection.h (per instance protection)
 
 
 Portable and easy to use scheduler in standard C++11
@@ -72,6 +74,11 @@ SOFTWARE.
 // Uncomment below to allow floating average
 #define InstantScheduler_StatisticsAverageCount 1000 
 
+/* Define below (for the whole project!) to observe each executed ActionNode
+   (needed by InstantPerfProfiler.h, costs delegate in each Scheduler
+    and additional test for each execution) */
+//#define InstantScheduler_ObserveExecutions
+
 
 #ifndef InstantScheduler_Ticks_Type
     ///Type to be used for storing time measurements and time calculations
@@ -105,6 +112,8 @@ SOFTWARE.
 #include "InstantDelegate.h"
 #include "InstantThenable.h"
 #include "InstantIntrusiveList.h"
+#include "InstantCriticalSection.h"
+#include "InstantTrace.h"
 
 /*
     TODO: futures/promises? JS then?
@@ -363,6 +372,9 @@ private:
     /// Place item to the right location in scheduler's queue
     void scheduleAfterFindPlace();
 
+    /// Cancel schedule in Scheduler other than targetScheduler (if any)
+    void leaveOtherScheduler(Scheduler& targetScheduler);
+
     /// Common setup for ListenOnce and ListenSubscribe
     void listenTo(MulticastToActions& multicastToAction, bool removeAfterCall);
 };
@@ -377,7 +389,10 @@ private:
  * have desired precision.
  * For saving battery use HasNextTicks to find the time of next schedule,
  * (one can implement different sleep strategy depending on known 
- *  schedule time to find the next time device shall wake up)! */
+ *  schedule time to find the next time device shall wake up)!
+ * Each instance can be protected by own critical section policy
+ * (in addition to InstantScheduler_EnterCritical, if configured),
+ * ActionNode moving to other Scheduler leaves the previous one first. */
 class Scheduler{
 public:
     //all the copying is banned (this ensures pointers are valid)
@@ -389,6 +404,11 @@ public:
     /// Create initial empty Scheduler
     constexpr Scheduler() = default;
 
+    /// Create initial empty Scheduler protected by criticalSectionToUse
+    /** Policy from InstantCriticalSection.h (or compatible) is used for
+     * all operations on this instance, it shall outlive the Scheduler */
+    explicit Scheduler(CriticalSectionReference criticalSectionToUse);
+
     /// Prepare initial time (so that all time intervals will start from it)
     /** This is the very first API to make schedule running!
      * All other API shall be called after this one,
@@ -442,6 +462,21 @@ public:
             /// Average case between ExecuteAll API calls 
             Ticks StatisticsDelayBetweenExecuteAllAvg() const;
 #       endif
+#   endif
+
+#   ifdef InstantScheduler_ObserveExecutions
+        /// Callback invoked around each executed ActionNode callback
+        /** Called on the thread running ExecuteOne with true right before
+         *  and with false right after the callback, this way execution
+         *  cost can be attributed per ActionNode (see InstantPerfProfiler.h) */
+        using ExecutionObserver = Delegate<void(const ActionNode&, bool)>;
+
+        /// Observe each execution (only one observer at a time)
+        /** Shall be called from the thread running ExecuteOne/ExecuteAll */
+        void StatisticsObserveExecutions(const ExecutionObserver& observer);
+
+        /// Stop observing executions
+        void StatisticsStopObservingExecutions();
 
 #   endif
 
@@ -457,6 +492,9 @@ private:
     /// The list of all items scheduled so far
     IntrusiveList<ActionNode> scheduledActions;
 
+    /// Per instance protection of scheduledActions (nothing by default)
+    CriticalSectionReference criticalSection;
+
 #   ifdef InstantScheduler_StatisticsCollection
         class MeasurementMonitor{
         public:
@@ -484,6 +522,32 @@ private:
         MeasurementMonitor statisticsDelayBetweenExecuteOne;
         MeasurementMonitor statisticsDelayBetweenExecuteAll;
 #   endif
+
+#   ifdef InstantScheduler_ObserveExecutions
+        /// Called around each execution when observingExecutions
+        ExecutionObserver executionObserver = ExecutionObserver(&ignoreExecution);
+        bool observingExecutions = false;
+
+        /// Placeholder for executionObserver
+        static void ignoreExecution(const ActionNode&, bool);
+#   endif
+};
+
+
+/// Scheduler owning own critical section policy instance
+/** Handy for host platforms, like
+ * (CriticalSectionStdMutex comes from InstantCriticalSectionHost.h)
+ * @code
+ *      SchedulerWithCriticalSection<CriticalSectionStdMutex> scheduler;
+ * @endcode */
+template<class CriticalSection>
+class SchedulerWithCriticalSection:
+    private CriticalSection, // goes first to exist before Scheduler
+    public Scheduler
+{
+public:
+    /// Create initial empty Scheduler protected by own CriticalSection
+    SchedulerWithCriticalSection();
 };
 
 
@@ -561,7 +625,11 @@ inline ActionNode& ActionNode::ScheduleAfter(
     Ticks ticksToWaitFirstTime,
     Ticks periodTicks
 ){
+    InstantTrace_Count(SchedulerSchedule);
+    leaveOtherScheduler(targetScheduler);
+
     InstantScheduler_EnterCritical
+    targetScheduler.criticalSection.Enter();
     
     prepareForNewSchedule(
         targetScheduler,
@@ -571,6 +639,7 @@ inline ActionNode& ActionNode::ScheduleAfter(
 
     scheduleAfterFindPlace();
 
+    targetScheduler.criticalSection.Leave();
     InstantScheduler_LeaveCritical
     return *this;
 }
@@ -580,7 +649,11 @@ inline ActionNode& ActionNode::ScheduleBefore(
     Ticks ticksToWaitFirstTime,
     Ticks periodTicks
 ){
+    InstantTrace_Count(SchedulerSchedule);
+    leaveOtherScheduler(targetScheduler);
+
     InstantScheduler_EnterCritical
+    targetScheduler.criticalSection.Enter();
 
     prepareForNewSchedule(
         targetScheduler,
@@ -607,6 +680,7 @@ inline ActionNode& ActionNode::ScheduleBefore(
     //element found or end is reached - operation is the same:
     itr->InsertPrevChainElement(this);
 
+    targetScheduler.criticalSection.Leave();
     InstantScheduler_LeaveCritical
     return *this;
 }
@@ -626,20 +700,25 @@ inline ActionNode::Ticks ActionNode::PeriodTicksAgain() const{
 }
 
 
-ActionNode& ActionNode::ListenOnce(MulticastToActions& multicastToAction){
+inline ActionNode& ActionNode::ListenOnce(MulticastToActions& multicastToAction){
     listenTo(multicastToAction, true);
     return *this;
 }
 
-ActionNode& ActionNode::ListenSubscribe(MulticastToActions& multicastToAction){
+inline ActionNode& ActionNode::ListenSubscribe(MulticastToActions& multicastToAction){
     listenTo(multicastToAction, false);
     return *this;
 }
 
-void ActionNode::listenTo(
+inline void ActionNode::listenTo(
     MulticastToActions& multicastToAction,
     bool removeAfterCall
 ){
+    // Scheduler protects own list by own critical section
+    if( scheduledWith ){
+        Cancel();
+    }
+
     InstantScheduler_EnterCritical
 
     scheduledWith = nullptr;
@@ -651,7 +730,7 @@ void ActionNode::listenTo(
 }
 
 
-bool ActionNode::IsListening() const{
+inline bool ActionNode::IsListening() const{
     /* IsScheduled means we are not "listening" for sure,
        IsChainElementSingle also means we are not "listening" */ 
     return !(IsScheduled() || IsChainElementSingle());
@@ -659,13 +738,21 @@ bool ActionNode::IsListening() const{
 
 
 inline void ActionNode::Cancel(){
+    /* Scheduler is not expected to change in parallel
+       (the same ActionNode is (re)scheduled from one place at a time) */
+    Scheduler* previousScheduler = scheduledWith;
+
     InstantScheduler_EnterCritical
+    if( previousScheduler ){
+        previousScheduler->criticalSection.Enter();
+    }
 
     if( scheduledWith ){
         /* Remember: we have to remove from that chain manually
             and no custom/scheduling code shall run here,
             This is also the sign we wre not scheduled any more */ 
         RemoveFromChain();
+        InstantTrace_Count(SchedulerCancel);
 
         /* Item can cancel self while being processed,
             so we shall prevent own periodTicksAgain to reschedule it again */ 
@@ -673,7 +760,14 @@ inline void ActionNode::Cancel(){
 
         scheduledWith = nullptr;
     }
+    else if( !IsChainElementSingle() ){
+        // listening to MulticastToActions, just stop listening
+        RemoveFromChain();
+    }
 
+    if( previousScheduler ){
+        previousScheduler->criticalSection.Leave();
+    }
     InstantScheduler_LeaveCritical
 }
 
@@ -684,6 +778,14 @@ inline void ActionNode::ResetCallback(){
 
 
 
+inline void ActionNode::leaveOtherScheduler(Scheduler& targetScheduler){
+    /* Each Scheduler has own critical section, so removal from
+       the previous one is done separately (under its own protection) */
+    if( scheduledWith && scheduledWith != &targetScheduler ){
+        Cancel();
+    }
+}
+
 inline void ActionNode::prepareForNewSchedule(
     Scheduler& targetScheduler,
     Ticks ticksToWaitFirstTime,
@@ -723,6 +825,9 @@ inline void ActionNode::scheduleAfterFindPlace(){
 //______________________________________________________________________________
 // Implementing Scheduler
 
+inline Scheduler::Scheduler(CriticalSectionReference criticalSectionToUse)
+    : criticalSection(criticalSectionToUse) {}
+
 inline void Scheduler::Start(Ticks currentTicks){
     knownAbsoluteTicks = currentTicks;
 
@@ -738,6 +843,7 @@ inline bool Scheduler::ExecuteOne(
     ActionNode* actionBeingExecutedNow = nullptr;
     {
         InstantScheduler_EnterCritical
+        criticalSection.Enter();
 
 #   ifdef InstantScheduler_StatisticsCollection
         statisticsDelayBetweenExecuteOne.OnMeasurement(currentTicks - knownAbsoluteTicks);
@@ -768,11 +874,16 @@ inline bool Scheduler::ExecuteOne(
                Thus just fix part of the values */
             actionBeingExecutedNow->RemoveFromChain();
 
+            InstantTrace_Count(SchedulerExecute);
+            InstantTrace_Add(SchedulerLateTicks,
+                currentTicks - actionBeingExecutedNow->scheduleData.absoluteScheduleTime);
+
             /* the actionBeingExecutedNow->scheduledWith = nullptr; 
                will happen later and only
                in the case if item is not scheduled to somewhere else */
         }
 
+        criticalSection.Leave();
         InstantScheduler_LeaveCritical
     }
 
@@ -780,10 +891,23 @@ inline bool Scheduler::ExecuteOne(
     if( actionBeingExecutedNow ){
         /*  Note: periodic item can cancel self here
                     (then periodTicksAgain turns 0) */
+#       ifdef InstantScheduler_ObserveExecutions
+            if( observingExecutions ){
+                executionObserver(*actionBeingExecutedNow, true);
+            }
+#       endif
+
         actionBeingExecutedNow->thenableToResolve();
 
+#       ifdef InstantScheduler_ObserveExecutions
+            if( observingExecutions ){
+                executionObserver(*actionBeingExecutedNow, false);
+            }
+#       endif
+
         {
             InstantScheduler_EnterCritical
+            criticalSection.Enter();
 
             /* ensure item did not add self to somewhere else,
                (no scheduling or listening to something)
@@ -805,6 +929,7 @@ inline bool Scheduler::ExecuteOne(
             }
             //else means scheduledWith already points to somewhere else!
 
+            criticalSection.Leave();
             InstantScheduler_LeaveCritical
         }
 
@@ -838,6 +963,7 @@ inline bool Scheduler::HasNextTicks(Ticks* writeTo) const{
     bool hasTicks = true;
     {
         InstantScheduler_EnterCritical
+        criticalSection.Enter();
         
         // the first one is the nearest
         auto actionToExecute = scheduledActions.begin();
@@ -847,6 +973,7 @@ inline bool Scheduler::HasNextTicks(Ticks* writeTo) const{
         else{
             hasTicks = false;
         }
+        criticalSection.Leave();
         InstantScheduler_LeaveCritical
     }
     return hasTicks;
@@ -905,10 +1032,33 @@ inline Scheduler::Ticks Scheduler::KnownAbsoluteTicks() const{
 #endif
 
 
+#ifdef InstantScheduler_ObserveExecutions
+    inline void Scheduler::StatisticsObserveExecutions(const ExecutionObserver& observer){
+        executionObserver = observer;
+        observingExecutions = true;
+    }
+
+    inline void Scheduler::StatisticsStopObservingExecutions(){
+        observingExecutions = false;
+        executionObserver = ExecutionObserver(&ignoreExecution);
+    }
+
+    inline void Scheduler::ignoreExecution(const ActionNode&, bool){}
+#endif
+
+
+//______________________________________________________________________________
+// Implementing SchedulerWithCriticalSection
+
+template<class CriticalSection>
+SchedulerWithCriticalSection<CriticalSection>::SchedulerWithCriticalSection()
+    : Scheduler(static_cast<CriticalSection&>(*this)) {}
+
+
 //______________________________________________________________________________
 // Implementing MulticastToActions
 
-void MulticastToActions::operator()(){
+inline void MulticastToActions::operator()(){
     IntrusiveList<ActionNode>* actions;
     {
         InstantScheduler_EnterCritical
@@ -927,15 +1077,20 @@ void MulticastToActions::operator()(){
         
         //Item is removed but iterator stays valid))
         action->RemoveFromChain();
+
+        /* Callback can schedule action to Scheduler, that reuses the same
+           memory for scheduleData, so the flag is remembered before */
+        const bool removeAfterCall = action->multicastToActionsRemoveAfterCall;
         
         action->thenableToResolve(); //Execute stuff (this can add action to somewhere)
 
         if(
                 // action does not want to be autoremoved!
-                !action->multicastToActionsRemoveAfterCall
+                !removeAfterCall
             /* and that action did not add self 
                 to somewhere else so far */
             &&  action->IsChainElementSingle()
+            &&  action->scheduledWith == nullptr
         ){
             // add to list for next call
             InstantScheduler_EnterCritical
@@ -2,6 +2,10 @@
     @brief Handle hardware signals being mapped to memory
 
 This is general abstraction to operate and manipulate bits in memory 
+    - BitsLocation references bits by address and mask
+    - BitsDebounce filters all bits of the port word at once
+    - BitsAccumulator catches short pulses (ISR accumulates, loop consumes)
+    - SignalRouter calls handlers only for bits that have changed
 
 
 MIT License
@@ -30,6 +34,69 @@ SOFTWARE.
 #ifndef InstantSignals_INCLUDED_H
 #define InstantSignals_INCLUDED_H
 
+//______________________________________________________________________________
+// Configurable options (InstantSignals specific)
+
+/* Common configuration to be included only if available
+   (you can separate file and/or configure individually
+    or just skip that to stick with defaults) */
+#if defined(__has_include) && __has_include("InstantRTOS.Config.h")
+#   include "InstantRTOS.Config.h"
+#endif
+
+/* Tuning optional support for accumulating bits from interrupts,
+   (just leave as is if interrupts/other RTOS are not used) */
+#ifndef InstantSignals_EnterCritical
+#   if defined(InstantRTOS_EnterCritical) && !defined(InstantSignals_SuppressEnterCritical)
+#       define InstantSignals_EnterCritical InstantRTOS_EnterCritical
+#       define InstantSignals_LeaveCritical InstantRTOS_LeaveCritical
+#       if defined(InstantRTOS_MutexObjectType)
+#           define InstantSignals_MutexObjectType InstantRTOS_MutexObjectType
+#           define InstantSignals_MutexObjectVariable InstantRTOS_MutexObjectVariable
+#       endif
+#   else
+#       define InstantSignals_EnterCritical
+#       define InstantSignals_LeaveCritical
+#   endif
+#endif
+
+#ifndef InstantSignals_Panic
+#   ifdef InstantRTOS_Panic
+#       define InstantSignals_Panic() InstantRTOS_Panic('S')  
+#   else
+#       define InstantSignals_Panic() /* you can customize here! */ do{}while(true)
+#   endif
+#endif
+
+/* Compiler provided atomic builtins are used for shared words where available
+   and only for those Word types they handle lock free (this is checked
+   for each Word with __atomic_always_lock_free, so 64 bit words on 32 bit
+   MCU or any RMW on ARMv6-M do not turn into library calls),
+   other words go with InstantSignals_EnterCritical/InstantSignals_LeaveCritical
+   (define InstantSignals_SuppressBuiltinAtomics to always go that way,
+    for AVR builtins are not lock free, so critical section is used) */
+#if !defined(InstantSignals_UseBuiltinAtomics) \
+    && !defined(InstantSignals_SuppressBuiltinAtomics) \
+    && (defined(__GNUC__) || defined(__clang__)) && !defined(__AVR__)
+#   define InstantSignals_UseBuiltinAtomics
+#endif
+
+/* Hardware assisted atomic bit operations for BitsLocation::Atomic...
+   (bit-banding on Cortex-M3/M4, set/clear/toggle registers, etc),
+   define macros below to make the hardware do the job, for example
+ @code
+    #define InstantSignals_AtomicSetBits(address, mask) \
+        (*BitBandAliasFor(address, mask) = 1)
+    #define InstantSignals_AtomicClearBits(address, mask) \
+        (*BitBandAliasFor(address, mask) = 0)
+ @endcode
+   Optionally InstantSignals_AtomicAssignBits(address, mask, value) can be
+   defined to set selected bits to value at once (like GPIO BSRR does).
+   (just leave as is to use builtins or critical section) */
+//#define InstantSignals_AtomicSetBits(address, mask)
+//#define InstantSignals_AtomicClearBits(address, mask)
+//#define InstantSignals_AtomicAssignBits(address, mask, value)
+
 // маска, фільтрація сигналів (масовий антидрєбєзг)
 /* ловлення сигналів на кожній ітерації
 там де ловимо 1 складати по |
@@ -37,6 +104,58 @@ SOFTWARE.
 (або викорситовувати "перевертальну" маску XOR)
 */
 
+/// Internal helpers for operating on words shared with interrupts/threads
+namespace InstantSignalsDetails{
+    /// Atomic read-modify-write operations for the Word
+    /** Compiler builtins are used where available (InstantSignals_UseBuiltinAtomics)
+     * and lock free for the Word, otherwise operations go inside the critical section */
+    template<class Word>
+    class Atomic{
+    public:
+        /// Operations on the Word are done by lock free builtins
+        static constexpr bool UsesBuiltins =
+#ifdef InstantSignals_UseBuiltinAtomics
+            __atomic_always_lock_free(sizeof(Word), 0);
+#else
+            false;
+#endif
+
+        /// OR bits into target, @returns previous value
+        static Word FetchOr(volatile Word* target, Word bits);
+        /// AND bits into target, @returns previous value
+        static Word FetchAnd(volatile Word* target, Word bits);
+        /// XOR bits into target, @returns previous value
+        static Word FetchXor(volatile Word* target, Word bits);
+        /// Replace target with value, @returns previous value
+        static Word Exchange(volatile Word* target, Word value);
+        /// Replace only bits selected by mask with value, @returns previous value
+        static Word AssignMasked(volatile Word* target, Word mask, Word value);
+
+    private:
+        /// Tag to select implementation by UsesBuiltins
+        template<bool builtins>
+        struct Implementation{};
+
+        static Word FetchOr(volatile Word* target, Word bits, Implementation<true>);
+        static Word FetchOr(volatile Word* target, Word bits, Implementation<false>);
+        static Word FetchAnd(volatile Word* target, Word bits, Implementation<true>);
+        static Word FetchAnd(volatile Word* target, Word bits, Implementation<false>);
+        static Word FetchXor(volatile Word* target, Word bits, Implementation<true>);
+        static Word FetchXor(volatile Word* target, Word bits, Implementation<false>);
+        static Word Exchange(volatile Word* target, Word value, Implementation<true>);
+        static Word Exchange(volatile Word* target, Word value, Implementation<false>);
+        static Word AssignMasked(
+            volatile Word* target, Word mask, Word value, Implementation<true>);
+        static Word AssignMasked(
+            volatile Word* target, Word mask, Word value, Implementation<false>);
+
+#if defined(InstantSignals_MutexObjectType)
+        static InstantSignals_MutexObjectType InstantSignals_MutexObjectVariable;
+#endif
+    };
+}
+
+
 /// Simple bits(s) location in memory
 /** Used to tie flags from multiple locations together,
  * This is actually address and mask to hold "coordinates of bits" */
@@ -82,7 +201,7 @@ public:
         return mask;
     }
 
-    /// Set to 1 all bits selected by the mask (nonatomic)
+    /// Set to 1 all bits selected by the mask (nonatomic, see AtomicSet)
     void Set(){
         *address |= mask;
     }
@@ -97,6 +216,23 @@ public:
         *address = (*address & ~mask);
     }
 
+    /// Atomically set to 1 all bits selected by the mask
+    /** Safe for words shared with interrupts/threads without
+     * critical section if hardware support or builtins lock free
+     * for AddressableUnit are available (see InstantSignalsDetails::Atomic) */
+    void AtomicSet();
+
+    /// Atomically set target bits to specific value
+    /** NOTE: with only InstantSignals_AtomicSetBits/InstantSignals_AtomicClearBits
+     *        hooks it is two atomic operations (ones are set first) */
+    void AtomicSet(AddressableUnit newValue);
+
+    /// Atomically set corresponding bits to ZEROES with regard to mask
+    void AtomicClear();
+
+    /// Atomically invert all bits selected by the mask
+    void AtomicToggle();
+
 private:
     /// Actual address where signal is located
     AddressableUnit* address;
@@ -106,45 +242,668 @@ private:
 };
 
 
+/// Debounce all bits of the port word at once (vertical counters)
+/** Each bit of Word is a separate channel (signal) being debounced,
+ * all channels are updated simultaneously by a handful of bitwise operations
+ * on every Discover call, so cost per sample does not depend on 
+ * the number of channels (there are no loops inside).
+ * Every channel has own 2 bit counter "stored vertically": bit N of
+ * counterLow and bit N of counterHigh form the counter for channel N.
+ * Channel accepts new value once SamplesToAccept consecutive samples
+ * are different from the debounced one, any sample equal to debounced value
+ * resets counter for that channel (chattering restarts debouncing).
+ * Call Discover with raw port value periodically (from timer interrupt,
+ * scheduler action or loop), sampling interval defines debounce time:
+ * debounce time = SamplesToAccept * sampling interval
+ * NOTE: Word shall be unsigned integral type (8/16/32/64 bit port word)
+ * NOTE: not thread/interrupt safe, Discover from one place only */
+template<class Word = BitsLocation::AddressableUnit>
 class BitsDebounce{
+public:
+    /// Type of the port word being debounced (one channel per bit)
+    using WordType = Word;
+
+    /// Number of consecutive samples needed to accept new value
+    static constexpr unsigned SamplesToAccept = 4;
+
+    /// Setup initial debounced value for all the channels
+    constexpr BitsDebounce(
+        Word initialValue = 0 ///< Value considered to be initial from start
+    ) : debouncedValue(initialValue) {}
+
+    /// Take the new raw sample of all channels into account
+    /** Called with raw value periodically, 
+     * @returns mask of channels that have new debounced value
+     *          (1s correspond to channels "discovered" right now),
+     *          0 means nothing has changed */
+    Word Discover(Word rawSample){
+        // 1s where raw sample differs from the debounced value
+        const Word delta = static_cast<Word>(rawSample ^ debouncedValue);
+
+        /* Increment counters of differing channels, reset others,
+           counter wraps to 00 exactly when SamplesToAccept is reached */
+        counterHigh = static_cast<Word>((counterHigh ^ counterLow) & delta);
+        counterLow = static_cast<Word>(~counterLow & delta);
+
+        // Channels where counter just wrapped (stable for SamplesToAccept)
+        const Word toggle = static_cast<Word>(delta & ~(counterLow | counterHigh));
+        debouncedValue ^= toggle;
+        return toggle;
+    }
+
+    /// Current values considered to be filtered (debounced)
+    constexpr Word Value() const{
+        return debouncedValue;
+    }
+
+    /// Select those channels from changedMask that turned to 1
+    /** Use with mask returned by Discover to detect "rising" edges */
+    constexpr Word ChangedToOnes(Word changedMask) const{
+        return static_cast<Word>(changedMask & debouncedValue);
+    }
+
+    /// Select those channels from changedMask that turned to 0
+    /** Use with mask returned by Discover to detect "falling" edges */
+    constexpr Word ChangedToZeroes(Word changedMask) const{
+        return static_cast<Word>(changedMask & ~debouncedValue);
+    }
 
+    /// Force debounced value and restart debouncing for all channels
+    void Reset(Word newValue){
+        debouncedValue = newValue;
+        counterLow = 0;
+        counterHigh = 0;
+    }
+
+private:
+    /// Value being already debounced (considered as being current)
+    Word debouncedValue;
+
+    /// Low bits of per channel counters
+    Word counterLow = 0;
+    /// High bits of per channel counters
+    Word counterHigh = 0;
 };
 
 
-/// 
+/// Accumulate (OR together) bits from the array of registers
+/** Intended to catch short pulses between checks: fast routine (like ISR)
+ * calls Refresh/RefreshAll as often as possible, while "slow" main loop
+ * periodically takes Snapshot of what was accumulated so far,
+ * Snapshot takes the value and clears it atomically, so no pulse is lost
+ * (nor reported twice) even if accumulating happens concurrently.
+ * Registers are described by the map of Source items (address, mask
+ * to select bits and mask of bits to be inverted for "active 0" signals),
+ * map is referenced, not copied, so it can stay constant (in flash).
+ * @tparam Word unsigned type of the register (8/16/32/64 bit)
+ * @tparam NumRegisters number of registers in the map */
+template<class Word = BitsLocation::AddressableUnit, unsigned NumRegisters = 1>
 class BitsAccumulator{
 public:
-    /// Fundamental type being referenced by SignalTracker
-    /** The same type as BitsLocation */
-    using AddressableUnit = BitsLocation::AddressableUnit;
+    /// Type of the register word being accumulated
+    using WordType = Word;
 
-    /// Update the latest value from the source
-    void Refresh(){
-        result |= *source ^ invert;
-    }
+    /// Number of registers being accumulated
+    static constexpr unsigned RegistersCount = NumRegisters;
+
+    /// Location of the single register to accumulate from
+    struct Source{
+        /// Address of the (memory mapped) register
+        const volatile Word* address;
+        /// Bits to be accumulated (1s means selected)
+        Word mask;
+        /// Bits to be inverted before accumulating ("active 0" signals)
+        Word invert;
+    };
+
+    /// Register map describing all registers being accumulated
+    using RegisterMap = Source[NumRegisters];
+
+    /// Tie with registers, map shall outlive the accumulator
+    explicit BitsAccumulator(const RegisterMap& registerMap);
+
+    /// Update the latest value from the register at index
+    void Refresh(unsigned index);
+
+    /// Update the latest values from all registers of the map
+    void RefreshAll();
+
+    /// Accumulate raw value (obtained elsewhere) as if read from index
+    /** Mask and invert from the map apply */
+    void Accumulate(unsigned index, Word rawValue);
+
+    /// Obtain what is accumulated so far for index (nothing is cleared)
+    Word Result(unsigned index) const;
+
+    /// Atomically obtain what is accumulated for index and clear it
+    Word Snapshot(unsigned index);
+
+    /// Atomically obtain and clear all registers (one by one)
+    /** @returns true if at least one bit was accumulated */
+    bool SnapshotAll(Word (&destination)[NumRegisters]);
 
     /// Clear what we have accumulated so far
-    void Clear(){
-        result = 0;
-    }
+    void Clear();
 
-    /// Obtain what is accumulated so far
-    BitsLocation Result(){
-        return BitsLocation(
-            &result,
-            source.Mask()
-        );
-    }
+private:
+    /// Registers map (where to obtain bits from)
+    const Source* registers;
+
+    /// The accumulated result (shared with the place calling Refresh)
+    volatile Word result[NumRegisters];
+
+    /// Operations on result shared with the place calling Refresh
+    using Atomic = InstantSignalsDetails::Atomic<Word>;
+};
+
+
+//activate SignalRouter feature only if InstantScheduler dependency is present 
+#if __has_include("InstantScheduler.h") && __has_include("InstantDelegate.h")
+// Needed for dispatching to MulticastToActions
+#include "InstantScheduler.h"
+// Fast deterministic delegates for invoking callbacks
+#include "InstantDelegate.h"
+
+/// Dispatch changes of bits to handlers registered per bit (signal)
+/** Each snapshot of registers is compared (XOR) with the previous one,
+ * only changed bits having route are visited (count trailing zeroes),
+ * so work is proportional to the number of changes, not to the number
+ * of signals. Routes live in the flat table indexed by signal number
+ * (signal N is bit N % BitsPerWord of the register N / BitsPerWord).
+ * Snapshot can be obtained by the router itself from registers (Poll)
+ * or provided from elsewhere, like BitsDebounce::Value() 
+ * or BitsAccumulator::SnapshotAll (Dispatch).
+ * NOTE: Dispatch/Poll from one place only, handlers are called inside
+ * @tparam Word unsigned type of the register (8/16/32/64 bit)
+ * @tparam NumRegisters number of registers being tracked */
+template<class Word = BitsLocation::AddressableUnit, unsigned NumRegisters = 1>
+class SignalRouter{
+public:
+    /// Type of the register word being tracked
+    using WordType = Word;
+
+    /// Number of signals in single Word
+    static constexpr unsigned BitsPerWord = sizeof(Word) * 8;
+    /// Total number of signals that can be routed
+    static constexpr unsigned SignalsCount = NumRegisters * BitsPerWord;
+
+    /// Handler called with the new value of the changed signal
+    using Handler = Delegate<void(bool newValue)>;
+
+    /// Addresses of (memory mapped) registers to be used by Poll
+    using Registers = const volatile Word* const[NumRegisters];
+
+    /// Router for snapshots provided to Dispatch (Poll is not available)
+    SignalRouter();
+
+    /// Router able to Poll registers, array shall outlive the router
+    /** Initial snapshot is taken from registers right now */
+    explicit SignalRouter(const Registers& registersToPoll);
+
+    /// Call handler each time signal changes (replaces previous route)
+    void Route(unsigned signal, const Handler& handler);
+
+    /// Trigger multicast each time signal changes (replaces previous route)
+    void Route(unsigned signal, MulticastToActions& multicast);
+
+    /// Stop dispatching changes of the signal
+    void Unroute(unsigned signal);
+
+    /// Test there is route for the signal
+    bool IsRouted(unsigned signal) const;
+
+    /// Read all registers and dispatch changes
+    /** @returns number of handlers being called */
+    unsigned Poll();
+
+    /// Dispatch changes between provided snapshot and the previous one
+    /** @returns number of handlers being called */
+    unsigned Dispatch(const Word (&snapshot)[NumRegisters]);
+
+    /// Dispatch changes of the single register
+    /** @returns number of handlers being called */
+    unsigned Dispatch(unsigned index, Word value);
+
+    /// Take values as known without dispatching anything
+    void Reset(const Word (&snapshot)[NumRegisters]);
+
+    /// Value of the register at index known from the last snapshot
+    Word Previous(unsigned index) const;
 
 private:
-    /// Real location where to obtain  
-    BitsLocation source;
+    /// Allow arrays of delegates (there is no default Delegate) 
+    class Slot: public Handler{
+    public:
+        Slot() : Handler(&doNothing) {}
+        using Handler::operator=;
+    };
+    /// Placeholder for signals not being routed
+    static void doNothing(bool){}
+
+    /// Used to route to MulticastToActions via Handler
+    static void triggerMulticast(class MulticastToActions& multicast, bool);
 
-    /// Those bytes, that need to be inverted (it is assumed "active 1")
-    AddressableUnit invert = 0;
+    /// Index of the lowest bit being set (value shall not be 0)
+    static unsigned countTrailingZeroes(Word value);
 
-    /// The accumulated result
-    AddressableUnit result = 0;
+    /// Tag to select builtin by Word being wider than unsigned long long
+    template<bool wide>
+    struct WordWidth{};
+    static unsigned countTrailingZeroes(Word value, WordWidth<false>);
+    static unsigned countTrailingZeroes(Word value, WordWidth<true>);
+
+    /// Registers being read by Poll (if any)
+    const volatile Word* const* registers = nullptr;
+
+    /// The last known snapshot
+    Word previous[NumRegisters];
+    /// Bits having route (changes of other bits are ignored)
+    Word routed[NumRegisters];
+    /// Flat table of routes (index is signal)
+    Slot handlers[SignalsCount];
 };
 
 #endif
+
+
+//______________________________________________________________________________
+//##############################################################################
+/*==============================================================================
+*  Implementation details follow                                               *
+*=============================================================================*/
+//##############################################################################
+
+//______________________________________________________________________________
+// Implementing InstantSignalsDetails::Atomic
+
+template<class Word>
+Word InstantSignalsDetails::Atomic<Word>::FetchOr(volatile Word* target, Word bits){
+    return FetchOr(target, bits, Implementation<UsesBuiltins>());
+}
+
+template<class Word>
+Word InstantSignalsDetails::Atomic<Word>::FetchAnd(volatile Word* target, Word bits){
+    return FetchAnd(target, bits, Implementation<UsesBuiltins>());
+}
+
+template<class Word>
+Word InstantSignalsDetails::Atomic<Word>::FetchXor(volatile Word* target, Word bits){
+    return FetchXor(target, bits, Implementation<UsesBuiltins>());
+}
+
+template<class Word>
+Word InstantSignalsDetails::Atomic<Word>::Exchange(volatile Word* target, Word value){
+    return Exchange(target, value, Implementation<UsesBuiltins>());
+}
+
+template<class Word>
+Word InstantSignalsDetails::Atomic<Word>::AssignMasked(
+    volatile Word* target, Word mask, Word value
+){
+    return AssignMasked(target, mask, value, Implementation<UsesBuiltins>());
+}
+
+#if defined(InstantSignals_MutexObjectType)
+template<class Word>
+InstantSignals_MutexObjectType 
+    InstantSignalsDetails::Atomic<Word>::InstantSignals_MutexObjectVariable;
+#endif
+
+#ifdef InstantSignals_UseBuiltinAtomics
+
+template<class Word>
+Word InstantSignalsDetails::Atomic<Word>::FetchOr(
+    volatile Word* target, Word bits, Implementation<true>
+){
+    return __atomic_fetch_or(target, bits, __ATOMIC_ACQ_REL);
+}
+
+template<class Word>
+Word InstantSignalsDetails::Atomic<Word>::FetchAnd(
+    volatile Word* target, Word bits, Implementation<true>
+){
+    return __atomic_fetch_and(target, bits, __ATOMIC_ACQ_REL);
+}
+
+template<class Word>
+Word InstantSignalsDetails::Atomic<Word>::FetchXor(
+    volatile Word* target, Word bits, Implementation<true>
+){
+    return __atomic_fetch_xor(target, bits, __ATOMIC_ACQ_REL);
+}
+
+template<class Word>
+Word InstantSignalsDetails::Atomic<Word>::Exchange(
+    volatile Word* target, Word value, Implementation<true>
+){
+    return __atomic_exchange_n(target, value, __ATOMIC_ACQ_REL);
+}
+
+template<class Word>
+Word InstantSignalsDetails::Atomic<Word>::AssignMasked(
+    volatile Word* target, Word mask, Word value, Implementation<true>
+){
+    // compare and swap loop (expected is refreshed on failure)
+    Word expected = __atomic_load_n(target, __ATOMIC_RELAXED);
+    while( !__atomic_compare_exchange_n(
+                target, &expected,
+                static_cast<Word>((expected & ~mask) | (value & mask)),
+                true, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED) )
+    {}
+    return expected;
+}
+
+#endif
+
+template<class Word>
+Word InstantSignalsDetails::Atomic<Word>::FetchOr(
+    volatile Word* target, Word bits, Implementation<false>
+){
+    Word res;
+    InstantSignals_EnterCritical
+        res = *target;
+        *target = static_cast<Word>(res | bits);
+    InstantSignals_LeaveCritical
+    return res;
+}
+
+template<class Word>
+Word InstantSignalsDetails::Atomic<Word>::FetchAnd(
+    volatile Word* target, Word bits, Implementation<false>
+){
+    Word res;
+    InstantSignals_EnterCritical
+        res = *target;
+        *target = static_cast<Word>(res & bits);
+    InstantSignals_LeaveCritical
+    return res;
+}
+
+template<class Word>
+Word InstantSignalsDetails::Atomic<Word>::FetchXor(
+    volatile Word* target, Word bits, Implementation<false>
+){
+    Word res;
+    InstantSignals_EnterCritical
+        res = *target;
+        *target = static_cast<Word>(res ^ bits);
+    InstantSignals_LeaveCritical
+    return res;
+}
+
+template<class Word>
+Word InstantSignalsDetails::Atomic<Word>::Exchange(
+    volatile Word* target, Word value, Implementation<false>
+){
+    Word res;
+    InstantSignals_EnterCritical
+        res = *target;
+        *target = value;
+    InstantSignals_LeaveCritical
+    return res;
+}
+
+template<class Word>
+Word InstantSignalsDetails::Atomic<Word>::AssignMasked(
+    volatile Word* target, Word mask, Word value, Implementation<false>
+){
+    Word res;
+    InstantSignals_EnterCritical
+        res = *target;
+        *target = static_cast<Word>((res & ~mask) | (value & mask));
+    InstantSignals_LeaveCritical
+    return res;
+}
+
+
+//______________________________________________________________________________
+// Implementing BitsLocation
+
+inline void BitsLocation::AtomicSet(){
+#ifdef InstantSignals_AtomicSetBits
+    InstantSignals_AtomicSetBits(address, mask);
+#else
+    InstantSignalsDetails::Atomic<AddressableUnit>::FetchOr(address, mask);
+#endif
+}
+
+inline void BitsLocation::AtomicSet(AddressableUnit newValue){
+#if defined(InstantSignals_AtomicAssignBits)
+    InstantSignals_AtomicAssignBits(address, mask, newValue);
+#elif defined(InstantSignals_AtomicSetBits) && defined(InstantSignals_AtomicClearBits)
+    InstantSignals_AtomicSetBits(address, static_cast<AddressableUnit>(mask & newValue));
+    InstantSignals_AtomicClearBits(address, static_cast<AddressableUnit>(mask & ~newValue));
+#else
+    InstantSignalsDetails::Atomic<AddressableUnit>::AssignMasked(address, mask, newValue);
+#endif
+}
+
+inline void BitsLocation::AtomicClear(){
+#ifdef InstantSignals_AtomicClearBits
+    InstantSignals_AtomicClearBits(address, mask);
+#else
+    InstantSignalsDetails::Atomic<AddressableUnit>::FetchAnd(
+        address, static_cast<AddressableUnit>(~mask)
+    );
+#endif
+}
+
+inline void BitsLocation::AtomicToggle(){
+    InstantSignalsDetails::Atomic<AddressableUnit>::FetchXor(address, mask);
+}
+
+
+//______________________________________________________________________________
+// Implementing BitsAccumulator
+
+template<class Word, unsigned NumRegisters>
+BitsAccumulator<Word, NumRegisters>::BitsAccumulator(const RegisterMap& registerMap)
+    : registers(registerMap)
+{
+    for(unsigned i = 0; i < NumRegisters; ++i){
+        result[i] = 0;
+    }
+}
+
+template<class Word, unsigned NumRegisters>
+void BitsAccumulator<Word, NumRegisters>::Refresh(unsigned index){
+    Accumulate(index, *registers[index].address);
+}
+
+template<class Word, unsigned NumRegisters>
+void BitsAccumulator<Word, NumRegisters>::RefreshAll(){
+    for(unsigned i = 0; i < NumRegisters; ++i){
+        Accumulate(i, *registers[i].address);
+    }
+}
+
+template<class Word, unsigned NumRegisters>
+void BitsAccumulator<Word, NumRegisters>::Accumulate(unsigned index, Word rawValue){
+    const Source& src = registers[index];
+    const Word bits = static_cast<Word>((rawValue ^ src.invert) & src.mask);
+    if( bits ){
+        // skip writing shared memory when there is nothing to add
+        Atomic::FetchOr(&result[index], bits);
+    }
+}
+
+template<class Word, unsigned NumRegisters>
+Word BitsAccumulator<Word, NumRegisters>::Result(unsigned index) const{
+    return result[index];
+}
+
+template<class Word, unsigned NumRegisters>
+Word BitsAccumulator<Word, NumRegisters>::Snapshot(unsigned index){
+    return Atomic::Exchange(&result[index], 0);
+}
+
+template<class Word, unsigned NumRegisters>
+bool BitsAccumulator<Word, NumRegisters>::SnapshotAll(Word (&destination)[NumRegisters]){
+    Word any = 0;
+    for(unsigned i = 0; i < NumRegisters; ++i){
+        any |= (destination[i] = Atomic::Exchange(&result[i], 0));
+    }
+    return any != 0;
+}
+
+template<class Word, unsigned NumRegisters>
+void BitsAccumulator<Word, NumRegisters>::Clear(){
+    for(unsigned i = 0; i < NumRegisters; ++i){
+        Atomic::Exchange(&result[i], 0);
+    }
+}
+
+#if __has_include("InstantScheduler.h") && __has_include("InstantDelegate.h")
+
+//______________________________________________________________________________
+// Implementing SignalRouter
+
+template<class Word, unsigned NumRegisters>
+SignalRouter<Word, NumRegisters>::SignalRouter(){
+    for(unsigned i = 0; i < NumRegisters; ++i){
+        previous[i] = 0;
+        routed[i] = 0;
+    }
+}
+
+template<class Word, unsigned NumRegisters>
+SignalRouter<Word, NumRegisters>::SignalRouter(const Registers& registersToPoll)
+    : registers(registersToPoll)
+{
+    for(unsigned i = 0; i < NumRegisters; ++i){
+        previous[i] = *registers[i];
+        routed[i] = 0;
+    }
+}
+
+template<class Word, unsigned NumRegisters>
+void SignalRouter<Word, NumRegisters>::Route(unsigned signal, const Handler& handler){
+    if( signal >= SignalsCount ){
+        InstantSignals_Panic();
+    }
+    handlers[signal] = handler;
+    routed[signal / BitsPerWord] |= static_cast<Word>(Word(1) << (signal % BitsPerWord));
+}
+
+template<class Word, unsigned NumRegisters>
+void SignalRouter<Word, NumRegisters>::Route(unsigned signal, MulticastToActions& multicast){
+    Route(signal, Handler::From(multicast).template Bind<&triggerMulticast>());
+}
+
+template<class Word, unsigned NumRegisters>
+void SignalRouter<Word, NumRegisters>::Unroute(unsigned signal){
+    if( signal >= SignalsCount ){
+        InstantSignals_Panic();
+    }
+    routed[signal / BitsPerWord] &= static_cast<Word>(~(Word(1) << (signal % BitsPerWord)));
+    handlers[signal] = Handler(&doNothing);
+}
+
+template<class Word, unsigned NumRegisters>
+bool SignalRouter<Word, NumRegisters>::IsRouted(unsigned signal) const{
+    return (routed[signal / BitsPerWord] >> (signal % BitsPerWord)) & 1;
+}
+
+template<class Word, unsigned NumRegisters>
+unsigned SignalRouter<Word, NumRegisters>::Poll(){
+    if( !registers ){
+        InstantSignals_Panic();
+    }
+    unsigned dispatched = 0;
+    for(unsigned i = 0; i < NumRegisters; ++i){
+        dispatched += Dispatch(i, *registers[i]);
+    }
+    return dispatched;
+}
+
+template<class Word, unsigned NumRegisters>
+unsigned SignalRouter<Word, NumRegisters>::Dispatch(const Word (&snapshot)[NumRegisters]){
+    unsigned dispatched = 0;
+    for(unsigned i = 0; i < NumRegisters; ++i){
+        dispatched += Dispatch(i, snapshot[i]);
+    }
+    return dispatched;
+}
+
+template<class Word, unsigned NumRegisters>
+unsigned SignalRouter<Word, NumRegisters>::Dispatch(unsigned index, Word value){
+    Word changes = static_cast<Word>((value ^ previous[index]) & routed[index]);
+    // remember before calling handlers (they can Dispatch/Reset again)
+    previous[index] = value;
+
+    unsigned dispatched = 0;
+    const Slot* registerHandlers = handlers + index * BitsPerWord;
+    while( changes ){
+        const unsigned bit = countTrailingZeroes(changes);
+        changes &= static_cast<Word>(changes - 1); //drop the lowest bit
+        registerHandlers[bit]( (value >> bit) & 1 );
+        ++dispatched;
+    }
+    return dispatched;
+}
+
+template<class Word, unsigned NumRegisters>
+void SignalRouter<Word, NumRegisters>::Reset(const Word (&snapshot)[NumRegisters]){
+    for(unsigned i = 0; i < NumRegisters; ++i){
+        previous[i] = snapshot[i];
+    }
+}
+
+template<class Word, unsigned NumRegisters>
+Word SignalRouter<Word, NumRegisters>::Previous(unsigned index) const{
+    return previous[index];
+}
+
+template<class Word, unsigned NumRegisters>
+void SignalRouter<Word, NumRegisters>::triggerMulticast(
+    class MulticastToActions& multicast, bool
+){
+    multicast();
+}
+
+template<class Word, unsigned NumRegisters>
+unsigned SignalRouter<Word, NumRegisters>::countTrailingZeroes(Word value){
+#if defined(__GNUC__) || defined(__clang__)
+    return countTrailingZeroes(
+        value, WordWidth<(sizeof(Word) > sizeof(unsigned long long))>()
+    );
+#else
+    unsigned res = 0;
+    while( !(value & 1) ){
+        value >>= 1;
+        ++res;
+    }
+    return res;
+#endif
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+template<class Word, unsigned NumRegisters>
+unsigned SignalRouter<Word, NumRegisters>::countTrailingZeroes(
+    Word value, WordWidth<false>
+){
+    return sizeof(Word) <= sizeof(unsigned) ?
+                __builtin_ctz(static_cast<unsigned>(value))
+           : sizeof(Word) <= sizeof(unsigned long) ?
+                __builtin_ctzl(static_cast<unsigned long>(value))
+           :    __builtin_ctzll(static_cast<unsigned long long>(value));
+}
+
+template<class Word, unsigned NumRegisters>
+unsigned SignalRouter<Word, NumRegisters>::countTrailingZeroes(
+    Word value, WordWidth<true>
+){
+    // skip empty lower parts, builtin shall never see 0
+    constexpr unsigned PartBits = sizeof(unsigned long long) * 8;
+    unsigned res = 0;
+    while( !static_cast<unsigned long long>(value) ){
+        value = static_cast<Word>(value >> PartBits);
+        res += PartBits;
+    }
+    return res + __builtin_ctzll(static_cast<unsigned long long>(value));
+}
+#endif
+
+#endif
+
+#endif
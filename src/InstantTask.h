@@ -198,6 +198,8 @@ SOFTWARE.
 #include "InstantThenable.h"
 //Delegate is needed to create compact lambda for "await" 
 #include "InstantDelegate.h"
+//Trace points
+#include "InstantTrace.h"
 
 
 //______________________________________________________________________________
@@ -393,8 +395,53 @@ SOFTWARE.
 #define TaskAwaitForResume(codeThatSchedulesResume) \
     TODO
 
-///TODO
+/// Await for C style callback taking context (void*) and arguments
+/** The task itself is the context, so nothing is allocated:
+ * callbackSignature is the parameter list of the C callback, where context
+ * parameter shall be named context, e.g. (void* context, int status),
+ * callbackSetup is the expression registering TaskCallback::Trampoline
+ * (one static function generated for this await) with this as context,
+ * callback code runs inside Trampoline with task referring to the Task,
+ * to write callback arguments into task fields before the Task resumes
+    @code
+        //C API: void adc_read(int channel, void (*done)(void* ctx, int value), void* ctx);
+        TaskDefine(Sampler){
+            int value = 0;
+
+            TaskBegin(int){
+                for(;;){
+                    TaskAwaitForCallback(
+                        adc_read(3, TaskCallback::Trampoline, this),
+                        (void* context, int value),
+                        task.value = value;
+                    );
+                    TaskYield(value);
+                }
+            }
+            TaskEnd();
+        };
+    @endcode
+    REMEMBER: callback shall be issued once per await (it resumes the Task),
+              it can be issued right from callbackSetup or later from
+              other thread/interrupt, as with other await macros
+    NOTE: Trampoline returns void, callbackSetup cannot contain top level
+          commas (commas inside parentheses of function call are fine) */
 #define TaskAwaitForCallback(callbackSetup, callbackSignature, /*callback code*/...) \
+    do{ \
+        using ThisClassType = InstantTaskDetails::RemoveReference<decltype(*this)>::type; \
+        /* The only static function for this await, the task is the context */ \
+        struct TaskCallback{ \
+            static void Trampoline callbackSignature { \
+                ThisClassType& task = *static_cast<ThisClassType*>(context); \
+                { __VA_ARGS__ } \
+                /* resume coroutine from await, let it decide what happens next */ \
+                task.Internal_ResumeTask_AfterAwait(); \
+            } \
+        }; \
+        TASK_INTERNAL_AWAIT_CALLBACK( \
+            (CppCoroutine_State::Initial + (COROUTINE_PLACE_COUNTER - CppCoroutineState_COUNTER_START)), \
+            [&]{ callbackSetup; }); \
+    } while (false)
 
 
 /// The "the last return" from the Cooperative Task
@@ -480,6 +527,17 @@ public:
         return callerShallContinueExecution;
     }
 
+    /// Helper API to be called from TaskAwaitForCallback macro
+    template<class CallbackSetupT>
+    bool CppTask_AwaitCallback_Suspends(CallbackSetupT&& callbackSetup){
+        CppTask_EnterOperation_ProtectFromRecursion();
+
+        // register "their" callback (this can execute right now!)
+        callbackSetup();
+
+        return CppTask_LeaveOperation_DoesTaskStaySuspended();
+    }
+
     /// Helper API to be called from TaskAwaitToValue macro
     template<class OtherThenableT, class FunctorT>
     bool CppTask_AwaitValue_Suspends(
@@ -670,6 +728,7 @@ namespace InstantTaskDetails{
                 /* Resuming callers shall use .Then to catch moment when task yields */ \
                 return cppTask_State.CppTask_thenable; \
             } \
+            InstantTrace_Count(TaskResume); \
             \
             /* Will jump to the previous saved position (or start from Initial) */\
             switch( cppCoroutine_State.current ){ \
@@ -721,6 +780,20 @@ namespace InstantTaskDetails{
         /*             saved state is not used, next yield will rewrite it */ \
     } while (false)
 
+///Helper macro to form state saving/resume point for C style callback
+#define TASK_INTERNAL_AWAIT_CALLBACK(cppCoroutine_place_id, callbackSetupFunctor) \
+    do{ \
+        /* Remember state to resume for the same cppCoroutine_place_id below */ \
+        COROUTINE_REMEMBER_STATE(cppCoroutine_place_id) \
+        \
+        /* Register "their" callback, it resumes this task */\
+        if( this->cppTask_State.CppTask_AwaitCallback_Suspends(callbackSetupFunctor) ){ \
+            /* Callback was not issued yet, wait for it to resume from the point below */\
+            COROUTINE_INTERNAL_SUSPEND(cppCoroutine_place_id, this->cppTask_State.CppTask_thenable) \
+        } \
+        /* else means: callback was issued by callbackSetup, just continue */ \
+    } while (false)
+
 //TODO: move implementations here
 
 #endif
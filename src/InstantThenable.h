@@ -10,7 +10,8 @@ the need to "block" on OS kernel API calls.
 
 One can treat this as "functional event" to tie producer and consumer.
 (this is NOT a kind of "promise/A+", there is no "thenable chaining",
-    use InstantTask.h to await for multiple "thenable"s in chain!!!)
+    use InstantTask.h to await for multiple "thenable"s in chain!!!
+    ThenableChain only fuses Map/Filter steps into one callback)
 
 Thenable works as "one shot per Then", this means that one needs to
 explicitly "await" again for event by "subscribing" callback to Then.
@@ -32,6 +33,7 @@ NOTE: InstantThenable.h is configurable for interrupt (thread) safety.
       (different objects used from different threads will work as well).
       It is safe to use the same object from different threads/interrupts
       only if that interrupt (thread) safety is configured, see below
+      or ThenableLockFree policy is used (atomic handshake without locking)
 
 
 MIT License
@@ -64,6 +66,12 @@ SOFTWARE.
 #include "InstantDelegate.h"
 //Thenable stores arrived result in "LifetimeManager" allocator member 
 #include "InstantMemory.h"
+//Per instance protection policy (CriticalSectionNone by default)
+#include "InstantCriticalSection.h"
+//Atomic state word for ThenableLockFree policy
+#include "InstantIntrusiveLockFree.h"
+//SharedThenable links waiters into intrusive list
+#include "InstantIntrusiveList.h"
 
 
 //______________________________________________________________________________
@@ -76,6 +84,14 @@ SOFTWARE.
 #   include "InstantRTOS.Config.h"
 #endif
 
+#ifndef InstantThenable_Panic
+#   ifdef InstantRTOS_Panic
+#       define InstantThenable_Panic() InstantRTOS_Panic('N')
+#   else
+#       define InstantThenable_Panic() /* you can customize here! */ do{}while(true)
+#   endif
+#endif
+
 #ifndef InstantThenable_EnterCritical
 #   if defined(InstantRTOS_EnterCritical) && !defined(InstantTask_SuppressEnterCritical)
         //we have access from interrupts and/or multithreading
@@ -106,13 +122,12 @@ SOFTWARE.
 // Public API
 
 //TODO: ThenableWhenAll, ThenableWhenAll
-//TODO: Use auto on global scope to construct thenable chains via expression templates!!!
 
 
-template<class T>
+template<class T, class CriticalSection = CriticalSectionNone>
 class ThenableToResolve;
-template<>
-class ThenableToResolve<void>;
+template<class CriticalSection>
+class ThenableToResolve<void, CriticalSection>;
 
 
 /// Simplest "thenable" to be used as "issue that callback handler once ready"
@@ -134,9 +149,15 @@ class ThenableToResolve<void>;
  *       (there will be as many callback calls 
  *        as many times is the operator() was is called,
  *        but StoredResult will remember only the last one)
- * TaskAwait from InstantTask.h accepts Thenable as a point for resuming */
-template<class T>
-class Thenable: private Delegate< void(const T& result) >{
+ * TaskAwait from InstantTask.h accepts Thenable as a point for resuming
+ * CriticalSection policy (see InstantCriticalSection.h) protects the instance
+ * being resolved from other thread, in addition to InstantThenable_EnterCritical
+ * (CriticalSectionNone costs nothing) */
+template<class T, class CriticalSection = CriticalSectionNone>
+class Thenable:
+    private Delegate< void(const T& result) >,
+    private CriticalSection
+{
 public:
     // cannot copy such Thenable (as there is no "state sharing" for it!)
     Thenable(const Thenable& other) = delete;
@@ -200,7 +221,7 @@ public:
     void ResetCallback();
 
 private:
-    friend class ThenableToResolve<T>;
+    friend class ThenableToResolve<T, CriticalSection>;
 
     /// One can create only ThenableToResolve instances
     /** Thenable can be passed only by reference,
@@ -224,15 +245,15 @@ private:
 };
 
 /// Invocable thenable to allow issuing corresponding callback  
-template<class T>
-class ThenableToResolve: public Thenable<T>{
-    using Base = Thenable<T>;
+template<class T, class CriticalSection>
+class ThenableToResolve: public Thenable<T, CriticalSection>{
+    using Base = Thenable<T, CriticalSection>;
 public:
     //inherit constructors from base as is
     using Base::Base;
 
     /// Type for callback (handler) to be passed to Then
-    using Callback = typename Thenable<T>::Callback;
+    using Callback = typename Base::Callback;
 
     /// Invoke the callback (or remember result)
     /** Allow calling Thenable "event" with const T& result argument,
@@ -257,8 +278,11 @@ public:
  * It is possible to call Thenable<void> before callback is attached,
  * call counts is accumulated and can be obtained via UntrackedEventsCount(),
  * Then(...) or Set(...) API can be used to tie with arrived calls */
-template<>
-class Thenable<void>: private Delegate<void()>{
+template<class CriticalSection>
+class Thenable<void, CriticalSection>:
+    private Delegate<void()>,
+    private CriticalSection
+{
 public:
     // cannot copy such Thenable (as there is no "state sharing" for it!)
     Thenable(const Thenable& other) = delete;
@@ -314,7 +338,7 @@ public:
     void ResetCallback();
 
 private:
-    friend class ThenableToResolve<void>;
+    friend class ThenableToResolve<void, CriticalSection>;
 
     /// One can create only ThenableToResolve instances
     /** Thenable can be passed only by reference,
@@ -333,15 +357,15 @@ private:
 };
 
 /// Invocable thenable to allow issuing corresponding callback  
-template<>
-class ThenableToResolve<void>: public Thenable<void>{
-    using Base = Thenable<void>;
+template<class CriticalSection>
+class ThenableToResolve<void, CriticalSection>: public Thenable<void, CriticalSection>{
+    using Base = Thenable<void, CriticalSection>;
 public:
     //inherit constructors from base as is
     using Base::Base;
 
     /// Type for callback (handler) to be passed to Then
-    using Callback = typename Thenable<void>::Callback;
+    using Callback = typename Base::Callback;
 
     /// Invoke the callback (or remember result)
     /** Allow calling Thenable "event" with const T& result argument,
@@ -373,284 +397,1720 @@ static_assert(
 #endif
 
 
-
 //______________________________________________________________________________
-//##############################################################################
-/*==============================================================================
-*  Implementation details follow                                               *
-*=============================================================================*/
-//##############################################################################
+// Lock-free Thenable (resolved from other thread/interrupt without locking)
+
+/// Policy to tie producer and consumer by atomic state instead of locking
+/** Thenable<T, ThenableLockFree> is a drop-in for awaiting with TaskAwait,
+ * where operator() and Then(...) race as atomic state machine:
+ *    resolved first:   Empty -> ValueStored -> Delivered -> Empty
+ *    subscribed first: Empty -> CallbackSet -> Empty
+ * Uncontended operator() and Then(...) need one CAS each
+ * (taking already stored result needs one more CAS to leave Delivered),
+ * there is no mutex, interrupts stay enabled, and none of sides waits 
+ * for the other, so resolving from interrupt that preempted Then(...)
+ * (and vice versa) is fine.
+ * NOTE: operator() calls shall be serialized (one producer at a time),
+ *       Then(...) calls as well (one consumer at a time), 
+ *       but producer and consumer can race freely.
+ *       Subscribing again before previous callback fired is a bug (panics).
+ * Result is stored in one of two slots, so that operator() never writes
+ * the slot consumer copies from (the latest result still wins) */
+class ThenableLockFree{};
 
+template<class T>
+class ThenableToResolve<T, ThenableLockFree>;
+template<>
+class ThenableToResolve<void, ThenableLockFree>;
 
 
+/// Thenable resolved by atomic state machine (see ThenableLockFree)
 template<class T>
-Thenable<T>::Thenable() : Callback(markerForThenableWithoutSubscription) {
-    Callback::state.untrackedEventsCount = 0;
-}
+class Thenable<T, ThenableLockFree>{
+public:
+    // cannot copy such Thenable (as there is no "state sharing" for it!)
+    Thenable(const Thenable& other) = delete;
+    Thenable& operator=(const Thenable& other) = delete;
 
-template<class T>
-Thenable<T>::Thenable(const Callback& eventCallbackHandler)
-    : Callback(eventCallbackHandler) {}
+    /// The simple signature corresponding to Thenable
+    using Signature = void(const T& result);
+    /// Type for callback (handler) to be passed to Then
+    using Callback = Delegate< Signature >;
 
+    /// Original template type (type of stored value, if any)
+    using ResultType = T;
+    /// Type of the argument received by the callback
+    using ArgumentType = const T&;
 
-template<class T>
-void Thenable<T>::Then(const Callback& eventCallbackHandler){
-#ifdef InstantThenable_NoMultithreadingProtection
-    //check there was a result waiting for that callback
-    if( !storedResult ){
-        //store to wait for future call
-        Callback::operator=(eventCallbackHandler);
-    }
-    else{
-        // call the operator one time as the sign there were other calls
-        
-        /* Make own stack copy to let the callback 
-            to do "other Then" in the same place (this instance is reused) */
-        T copy{static_cast<T&&>(*storedResult)};
 
-        /* Value in storedResult is not needed any more
-            (this also ensures eventCallback can attach other callback
-            via Then withput causing it to immediately fire) */
-        storedResult.DestroyOrPanic();
+    /// Setup initial Thenable to work 
+    Thenable() = default;
 
-        // At least one event is just tracked )) 
-        --Callback::state.untrackedEventsCount;
 
-        /* Just execute callback,
-            any other callback can overwrite it without problems
-            NOTE: forwarding with static_cast<T&&> is useless for now */
-        eventCallbackHandler( copy );
-    }
-#else
-    LifetimeManager<T> storedResultCopy;
+    /// Setup new callback (handler) to execute on ThenableToResolve::operator()
+    /** Callback will execute immediately if Thenable was previously called
+     *  (with the latest result), otherwise once operator() is called.
+     *  Can race with operator() from other thread/interrupt */
+    void Then(const Callback& eventCallbackHandler);
 
-    {InstantThenable_EnterCritical
-        //check there was a result waiting for that callback
-        if( !storedResult ){
-            //store to wait for future call
-            Callback::operator=(eventCallbackHandler);
-        }
-        else{
-            // call the operator one time as the sign there were other calls
-            
-            /* Make own stack copy to let the callback 
-            to do "other Then" in the same place (this instance is reused) */
-            storedResultCopy.Emplace(static_cast<T&&>(*storedResult));
+    /// Explicitly ignore that thenable
+    /** Attach "do nothing" callback (it will "eat" stored result if any) */
+    void ExplicitlyIgnore();
 
-            /* Value in storedResult is not needed any more
-            (this also ensures eventCallback can attach other callback
-                via Then withput causing it to immediately fire) */
-            storedResult.DestroyOrPanic();
+    /// Check there is a result waiting for Then (just a snapshot when racing)
+    bool HasStoredResult() const;
 
-            // At least one event is just tracked )) 
-            --Callback::state.untrackedEventsCount;
-        }
-    InstantThenable_LeaveCritical}
+    /// Reset to initial state (shall not race with operator() and Then)
+    void ResetCallback();
 
-    if( storedResultCopy ){
-        eventCallback( storedResultCopy );
-    }
-#endif
-}
+private:
+    friend class ThenableToResolve<T, ThenableLockFree>;
 
-template<class T>
-void Thenable<T>::Set(const Callback& eventCallback){
-    InstantThenable_EnterCritical
-    storedResult.Destroy(); //we are not interested
-    Callback::operator=(eventCallback);
-    InstantThenable_LeaveCritical
-}
+    /// One can create only ThenableToResolve instances
+    ~Thenable() = default;
 
+    /// Handshake phases (state & PhaseMask), state & Slot selects the slot
+    enum : unsigned {
+        Empty = 0,              ///< Neither result nor callback
+        ValueStored = 1,        ///< Result waits in resultIn(state & Slot)
+        CallbackSet = 2,        ///< Callback waits for operator()
+        Delivered = 3,          ///< Then(...) takes resultIn(state & Slot)
+        DeliveredAndStored = 4, ///< As Delivered, newer result in the other slot
+        PhaseMask = 7,
+        Slot = 8
+    };
+    using Atomic = InstantIntrusiveLockFreeDetails::AtomicLink<unsigned>;
+
+    /// Special helper for ExplicitlyIgnore and initial state
+    static void doNothing(const T&){}
 
-template<class T>
-void Thenable<T>::ExplicitlyIgnore(){
-    Then(doNothing);
-}
+    /// Slot selected by Slot bit
+    LifetimeManager<T>& resultIn(unsigned slot);
 
-template<class T>
-unsigned Thenable<T>::UntrackedEventsCount() const {
-    if( Callback::state.correspondingCaller != markerForThenableWithoutSubscription ){
-        return 0;
-    }
-    return Callback::state.untrackedEventsCount;
-}
+    /// Current phase and slot (changed only by CAS when racing)
+    unsigned volatile state = Empty;
+    /// Written by Then(...) in Empty, read by operator() in CallbackSet
+    Callback callback{ doNothing };
+    /// Slot not referenced by state belongs to operator()
+    LifetimeManager<T> storedResults[2];
+};
 
+/// Invocable lock-free thenable to allow issuing corresponding callback  
 template<class T>
-LifetimeManager<T>& Thenable<T>::StoredResult(){
-    return storedResult;
-}
+class ThenableToResolve<T, ThenableLockFree>: public Thenable<T, ThenableLockFree>{
+    using Base = Thenable<T, ThenableLockFree>;
+public:
+    /// Type for callback (handler) to be passed to Then
+    using Callback = typename Base::Callback;
 
+    /// Invoke the callback (or remember result), can race with Then(...)
+    void operator()(const T& result);
+};
 
-template<class T>
-void Thenable<T>::ResetCallback(){
-    InstantThenable_EnterCritical
-    Callback::state.correspondingCaller = markerForThenableWithoutSubscription;
-    Callback::state.untrackedEventsCount = 0;
-    storedResult.Destroy();
-    InstantThenable_LeaveCritical
-}
 
+/// Callable Event resolved by atomic state machine (see ThenableLockFree)
+/** Here state is either CallbackSet or number of untracked events,
+ * so both operator() and Then(...) need exactly one CAS */
+template<>
+class Thenable<void, ThenableLockFree>{
+public:
+    // cannot copy such Thenable (as there is no "state sharing" for it!)
+    Thenable(const Thenable& other) = delete;
+    Thenable& operator=(const Thenable& other) = delete;
 
-template<class T>
-void ThenableToResolve<T>::operator()(const T& result){
-#ifdef InstantThenable_NoMultithreadingProtection
-    if(     Callback::state.correspondingCaller 
-        !=  Thenable<T>::markerForThenableWithoutSubscription
-    ){
-        //separate copy to allow new subscription inside callback (handler)
-        Delegate< void(const T& result) > copy{ *(Callback*)this };
-
-        Callback::state.correspondingCaller = Thenable<T>::markerForThenableWithoutSubscription;
-        Callback::state.untrackedEventsCount = 0;
-        copy(result);
-    }
-    else{
-        ++Callback::state.untrackedEventsCount;
-        Thenable<T>::storedResult.Force(result);
-    }
-#else
-    Delegate< void(const T& result) > copy{ [](const T& result) {} };
+    /// The simple signature corresponding to Thenable
+    using Signature = void();
+    /// Type for callback (handler) to be passed to Then
+    using Callback = Delegate< Signature >;
 
-    {InstantThenable_EnterCritical
-        if(     Callback::state.correspondingCaller 
-            !=  Thenable<T>::markerForThenableWithoutSubscription
-        ){
-            copy = *static_cast<Callback*>(this);
+    /// Type of the argument received by the callback
+    using ArgumentType = void;
 
-            Callback::state.correspondingCaller = Thenable<T>::markerForThenableWithoutSubscription;
-            Callback::state.untrackedEventsCount = 0;
-        }
-        else{
-            ++Callback::state.untrackedEventsCount;
-            Thenable<T>::storedResult.Force(result);
-        }
-    InstantThenable_LeaveCritical}
 
-    //copy is executed outside of "critical section" to avoid deadlocks
-    copy(result);
-#endif
-}
+    /// Setup initial Thenable to work 
+    Thenable() = default;
 
 
-inline Thenable<void>::Thenable() : Callback(markerForThenableWithoutSubscription) {
-    Callback::state.untrackedEventsCount = 0;
-}
+    /// Setup new callback (handler) to execute on (and after) operator() call
+    /** Callback will execute immediately if Thenable was previously called
+     *  (one untracked event is consumed), otherwise once operator() is called.
+     *  Can race with operator() from other thread/interrupt */
+    void Then(const Callback& eventCallbackHandler);
 
-inline Thenable<void>::Thenable(const Callback& eventCallback)
-    : Callback(eventCallback) {}
+    /// Explicitly ignore that thenable
+    /** Attach "do nothing" callback (it will "eat" one untracked event) */
+    void ExplicitlyIgnore();
 
+    /// Obtain number of event that did not invoke callback (snapshot)
+    unsigned UntrackedEventsCount() const;
 
-inline void Thenable<void>::Then(const Callback& eventCallbackHandler){
-#ifdef InstantThenable_NoMultithreadingProtection
-    if(
-        !(  Callback::state.correspondingCaller != markerForThenableWithoutSubscription
-            && Callback::state.untrackedEventsCount
-        )
-    ){
-        //store to wait for future call
-        Callback::operator=(eventCallbackHandler);
-    }
-    else{
-        // call the operator one time as the sign there were other calls
+    /// Reset to initial state (shall not race with operator() and Then)
+    void ResetCallback();
 
-        // At least one event is just tracked )) 
-        --Callback::state.untrackedEventsCount;
+private:
+    friend class ThenableToResolve<void, ThenableLockFree>;
 
-        /* Just execute callback,
-        any other callback can overwrite it without problems
-        NOTE: forwarding with static_cast<T&&> is useless for now */
-        eventCallbackHandler();
-    }
-#else
-    bool runNow = false;
-    {InstantThenable_EnterCritical
-        //check there was a result waiting for that callback
-        if(
-            !(  Callback::state.correspondingCaller != markerForThenableWithoutSubscription
-                && Callback::state.untrackedEventsCount
-            )
-        ){
-            //store to wait for future call
-            Callback::operator=(eventCallbackHandler);
-        }
-        else{
-            // call the operator one time as the sign there were other calls
+    /// One can create only ThenableToResolve instances
+    ~Thenable() = default;
 
-            // At least one event is just tracked )) 
-            --Callback::state.untrackedEventsCount;
+    /// CallbackSet or untracked events count multiplied by OneEvent
+    enum : unsigned {
+        CallbackSet = 1,
+        OneEvent = 2
+    };
+    using Atomic = InstantIntrusiveLockFreeDetails::AtomicLink<unsigned>;
 
-            runNow = true;
+    /// Special helper for ExplicitlyIgnore and initial state
+    static void doNothing(){}
+
+    /// CallbackSet or number of untracked events (changed only by CAS)
+    unsigned volatile state = 0;
+    /// Written by Then(...) when not CallbackSet, read by operator() otherwise
+    Callback callback{ doNothing };
+};
+
+/// Invocable lock-free thenable to allow issuing corresponding callback  
+template<>
+class ThenableToResolve<void, ThenableLockFree>: public Thenable<void, ThenableLockFree>{
+    using Base = Thenable<void, ThenableLockFree>;
+public:
+    /// Type for callback (handler) to be passed to Then
+    using Callback = Base::Callback;
+
+    /// Invoke the callback (or count event), can race with Then(...)
+    void operator()();
+};
+
+
+//______________________________________________________________________________
+// Thenable chains (expression templates)
+
+namespace InstantThenableDetails{
+    /// The first stage of any chain, pass arguments as is
+    class ChainStart{
+    public:
+        template<class Continuation, class... Args>
+        void Apply(Continuation& continuation, const Args&... args){
+            continuation(args...);
         }
-    InstantThenable_LeaveCritical}
-    
-    if( runNow ){
-        eventCallbackHandler();
-    }
-#endif
+    };
+
+    /// Pass transformed arguments to continuation
+    template<class Transform, class Continuation>
+    class MapContinuation{
+    public:
+        MapContinuation(Transform& transform, Continuation& continuation)
+            : transform(transform), continuation(continuation) {}
+
+        template<class... Args>
+        void operator()(const Args&... args){
+            continuation( transform(args...) );
+        }
+    private:
+        Transform& transform;
+        Continuation& continuation;
+    };
+
+    /// Pass arguments to continuation only if predicate allows
+    template<class Predicate, class Continuation>
+    class FilterContinuation{
+    public:
+        FilterContinuation(Predicate& predicate, Continuation& continuation)
+            : predicate(predicate), continuation(continuation) {}
+
+        template<class... Args>
+        void operator()(const Args&... args){
+            if( predicate(args...) ){
+                continuation(args...);
+            }
+        }
+    private:
+        Predicate& predicate;
+        Continuation& continuation;
+    };
+
+    /// Stage applying Transform to the output of Previous stages
+    template<class Previous, class Transform>
+    class MapStage{
+    public:
+        MapStage(const Previous& previous, const Transform& transform)
+            : previous(previous), transform(transform) {}
+
+        template<class Continuation, class... Args>
+        void Apply(Continuation& continuation, const Args&... args){
+            MapContinuation<Transform, Continuation> next(transform, continuation);
+            previous.Apply(next, args...);
+        }
+    private:
+        Previous previous;
+        Transform transform;
+    };
+
+    /// Stage dropping output of Previous stages unless Predicate allows
+    template<class Previous, class Predicate>
+    class FilterStage{
+    public:
+        FilterStage(const Previous& previous, const Predicate& predicate)
+            : previous(previous), predicate(predicate) {}
+
+        template<class Continuation, class... Args>
+        void Apply(Continuation& continuation, const Args&... args){
+            FilterContinuation<Predicate, Continuation> next(predicate, continuation);
+            previous.Apply(next, args...);
+        }
+    private:
+        Previous previous;
+        Predicate predicate;
+    };
 }
 
-inline void Thenable<void>::Set(const Callback& eventCallback){
-    InstantThenable_EnterCritical
-    Callback::operator=(eventCallback);
-    InstantThenable_LeaveCritical
-}
+template<class Stages, class Handler>
+class ThenableChainHandler;
+
+/// Statically typed chain of transformations for the Thenable result
+/** Each Map(...)/Filter(...) returns new chain type holding all stages
+ * by value, Then(...) completes the chain with the final handler,
+ * resulting ThenableChainHandler is a single functor to be passed to
+ * Thenable::Then (or anywhere Delegate is expected).
+ * There is no allocation and no indirect call between stages,
+ * so compiler fuses the whole chain into the single callback.
+ * Use auto (on global scope or as a member) to keep the chain:
+ @code
+    static auto onPacket = ThenableChain<>()
+        .Map(ParsePacket)                                 // const Raw& -> Packet
+        .Filter([](const Packet& p){ return p.IsValid(); })
+        .Map(ToCommand)                                   // const Packet& -> Command
+        .Then(ExecuteCommand);                            // const Command&
 
+    packetArrived.Then(onPacket);
+ @endcode
+ * NOTE: Delegate holds the chain by reference, so the chain shall live
+ *       as long as Thenable can call it (do not pass temporaries!)
+ * NOTE: Map result is passed to the next stage by const reference
+ *       to the temporary, so there is no extra copy between stages
+ * NOTE: prefer lambdas (functors) for stages, plain function pointer is
+ *       stored as a value and stays indirect call unless optimizer
+ *       proves it constant (wrap into lambda to fuse it for sure) */
+template<class Stages = InstantThenableDetails::ChainStart>
+class ThenableChain{
+public:
+    /// Start the chain (arguments go to the first stage as is)
+    ThenableChain() = default;
 
-inline void Thenable<void>::ExplicitlyIgnore(){
-    Then(doNothing);
-}
+    /// Wrap already combined stages (used by Map and Filter)
+    explicit ThenableChain(const Stages& stages);
 
-inline unsigned Thenable<void>::UntrackedEventsCount() const {
-    if( Callback::state.correspondingCaller != markerForThenableWithoutSubscription ){
-        return 0;
-    }
-    return Callback::state.untrackedEventsCount;
-}
 
-inline void Thenable<void>::ResetCallback(){
-    InstantThenable_EnterCritical
-    Callback::state.correspondingCaller = markerForThenableWithoutSubscription;
-    Callback::state.untrackedEventsCount = 0;
-    InstantThenable_LeaveCritical
-}
+    /// Add stage passing transform(arguments) to the next stage
+    template<class Transform>
+    ThenableChain< InstantThenableDetails::MapStage<Stages, Transform> >
+        Map(Transform transform) const;
 
+    /// Add stage passing arguments further only if predicate(arguments)
+    template<class Predicate>
+    ThenableChain< InstantThenableDetails::FilterStage<Stages, Predicate> >
+        Filter(Predicate predicate) const;
 
-inline void ThenableToResolve<void>::operator()(){
-#ifdef InstantThenable_NoMultithreadingProtection
-    if(     Callback::state.correspondingCaller 
-        !=  Thenable<void>::markerForThenableWithoutSubscription
-    ){
-        //separate copy to allow new subscription inside callback (handler)
-        Delegate<void()> copy{ *(Callback*)this };
+    /// Complete the chain with the final handler
+    template<class Handler>
+    ThenableChainHandler<Stages, Handler> Then(Handler handler) const;
 
-        Callback::state.correspondingCaller = Thenable<void>::markerForThenableWithoutSubscription;
-        Callback::state.untrackedEventsCount = 0;
+private:
+    Stages stages;
+};
 
-        copy();
-    }
-    else{
-        ++Callback::state.untrackedEventsCount;
-    }
-#else
-    Delegate< void() > copy{ []() {} };
+/// Completed chain, the single functor to be passed to Thenable::Then
+template<class Stages, class Handler>
+class ThenableChainHandler{
+public:
+    /// Combine stages with the final handler
+    ThenableChainHandler(const Stages& stages, const Handler& handler);
 
-    {InstantThenable_EnterCritical
-        if(     Callback::state.correspondingCaller 
-            !=  Thenable<void>::markerForThenableWithoutSubscription
-        ){
-            copy = *static_cast<Callback*>(this);
+    /// Run all the stages and the handler (inlined as single call)
+    template<class... Args>
+    void operator()(const Args&... args);
 
-            Callback::state.correspondingCaller = markerForThenableWithoutSubscription;
-            Callback::state.untrackedEventsCount = 0;
-        }
-        else{
-            ++Callback::state.untrackedEventsCount;
-        }
-    InstantThenable_LeaveCritical}
+private:
+    Stages stages;
+    Handler handler;
+};
 
-    //copy is executed outside of "critical section" to avoid deadlocks
-    copy();
-#endif
+
+//______________________________________________________________________________
+// Thenable with multiple waiters
+
+template<class T, class CriticalSection = CriticalSectionNone>
+class SharedThenable;
+template<class T, class CriticalSection = CriticalSectionNone>
+class SharedThenableToResolve;
+template<class CriticalSection>
+class SharedThenableToResolve<void, CriticalSection>;
+
+
+/// Thenable to be awaited by many waiters at once (like "config loaded")
+/** Each waiter embeds own SharedThenable::Waiter node (usually as a field
+ * of the awaiting task), so there is no allocation per waiter,
+ * and all waiters are linked into intrusive list.
+ * SharedThenableToResolve::operator() stores the result and wakes all
+ * the waiters in one pass, while waiters subscribed after that
+ * (late subscribers) receive the stored result immediately.
+ * Result stays stored until ResetResult() (this is a "latch"),
+ * resolving again replaces stored result.
+ * Waiter has Then(...) API, so it can be passed to TaskAwait directly:
+ @code
+    SharedThenableToResolve<Config> configLoaded;
+
+    class Worker: public Task<>{ //each worker waits on own node
+        SharedThenable<Config>::Waiter configWaiter{configLoaded};
+        Config config;
+        ...
+        TaskAwaitToField(config, configWaiter);
+        ...
+    };
+ @endcode
+ * CriticalSection policy (see InstantCriticalSection.h) protects the instance
+ * being resolved from other thread, in addition to InstantThenable_EnterCritical
+ * (CriticalSectionNone costs nothing) */
+template<class T, class CriticalSection>
+class SharedThenable: private CriticalSection{
+public:
+    // cannot copy such Thenable (waiters are linked to it!)
+    SharedThenable(const SharedThenable& other) = delete;
+    SharedThenable& operator=(const SharedThenable& other) = delete;
+
+    /// The simple signature corresponding to Thenable
+    using Signature = void(const T& result);
+    /// Type for callback (handler) to be passed to Then
+    using Callback = Delegate< Signature >;
+
+    /// Original template type (type of stored value)
+    using ResultType = T;
+    /// Type of the argument received by the callback
+    using ArgumentType = const T&;
+
+
+    /// Node to be embedded into each awaiting object
+    /** Forgets subscription (if any) when destroyed */
+    class Waiter: public IntrusiveList<Waiter>::Node{
+    public:
+        /// Waiter for the result of source
+        explicit Waiter(SharedThenable& source);
+        ~Waiter();
+
+        /// Subscribe callback to the source (see SharedThenable::Then)
+        void Then(const Callback& eventCallbackHandler);
+
+        /// Unsubscribe (callback will not be called)
+        void Forget();
+
+        /// Test this waiter is subscribed and waits for the result
+        bool IsWaiting() const;
+
+    private:
+        friend class SharedThenable;
+        friend class SharedThenableToResolve<T, CriticalSection>;
+
+        /// Thenable this waiter subscribes to
+        SharedThenable& source;
+        /// The one shot callback to be issued on resolve
+        Callback callback{ doNothing };
+    };
+
+
+    /// Setup initial (not resolved) SharedThenable
+    SharedThenable() = default;
+
+    /// Subscribe waiter to be called once with the result
+    /** Callback will execute immediately if the result is already stored,
+     *  otherwise waiter is linked to the list until operator() is called.
+     *  Subscribing already waiting waiter replaces its callback */
+    void Then(Waiter& waiter, const Callback& eventCallbackHandler);
+
+    /// Unsubscribe waiter (callback will not be called)
+    void Forget(Waiter& waiter);
+
+    /// Test result is stored (late subscribers are called immediately)
+    bool IsResolved() const;
+
+    /// Forget stored result, so that waiters wait for the next resolve
+    void ResetResult();
+
+private:
+    friend class SharedThenableToResolve<T, CriticalSection>;
+
+    /// One can create only SharedThenableToResolve instances
+    ~SharedThenable() = default;
+
+    /// Special helper for initial waiter callback
+    static void doNothing(const T&){}
+
+    /// Waiters subscribed before result arrived
+    IntrusiveList<Waiter> waiters;
+    /// Result delivered to late subscribers
+    LifetimeManager<T> storedResult;
+
+#if !defined(InstantThenable_NoMultithreadingProtection) && defined(InstantThenable_MutexObjectType)
+    InstantThenable_MutexObjectType InstantThenable_MutexObjectVariable;
+#endif
+};
+
+/// Invocable shared thenable to wake all the waiters
+template<class T, class CriticalSection>
+class SharedThenableToResolve: public SharedThenable<T, CriticalSection>{
+    using Base = SharedThenable<T, CriticalSection>;
+public:
+    /// Type for callback (handler) to be passed to Then
+    using Callback = typename Base::Callback;
+
+    /// Store result and call all the waiters (in order of subscription)
+    /** Waiters can subscribe again from own callback
+     *  (they will be called immediately as result is stored) */
+    void operator()(const T& result);
+};
+
+
+/// Event to be awaited by many waiters at once
+/** Special case of SharedThenable<void>, remembers the fact of call */
+template<class CriticalSection>
+class SharedThenable<void, CriticalSection>: private CriticalSection{
+public:
+    // cannot copy such Thenable (waiters are linked to it!)
+    SharedThenable(const SharedThenable& other) = delete;
+    SharedThenable& operator=(const SharedThenable& other) = delete;
+
+    /// The simple signature corresponding to Thenable
+    using Signature = void();
+    /// Type for callback (handler) to be passed to Then
+    using Callback = Delegate< Signature >;
+
+    /// Type of the argument received by the callback
+    using ArgumentType = void;
+
+
+    /// Node to be embedded into each awaiting object
+    /** Forgets subscription (if any) when destroyed */
+    class Waiter: public IntrusiveList<Waiter>::Node{
+    public:
+        /// Waiter for the event of source
+        explicit Waiter(SharedThenable& source);
+        ~Waiter();
+
+        /// Subscribe callback to the source (see SharedThenable::Then)
+        void Then(const Callback& eventCallbackHandler);
+
+        /// Unsubscribe (callback will not be called)
+        void Forget();
+
+        /// Test this waiter is subscribed and waits for the event
+        bool IsWaiting() const;
+
+    private:
+        friend class SharedThenable;
+        friend class SharedThenableToResolve<void, CriticalSection>;
+
+        /// Thenable this waiter subscribes to
+        SharedThenable& source;
+        /// The one shot callback to be issued on resolve
+        Callback callback{ doNothing };
+    };
+
+
+    /// Setup initial (not resolved) SharedThenable
+    SharedThenable() = default;
+
+    /// Subscribe waiter to be called once the event happens
+    /** Callback will execute immediately if event already happened,
+     *  otherwise waiter is linked to the list until operator() is called */
+    void Then(Waiter& waiter, const Callback& eventCallbackHandler);
+
+    /// Unsubscribe waiter (callback will not be called)
+    void Forget(Waiter& waiter);
+
+    /// Test event already happened (late subscribers are called immediately)
+    bool IsResolved() const;
+
+    /// Forget the event, so that waiters wait for the next one
+    void ResetResult();
+
+private:
+    friend class SharedThenableToResolve<void, CriticalSection>;
+
+    /// One can create only SharedThenableToResolve instances
+    ~SharedThenable() = default;
+
+    /// Special helper for initial waiter callback
+    static void doNothing(){}
+
+    /// Waiters subscribed before event happened
+    IntrusiveList<Waiter> waiters;
+    /// Event happened (late subscribers are called immediately)
+    bool resolved = false;
+
+#if !defined(InstantThenable_NoMultithreadingProtection) && defined(InstantThenable_MutexObjectType)
+    InstantThenable_MutexObjectType InstantThenable_MutexObjectVariable;
+#endif
+};
+
+/// Invocable shared event to wake all the waiters
+template<class CriticalSection>
+class SharedThenableToResolve<void, CriticalSection>: public SharedThenable<void, CriticalSection>{
+    using Base = SharedThenable<void, CriticalSection>;
+public:
+    /// Type for callback (handler) to be passed to Then
+    using Callback = typename Base::Callback;
+
+    /// Remember the event and call all the waiters (in order of subscription)
+    void operator()();
+};
+
+
+//______________________________________________________________________________
+// Thenable without embedded result storage
+
+/// Policy for ThenableUnstored/ThenablePooled: panic on result that cannot be kept
+class ThenableUnstoredPanic{
+public:
+    static constexpr bool Panics = true;
+};
+/// Policy for ThenableUnstored/ThenablePooled: silently drop such result
+class ThenableUnstoredDrop{
+public:
+    static constexpr bool Panics = false;
+};
+
+namespace InstantThenableDetails{
+    /// Shared pool of Slots type to borrow result storage from
+    template<class Slots>
+    class BorrowedSlots{
+    public:
+        /// The single pool for all ThenablePooled using Slots
+        static Slots pool;
+        /// Raw block for the result or nullptr when exhausted
+        static void* Allocate(){ return pool.AllocateRaw(); }
+        /// Test T can be placed into the block
+        template<class T>
+        static constexpr bool Fits(){
+            return sizeof(T) <= Slots::SingleBlockSize && alignof(T) <= Slots::BlockAlignment;
+        }
+        /// Test pool is protected whenever owner's CriticalSection is
+        /** (the pool is shared by instances locking only themselves) */
+        template<class CriticalSection>
+        static constexpr bool Protects(){
+            return CriticalSection::IsNoOp || !Slots::CriticalSectionType::IsNoOp;
+        }
+    };
+    /// No slots at all (ThenableUnstored)
+    template<>
+    class BorrowedSlots<void>{
+    public:
+        static void* Allocate(){ return nullptr; }
+        template<class T>
+        static constexpr bool Fits(){ return true; }
+        template<class CriticalSection>
+        static constexpr bool Protects(){ return true; }
+    };
+
+    template<class Slots>
+    Slots BorrowedSlots<Slots>::pool;
+}
+
+template<class T, class Slots, class WhenUnstored, class CriticalSection>
+class ThenableSlimToResolve;
+
+/// Thenable costing one delegate (result is kept only in borrowed slot)
+/** Unlike Thenable there is no LifetimeManager<T> inside, so sizeof(T)
+ * is not paid by every instance: result arriving before subscription
+ * is placed into a block borrowed from the Slots pool (BlockPool type,
+ * single static instance per Slots type, see ThenablePooledSlots),
+ * and the block pointer lives in the free word of unsubscribed delegate.
+ * Block returns to the pool once result is delivered to Then(...).
+ * Slots = void means there is no storage at all (see ThenableUnstored).
+ * WhenUnstored policy decides what happens to the result that cannot be
+ * kept (no slots or pool exhausted): ThenableUnstoredPanic panics,
+ * ThenableUnstoredDrop drops it silently.
+ * NOTE: use aliases ThenableUnstored and ThenablePooled below
+ * CriticalSection policy works as for Thenable */
+template<class T, class Slots, class WhenUnstored, class CriticalSection>
+class ThenableSlim:
+    private Delegate< void(const T& result) >,
+    private CriticalSection
+{
+    static_assert(
+        InstantThenableDetails::BorrowedSlots<Slots>::template Fits<T>(),
+        "Slots blocks shall be large enough and aligned enough for T"
+    );
+    static_assert(
+        InstantThenableDetails::BorrowedSlots<Slots>::template Protects<CriticalSection>(),
+        "Slots shall have own CriticalSection once ThenableSlim is protected"
+    );
+public:
+    // cannot copy such Thenable (as there is no "state sharing" for it!)
+    ThenableSlim(const ThenableSlim& other) = delete;
+    ThenableSlim& operator=(const ThenableSlim& other) = delete;
+
+    /// The simple signature corresponding to Thenable
+    using Signature = void(const T& result);
+    /// Type for callback (handler) to be passed to Then
+    using Callback = Delegate< Signature >;
+
+    /// Original template type (type of stored value, if any)
+    using ResultType = T;
+    /// Type of the argument received by the callback
+    using ArgumentType = const T&;
+
+
+    /// Setup initial Thenable to work 
+    ThenableSlim();
+
+    /// Setup with already attached handler
+    ThenableSlim(const Callback& eventCallbackHandler);
+
+
+    /// Setup new callback (handler) to execute on operator()
+    /** Callback will execute immediately if there is borrowed result
+     *  (block is returned to the pool after callback),
+     *  otherwise once operator() is called */
+    void Then(const Callback& eventCallbackHandler);
+
+    /// Setup new callback to execute only on operator() call
+    /** Borrowed result (if any) is dropped and returned to the pool */
+    void Set(const Callback& eventCallback);
+
+    /// Explicitly ignore that thenable
+    /** Attach "do nothing" callback (it will "eat" borrowed result if any) */
+    void ExplicitlyIgnore();
+
+    /// Test there is a result waiting for Then (in borrowed slot)
+    bool HasStoredResult() const;
+
+    /// Reset to initial state (borrowed result is returned to the pool)
+    void ResetCallback();
+
+private:
+    friend class ThenableSlimToResolve<T, Slots, WhenUnstored, CriticalSection>;
+
+    /// One can create only ThenableSlimToResolve instances
+    ~ThenableSlim();
+
+    /// Just a placeholder to mark "unsubscribed" thenable
+    static void markerForThenableWithoutSubscription(
+        const Callback*, const T&
+    ){}
+
+    /// Special helper for ExplicitlyIgnore
+    static void doNothing(const T&){}
+
+    /// Take borrowed result (if any) leaving unsubscribed without result
+    /** Call only inside critical section */
+    T* takeBorrowedResult();
+
+#if !defined(InstantThenable_NoMultithreadingProtection) && defined(InstantThenable_MutexObjectType)
+    InstantThenable_MutexObjectType InstantThenable_MutexObjectVariable;
+#endif
+};
+
+/// Invocable slim thenable to allow issuing corresponding callback  
+template<class T, class Slots, class WhenUnstored, class CriticalSection>
+class ThenableSlimToResolve: public ThenableSlim<T, Slots, WhenUnstored, CriticalSection>{
+    using Base = ThenableSlim<T, Slots, WhenUnstored, CriticalSection>;
+public:
+    //inherit constructors from base as is
+    using Base::Base;
+
+    /// Type for callback (handler) to be passed to Then
+    using Callback = typename Base::Callback;
+
+    /// Invoke the callback (or keep result in borrowed slot)
+    /** Without subscription result goes to (already borrowed or new) block,
+     *  WhenUnstored policy is applied when there is no block for it */
+    void operator()(const T& result);
+};
+
+
+/// Thenable without any result storage (one delegate of RAM)
+/** Consumer shall subscribe before producer resolves,
+ * otherwise result is handled by WhenUnstored policy (panic by default) */
+template<
+    class T,
+    class WhenUnstored = ThenableUnstoredPanic,
+    class CriticalSection = CriticalSectionNone
+>
+using ThenableUnstored = ThenableSlim<T, void, WhenUnstored, CriticalSection>;
+
+/// Invocable ThenableUnstored
+template<
+    class T,
+    class WhenUnstored = ThenableUnstoredPanic,
+    class CriticalSection = CriticalSectionNone
+>
+using ThenableUnstoredToResolve =
+    ThenableSlimToResolve<T, void, WhenUnstored, CriticalSection>;
+
+/// Thenable borrowing block from the Slots pool only for early result
+/** Slots is BlockPool type with blocks large enough for T, e.g.
+ @code
+    using ReportSlots = BlockPool<sizeof(Report), 4>;
+    ThenablePooledToResolve<Report, ReportSlots> reports[200]; //4 pending at most
+ @endcode
+ * all ThenablePooled with the same Slots share the same pool instance,
+ * so protected ThenablePooled needs protected Slots as well:
+ @code
+    using SharedSlots = BlockPool<
+        sizeof(Report), 4, CommonBlockPool::Metadata, CriticalSectionSpinLock>;
+    ThenablePooledToResolve<
+        Report, SharedSlots, ThenableUnstoredPanic, CriticalSectionSpinLock> shared;
+ @endcode */
+template<
+    class T,
+    class Slots,
+    class WhenUnstored = ThenableUnstoredPanic,
+    class CriticalSection = CriticalSectionNone
+>
+using ThenablePooled = ThenableSlim<T, Slots, WhenUnstored, CriticalSection>;
+
+/// Invocable ThenablePooled
+template<
+    class T,
+    class Slots,
+    class WhenUnstored = ThenableUnstoredPanic,
+    class CriticalSection = CriticalSectionNone
+>
+using ThenablePooledToResolve =
+    ThenableSlimToResolve<T, Slots, WhenUnstored, CriticalSection>;
+
+/// Access the pool shared by all ThenablePooled with Slots (for statistics)
+template<class Slots>
+Slots& ThenablePooledSlots();
+
+
+#ifdef InstantThenable_NoMultithreadingProtection
+static_assert(
+    sizeof( ThenableUnstoredToResolve<int> ) == sizeof( Delegate<void(const int&)> ),
+    "There is a warranty ThenableUnstored costs as corresponding delegate!!!"
+);
+#endif
+
+
+
+//______________________________________________________________________________
+//##############################################################################
+/*==============================================================================
+*  Implementation details follow                                               *
+*=============================================================================*/
+//##############################################################################
+
+
+
+template<class T, class CriticalSection>
+Thenable<T, CriticalSection>::Thenable() : Callback(markerForThenableWithoutSubscription) {
+    Callback::state.untrackedEventsCount = 0;
+}
+
+template<class T, class CriticalSection>
+Thenable<T, CriticalSection>::Thenable(const Callback& eventCallbackHandler)
+    : Callback(eventCallbackHandler) {}
+
+
+template<class T, class CriticalSection>
+void Thenable<T, CriticalSection>::Then(const Callback& eventCallbackHandler){
+#ifdef InstantThenable_NoMultithreadingProtection
+    if( CriticalSection::IsNoOp ){
+        //check there was a result waiting for that callback
+        if( !storedResult ){
+            //store to wait for future call
+            Callback::operator=(eventCallbackHandler);
+        }
+        else{
+            // call the operator one time as the sign there were other calls
+            
+            /* Make own stack copy to let the callback 
+                to do "other Then" in the same place (this instance is reused) */
+            T copy{static_cast<T&&>(*storedResult)};
+
+            /* Value in storedResult is not needed any more
+                (this also ensures eventCallback can attach other callback
+                via Then withput causing it to immediately fire) */
+            storedResult.DestroyOrPanic();
+
+            // At least one event is just tracked )) 
+            --Callback::state.untrackedEventsCount;
+
+            /* Just execute callback,
+                any other callback can overwrite it without problems
+                NOTE: forwarding with static_cast<T&&> is useless for now */
+            eventCallbackHandler( copy );
+        }
+        return;
+    }
+#endif
+    LifetimeManager<T> storedResultCopy;
+
+    {InstantThenable_EnterCritical
+    CriticalSection::Enter();
+        //check there was a result waiting for that callback
+        if( !storedResult ){
+            //store to wait for future call
+            Callback::operator=(eventCallbackHandler);
+        }
+        else{
+            // call the operator one time as the sign there were other calls
+            
+            /* Make own stack copy to let the callback 
+            to do "other Then" in the same place (this instance is reused) */
+            storedResultCopy.Emplace(static_cast<T&&>(*storedResult));
+
+            /* Value in storedResult is not needed any more
+            (this also ensures eventCallback can attach other callback
+                via Then withput causing it to immediately fire) */
+            storedResult.DestroyOrPanic();
+
+            // At least one event is just tracked )) 
+            --Callback::state.untrackedEventsCount;
+        }
+    CriticalSection::Leave();
+    InstantThenable_LeaveCritical}
+
+    if( storedResultCopy ){
+        eventCallbackHandler( *storedResultCopy );
+    }
+}
+
+template<class T, class CriticalSection>
+void Thenable<T, CriticalSection>::Set(const Callback& eventCallback){
+    InstantThenable_EnterCritical
+    CriticalSection::Enter();
+    storedResult.Destroy(); //we are not interested
+    Callback::operator=(eventCallback);
+    CriticalSection::Leave();
+    InstantThenable_LeaveCritical
+}
+
+
+template<class T, class CriticalSection>
+void Thenable<T, CriticalSection>::ExplicitlyIgnore(){
+    Then(doNothing);
+}
+
+template<class T, class CriticalSection>
+unsigned Thenable<T, CriticalSection>::UntrackedEventsCount() const {
+    if( Callback::state.correspondingCaller != markerForThenableWithoutSubscription ){
+        return 0;
+    }
+    return Callback::state.untrackedEventsCount;
+}
+
+template<class T, class CriticalSection>
+LifetimeManager<T>& Thenable<T, CriticalSection>::StoredResult(){
+    return storedResult;
+}
+
+
+template<class T, class CriticalSection>
+void Thenable<T, CriticalSection>::ResetCallback(){
+    InstantThenable_EnterCritical
+    CriticalSection::Enter();
+    Callback::state.correspondingCaller = markerForThenableWithoutSubscription;
+    Callback::state.untrackedEventsCount = 0;
+    storedResult.Destroy();
+    CriticalSection::Leave();
+    InstantThenable_LeaveCritical
+}
+
+
+template<class T, class CriticalSection>
+void ThenableToResolve<T, CriticalSection>::operator()(const T& result){
+#ifdef InstantThenable_NoMultithreadingProtection
+    if( CriticalSection::IsNoOp ){
+        if(     Callback::state.correspondingCaller 
+            !=  Base::markerForThenableWithoutSubscription
+        ){
+            //separate copy to allow new subscription inside callback (handler)
+            Delegate< void(const T& result) > copy{ *(Callback*)this };
+
+            Callback::state.correspondingCaller = Base::markerForThenableWithoutSubscription;
+            Callback::state.untrackedEventsCount = 0;
+            copy(result);
+        }
+        else{
+            ++Callback::state.untrackedEventsCount;
+            Base::storedResult.Force(result);
+        }
+        return;
+    }
+#endif
+    Delegate< void(const T& result) > copy{ [](const T&) {} };
+
+    {InstantThenable_EnterCritical
+    CriticalSection::Enter();
+        if(     Callback::state.correspondingCaller 
+            !=  Base::markerForThenableWithoutSubscription
+        ){
+            copy = *(Callback*)this;
+
+            Callback::state.correspondingCaller = Base::markerForThenableWithoutSubscription;
+            Callback::state.untrackedEventsCount = 0;
+        }
+        else{
+            ++Callback::state.untrackedEventsCount;
+            Base::storedResult.Force(result);
+        }
+    CriticalSection::Leave();
+    InstantThenable_LeaveCritical}
+
+    //copy is executed outside of "critical section" to avoid deadlocks
+    copy(result);
+}
+
+
+template<class CriticalSection>
+Thenable<void, CriticalSection>::Thenable() : Callback(markerForThenableWithoutSubscription) {
+    Callback::state.untrackedEventsCount = 0;
+}
+
+template<class CriticalSection>
+Thenable<void, CriticalSection>::Thenable(const Callback& eventCallback)
+    : Callback(eventCallback) {}
+
+
+template<class CriticalSection>
+void Thenable<void, CriticalSection>::Then(const Callback& eventCallbackHandler){
+#ifdef InstantThenable_NoMultithreadingProtection
+    if( CriticalSection::IsNoOp ){
+        if(
+            !(  Callback::state.correspondingCaller == markerForThenableWithoutSubscription
+                && Callback::state.untrackedEventsCount
+            )
+        ){
+            //store to wait for future call
+            Callback::operator=(eventCallbackHandler);
+        }
+        else{
+            // call the operator one time as the sign there were other calls
+
+            // At least one event is just tracked )) 
+            --Callback::state.untrackedEventsCount;
+
+            /* Just execute callback,
+            any other callback can overwrite it without problems
+            NOTE: forwarding with static_cast<T&&> is useless for now */
+            eventCallbackHandler();
+        }
+        return;
+    }
+#endif
+    bool runNow = false;
+    {InstantThenable_EnterCritical
+    CriticalSection::Enter();
+        //check there was a result waiting for that callback
+        if(
+            !(  Callback::state.correspondingCaller == markerForThenableWithoutSubscription
+                && Callback::state.untrackedEventsCount
+            )
+        ){
+            //store to wait for future call
+            Callback::operator=(eventCallbackHandler);
+        }
+        else{
+            // call the operator one time as the sign there were other calls
+
+            // At least one event is just tracked )) 
+            --Callback::state.untrackedEventsCount;
+
+            runNow = true;
+        }
+    CriticalSection::Leave();
+    InstantThenable_LeaveCritical}
+    
+    if( runNow ){
+        eventCallbackHandler();
+    }
+}
+
+template<class CriticalSection>
+void Thenable<void, CriticalSection>::Set(const Callback& eventCallback){
+    InstantThenable_EnterCritical
+    CriticalSection::Enter();
+    Callback::operator=(eventCallback);
+    CriticalSection::Leave();
+    InstantThenable_LeaveCritical
+}
+
+
+template<class CriticalSection>
+void Thenable<void, CriticalSection>::ExplicitlyIgnore(){
+    Then(doNothing);
+}
+
+template<class CriticalSection>
+unsigned Thenable<void, CriticalSection>::UntrackedEventsCount() const {
+    if( Callback::state.correspondingCaller != markerForThenableWithoutSubscription ){
+        return 0;
+    }
+    return Callback::state.untrackedEventsCount;
+}
+
+template<class CriticalSection>
+void Thenable<void, CriticalSection>::ResetCallback(){
+    InstantThenable_EnterCritical
+    CriticalSection::Enter();
+    Callback::state.correspondingCaller = markerForThenableWithoutSubscription;
+    Callback::state.untrackedEventsCount = 0;
+    CriticalSection::Leave();
+    InstantThenable_LeaveCritical
+}
+
+
+template<class CriticalSection>
+void ThenableToResolve<void, CriticalSection>::operator()(){
+#ifdef InstantThenable_NoMultithreadingProtection
+    if( CriticalSection::IsNoOp ){
+        if(     Callback::state.correspondingCaller 
+            !=  Base::markerForThenableWithoutSubscription
+        ){
+            //separate copy to allow new subscription inside callback (handler)
+            Delegate<void()> copy{ *(Callback*)this };
+
+            Callback::state.correspondingCaller = Base::markerForThenableWithoutSubscription;
+            Callback::state.untrackedEventsCount = 0;
+
+            copy();
+        }
+        else{
+            ++Callback::state.untrackedEventsCount;
+        }
+        return;
+    }
+#endif
+    Delegate< void() > copy{ []() {} };
+
+    {InstantThenable_EnterCritical
+    CriticalSection::Enter();
+        if(     Callback::state.correspondingCaller 
+            !=  Base::markerForThenableWithoutSubscription
+        ){
+            copy = *(Callback*)this;
+
+            Callback::state.correspondingCaller = Base::markerForThenableWithoutSubscription;
+            Callback::state.untrackedEventsCount = 0;
+        }
+        else{
+            ++Callback::state.untrackedEventsCount;
+        }
+    CriticalSection::Leave();
+    InstantThenable_LeaveCritical}
+
+    //copy is executed outside of "critical section" to avoid deadlocks
+    copy();
+}
+
+
+template<class T>
+void Thenable<T, ThenableLockFree>::Then(const Callback& eventCallbackHandler){
+    unsigned current = Atomic::Load(&state);
+    for(;;){
+        const unsigned phase = current & PhaseMask;
+        if( Empty == phase ){
+            //operator() reads callback only after observing CallbackSet
+            callback = eventCallbackHandler;
+            if( Atomic::CompareExchange(&state, current, CallbackSet) ){
+                return;
+            }
+        }
+        else if( ValueStored == phase ){
+            const unsigned slot = current & Slot;
+            //from now operator() will not touch that slot
+            if( Atomic::CompareExchange(&state, current, Delivered | slot) ){
+                /* Make own stack copy to let the callback 
+                    to do "other Then" in the same place (this instance is reused) */
+                T copy{static_cast<T&&>(*resultIn(slot))};
+                resultIn(slot).DestroyOrPanic();
+
+                //newer result could arrive meanwhile, it stays stored
+                current = Delivered | slot;
+                while(
+                    !Atomic::CompareExchange(
+                        &state, current,
+                        DeliveredAndStored == (current & PhaseMask) ?
+                            ValueStored | (slot ^ Slot) : Empty
+                    )
+                ){}
+
+                eventCallbackHandler( copy );
+                return;
+            }
+        }
+        else{
+            //previous subscription is still active (two consumers?)
+            InstantThenable_Panic();
+        }
+        //current is updated by failed CompareExchange, just try again
+    }
+}
+
+template<class T>
+void Thenable<T, ThenableLockFree>::ExplicitlyIgnore(){
+    Then(doNothing);
+}
+
+template<class T>
+bool Thenable<T, ThenableLockFree>::HasStoredResult() const{
+    const unsigned phase = Atomic::Load(const_cast<unsigned volatile*>(&state)) & PhaseMask;
+    return ValueStored == phase || DeliveredAndStored == phase;
+}
+
+template<class T>
+void Thenable<T, ThenableLockFree>::ResetCallback(){
+    Atomic::Store(&state, Empty);
+    callback = doNothing;
+    storedResults[0].Destroy();
+    storedResults[1].Destroy();
+}
+
+template<class T>
+LifetimeManager<T>& Thenable<T, ThenableLockFree>::resultIn(unsigned slot){
+    return storedResults[slot ? 1 : 0];
+}
+
+
+template<class T>
+void ThenableToResolve<T, ThenableLockFree>::operator()(const T& result){
+    using Atomic = typename Base::Atomic;
+
+    bool written = false;
+    unsigned writtenSlot = 0;
+
+    unsigned current = Atomic::Load(&this->state);
+    for(;;){
+        const unsigned phase = current & Base::PhaseMask;
+        const unsigned slot = current & Base::Slot;
+
+        if( Base::CallbackSet == phase ){
+            //Then(...) does not touch callback while in CallbackSet
+            Callback copy{ this->callback };
+            if( Atomic::CompareExchange(&this->state, current, Base::Empty) ){
+                if( written ){
+                    this->resultIn(writtenSlot).Destroy();
+                }
+                copy(result);
+                return;
+            }
+            continue;
+        }
+        if( Base::DeliveredAndStored == phase ){
+            //take back the waiting slot to replace its result
+            if( Atomic::CompareExchange(&this->state, current, Base::Delivered | slot) ){
+                current = Base::Delivered | slot;
+            }
+            continue;
+        }
+
+        //Empty, ValueStored or Delivered: fill the slot state does not reference
+        const unsigned freeSlot =
+            Base::Empty == phase ? writtenSlot : slot ^ Base::Slot;
+        if( !written || freeSlot != writtenSlot ){
+            if( written ){
+                this->resultIn(writtenSlot).Destroy();
+            }
+            this->resultIn(freeSlot).Force(result);
+            written = true;
+            writtenSlot = freeSlot;
+        }
+
+        if( Base::Delivered == phase ){
+            if( Atomic::CompareExchange(&this->state, current, Base::DeliveredAndStored | slot) ){
+                return;
+            }
+        }
+        else if( Atomic::CompareExchange(&this->state, current, Base::ValueStored | freeSlot) ){
+            if( Base::ValueStored == phase ){
+                //previous result is not referenced any more
+                this->resultIn(slot).Destroy();
+            }
+            return;
+        }
+        //current is updated by failed CompareExchange, just try again
+    }
+}
+
+
+inline void Thenable<void, ThenableLockFree>::Then(const Callback& eventCallbackHandler){
+    unsigned current = Atomic::Load(&state);
+    for(;;){
+        if( CallbackSet == current ){
+            //previous subscription is still active (two consumers?)
+            InstantThenable_Panic();
+        }
+        else if( current ){
+            //consume one untracked event and run right now
+            if( Atomic::CompareExchange(&state, current, current - OneEvent) ){
+                eventCallbackHandler();
+                return;
+            }
+        }
+        else{
+            //operator() reads callback only after observing CallbackSet
+            callback = eventCallbackHandler;
+            if( Atomic::CompareExchange(&state, current, CallbackSet) ){
+                return;
+            }
+        }
+        //current is updated by failed CompareExchange, just try again
+    }
+}
+
+inline void Thenable<void, ThenableLockFree>::ExplicitlyIgnore(){
+    Then(doNothing);
+}
+
+inline unsigned Thenable<void, ThenableLockFree>::UntrackedEventsCount() const{
+    const unsigned current = Atomic::Load(const_cast<unsigned volatile*>(&state));
+    return CallbackSet == current ? 0 : current / OneEvent;
+}
+
+inline void Thenable<void, ThenableLockFree>::ResetCallback(){
+    Atomic::Store(&state, 0);
+    callback = doNothing;
+}
+
+
+inline void ThenableToResolve<void, ThenableLockFree>::operator()(){
+    unsigned current = Atomic::Load(&state);
+    for(;;){
+        if( CallbackSet == current ){
+            //Then(...) does not touch callback while in CallbackSet
+            Callback copy{ callback };
+            if( Atomic::CompareExchange(&state, current, 0) ){
+                copy();
+                return;
+            }
+        }
+        else if( Atomic::CompareExchange(&state, current, current + OneEvent) ){
+            return;
+        }
+        //current is updated by failed CompareExchange, just try again
+    }
+}
+
+
+template<class Stages>
+ThenableChain<Stages>::ThenableChain(const Stages& stages)
+    : stages(stages) {}
+
+template<class Stages>
+template<class Transform>
+ThenableChain< InstantThenableDetails::MapStage<Stages, Transform> >
+    ThenableChain<Stages>::Map(Transform transform) const
+{
+    return ThenableChain< InstantThenableDetails::MapStage<Stages, Transform> >(
+        InstantThenableDetails::MapStage<Stages, Transform>(stages, transform)
+    );
+}
+
+template<class Stages>
+template<class Predicate>
+ThenableChain< InstantThenableDetails::FilterStage<Stages, Predicate> >
+    ThenableChain<Stages>::Filter(Predicate predicate) const
+{
+    return ThenableChain< InstantThenableDetails::FilterStage<Stages, Predicate> >(
+        InstantThenableDetails::FilterStage<Stages, Predicate>(stages, predicate)
+    );
+}
+
+template<class Stages>
+template<class Handler>
+ThenableChainHandler<Stages, Handler> ThenableChain<Stages>::Then(Handler handler) const{
+    return ThenableChainHandler<Stages, Handler>(stages, handler);
+}
+
+
+template<class Stages, class Handler>
+ThenableChainHandler<Stages, Handler>::ThenableChainHandler(
+    const Stages& stages, const Handler& handler
+) : stages(stages), handler(handler) {}
+
+template<class Stages, class Handler>
+template<class... Args>
+void ThenableChainHandler<Stages, Handler>::operator()(const Args&... args){
+    stages.Apply(handler, args...);
+}
+
+
+template<class T, class CriticalSection>
+SharedThenable<T, CriticalSection>::Waiter::Waiter(SharedThenable& source)
+    : source(source) {}
+
+template<class T, class CriticalSection>
+SharedThenable<T, CriticalSection>::Waiter::~Waiter(){
+    Forget();
+}
+
+template<class T, class CriticalSection>
+void SharedThenable<T, CriticalSection>::Waiter::Then(const Callback& eventCallbackHandler){
+    source.Then(*this, eventCallbackHandler);
+}
+
+template<class T, class CriticalSection>
+void SharedThenable<T, CriticalSection>::Waiter::Forget(){
+    source.Forget(*this);
+}
+
+template<class T, class CriticalSection>
+bool SharedThenable<T, CriticalSection>::Waiter::IsWaiting() const{
+    return !this->IsChainElementSingle();
+}
+
+
+template<class T, class CriticalSection>
+void SharedThenable<T, CriticalSection>::Then(
+    Waiter& waiter, const Callback& eventCallbackHandler
+){
+#ifdef InstantThenable_NoMultithreadingProtection
+    if( CriticalSection::IsNoOp ){
+        if( storedResult ){
+            //late subscriber, callback can subscribe again or resolve
+            waiter.RemoveFromChain();
+            //own copy, as callback can reset or resolve again
+            const T storedResultCopy( *storedResult );
+            eventCallbackHandler( storedResultCopy );
+        }
+        else{
+            waiter.callback = eventCallbackHandler;
+            waiter.RemoveFromChain();
+            waiters.InsertAtBack(&waiter);
+        }
+        return;
+    }
+#endif
+    LifetimeManager<T> storedResultCopy;
+
+    {InstantThenable_EnterCritical
+    CriticalSection::Enter();
+        waiter.RemoveFromChain();
+        if( storedResult ){
+            //own copy, as other thread can resolve again meanwhile
+            storedResultCopy.Emplace(*storedResult);
+        }
+        else{
+            waiter.callback = eventCallbackHandler;
+            waiters.InsertAtBack(&waiter);
+        }
+    CriticalSection::Leave();
+    InstantThenable_LeaveCritical}
+
+    if( storedResultCopy ){
+        eventCallbackHandler( *storedResultCopy );
+    }
+}
+
+template<class T, class CriticalSection>
+void SharedThenable<T, CriticalSection>::Forget(Waiter& waiter){
+    InstantThenable_EnterCritical
+    CriticalSection::Enter();
+    waiter.RemoveFromChain();
+    CriticalSection::Leave();
+    InstantThenable_LeaveCritical
+}
+
+template<class T, class CriticalSection>
+bool SharedThenable<T, CriticalSection>::IsResolved() const{
+    return static_cast<bool>(storedResult);
+}
+
+template<class T, class CriticalSection>
+void SharedThenable<T, CriticalSection>::ResetResult(){
+    InstantThenable_EnterCritical
+    CriticalSection::Enter();
+    storedResult.Destroy();
+    CriticalSection::Leave();
+    InstantThenable_LeaveCritical
+}
+
+
+template<class T, class CriticalSection>
+void SharedThenableToResolve<T, CriticalSection>::operator()(const T& result){
+    using Waiter = typename Base::Waiter;
+
+    //all current waiters are taken at once, new ones are called immediately
+    IntrusiveList<Waiter> woken;
+    {InstantThenable_EnterCritical
+    CriticalSection::Enter();
+        Base::storedResult.Force(result);
+        woken.SpliceAtBack(Base::waiters);
+    CriticalSection::Leave();
+    InstantThenable_LeaveCritical}
+
+    for(;;){
+        //waiter can Forget or subscribe again meanwhile, so take one by one
+        Callback copy{ Base::doNothing };
+        Waiter* waiter;
+        {InstantThenable_EnterCritical
+        CriticalSection::Enter();
+            waiter = woken.RemoveAtFront();
+            if( waiter ){
+                copy = waiter->callback;
+            }
+        CriticalSection::Leave();
+        InstantThenable_LeaveCritical}
+
+        if( !waiter ){
+            return;
+        }
+        copy(result);
+    }
+}
+
+
+template<class CriticalSection>
+SharedThenable<void, CriticalSection>::Waiter::Waiter(SharedThenable& source)
+    : source(source) {}
+
+template<class CriticalSection>
+SharedThenable<void, CriticalSection>::Waiter::~Waiter(){
+    Forget();
+}
+
+template<class CriticalSection>
+void SharedThenable<void, CriticalSection>::Waiter::Then(const Callback& eventCallbackHandler){
+    source.Then(*this, eventCallbackHandler);
+}
+
+template<class CriticalSection>
+void SharedThenable<void, CriticalSection>::Waiter::Forget(){
+    source.Forget(*this);
+}
+
+template<class CriticalSection>
+bool SharedThenable<void, CriticalSection>::Waiter::IsWaiting() const{
+    return !this->IsChainElementSingle();
+}
+
+
+template<class CriticalSection>
+void SharedThenable<void, CriticalSection>::Then(
+    Waiter& waiter, const Callback& eventCallbackHandler
+){
+    bool runNow = false;
+    {InstantThenable_EnterCritical
+    CriticalSection::Enter();
+        waiter.RemoveFromChain();
+        if( resolved ){
+            runNow = true;
+        }
+        else{
+            waiter.callback = eventCallbackHandler;
+            waiters.InsertAtBack(&waiter);
+        }
+    CriticalSection::Leave();
+    InstantThenable_LeaveCritical}
+
+    if( runNow ){
+        eventCallbackHandler();
+    }
+}
+
+template<class CriticalSection>
+void SharedThenable<void, CriticalSection>::Forget(Waiter& waiter){
+    InstantThenable_EnterCritical
+    CriticalSection::Enter();
+    waiter.RemoveFromChain();
+    CriticalSection::Leave();
+    InstantThenable_LeaveCritical
+}
+
+template<class CriticalSection>
+bool SharedThenable<void, CriticalSection>::IsResolved() const{
+    return resolved;
+}
+
+template<class CriticalSection>
+void SharedThenable<void, CriticalSection>::ResetResult(){
+    InstantThenable_EnterCritical
+    CriticalSection::Enter();
+    resolved = false;
+    CriticalSection::Leave();
+    InstantThenable_LeaveCritical
+}
+
+
+template<class CriticalSection>
+void SharedThenableToResolve<void, CriticalSection>::operator()(){
+    using Waiter = typename Base::Waiter;
+
+    //all current waiters are taken at once, new ones are called immediately
+    IntrusiveList<Waiter> woken;
+    {InstantThenable_EnterCritical
+    CriticalSection::Enter();
+        Base::resolved = true;
+        woken.SpliceAtBack(Base::waiters);
+    CriticalSection::Leave();
+    InstantThenable_LeaveCritical}
+
+    for(;;){
+        //waiter can Forget or subscribe again meanwhile, so take one by one
+        Callback copy{ Base::doNothing };
+        Waiter* waiter;
+        {InstantThenable_EnterCritical
+        CriticalSection::Enter();
+            waiter = woken.RemoveAtFront();
+            if( waiter ){
+                copy = waiter->callback;
+            }
+        CriticalSection::Leave();
+        InstantThenable_LeaveCritical}
+
+        if( !waiter ){
+            return;
+        }
+        copy();
+    }
+}
+
+
+template<class Slots>
+Slots& ThenablePooledSlots(){
+    return InstantThenableDetails::BorrowedSlots<Slots>::pool;
+}
+
+
+template<class T, class Slots, class WhenUnstored, class CriticalSection>
+ThenableSlim<T, Slots, WhenUnstored, CriticalSection>::ThenableSlim()
+    : Callback(markerForThenableWithoutSubscription)
+{
+    Callback::state.theCalleeAsObject = nullptr;
+}
+
+template<class T, class Slots, class WhenUnstored, class CriticalSection>
+ThenableSlim<T, Slots, WhenUnstored, CriticalSection>::ThenableSlim(
+    const Callback& eventCallbackHandler
+) : Callback(eventCallbackHandler) {}
+
+template<class T, class Slots, class WhenUnstored, class CriticalSection>
+ThenableSlim<T, Slots, WhenUnstored, CriticalSection>::~ThenableSlim(){
+    CommonBlockPool::Free( takeBorrowedResult() );
+}
+
+
+template<class T, class Slots, class WhenUnstored, class CriticalSection>
+void ThenableSlim<T, Slots, WhenUnstored, CriticalSection>::Then(
+    const Callback& eventCallbackHandler
+){
+    T* borrowedResult;
+    {InstantThenable_EnterCritical
+    CriticalSection::Enter();
+        borrowedResult = takeBorrowedResult();
+        if( !borrowedResult ){
+            //store to wait for future call
+            Callback::operator=(eventCallbackHandler);
+        }
+    CriticalSection::Leave();
+    InstantThenable_LeaveCritical}
+
+    if( borrowedResult ){
+        /* Block is owned here, so the callback can do "other Then"
+           in the same place without copying the result */
+        eventCallbackHandler( *borrowedResult );
+        CommonBlockPool::Free( borrowedResult );
+    }
+}
+
+template<class T, class Slots, class WhenUnstored, class CriticalSection>
+void ThenableSlim<T, Slots, WhenUnstored, CriticalSection>::Set(
+    const Callback& eventCallback
+){
+    T* borrowedResult;
+    {InstantThenable_EnterCritical
+    CriticalSection::Enter();
+        borrowedResult = takeBorrowedResult(); //we are not interested
+        Callback::operator=(eventCallback);
+    CriticalSection::Leave();
+    InstantThenable_LeaveCritical}
+
+    CommonBlockPool::Free( borrowedResult );
+}
+
+template<class T, class Slots, class WhenUnstored, class CriticalSection>
+void ThenableSlim<T, Slots, WhenUnstored, CriticalSection>::ExplicitlyIgnore(){
+    Then(doNothing);
+}
+
+template<class T, class Slots, class WhenUnstored, class CriticalSection>
+bool ThenableSlim<T, Slots, WhenUnstored, CriticalSection>::HasStoredResult() const{
+    return
+        Callback::state.correspondingCaller == markerForThenableWithoutSubscription
+        && Callback::state.theCalleeAsObject;
+}
+
+template<class T, class Slots, class WhenUnstored, class CriticalSection>
+void ThenableSlim<T, Slots, WhenUnstored, CriticalSection>::ResetCallback(){
+    T* borrowedResult;
+    {InstantThenable_EnterCritical
+    CriticalSection::Enter();
+        borrowedResult = takeBorrowedResult();
+        Callback::state.correspondingCaller = markerForThenableWithoutSubscription;
+        Callback::state.theCalleeAsObject = nullptr;
+    CriticalSection::Leave();
+    InstantThenable_LeaveCritical}
+
+    CommonBlockPool::Free( borrowedResult );
+}
+
+template<class T, class Slots, class WhenUnstored, class CriticalSection>
+T* ThenableSlim<T, Slots, WhenUnstored, CriticalSection>::takeBorrowedResult(){
+    if( Callback::state.correspondingCaller != markerForThenableWithoutSubscription ){
+        return nullptr;
+    }
+    T* borrowedResult = static_cast<T*>(Callback::state.theCalleeAsObject);
+    Callback::state.theCalleeAsObject = nullptr;
+    return borrowedResult;
+}
+
+
+template<class T, class Slots, class WhenUnstored, class CriticalSection>
+void ThenableSlimToResolve<T, Slots, WhenUnstored, CriticalSection>::operator()(
+    const T& result
+){
+    Delegate< void(const T& result) > copy{ Base::doNothing };
+    bool subscribed = false;
+    bool unstored = false;
+
+    {InstantThenable_EnterCritical
+    CriticalSection::Enter();
+        if(     Callback::state.correspondingCaller 
+            !=  Base::markerForThenableWithoutSubscription
+        ){
+            copy = *(Callback*)this;
+            subscribed = true;
+
+            Callback::state.correspondingCaller = Base::markerForThenableWithoutSubscription;
+            Callback::state.theCalleeAsObject = nullptr;
+        }
+        else{
+            //the latest result replaces previous one in the same block
+            void* place = Callback::state.theCalleeAsObject;
+            if( place ){
+                static_cast<T*>(place)->~T();
+            }
+            else{
+                place = InstantThenableDetails::BorrowedSlots<Slots>::Allocate();
+            }
+            if( place ){
+                Callback::state.theCalleeAsObject =
+                    new( InstantMemoryPlaceholderHelper(place) ) T(result);
+            }
+            else{
+                unstored = true;
+            }
+        }
+    CriticalSection::Leave();
+    InstantThenable_LeaveCritical}
+
+    //copy is executed outside of "critical section" to avoid deadlocks
+    if( subscribed ){
+        copy(result);
+    }
+    else if( unstored && WhenUnstored::Panics ){
+        InstantThenable_Panic();
+    }
 }
 
 #endif
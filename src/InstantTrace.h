@@ -0,0 +1,413 @@
+/** @file InstantTrace.h
+    @brief Tiny instrumentation layer: compile time trace points with
+           per thread (per core) counters, compiles to nothing when disabled
+
+All InstantRTOS modules report hot path events through the same
+trace points (scheduler executes, pool allocations, queue pushes,
+task resumes, callback trampolines), so one can see what the system
+actually does without attaching a debugger.
+
+Trace points are compile time IDs (TracePoint enumeration), so
+each event costs one counter increment in the slot of the current
+thread (or core), slots are padded to the cache line, so threads
+never share the line they write. TraceRegistry sums slots
+and enumerates all the points with names for dumping.
+
+Instrumentation is disabled by default, then InstantTrace_Count and
+InstantTrace_Add expand to nothing (arguments are not even evaluated).
+Define InstantTrace_Enable (in InstantRTOS.Config.h or for the whole build)
+to turn it on. Additional application points can be added with
+InstantTrace_UserPoints, see below.
+
+Example usage:
+ @code
+    // InstantRTOS.Config.h or compiler flags
+    #define InstantTrace_Enable
+    #define InstantTrace_UserPoints(X) \
+        X(UartByte, "App.UartByte")
+
+    // somewhere in the hot path
+    InstantTrace_Count(UartByte);
+
+    // periodically, like from the idle loop
+    TraceRegistry::Dump([](const char* name, TraceCounter total){
+        Serial.print(name);
+        Serial.print(F(": "));
+        Serial.println(total);
+    });
+ @endcode
+
+By default slots are assigned to threads on the first event (host platforms
+with thread_local) and given back when the thread exits (counters stay and
+keep growing with the next thread taking the slot), define
+InstantTrace_CurrentSlot() to select slot by core (like get_core_num()
+on RP2040), otherwise single slot is used.
+Counter increment is not atomic read-modify-write on purpose (that is the
+cost of one increment), so events coming from interrupts preempting the
+same slot can occasionally be lost. The last slot is never owned: threads
+not fitting into the others share it and update it atomically (slower,
+but nothing is lost).
+
+MIT License
+
+Copyright (c) 2023 Pavlo M, see https://github.com/olvap80/InstantRTOS
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef InstantTrace_INCLUDED_H
+#define InstantTrace_INCLUDED_H
+
+//______________________________________________________________________________
+// Configurable options (InstantTrace specific)
+
+/* Common configuration to be included only if available
+   (you can separate file and/or configure individually
+    or just skip that to stick with defaults) */
+#if defined(__has_include) && __has_include("InstantRTOS.Config.h")
+#   include "InstantRTOS.Config.h"
+#endif
+
+/* Define InstantTrace_Enable to collect counters
+   (otherwise all InstantTrace_Count/InstantTrace_Add compile to nothing) */
+//#define InstantTrace_Enable
+
+#ifndef InstantTrace_UserPoints
+    /// Application specific trace points X(Name, "Printable.Name")
+#   define InstantTrace_UserPoints(X)
+#endif
+
+#ifndef InstantTrace_CounterType
+    /// Type of each counter (wraps around on overflow)
+#   define InstantTrace_CounterType unsigned long
+#endif
+
+#ifndef InstantTrace_CacheLineSize
+    /// Each slot is aligned (and padded) to this size
+#   define InstantTrace_CacheLineSize 64
+#endif
+
+/* Slots are assigned per thread where thread_local is expected to work
+   (define InstantTrace_SuppressPerThreadSlots to always use single slot) */
+#if !defined(InstantTrace_CurrentSlot) && !defined(InstantTrace_PerThreadSlots) \
+    && !defined(InstantTrace_SuppressPerThreadSlots) \
+    && defined(__has_include) && !defined(ARDUINO) && !defined(__AVR__)
+#   if __has_include(<thread>)
+#       define InstantTrace_PerThreadSlots
+#   endif
+#endif
+
+#ifndef InstantTrace_MaxSlots
+#   if defined(InstantTrace_CurrentSlot) || defined(InstantTrace_PerThreadSlots)
+        /// Number of padded counter sets (threads/cores)
+#       define InstantTrace_MaxSlots 16
+#   else
+#       define InstantTrace_MaxSlots 1
+#   endif
+#endif
+
+
+//______________________________________________________________________________
+// Trace points used by InstantRTOS modules
+
+/// Built in trace points X(Name, "Printable.Name")
+#define InstantTrace_BuiltinPoints(X) \
+    X(SchedulerSchedule,  "Scheduler.Schedule") \
+    X(SchedulerCancel,    "Scheduler.Cancel") \
+    X(SchedulerExecute,   "Scheduler.Execute") \
+    X(SchedulerLateTicks, "Scheduler.LateTicks") \
+    X(PoolAllocate,       "BlockPool.Allocate") \
+    X(PoolExhausted,      "BlockPool.Exhausted") \
+    X(PoolFree,           "BlockPool.Free") \
+    X(QueuePush,          "MpscQueue.Push") \
+    X(StackPush,          "LockFreeStack.Push") \
+    X(TaskResume,         "Task.Resume") \
+    X(CallbackTrampoline, "Callback.Trampoline")
+
+
+//______________________________________________________________________________
+// Public API
+
+#ifdef InstantTrace_Enable
+    /// Count single event for the trace point (like InstantTrace_Count(QueuePush))
+#   define InstantTrace_Count(pointName) \
+        TraceRegistry::Add(TracePoint::pointName, 1)
+    /// Add amount to the trace point (like durations or sizes)
+#   define InstantTrace_Add(pointName, amount) \
+        TraceRegistry::Add(TracePoint::pointName, (amount))
+#else
+#   define InstantTrace_Count(pointName) ((void)0)
+#   define InstantTrace_Add(pointName, amount) ((void)0)
+#endif
+
+
+/// Type of each counter
+using TraceCounter = InstantTrace_CounterType;
+
+/// Compile time IDs for all trace points
+enum class TracePoint: unsigned char{
+#   define InstantTrace_DeclareId(name, printableName) name,
+    InstantTrace_BuiltinPoints(InstantTrace_DeclareId)
+    InstantTrace_UserPoints(InstantTrace_DeclareId)
+#   undef InstantTrace_DeclareId
+    Count ///< Number of trace points (not a trace point)
+};
+
+
+/// Enumerate and sum counters collected so far
+/** Can be used even when InstantTrace_Enable is not defined
+ * (then all counters just stay 0).
+ * Reading is safe while other threads count (values are "recent enough") */
+class TraceRegistry{
+public:
+    /// Number of trace points
+    static constexpr unsigned PointsCount = unsigned(TracePoint::Count);
+    /// Number of slots (threads/cores) counters are kept for
+    static constexpr unsigned MaxSlots = InstantTrace_MaxSlots;
+
+    /// Printable name of the trace point
+    static const char* Name(TracePoint point);
+
+    /// Sum of the trace point over all slots
+    static TraceCounter Total(TracePoint point);
+
+    /// Value of the trace point in specific slot
+    static TraceCounter Value(unsigned slotIndex, TracePoint point);
+
+    /// Number of slots that received events so far
+    static unsigned SlotsUsed();
+
+    /// Call printer(const char* name, TraceCounter total) for each trace point
+    template<class Printer>
+    static void Dump(Printer&& printer);
+
+    /// Set all counters to 0
+    /** Events counted meanwhile by other threads may survive the reset */
+    static void Reset();
+
+    /// Add amount to the trace point in the slot of the current thread/core
+    /** Use InstantTrace_Count/InstantTrace_Add macros instead,
+     * they compile to nothing when InstantTrace_Enable is not defined */
+    static void Add(TracePoint point, TraceCounter amount);
+};
+
+
+
+//______________________________________________________________________________
+//##############################################################################
+/*==============================================================================
+*  Implementation details follow                                               *
+*=============================================================================*/
+//##############################################################################
+
+
+/// Internal storage for TraceRegistry
+namespace InstantTraceDetails{
+    /// Counters of one thread/core (does not share cache line with others)
+    struct alignas(InstantTrace_CacheLineSize) Slot{
+        TraceCounter volatile counters[TraceRegistry::PointsCount];
+    };
+
+    /// Template to have single instance of statics in header only library
+    template<class Dummy = void>
+    struct Storage{
+        static Slot slots[InstantTrace_MaxSlots];
+        /// Number of slots given to threads so far (the highest one used)
+        static unsigned volatile slotsTaken;
+#ifdef InstantTrace_PerThreadSlots
+        /// Nonzero while the slot belongs to running thread
+        static unsigned char volatile slotOwned[InstantTrace_MaxSlots];
+#endif
+    };
+
+    template<class Dummy>
+    Slot Storage<Dummy>::slots[InstantTrace_MaxSlots];
+    template<class Dummy>
+    unsigned volatile Storage<Dummy>::slotsTaken = 0;
+#ifdef InstantTrace_PerThreadSlots
+    template<class Dummy>
+    unsigned char volatile Storage<Dummy>::slotOwned[InstantTrace_MaxSlots] = {};
+#endif
+
+    /// Read counter written by other threads
+    inline TraceCounter Load(TraceCounter volatile* counter){
+#   if (defined(__GNUC__) || defined(__clang__)) && !defined(__AVR__)
+        return __atomic_load_n(counter, __ATOMIC_RELAXED);
+#   else
+        return *counter;
+#   endif
+    }
+
+    /// Write counter that may be read by other threads
+    inline void Store(TraceCounter volatile* counter, TraceCounter value){
+#   if (defined(__GNUC__) || defined(__clang__)) && !defined(__AVR__)
+        __atomic_store_n(counter, value, __ATOMIC_RELAXED);
+#   else
+        *counter = value;
+#   endif
+    }
+
+#ifdef InstantTrace_PerThreadSlots
+    /// Slot shared by threads not fitting into the others (updated atomically)
+    inline Slot* OverflowSlot(){
+        return &Storage<>::slots[InstantTrace_MaxSlots - 1];
+    }
+
+    /// Remember slots up to count were given to threads
+    inline void UpdateSlotsTaken(unsigned count){
+        unsigned taken = __atomic_load_n(&Storage<>::slotsTaken, __ATOMIC_RELAXED);
+        while( taken < count && !__atomic_compare_exchange_n(
+                    &Storage<>::slotsTaken, &taken, count,
+                    true, __ATOMIC_RELAXED, __ATOMIC_RELAXED) )
+        {}
+    }
+
+    /// Give the first free slot to the calling thread
+    inline Slot* TakeSlot(){
+        for(unsigned index = 0; index < InstantTrace_MaxSlots - 1; ++index){
+            unsigned char expected = 0;
+            // acquire: see counters left by the thread owned the slot before
+            if( __atomic_compare_exchange_n(
+                    &Storage<>::slotOwned[index], &expected, static_cast<unsigned char>(1),
+                    false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED) )
+            {
+                UpdateSlotsTaken(index + 1);
+                return &Storage<>::slots[index];
+            }
+        }
+        // too many threads at once, the rest share the last slot
+        UpdateSlotsTaken(InstantTrace_MaxSlots);
+        return OverflowSlot();
+    }
+
+    /// Give the slot (with its counters) back for other threads
+    inline void ReleaseSlot(Slot* slot){
+        if( slot != OverflowSlot() ){
+            __atomic_store_n(
+                &Storage<>::slotOwned[slot - Storage<>::slots],
+                static_cast<unsigned char>(0), __ATOMIC_RELEASE
+            );
+        }
+    }
+
+    /// Slot owned by the thread while the thread runs
+    class ThreadSlot{
+    public:
+        Slot& Get(){
+            if( !slot ){
+                slot = TakeSlot();
+            }
+            return *slot;
+        }
+
+        ~ThreadSlot(){
+            if( slot ){
+                ReleaseSlot(slot);
+            }
+            // events from destructors of other thread_local objects
+            slot = OverflowSlot();
+        }
+
+    private:
+        Slot* slot = nullptr;
+    };
+#endif
+
+    /// Slot of the calling thread/core
+    inline Slot& CurrentSlot(){
+#   if defined(InstantTrace_CurrentSlot)
+        return Storage<>::slots[InstantTrace_CurrentSlot()];
+#   elif defined(InstantTrace_PerThreadSlots)
+        static thread_local ThreadSlot slot;
+        return slot.Get();
+#   else
+        return Storage<>::slots[0];
+#   endif
+    }
+}
+
+
+//______________________________________________________________________________
+// Implementing TraceRegistry
+
+inline const char* TraceRegistry::Name(TracePoint point){
+    static const char* const names[PointsCount] = {
+#   define InstantTrace_DeclareName(name, printableName) printableName,
+        InstantTrace_BuiltinPoints(InstantTrace_DeclareName)
+        InstantTrace_UserPoints(InstantTrace_DeclareName)
+#   undef InstantTrace_DeclareName
+    };
+    return unsigned(point) < PointsCount ? names[unsigned(point)] : "";
+}
+
+inline TraceCounter TraceRegistry::Total(TracePoint point){
+    TraceCounter res = 0;
+    for(unsigned i = 0; i < MaxSlots; ++i){
+        res += Value(i, point);
+    }
+    return res;
+}
+
+inline TraceCounter TraceRegistry::Value(unsigned slotIndex, TracePoint point){
+    return InstantTraceDetails::Load(
+        &InstantTraceDetails::Storage<>::slots[slotIndex].counters[unsigned(point)]
+    );
+}
+
+inline unsigned TraceRegistry::SlotsUsed(){
+#if defined(InstantTrace_CurrentSlot)
+    return MaxSlots;
+#elif defined(InstantTrace_PerThreadSlots)
+    const unsigned taken = __atomic_load_n(&InstantTraceDetails::Storage<>::slotsTaken, __ATOMIC_RELAXED);
+    return taken < MaxSlots ? taken : MaxSlots;
+#else
+    return 1;
+#endif
+}
+
+template<class Printer>
+inline void TraceRegistry::Dump(Printer&& printer){
+    for(unsigned i = 0; i < PointsCount; ++i){
+        printer(Name(TracePoint(i)), Total(TracePoint(i)));
+    }
+}
+
+inline void TraceRegistry::Reset(){
+    for(auto& slot : InstantTraceDetails::Storage<>::slots){
+        for(auto& counter : slot.counters){
+            InstantTraceDetails::Store(&counter, 0);
+        }
+    }
+}
+
+inline void TraceRegistry::Add(TracePoint point, TraceCounter amount){
+    InstantTraceDetails::Slot& slot = InstantTraceDetails::CurrentSlot();
+    TraceCounter volatile* counter = &slot.counters[unsigned(point)];
+#ifdef InstantTrace_PerThreadSlots
+    if( &slot == InstantTraceDetails::OverflowSlot() ){
+        // shared by threads exceeding the slots, increments shall not be lost
+        __atomic_fetch_add(counter, amount, __ATOMIC_RELAXED);
+        return;
+    }
+#endif
+    // plain increment, the slot is written only by the owning thread/core
+    InstantTraceDetails::Store(counter, InstantTraceDetails::Load(counter) + amount);
+}
+
+#endif
@@ -0,0 +1,181 @@
+/** @file tests/test_InstantConcurrentScheduler.cpp
+    @brief Unit tests for InstantConcurrentScheduler.h
+*/
+
+#include "InstantConcurrentScheduler.h"
+
+#include "doctest/doctest.h"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("ConcurrentScheduler executes in time order"){
+    ConcurrentScheduler scheduler;
+    scheduler.Start(100);
+
+    std::string trace;
+    auto a = [&]{ trace += 'a'; };
+    auto b = [&]{ trace += 'b'; };
+    auto c = [&]{ trace += 'c'; };
+    auto d = [&]{ trace += 'd'; };
+    ConcurrentActionNode nodeA(a), nodeB(b), nodeC(c), nodeD(d);
+
+    ConcurrentScheduler::Ticks next = 0;
+    CHECK( !scheduler.HasNextTicks(&next) );
+
+    nodeA.ScheduleAfter(scheduler, 20);
+    nodeB.ScheduleAfter(scheduler, 10);
+    nodeC.ScheduleAfter(scheduler, 20); // same time goes after a
+    nodeD.ScheduleNow(scheduler);
+    CHECK( nodeA.IsScheduled() );
+    CHECK( nodeA.IsInScheduler() );
+
+    CHECK( scheduler.HasNextTicks(&next) );
+    CHECK( next == 100 );
+    CHECK( scheduler.ExecuteAll(100) );
+    CHECK( trace == "d" );
+    CHECK( !nodeD.IsScheduled() );
+    CHECK( !nodeD.IsInScheduler() );
+
+    CHECK( scheduler.HasNextTicks(&next) );
+    CHECK( next == 110 );
+    CHECK( !scheduler.ExecuteAll(109) );
+    CHECK( scheduler.ExecuteOne(125) );
+    CHECK( trace == "db" );
+    CHECK( scheduler.ExecuteAll(125) );
+    CHECK( trace == "dbac" );
+    CHECK( !scheduler.HasNextTicks(&next) );
+}
+
+TEST_CASE("ConcurrentActionNode cancel and reschedule"){
+    ConcurrentScheduler scheduler;
+    scheduler.Start(0);
+
+    int count = 0;
+    auto increment = [&]{ ++count; };
+    ConcurrentActionNode node(increment);
+
+    SUBCASE("cancel before consumer saw the request"){
+        node.ScheduleAfter(scheduler, 5);
+        node.Cancel();
+        CHECK( !node.IsScheduled() );
+        CHECK( node.IsInScheduler() ); // still in the inbox
+        CHECK( !scheduler.ExecuteAll(10) );
+        CHECK( !node.IsInScheduler() );
+    }
+    SUBCASE("cancel pending item"){
+        node.ScheduleAfter(scheduler, 5);
+        CHECK( !scheduler.ExecuteAll(1) );
+        node.Cancel();
+        CHECK( !node.IsScheduled() );
+        ConcurrentScheduler::Ticks next = 0;
+        CHECK( !scheduler.HasNextTicks(&next) );
+        CHECK( !node.IsInScheduler() );
+        CHECK( !scheduler.ExecuteAll(10) );
+    }
+    SUBCASE("later request replaces previous one"){
+        node.ScheduleAfter(scheduler, 5);
+        CHECK( !scheduler.ExecuteAll(1) );
+        node.ScheduleAfter(scheduler, 20); // counted from 1
+        CHECK( !scheduler.ExecuteAll(10) );
+        CHECK( scheduler.ExecuteAll(21) );
+        CHECK( count == 1 );
+    }
+    SUBCASE("cancel without schedule does nothing"){
+        node.Cancel();
+        CHECK( !node.IsInScheduler() );
+    }
+    CHECK( !node.IsInScheduler() );
+}
+
+TEST_CASE("ConcurrentActionNode periodic and self cancel"){
+    ConcurrentScheduler scheduler;
+    scheduler.Start(0);
+
+    int count = 0;
+    ConcurrentActionNode* self = nullptr;
+    auto tick = [&]{
+        if( ++count == 3 ){
+            self->Cancel();
+        }
+    };
+    ConcurrentActionNode node(tick);
+    self = &node;
+
+    node.ScheduleAfter(scheduler, 10, 10);
+    for(ConcurrentScheduler::Ticks now = 0; now <= 100; ++now){
+        scheduler.ExecuteAll(now);
+    }
+    CHECK( count == 3 );
+    CHECK( !node.IsInScheduler() );
+
+    SUBCASE("reschedule from own callback wins over the period"){
+        count = 0;
+        auto again = [&]{
+            if( ++count < 4 ){
+                self->ScheduleAfter(scheduler, 1, 50);
+            }
+        };
+        node.Set(again);
+        node.ScheduleAfter(scheduler, 1, 50);
+        for(ConcurrentScheduler::Ticks now = 101; now <= 120; ++now){
+            scheduler.ExecuteAll(now);
+        }
+        CHECK( count == 4 );
+        node.Cancel();
+        scheduler.ExecuteAll(121);
+        CHECK( !node.IsInScheduler() );
+    }
+}
+
+TEST_CASE("ConcurrentScheduler accepts schedules and cancels from threads"){
+    constexpr int Producers = 4;
+    constexpr int NodesPerProducer = 64;
+    constexpr int Rounds = 2000;
+
+    ConcurrentScheduler scheduler;
+    scheduler.Start(0);
+
+    std::atomic<long> executed(0);
+    auto count = [&]{ ++executed; };
+    std::vector<ConcurrentActionNode> nodes(Producers * NodesPerProducer);
+    for(auto& node : nodes){
+        node.Set(count);
+    }
+
+    std::atomic<int> done(0);
+    std::vector<std::thread> producers;
+    for(int p = 0; p < Producers; ++p){
+        producers.emplace_back([&, p]{
+            ConcurrentActionNode* mine = &nodes[p * NodesPerProducer];
+            for(int r = 0; r < Rounds; ++r){
+                ConcurrentActionNode& node = mine[r % NodesPerProducer];
+                node.ScheduleAfter(scheduler, r % 3);
+                if( r % 5 == 0 ){
+                    node.Cancel();
+                }
+            }
+            ++done;
+        });
+    }
+
+    ConcurrentScheduler::Ticks now = 0;
+    while( done < Producers ){
+        scheduler.ExecuteAll(++now);
+    }
+    for(auto& producer : producers){
+        producer.join();
+    }
+    // everything left is due within 3 ticks
+    for(int i = 0; i < 4; ++i){
+        scheduler.ExecuteAll(++now);
+    }
+    bool allLeft = true;
+    for(auto& node : nodes){
+        allLeft = allLeft && !node.IsInScheduler();
+    }
+    CHECK( allLeft );
+    CHECK( executed > 0 );
+    CHECK( executed <= long(Producers) * Rounds );
+}
@@ -0,0 +1,199 @@
+/** @file tests/test_InstantCriticalSection.cpp
+    @brief Unit tests for InstantCriticalSection.h and per instance protection
+*/
+
+#include "InstantCriticalSectionHost.h"
+#include "InstantScheduler.h"
+#include "InstantMemory.h"
+#include "InstantThenable.h"
+
+#include "doctest/doctest.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace{
+    constexpr int Threads = 4;
+    constexpr int PerThread = 20000;
+
+    /// Increment unprotected counter from several threads under criticalSection
+    template<class CriticalSection>
+    long CountUnder(CriticalSection& criticalSection){
+        long counter = 0;
+        std::vector<std::thread> threads;
+        for(int t = 0; t < Threads; ++t){
+            threads.emplace_back([&]{
+                for(int i = 0; i < PerThread; ++i){
+                    criticalSection.Enter();
+                    counter = counter + 1; // not atomic on purpose
+                    criticalSection.Leave();
+                }
+            });
+        }
+        for(auto& thread : threads){
+            thread.join();
+        }
+        return counter;
+    }
+} //namespace
+
+TEST_CASE("CriticalSection policies provide mutual exclusion"){
+    SUBCASE("CriticalSectionSpinLock"){
+        CriticalSectionSpinLock spinLock;
+        CHECK( CountUnder(spinLock) == long(Threads) * PerThread );
+        CHECK( spinLock.TryEnter() );
+        CHECK( !spinLock.TryEnter() );
+        spinLock.Leave();
+    }
+#ifdef InstantCriticalSection_HasFutex
+    SUBCASE("CriticalSectionFutex"){
+        CriticalSectionFutex futex;
+        CHECK( CountUnder(futex) == long(Threads) * PerThread );
+    }
+#endif
+    SUBCASE("CriticalSectionStdMutex"){
+        CriticalSectionStdMutex mutex;
+        CHECK( CountUnder(mutex) == long(Threads) * PerThread );
+    }
+    SUBCASE("CriticalSectionReference"){
+        CriticalSectionSpinLock spinLock;
+        CriticalSectionReference reference(spinLock);
+        CHECK( !reference.IsNoOp() );
+        CriticalSectionReference copy(reference); // refers the same spin lock
+        CHECK( CountUnder(copy) == long(Threads) * PerThread );
+    }
+}
+
+TEST_CASE("CriticalSectionReference to nothing"){
+    CriticalSectionReference empty;
+    CHECK( empty.IsNoOp() );
+    empty.Enter();
+    empty.Leave();
+
+    CriticalSectionNone none;
+    CHECK( CriticalSectionReference(none).IsNoOp() );
+}
+
+TEST_CASE("Scheduler with own critical section accepts schedules from threads"){
+    SchedulerWithCriticalSection<CriticalSectionStdMutex> scheduler;
+    scheduler.Start(0);
+
+    constexpr int PerProducer = 2000;
+    int executed = 0; // touched only by the consumer (callbacks run there)
+    auto onExecute = [&executed]{ ++executed; };
+
+    std::vector<ActionNode> actions(Threads * PerProducer);
+    for(auto& action : actions){
+        action.Set(onExecute);
+    }
+
+    std::atomic<int> done(0);
+    std::vector<std::thread> producers;
+    for(int p = 0; p < Threads; ++p){
+        producers.emplace_back([&, p]{
+            for(int i = 0; i < PerProducer; ++i){
+                actions[p * PerProducer + i].ScheduleAfter(scheduler, i % 3);
+            }
+            ++done;
+        });
+    }
+
+    ActionNode::Ticks now = 0;
+    while( done < Threads || executed < Threads * PerProducer ){
+        scheduler.ExecuteAll(++now);
+    }
+    for(auto& producer : producers){
+        producer.join();
+    }
+    CHECK( executed == Threads * PerProducer );
+    ActionNode::Ticks next;
+    CHECK( !scheduler.HasNextTicks(&next) );
+}
+
+TEST_CASE("ActionNode moves between differently protected schedulers"){
+    CriticalSectionSpinLock spinLock;
+    Scheduler first(spinLock);
+    SchedulerWithCriticalSection<CriticalSectionStdMutex> second;
+    first.Start(0);
+    second.Start(0);
+
+    int executed = 0;
+    auto onExecute = [&executed]{ ++executed; };
+    ActionNode action(onExecute);
+
+    action.ScheduleAfter(first, 1);
+    action.ScheduleAfter(second, 1); // leaves the first one
+    CHECK( action.IsScheduled() );
+    ActionNode::Ticks next;
+    CHECK( !first.HasNextTicks(&next) );
+    CHECK( second.HasNextTicks(&next) );
+
+    CHECK( !first.ExecuteAll(5) );
+    CHECK( second.ExecuteAll(5) );
+    CHECK( executed == 1 );
+    CHECK( !action.IsScheduled() );
+
+    action.Set(onExecute);
+    action.ScheduleBefore(first, 0);
+    action.Cancel();
+    CHECK( !first.ExecuteAll(6) );
+    CHECK( executed == 1 );
+}
+
+TEST_CASE("BlockPool with own critical section is shared between threads"){
+    constexpr int Blocks = 16;
+    BlockPool<sizeof(long), Blocks, CommonBlockPool::Metadata, CriticalSectionSpinLock> pool;
+
+    std::atomic<bool> collision(false);
+    std::vector<std::thread> threads;
+    for(int t = 0; t < Threads; ++t){
+        threads.emplace_back([&, t]{
+            for(int i = 0; i < PerThread / 4; ++i){
+                long* block = static_cast<long*>(pool.AllocateRaw());
+                if( !block ){
+                    continue; // all blocks are taken by others right now
+                }
+                *block = t;
+                std::this_thread::yield();
+                if( *block != t ){
+                    collision = true; // the same block was given twice
+                }
+                CommonBlockPool::FreeRaw(block);
+            }
+        });
+    }
+    for(auto& thread : threads){
+        thread.join();
+    }
+    CHECK( !collision );
+    CHECK( pool.BlocksAllocated() == 0 );
+}
+
+TEST_CASE("Thenable with own critical section resolved from other thread"){
+    ThenableToResolve<int, CriticalSectionSpinLock> thenable;
+    ThenableToResolve<void, CriticalSectionSpinLock> event;
+
+    std::thread resolver([&]{
+        thenable(42);
+    });
+    resolver.join();
+
+    int received = 0;
+    auto onResult = [&received](const int& value){ received = value; };
+    thenable.Then(onResult);
+    CHECK( received == 42 );
+
+    std::atomic<int> calls(0);
+    auto onEvent = [&calls]{ ++calls; };
+    event.Set(onEvent);
+    std::thread caller([&]{
+        event();
+    });
+    caller.join();
+    CHECK( calls == 1 );
+
+    static_assert(
+        sizeof( ThenableToResolve<void> ) == sizeof( ThenableToResolve<void, CriticalSectionNone> ),
+        "CriticalSectionNone is the default"
+    );
+}
@@ -2,6 +2,15 @@
     @brief Unit tests for InstantDebounce.h
 */
 
+#include <exception>
+/// Custom exception for testing InstantDebounce_Panic
+class TestInstantDebouncePanicException: public std::exception{
+    const char* what() const noexcept override{
+        return "TestInstantDebouncePanicException";
+    }
+};
+//Header will see this definition
+#define InstantDebounce_Panic() throw TestInstantDebouncePanicException()
 #include "InstantDebounce.h"
 #include "doctest/doctest.h"
 
@@ -105,3 +114,331 @@ TEST_CASE("InstantDebounce: SimpleDebounce") {
         CHECK( !button.Value() ); //debounced!
     }
 }
+
+
+TEST_CASE("InstantDebounce: SimpleDebounceBank") {
+    using Bank = SimpleDebounceBank<8, unsigned char>;
+    using Ticks = Bank::Ticks;
+    Bank buttons(0x00, 50);
+
+    CHECK( buttons.Values(0) == 0x00 );
+
+    SUBCASE("Debouncing independent channels") {
+        CHECK( buttons.Discover(Ticks(1000), (unsigned char)0x01) == 0 );
+        CHECK( buttons.Discover(Ticks(1020), (unsigned char)0x03) == 0 );
+        CHECK( buttons.Discover(Ticks(1049), (unsigned char)0x03) == 0 );
+        CHECK( buttons.Values(0) == 0x00 ); //still counting
+
+        CHECK( buttons.Discover(Ticks(1050), (unsigned char)0x03) == 0x01 );
+        CHECK( buttons.Value(0) );
+        CHECK( !buttons.Value(1) ); //counts from 1020
+
+        CHECK( buttons.Discover(Ticks(1069), (unsigned char)0x03) == 0 );
+        CHECK( buttons.Discover(Ticks(1070), (unsigned char)0x03) == 0x02 );
+        CHECK( buttons.Values(0) == 0x03 );
+        CHECK( buttons.Changed(0) == 0x02 );
+
+        CHECK( buttons.Discover(Ticks(1100), (unsigned char)0x02) == 0 );
+        CHECK( buttons.Discover(Ticks(1150), (unsigned char)0x02) == 0x01 );
+        CHECK( buttons.Values(0) == 0x02 );
+    }
+    SUBCASE("Chatter restarts debouncing") {
+        buttons.Discover(Ticks(1000), (unsigned char)0x80);
+        buttons.Discover(Ticks(1010), (unsigned char)0x00); //chatter
+        CHECK( buttons.Discover(Ticks(1050), (unsigned char)0x80) == 0 ); //starts again
+        CHECK( buttons.Discover(Ticks(1099), (unsigned char)0x80) == 0 );
+        CHECK( buttons.Discover(Ticks(1100), (unsigned char)0x80) == 0x80 );
+        CHECK( buttons.Value(7) );
+    }
+    SUBCASE("Same results as separate SimpleDebounce instances") {
+        SimpleDebounceBank<70> bank(0, 7);
+        SimpleDebounce* single[70];
+        for(unsigned i = 0; i < 70; ++i){
+            single[i] = new SimpleDebounce(false, 7);
+        }
+
+        using BankType = SimpleDebounceBank<70>;
+        unsigned long raw[BankType::WordsCount] = {};
+        unsigned seed = 12345;
+        for(unsigned step = 0; step < 500; ++step){
+            const BankType::Ticks now = 4000000000UL + step; // wraps for 32 bit
+            for(unsigned i = 0; i < 70; ++i){
+                seed = seed * 1103515245u + 12345u;
+                if( (seed >> 16) % 5 == 0 ){
+                    raw[i / BankType::BitsPerWord] ^= 1UL << (i % BankType::BitsPerWord);
+                }
+            }
+            bank.Discover(now, raw);
+            for(unsigned i = 0; i < 70; ++i){
+                const bool bit = (raw[i / BankType::BitsPerWord] >> (i % BankType::BitsPerWord)) & 1;
+                const bool changed = single[i]->Discover(now, bit);
+                CHECK( changed == bool((bank.Changed(i / BankType::BitsPerWord) >> (i % BankType::BitsPerWord)) & 1) );
+                CHECK( single[i]->Value() == bank.Value(i) );
+            }
+        }
+
+        for(unsigned i = 0; i < 70; ++i){
+            delete single[i];
+        }
+    }
+}
+
+
+TEST_CASE("InstantDebounce: DebounceAction") {
+    Scheduler scheduler;
+    scheduler.Start(0);
+
+    bool raw = false;
+    int trueCount = 0;
+    int falseCount = 0;
+
+    //ensure lambdas live as long as debounce is used
+    auto onTrue = [&]{ ++trueCount; };
+    auto onFalse = [&]{ ++falseCount; };
+    auto checker = [&]{ return raw; };
+
+    DebounceAction debounce(false, 10, 3);
+    debounce.OnTrue(onTrue).OnFalse(onFalse);
+    debounce.Schedule(scheduler, checker);
+    
+    raw = true;
+    scheduler.ExecuteAll(10);
+    scheduler.ExecuteAll(20);
+    CHECK( !debounce.Value() ); //still false, counts
+    CHECK( trueCount == 0 );
+    scheduler.ExecuteAll(30);
+    CHECK( debounce.Value() ); //debounced, now true
+    CHECK( trueCount == 1 );
+
+    raw = false;
+    scheduler.ExecuteAll(40);
+    scheduler.ExecuteAll(50);
+    raw = true; //chatter
+    scheduler.ExecuteAll(60);
+    raw = false;
+    scheduler.ExecuteAll(70);
+    scheduler.ExecuteAll(80);
+    CHECK( debounce.Value() ); //still true, counts from start
+    scheduler.ExecuteAll(90);
+    CHECK( !debounce.Value() ); //debounced, now false
+    CHECK( trueCount == 1 );
+    CHECK( falseCount == 1 );
+
+    debounce.Cancel();
+}
+
+TEST_CASE("InstantDebounce: DebounceGroup") {
+    Scheduler scheduler;
+    scheduler.Start(0);
+
+    bool raw[3] = {false, true, false};
+    int changes[3] = {};
+
+    auto checker0 = [&]{ return raw[0]; };
+    auto checker1 = [&]{ return raw[1]; };
+    auto checker2 = [&]{ return raw[2]; };
+
+    DebounceGroup<4> group(10, 2);
+    CHECK( group.Add(raw[0], checker0) == 0 );
+    CHECK( group.Add(raw[1], checker1) == 1 );
+    CHECK( group.Add(raw[2], checker2) == 2 );
+    CHECK( group.ChannelsCount() == 3 );
+
+    //ensure lambdas live as long as group is used
+    auto onTrue0 = [&]{ ++changes[0]; };
+    auto onFalse1 = [&]{ ++changes[1]; };
+    auto onTrue2 = [&]{ ++changes[2]; };
+    group.OnTrue(0, onTrue0).OnFalse(1, onFalse1).OnTrue(2, onTrue2);
+    group.Schedule(scheduler);
+
+    raw[0] = true;
+    raw[1] = false;
+    scheduler.ExecuteAll(10);
+    CHECK( !group.Value(0) ); //counts
+    CHECK( group.Value(1) ); //counts
+    raw[2] = true;
+    scheduler.ExecuteAll(20);
+    CHECK( group.Value(0) ); //debounced
+    CHECK( !group.Value(1) ); //debounced
+    CHECK( !group.Value(2) ); //counts
+    CHECK( changes[0] == 1 );
+    CHECK( changes[1] == 1 );
+    CHECK( changes[2] == 0 );
+
+    raw[2] = false; //chatter
+    scheduler.ExecuteAll(30);
+    raw[2] = true;
+    scheduler.ExecuteAll(40);
+    CHECK( !group.Value(2) ); //counts from start
+    scheduler.ExecuteAll(50);
+    CHECK( group.Value(2) ); //debounced
+
+    //only changed channels are reported
+    CHECK( changes[0] == 1 );
+    CHECK( changes[1] == 1 );
+    CHECK( changes[2] == 1 );
+
+    group.Cancel();
+}
+
+TEST_CASE("InstantDebounce: DebounceGroup panics on channel not added") {
+    auto checker = []{ return true; };
+    auto callback = []{};
+    DebounceGroup<2> group(10, 2);
+    CHECK_THROWS_AS( group.OnTrue(0, callback), TestInstantDebouncePanicException );
+
+    group.Add(false, checker);
+    group.Add(false, checker);
+    CHECK_NOTHROW( group.OnTrue(1, callback).OnFalse(1, callback) );
+    CHECK_THROWS_AS( group.Add(false, checker), TestInstantDebouncePanicException );
+    CHECK_THROWS_AS( group.OnFalse(2, callback), TestInstantDebouncePanicException );
+    CHECK_THROWS_AS( group.Value(7), TestInstantDebouncePanicException );
+}
+
+TEST_CASE("InstantDebounce: ButtonAction") {
+    Scheduler scheduler;
+    scheduler.Start(0);
+    Scheduler::Ticks now = 0;
+    //move time forward with the same steps as the check interval
+    auto runTill = [&](Scheduler::Ticks till){
+        while( now < till ){
+            now += 10;
+            scheduler.ExecuteAll(now);
+        }
+    };
+
+    bool raw = false;
+    auto checker = [&]{ return raw; };
+
+    int presses = 0, releases = 0, longPresses = 0, repeats = 0, doubleClicks = 0;
+    auto onPress = [&]{ ++presses; };
+    auto onRelease = [&]{ ++releases; };
+    auto onLongPress = [&]{ ++longPresses; };
+    auto onRepeat = [&]{ ++repeats; };
+    auto onDoubleClick = [&]{ ++doubleClicks; };
+
+    ButtonAction button(checker, 10, 2);
+    button.OnPress(onPress).OnRelease(onRelease);
+    button.Start(scheduler);
+    CHECK( button.IsIdle() );
+
+    SUBCASE("Idle button is not scheduled") {
+        Scheduler::Ticks next = 0;
+        CHECK( !scheduler.HasNextTicks(&next) );
+
+        raw = true; //nobody woke the button
+        runTill(100);
+        CHECK( presses == 0 );
+        CHECK( button.IsIdle() );
+    }
+
+    SUBCASE("Press and release") {
+        raw = true;
+        button.Wake();
+        CHECK( !button.IsIdle() );
+        runTill(10);
+        CHECK( presses == 0 ); //debouncing
+        runTill(20);
+        CHECK( presses == 1 );
+        CHECK( button.Value() );
+
+        raw = false;
+        runTill(40);
+        CHECK( releases == 1 );
+        CHECK( !button.Value() );
+        CHECK( button.IsIdle() ); //at rest again
+
+        Scheduler::Ticks next = 0;
+        CHECK( !scheduler.HasNextTicks(&next) );
+    }
+
+    SUBCASE("Long press and repeat") {
+        button.OnLongPress(onLongPress, 100).OnRepeat(onRepeat, 50);
+
+        raw = true;
+        button.Wake();
+        runTill(20); //pressed at 20
+        CHECK( presses == 1 );
+        runTill(110);
+        CHECK( longPresses == 0 );
+        runTill(120);
+        CHECK( longPresses == 1 );
+        CHECK( repeats == 0 );
+        runTill(160);
+        CHECK( repeats == 0 );
+        runTill(170);
+        CHECK( repeats == 1 );
+        runTill(220);
+        CHECK( repeats == 2 );
+
+        raw = false;
+        runTill(240);
+        CHECK( releases == 1 );
+        CHECK( longPresses == 1 );
+        CHECK( button.IsIdle() );
+    }
+
+    SUBCASE("Double click") {
+        button.OnDoubleClick(onDoubleClick, 100);
+
+        raw = true;
+        button.Wake();
+        runTill(20);
+        raw = false;
+        runTill(40);
+        CHECK( releases == 1 );
+        CHECK( !button.IsIdle() ); //waiting for the second click
+
+        raw = true;
+        runTill(60);
+        CHECK( presses == 2 );
+        CHECK( doubleClicks == 1 );
+        raw = false;
+        runTill(80);
+        CHECK( releases == 2 );
+        CHECK( button.IsIdle() ); //second click does not start other one
+
+        //too late for double click
+        raw = true;
+        button.Wake();
+        runTill(100);
+        raw = false;
+        runTill(120);
+        runTill(300);
+        CHECK( button.IsIdle() );
+        raw = true;
+        button.Wake();
+        runTill(320);
+        CHECK( presses == 4 );
+        CHECK( doubleClicks == 1 );
+        raw = false;
+        runTill(340);
+    }
+
+    SUBCASE("Wake from multicast") {
+        MulticastToActions pinChange;
+        button.Start(scheduler, pinChange);
+        
+        raw = true;
+        pinChange();
+        CHECK( !button.IsIdle() );
+        runTill(20);
+        CHECK( presses == 1 );
+        pinChange(); //no effect while tracking
+        raw = false;
+        runTill(40);
+        CHECK( releases == 1 );
+        CHECK( button.IsIdle() );
+
+        raw = true;
+        pinChange(); //listening again
+        runTill(60);
+        CHECK( presses == 2 );
+        raw = false;
+        runTill(80);
+
+        button.Cancel();
+    }
+
+    button.Cancel();
+}
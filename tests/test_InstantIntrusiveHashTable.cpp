@@ -0,0 +1,247 @@
+/** @file tests/test_InstantIntrusiveHashTable.cpp
+    @brief Unit tests for InstantIntrusiveHashTable.h
+*/
+
+#include <exception>
+/// Custom exception for testing InstantIntrusiveHashTable_Panic
+class TestInstantIntrusiveHashTableException: public std::exception{
+    const char* what() const noexcept override{
+        return "TestInstantIntrusiveHashTableException";
+    }
+};
+//Header will see this definition
+#define InstantIntrusiveHashTable_Panic() throw TestInstantIntrusiveHashTableException()
+#include "InstantIntrusiveHashTable.h"
+
+#include "doctest/doctest.h"
+#include <random>
+#include <set>
+#include <vector>
+
+namespace{
+    struct HashItemHash;
+
+    /// Table with migration into the larger array
+    template<class Item>
+    using GrowingTable = IntrusiveHashTable<Item, int, HashItemHash, 8, 64>;
+
+    /// Class for testing purposes
+    class MyHashItem: public GrowingTable<MyHashItem>::Node{
+    public:
+        /// Constructor for testing purposes
+        MyHashItem(int key) : storedKey(key) {}
+
+        /// Method for testing purposes
+        int Key() const{
+            return storedKey;
+        }
+    private:
+        int storedKey;
+    };
+
+    struct HashItemHash{
+        unsigned long operator()(int key) const { return static_cast<unsigned long>(key) * 2654435761UL; }
+        int operator()(const MyHashItem& item) const { return item.Key(); }
+    };
+
+    using MyTable = GrowingTable<MyHashItem>;
+
+    struct PlainHash;
+    /// Item for the table having single bucket array
+    struct PlainItem: public IntrusiveHashTable<PlainItem, unsigned, PlainHash, 4>::Node{
+        explicit PlainItem(unsigned k) : key(k) {}
+        unsigned key;
+    };
+    struct PlainHash{
+        unsigned long operator()(unsigned key) const { return key; }
+        unsigned operator()(const PlainItem& item) const { return item.key; }
+    };
+
+    struct MultiplicativeHash;
+    /// Item for checking how keys are spread over the buckets
+    struct SpreadItem: public IntrusiveHashTable<SpreadItem, unsigned, MultiplicativeHash, 64>::Node{
+        explicit SpreadItem(unsigned k) : key(k) {}
+        unsigned key;
+    };
+    struct MultiplicativeHash{
+        // low bits of the product depend only on low bits of the key
+        unsigned long operator()(unsigned key) const { return key * 2654435761UL; }
+        unsigned operator()(const SpreadItem& item) const { return item.key; }
+    };
+
+} //namespace
+
+TEST_CASE("InstantIntrusiveHashTable basic"){
+    MyTable table;
+    CHECK( table.IsEmpty() );
+    CHECK( table.Count() == 0 );
+    CHECK( table.Find(1) == nullptr );
+    CHECK( table.BucketsCount() == 8 );
+
+    MyHashItem i1(1), i2(2), i3(3), other1(1);
+    CHECK( !i1.IsInHashTable() );
+
+    CHECK( table.Insert(&i1) );
+    CHECK( table.Insert(&i2) );
+    CHECK( table.Insert(&i3) );
+    CHECK( i1.IsInHashTable() );
+    CHECK( table.Count() == 3 );
+
+    CHECK( table.Find(1) == &i1 );
+    CHECK( table.Find(2) == &i2 );
+    CHECK( table.Find(3) == &i3 );
+    CHECK( table.Find(4) == nullptr );
+
+    SUBCASE("keys are unique"){
+        CHECK( !table.Insert(&other1) );
+        CHECK( !other1.IsInHashTable() );
+        CHECK( table.Count() == 3 );
+    }
+
+    SUBCASE("remove"){
+        table.Remove(&i2);
+        CHECK( !i2.IsInHashTable() );
+        CHECK( table.Find(2) == nullptr );
+        CHECK( table.Count() == 2 );
+
+        CHECK( table.RemoveKey(3) == &i3 );
+        CHECK( table.RemoveKey(3) == nullptr );
+        CHECK( table.Count() == 1 );
+
+        CHECK_THROWS_AS( table.Remove(&i2), TestInstantIntrusiveHashTableException );
+    }
+
+    SUBCASE("misuse panics"){
+        CHECK_THROWS_AS( table.Insert(&i1), TestInstantIntrusiveHashTableException );
+    }
+
+    table.Clear();
+    CHECK( table.IsEmpty() );
+    CHECK( !i1.IsInHashTable() );
+    CHECK( !i3.IsInHashTable() );
+}
+
+TEST_CASE("InstantIntrusiveHashTable migrates incrementally"){
+    constexpr int ItemsCount = 40;
+    std::vector<MyHashItem*> items;
+    for(int i = 0; i < ItemsCount; ++i){
+        items.push_back(new MyHashItem(i * 7));
+    }
+
+    MyTable table;
+    for(int i = 0; i < 8; ++i){
+        CHECK( table.Insert(items[i]) );
+    }
+    CHECK( !table.IsRehashing() );
+    CHECK( table.BucketsCount() == 8 );
+
+    // exceeding the load starts migration, all items stay visible
+    CHECK( table.Insert(items[8]) );
+    CHECK( table.IsRehashing() );
+    for(int i = 0; i <= 8; ++i){
+        CHECK( table.Find(i * 7) == items[i] );
+    }
+
+    for(int i = 9; i < ItemsCount; ++i){
+        CHECK( table.Insert(items[i]) );
+    }
+    CHECK( !table.IsRehashing() );
+    CHECK( table.BucketsCount() == 64 );
+    for(int i = 0; i < ItemsCount; ++i){
+        CHECK( table.Find(i * 7) == items[i] );
+    }
+
+    // empty table returns to the small array
+    for(auto item : items){
+        table.Remove(item);
+    }
+    CHECK( table.IsEmpty() );
+    CHECK( table.BucketsCount() == 8 );
+
+    for(auto item : items){
+        delete item;
+    }
+}
+
+TEST_CASE("InstantIntrusiveHashTable matches reference on random operations"){
+    constexpr int ItemsCount = 200;
+    std::vector<MyHashItem*> items;
+    for(int i = 0; i < ItemsCount; ++i){
+        items.push_back(new MyHashItem(i));
+    }
+
+    MyTable table;
+    std::set<int> reference;
+    std::mt19937 rnd(2024);
+
+    for(int step = 0; step < 4000; ++step){
+        MyHashItem* item = items[rnd() % ItemsCount];
+        if( item->IsInHashTable() ){
+            table.Remove(item);
+            reference.erase(item->Key());
+        }
+        else{
+            REQUIRE( table.Insert(item) );
+            reference.insert(item->Key());
+        }
+
+        if( step % 50 == 0 ){
+            REQUIRE( table.Count() == reference.size() );
+            for(int key = 0; key < ItemsCount; ++key){
+                MyHashItem* found = table.Find(key);
+                if( reference.count(key) ){
+                    REQUIRE( found == items[key] );
+                }
+                else{
+                    REQUIRE( found == nullptr );
+                }
+            }
+        }
+    }
+
+    table.Clear();
+    for(auto item : items){
+        delete item;
+    }
+}
+
+TEST_CASE("InstantIntrusiveHashTable without GrowBuckets"){
+    IntrusiveHashTable<PlainItem, unsigned, PlainHash, 4> table;
+    std::vector<PlainItem*> items;
+    for(unsigned i = 0; i < 20; ++i){
+        items.push_back(new PlainItem(i));
+        CHECK( table.Insert(items.back()) );
+    }
+    // load is above the limit, but there is nowhere to grow
+    CHECK( !table.IsRehashing() );
+    CHECK( table.BucketsCount() == 4 );
+    for(unsigned i = 0; i < 20; ++i){
+        CHECK( table.Find(i) == items[i] );
+    }
+
+    table.Clear();
+    for(auto item : items){
+        delete item;
+    }
+}
+
+TEST_CASE("InstantIntrusiveHashTable spreads keys differing only in high bits"){
+    IntrusiveHashTable<SpreadItem, unsigned, MultiplicativeHash, 64> table;
+    std::vector<SpreadItem*> items;
+    for(unsigned i = 1; i <= 40; ++i){
+        items.push_back(new SpreadItem(i * 64));
+        CHECK( table.Insert(items.back()) );
+    }
+    // all would share the single chain if low bits of the hash were used as is
+    CHECK( table.LongestChain() <= 4 );
+    for(unsigned i = 1; i <= 40; ++i){
+        CHECK( table.Find(i * 64) == items[i - 1] );
+    }
+    CHECK( table.Find(32) == nullptr );
+
+    table.Clear();
+    CHECK( table.LongestChain() == 0 );
+    for(auto item : items){
+        delete item;
+    }
+}
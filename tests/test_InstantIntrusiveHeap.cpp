@@ -0,0 +1,170 @@
+/** @file tests/test_InstantIntrusiveHeap.cpp
+    @brief Unit tests for InstantIntrusiveHeap.h
+*/
+
+#include <exception>
+/// Custom exception for testing InstantIntrusiveHeap_Panic
+class TestInstantIntrusiveHeapException: public std::exception{
+    const char* what() const noexcept override{
+        return "TestInstantIntrusiveHeapException";
+    }
+};
+//Header will see this definition
+#define InstantIntrusiveHeap_Panic() throw TestInstantIntrusiveHeapException()
+#include "InstantIntrusiveHeap.h"
+
+#include "doctest/doctest.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace{
+    struct HeapItemEarlier;
+
+    /// Class for testing purposes
+    class MyHeapItem: public IntrusivePairingHeap<MyHeapItem, HeapItemEarlier>::Node{
+    public:
+        /// Constructor for testing purposes
+        MyHeapItem(int key = 0) : storedKey(key) {}
+
+        /// Method for testing purposes
+        int Key() const{
+            return storedKey;
+        }
+        /// Change priority (caller is responsible for heap update)
+        void SetKey(int key){
+            storedKey = key;
+        }
+    private:
+        int storedKey;
+    };
+
+    struct HeapItemEarlier{
+        bool operator()(const MyHeapItem& a, const MyHeapItem& b) const{
+            return a.Key() < b.Key();
+        }
+    };
+
+    using MyHeap = IntrusivePairingHeap<MyHeapItem, HeapItemEarlier>;
+
+    /// Pop everything and collect keys
+    std::vector<int> Drain(MyHeap& heap){
+        std::vector<int> res;
+        while( MyHeapItem* item = heap.Pop() ){
+            res.push_back(item->Key());
+        }
+        return res;
+    }
+} //namespace
+
+TEST_CASE("IntrusivePairingHeap basic operations"){
+    MyHeap heap;
+    CHECK( heap.IsEmpty() );
+    CHECK( heap.Top() == nullptr );
+    CHECK( heap.Pop() == nullptr );
+
+    MyHeapItem i5(5), i1(1), i3(3), i4(4), i2(2);
+    heap.Insert(&i5);
+    CHECK( heap.Top() == &i5 );
+    heap.Insert(&i1);
+    heap.Insert(&i3);
+    heap.Insert(&i4);
+    heap.Insert(&i2);
+    CHECK( !heap.IsEmpty() );
+    CHECK( i3.IsInHeap() );
+    CHECK( heap.Top() == &i1 );
+
+    SUBCASE("Pop gives sorted order"){
+        CHECK( Drain(heap) == std::vector<int>{1, 2, 3, 4, 5} );
+        CHECK( !i3.IsInHeap() );
+        CHECK( heap.IsEmpty() );
+    }
+    SUBCASE("DecreaseKey moves item forward"){
+        i4.SetKey(0);
+        heap.DecreaseKey(&i4);
+        CHECK( heap.Top() == &i4 );
+        i1.SetKey(-1); // decreasing the root itself
+        heap.DecreaseKey(&i1);
+        CHECK( Drain(heap) == std::vector<int>{-1, 0, 2, 3, 5} );
+    }
+    SUBCASE("Remove arbitrary item"){
+        heap.Remove(&i3);
+        CHECK( !i3.IsInHeap() );
+        heap.Remove(&i1); // the root
+        CHECK( heap.Top() == &i2 );
+        // removed item can be inserted again
+        heap.Insert(&i3);
+        CHECK( Drain(heap) == std::vector<int>{2, 3, 4, 5} );
+    }
+    SUBCASE("Meld"){
+        MyHeap other;
+        MyHeapItem i0(0), i6(6);
+        other.Insert(&i6);
+        other.Insert(&i0);
+        heap.Meld(other);
+        CHECK( other.IsEmpty() );
+        heap.Meld(other); // melding empty heap changes nothing
+        heap.Meld(heap);
+        CHECK( Drain(heap) == std::vector<int>{0, 1, 2, 3, 4, 5, 6} );
+    }
+}
+
+TEST_CASE("IntrusivePairingHeap panics on misuse"){
+    MyHeap heap;
+    MyHeapItem item(1);
+    CHECK_THROWS_AS( heap.Remove(&item), TestInstantIntrusiveHeapException );
+    CHECK_THROWS_AS( heap.DecreaseKey(&item), TestInstantIntrusiveHeapException );
+    heap.Insert(&item);
+    CHECK_THROWS_AS( heap.Insert(&item), TestInstantIntrusiveHeapException );
+    heap.Pop();
+}
+
+TEST_CASE("IntrusivePairingHeap matches sorted reference"){
+    constexpr int ItemsCount = 300;
+    std::vector<MyHeapItem> items(ItemsCount);
+    std::mt19937 rnd(7);
+
+    MyHeap heap;
+    std::vector<MyHeapItem*> inHeap;
+    for(int step = 0; step < 20000; ++step){
+        MyHeapItem& item = items[rnd() % ItemsCount];
+        switch( rnd() % 4 ){
+        case 0:
+        case 1:
+            if( !item.IsInHeap() ){
+                item.SetKey(static_cast<int>(rnd() % 1000));
+                heap.Insert(&item);
+            }
+            else{
+                item.SetKey(item.Key() - static_cast<int>(rnd() % 100));
+                heap.DecreaseKey(&item);
+            }
+            break;
+        case 2:
+            if( item.IsInHeap() ){
+                heap.Remove(&item);
+            }
+            break;
+        default:
+            if( MyHeapItem* top = heap.Top() ){
+                int minimum = top->Key();
+                for(auto& other : items){
+                    if( other.IsInHeap() ){
+                        minimum = std::min(minimum, other.Key());
+                    }
+                }
+                REQUIRE( top->Key() == minimum );
+                CHECK( heap.Pop() == top );
+            }
+        }
+    }
+
+    std::vector<int> expected;
+    for(auto& item : items){
+        if( item.IsInHeap() ){
+            expected.push_back(item.Key());
+        }
+    }
+    std::sort(expected.begin(), expected.end());
+    CHECK( Drain(heap) == expected );
+}
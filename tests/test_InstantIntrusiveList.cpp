@@ -15,6 +15,7 @@ class TestInstantIntrusiveListException: public std::exception{
 
 #include "doctest/doctest.h"
 #include <initializer_list>
+#include <vector>
 
 namespace{
     /// Class for testing purposes
@@ -137,3 +138,271 @@ TEST_CASE("InstantIntrusiveList"){
     ti2.RemoveFromChain();
     CHECK( il.IsEmpty() );
 }
+
+
+namespace{
+    /// Item being both in singly linked list and in hlist
+    class MyTestSItem:
+        public IntrusiveSList<MyTestSItem>::Node,
+        public IntrusiveHList<MyTestSItem>::Node
+    {
+    public:
+        MyTestSItem(int value) : storedValue(value){}
+
+        int Value() const{
+            return storedValue;
+        }
+    private:
+        int storedValue;
+    };
+
+    /// Collect values in iteration order
+    template<class List>
+    std::vector<int> ValuesOf(const List& list){
+        std::vector<int> res;
+        for(const auto& item : list){
+            res.push_back(item.Value());
+        }
+        return res;
+    }
+
+    /// Sample item to ensure only single pointer is used
+    class OnePointerItem: public IntrusiveSList<OnePointerItem>::Node{};
+} //namespace
+
+TEST_CASE("InstantIntrusiveList: IntrusiveSList"){
+    static_assert(sizeof(OnePointerItem) == sizeof(void*), "Only one link per node");
+    static_assert(sizeof(IntrusiveHList<MyTestSItem>) == sizeof(void*), "Only one pointer per head");
+
+    IntrusiveSList<MyTestSItem> sl;
+    CHECK( sl.IsEmpty() );
+    CHECK( sl.RemoveAtFront() == nullptr );
+    CHECK( sl.begin() == sl.end() );
+
+    MyTestSItem i1(1), i2(2), i3(3), i4(4);
+
+    SUBCASE("LIFO") {
+        sl.InsertAtFront(&i1);
+        sl.InsertAtFront(&i2);
+        sl.InsertAtFront(&i3);
+        CHECK( ValuesOf(sl) == std::vector<int>{3, 2, 1} );
+        CHECK( sl.RemoveAtFront() == &i3 );
+        CHECK( sl.RemoveAtFront() == &i2 );
+        CHECK( sl.RemoveAtFront() == &i1 );
+        CHECK( sl.IsEmpty() );
+    }
+    SUBCASE("FIFO and in the middle operations") {
+        sl.InsertAtBack(&i1);
+        sl.InsertAtBack(&i3);
+        sl.InsertAfter(&i1, &i2);
+        sl.InsertAfter(&i3, &i4); // becomes tail
+        CHECK( ValuesOf(sl) == std::vector<int>{1, 2, 3, 4} );
+        CHECK( sl.Back() == &i4 );
+
+        CHECK( sl.RemoveAfter(&i3) == &i4 );
+        CHECK( sl.Back() == &i3 );
+        CHECK( sl.RemoveAfter(&i3) == nullptr );
+
+        CHECK( sl.Remove(&i2) );
+        CHECK( !sl.Remove(&i4) );
+        CHECK( ValuesOf(sl) == std::vector<int>{1, 3} );
+
+        sl.InsertAtBack(&i4);
+        CHECK( sl.Back() == &i4 );
+        CHECK( sl.Front() == &i1 );
+        while( sl.RemoveAtFront() ){}
+    }
+    SUBCASE("Splice") {
+        IntrusiveSList<MyTestSItem> other;
+        sl.InsertAtBack(&i1);
+        other.InsertAtBack(&i2);
+        other.InsertAtBack(&i3);
+        sl.SpliceAtBack(other);
+        CHECK( other.IsEmpty() );
+        CHECK( ValuesOf(sl) == std::vector<int>{1, 2, 3} );
+        sl.InsertAtBack(&i4);
+        CHECK( ValuesOf(sl) == std::vector<int>{1, 2, 3, 4} );
+
+        other.SpliceAtBack(sl);
+        CHECK( sl.IsEmpty() );
+        CHECK( other.Back() == &i4 );
+        while( other.RemoveAtFront() ){}
+    }
+}
+
+TEST_CASE("InstantIntrusiveList: IntrusiveHList"){
+    IntrusiveHList<MyTestSItem> bucket1;
+    IntrusiveHList<MyTestSItem> bucket2;
+    MyTestSItem i1(1), i2(2), i3(3);
+
+    bucket1.InsertAtFront(&i1);
+    bucket1.InsertAtFront(&i2);
+    bucket1.InsertAtFront(&i3);
+    CHECK( ValuesOf(bucket1) == std::vector<int>{3, 2, 1} );
+    CHECK( i2.IsInHList() );
+
+    // remove from the middle without knowing the list
+    i2.RemoveFromHList();
+    CHECK( !i2.IsInHList() );
+    CHECK( ValuesOf(bucket1) == std::vector<int>{3, 1} );
+
+    i3.InsertNextHListNode(&i2);
+    CHECK( ValuesOf(bucket1) == std::vector<int>{3, 2, 1} );
+
+    // moving to other list removes from the previous one
+    bucket2.InsertAtFront(&i3);
+    CHECK( ValuesOf(bucket1) == std::vector<int>{2, 1} );
+    CHECK( ValuesOf(bucket2) == std::vector<int>{3} );
+
+    CHECK( bucket1.RemoveAtFront() == &i2 );
+    i1.RemoveFromHList();
+    CHECK( bucket1.IsEmpty() );
+    CHECK( bucket2.RemoveAtFront() == &i3 );
+    CHECK( bucket2.IsEmpty() );
+}
+
+
+namespace{
+    /// Item with key to sort by and tag to check stability
+    class MySortItem: public IntrusiveList<MySortItem>::Node{
+    public:
+        MySortItem(int value, int tag = 0) : storedValue(value), storedTag(tag){}
+
+        int Value() const{
+            return storedValue;
+        }
+        int Tag() const{
+            return storedTag;
+        }
+    private:
+        int storedValue;
+        int storedTag;
+    };
+
+    bool LessByValue(const MySortItem& a, const MySortItem& b){
+        return a.Value() < b.Value();
+    }
+
+    /// Collect tags in iteration order
+    std::vector<int> TagsOf(const IntrusiveList<MySortItem>& list){
+        std::vector<int> res;
+        for(const auto& item : list){
+            res.push_back(item.Tag());
+        }
+        return res;
+    }
+} //namespace
+
+TEST_CASE("InstantIntrusiveList: bulk operations"){
+    IntrusiveList<MySortItem> list;
+    IntrusiveList<MySortItem> other;
+    MySortItem i1(1), i2(2), i3(3), i4(4), i5(5);
+
+    SUBCASE("SpliceAtBack and SpliceAtFront"){
+        list.InsertAtBack(&i1);
+        other.InsertAtBack(&i2);
+        other.InsertAtBack(&i3);
+        list.SpliceAtBack(other);
+        CHECK( other.IsEmpty() );
+        CHECK( ValuesOf(list) == std::vector<int>{1, 2, 3} );
+
+        other.InsertAtBack(&i4);
+        other.InsertAtBack(&i5);
+        list.SpliceAtFront(other);
+        CHECK( other.IsEmpty() );
+        CHECK( ValuesOf(list) == std::vector<int>{4, 5, 1, 2, 3} );
+
+        // empty list and self splice change nothing
+        list.SpliceAtBack(other);
+        list.SpliceAtBack(list);
+        CHECK( ValuesOf(list) == std::vector<int>{4, 5, 1, 2, 3} );
+
+        other.SpliceAtBack(list);
+        CHECK( list.IsEmpty() );
+        CHECK( ValuesOf(other) == std::vector<int>{4, 5, 1, 2, 3} );
+    }
+
+    SUBCASE("Splice range"){
+        for(auto item : {&i1, &i2, &i3, &i4, &i5}){
+            list.InsertAtBack(item);
+        }
+        other.InsertAtBack(&i5); // moved from list
+
+        // move [2, 4) before 5 of other list
+        auto first = list.begin();
+        ++first;
+        auto last = first;
+        ++last;
+        ++last;
+        other.Splice(other.begin(), first, last);
+        CHECK( ValuesOf(list) == std::vector<int>{1, 4} );
+        CHECK( ValuesOf(other) == std::vector<int>{2, 3, 5} );
+
+        // move within the same list (tail to front)
+        other.Splice(other.begin(), ++other.begin(), other.end());
+        CHECK( ValuesOf(other) == std::vector<int>{3, 5, 2} );
+
+        // empty range
+        other.Splice(other.end(), list.begin(), list.begin());
+        CHECK( ValuesOf(other) == std::vector<int>{3, 5, 2} );
+
+        other.SpliceAtBack(list);
+    }
+
+    SUBCASE("Merge is stable"){
+        MySortItem a1(1, 10), a3(3, 11), a5(5, 12);
+        MySortItem b1(1, 20), b2(2, 21), b5(5, 22), b7(7, 23);
+        for(auto item : {&a1, &a3, &a5}){
+            list.InsertAtBack(item);
+        }
+        for(auto item : {&b1, &b2, &b5, &b7}){
+            other.InsertAtBack(item);
+        }
+        list.Merge(other, LessByValue);
+        CHECK( other.IsEmpty() );
+        CHECK( ValuesOf(list) == std::vector<int>{1, 1, 2, 3, 5, 5, 7} );
+        CHECK( TagsOf(list) == std::vector<int>{10, 20, 21, 11, 12, 22, 23} );
+
+        // merge into empty list
+        other.Merge(list, LessByValue);
+        CHECK( list.IsEmpty() );
+        CHECK( ValuesOf(other) == std::vector<int>{1, 1, 2, 3, 5, 5, 7} );
+        while( other.RemoveAtFront() ){}
+    }
+
+    SUBCASE("Sort is stable"){
+        std::vector<MySortItem*> items;
+        unsigned seed = 12345;
+        for(int n : {0, 1, 2, 3, 7, 8, 9, 100, 1000}){
+            for(int i = 0; i < n; ++i){
+                seed = seed * 1103515245u + 12345u;
+                items.push_back(new MySortItem(static_cast<int>((seed >> 16) % 50), i));
+                list.InsertAtBack(items.back());
+            }
+            list.Sort(LessByValue);
+
+            bool sorted = true;
+            const MySortItem* previous = nullptr;
+            int count = 0;
+            for(const auto& item : list){
+                if( previous ){
+                    sorted = sorted && ( previous->Value() < item.Value() ||
+                        (previous->Value() == item.Value() && previous->Tag() < item.Tag()) );
+                }
+                previous = &item;
+                ++count;
+            }
+            CHECK( sorted );
+            CHECK( count == n );
+
+            while( list.RemoveAtFront() ){}
+            for(auto item : items){
+                delete item;
+            }
+            items.clear();
+        }
+    }
+
+    while( list.RemoveAtFront() ){}
+    while( other.RemoveAtFront() ){}
+}
@@ -0,0 +1,349 @@
+/** @file tests/test_InstantIntrusiveLockFree.cpp
+    @brief Unit tests for InstantIntrusiveLockFree.h
+*/
+
+#include "InstantIntrusiveLockFree.h"
+#include "InstantIntrusiveList.h"
+
+#include "doctest/doctest.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace{
+    /// Item travelling through both structures (and also list member)
+    class MyMessage:
+        public IntrusiveList<MyMessage>::Node,
+        public IntrusiveMpscQueue<MyMessage>::Node,
+        public IntrusiveLockFreeStack<MyMessage>::Node
+    {
+    public:
+        /// Constructor for testing purposes
+        MyMessage(int value = 0) : storedValue(value) {}
+
+        int Value() const{
+            return storedValue;
+        }
+    private:
+        int storedValue;
+    };
+
+} //namespace
+
+TEST_CASE("IntrusiveMpscQueue single thread"){
+    IntrusiveMpscQueue<MyMessage> queue;
+    CHECK( queue.IsEmpty() );
+    CHECK( queue.Pop() == nullptr );
+
+    MyMessage m1(1), m2(2), m3(3);
+    queue.Push(&m1);
+    CHECK( !queue.IsEmpty() );
+    CHECK( queue.Pop() == &m1 );
+    CHECK( queue.IsEmpty() );
+    CHECK( queue.Pop() == nullptr );
+
+    queue.Push(&m1);
+    queue.Push(&m2);
+    queue.Push(&m3);
+    CHECK( queue.Pop() == &m1 );
+    // item can be pushed again right after taken
+    queue.Push(&m1);
+
+    std::vector<int> values;
+    CHECK( queue.PopBatch([&](MyMessage* message){ values.push_back(message->Value()); }, 2) == 2 );
+    CHECK( values == std::vector<int>{2, 3} );
+    CHECK( queue.PopBatch([&](MyMessage* message){ values.push_back(message->Value()); }) == 1 );
+    CHECK( values == std::vector<int>{2, 3, 1} );
+    CHECK( queue.IsEmpty() );
+
+    SUBCASE("queue node does not clash with list node"){
+        IntrusiveList<MyMessage> list;
+        list.InsertAtBack(&m1);
+        queue.Push(&m1);
+        CHECK( queue.Pop() == &m1 );
+        CHECK( &*list.begin() == &m1 );
+        list.RemoveAtFront();
+    }
+}
+
+TEST_CASE("IntrusiveLockFreeStack single thread"){
+    IntrusiveLockFreeStack<MyMessage> stack;
+    CHECK( stack.IsEmpty() );
+    CHECK( stack.Pop() == nullptr );
+    CHECK( stack.PopAll() == nullptr );
+
+    MyMessage m1(1), m2(2), m3(3);
+    stack.Push(&m1);
+    stack.Push(&m2);
+    stack.Push(&m3);
+    CHECK( !stack.IsEmpty() );
+    CHECK( stack.Pop() == &m3 );
+
+    SUBCASE("PopAll gives LIFO chain"){
+        stack.Push(&m3);
+        MyMessage* chain = stack.PopAll();
+        CHECK( stack.IsEmpty() );
+        std::vector<int> values;
+        for(MyMessage* m = chain; m; m = m->NextLockFreeStackNode()){
+            values.push_back(m->Value());
+        }
+        CHECK( values == std::vector<int>{3, 2, 1} );
+    }
+    SUBCASE("PopAllInPushOrder gives FIFO chain"){
+        stack.Push(&m3);
+        MyMessage* chain = stack.PopAllInPushOrder();
+        CHECK( stack.IsEmpty() );
+        std::vector<int> values;
+        for(MyMessage* m = chain; m; m = m->NextLockFreeStackNode()){
+            values.push_back(m->Value());
+        }
+        CHECK( values == std::vector<int>{1, 2, 3} );
+    }
+}
+
+TEST_CASE("IntrusiveMpscQueue keeps per producer order across threads"){
+    constexpr int Producers = 4;
+    constexpr int PerProducer = 20000;
+
+    // producer and sequence number are derived from the position
+    std::vector<MyMessage> messages(Producers * PerProducer);
+
+    IntrusiveMpscQueue<MyMessage> queue;
+    std::vector<std::thread> producers;
+    for(int p = 0; p < Producers; ++p){
+        producers.emplace_back([&, p]{
+            for(int i = 0; i < PerProducer; ++i){
+                queue.Push(&messages[p * PerProducer + i]);
+            }
+        });
+    }
+
+    int expectedNext[Producers] = {};
+    int received = 0;
+    bool ordered = true;
+    while( received < Producers * PerProducer ){
+        queue.PopBatch([&](MyMessage* message){
+            const long index = message - messages.data();
+            const int producer = static_cast<int>(index / PerProducer);
+            ordered = ordered && index % PerProducer == expectedNext[producer];
+            ++expectedNext[producer];
+            ++received;
+        });
+    }
+    for(auto& producer : producers){
+        producer.join();
+    }
+    CHECK( ordered );
+    CHECK( queue.IsEmpty() );
+    CHECK( queue.Pop() == nullptr );
+}
+
+TEST_CASE("IntrusiveLockFreeStack loses nothing across threads"){
+    constexpr int Producers = 4;
+    constexpr int PerProducer = 20000;
+
+    std::vector<MyMessage> messages(Producers * PerProducer);
+    IntrusiveLockFreeStack<MyMessage> stack;
+    std::atomic<int> done(0);
+
+    std::vector<std::thread> producers;
+    for(int p = 0; p < Producers; ++p){
+        producers.emplace_back([&, p]{
+            for(int i = 0; i < PerProducer; ++i){
+                stack.Push(&messages[p * PerProducer + i]);
+            }
+            ++done;
+        });
+    }
+
+    std::vector<int> seen(messages.size(), 0);
+    auto take = [&](MyMessage* message){
+        ++seen[message - messages.data()];
+    };
+    bool alternate = false;
+    while( done < Producers || !stack.IsEmpty() ){
+        // mix single item and batch removal from the consumer
+        if( (alternate = !alternate) ){
+            if( MyMessage* message = stack.Pop() ){
+                take(message);
+            }
+        }
+        else{
+            for(MyMessage* m = stack.PopAll(); m; ){
+                MyMessage* next = m->NextLockFreeStackNode();
+                take(m);
+                m = next;
+            }
+        }
+    }
+    for(auto& producer : producers){
+        producer.join();
+    }
+    bool allOnce = true;
+    for(auto count : seen){
+        allOnce = allOnce && count == 1;
+    }
+    CHECK( allOnce );
+}
+
+
+namespace{
+    struct SkipItemLess;
+
+    /// Item for skip list tests
+    class MySkipItem: public IntrusiveSkipList<MySkipItem, SkipItemLess, 8>::Node{
+    public:
+        MySkipItem(int key = 0) : storedKey(key) {}
+
+        int Key() const{
+            return storedKey;
+        }
+        void SetKey(int key){
+            storedKey = key;
+        }
+    private:
+        int storedKey;
+    };
+
+    struct SkipItemLess{
+        bool operator()(const MySkipItem& a, const MySkipItem& b) const { return a.Key() < b.Key(); }
+        bool operator()(const MySkipItem& a, int key) const { return a.Key() < key; }
+        bool operator()(int key, const MySkipItem& b) const { return key < b.Key(); }
+    };
+
+    using MySkipList = IntrusiveSkipList<MySkipItem, SkipItemLess, 8>;
+
+    std::vector<int> KeysOf(MySkipList& skipList){
+        std::vector<int> res;
+        for(auto& item : skipList){
+            res.push_back(item.Key());
+        }
+        return res;
+    }
+} //namespace
+
+TEST_CASE("IntrusiveSkipList single thread"){
+    MySkipList skipList;
+    CHECK( skipList.IsEmpty() );
+    CHECK( skipList.First() == nullptr );
+    CHECK( skipList.LowerBound(0) == nullptr );
+
+    MySkipItem i10(10), i20(20), i30(30), another20(20);
+    skipList.Insert(&i30);
+    skipList.Insert(&i10);
+    skipList.Insert(&i20);
+    CHECK( i10.IsInSkipList() );
+    CHECK( !skipList.IsEmpty() );
+    CHECK( KeysOf(skipList) == std::vector<int>{10, 20, 30} );
+    CHECK( skipList.First() == &i10 );
+
+    CHECK( skipList.LowerBound(5) == &i10 );
+    CHECK( skipList.LowerBound(11) == &i20 );
+    CHECK( skipList.LowerBound(31) == nullptr );
+    CHECK( skipList.Find(30) == &i30 );
+    CHECK( skipList.Find(25) == nullptr );
+
+    // equal keys are allowed
+    skipList.Insert(&another20);
+    CHECK( KeysOf(skipList) == std::vector<int>{10, 20, 20, 30} );
+
+    CHECK( skipList.Remove(&i20) );
+    CHECK( !i20.IsInSkipList() );
+    CHECK( skipList.Find(20) == &another20 );
+    CHECK( skipList.Remove(&another20) );
+    CHECK( skipList.Find(20) == nullptr );
+    CHECK( KeysOf(skipList) == std::vector<int>{10, 30} );
+
+    // removed item can be inserted again
+    skipList.Insert(&i20);
+    CHECK( KeysOf(skipList) == std::vector<int>{10, 20, 30} );
+
+    CHECK( skipList.Remove(&i10) );
+    CHECK( skipList.Remove(&i20) );
+    CHECK( skipList.Remove(&i30) );
+    CHECK( skipList.IsEmpty() );
+}
+
+TEST_CASE("IntrusiveSkipList matches sorted reference"){
+    constexpr int ItemsCount = 500;
+    std::vector<MySkipItem> items(ItemsCount);
+    for(int i = 0; i < ItemsCount; ++i){
+        items[i].SetKey((i * 7919) % 1000);
+    }
+
+    MySkipList skipList;
+    std::vector<int> reference;
+    unsigned seed = 1;
+    for(int step = 0; step < 5000; ++step){
+        seed = seed * 1103515245u + 12345u;
+        MySkipItem& item = items[(seed >> 8) % ItemsCount];
+        if( item.IsInSkipList() ){
+            REQUIRE( skipList.Remove(&item) );
+            reference.erase(std::find(reference.begin(), reference.end(), item.Key()));
+        }
+        else{
+            skipList.Insert(&item);
+            reference.insert(std::upper_bound(reference.begin(), reference.end(), item.Key()), item.Key());
+        }
+        if( step % 250 == 0 ){
+            REQUIRE( KeysOf(skipList) == reference );
+            const int key = static_cast<int>((seed >> 4) % 1000);
+            auto expected = std::lower_bound(reference.begin(), reference.end(), key);
+            MySkipItem* found = skipList.LowerBound(key);
+            CHECK( (found ? found->Key() : -1) == (expected == reference.end() ? -1 : *expected) );
+        }
+    }
+    for(auto& item : items){
+        if( item.IsInSkipList() ){
+            skipList.Remove(&item);
+        }
+    }
+    CHECK( skipList.IsEmpty() );
+}
+
+TEST_CASE("IntrusiveSkipList concurrent insert and remove"){
+    constexpr int Threads = 4;
+    constexpr int PerThread = 5000;
+
+    // every item is inserted and removed at most once (no reuse while others traverse)
+    std::vector<MySkipItem> items(Threads * PerThread);
+    for(int i = 0; i < Threads * PerThread; ++i){
+        items[i].SetKey((i * 7919) % 4096);
+    }
+    MySkipList skipList;
+
+    std::vector<std::thread> threads;
+    for(int t = 0; t < Threads; ++t){
+        threads.emplace_back([&, t]{
+            MySkipItem* mine = &items[t * PerThread];
+            for(int i = 0; i < PerThread; ++i){
+                skipList.Insert(mine + i);
+                // remove every second own item a bit later
+                if( i % 2 && i > 16 ){
+                    skipList.Remove(mine + i - 16);
+                }
+                skipList.LowerBound(mine[i].Key());
+            }
+        });
+    }
+    for(auto& thread : threads){
+        thread.join();
+    }
+
+    std::vector<int> expected;
+    for(auto& item : items){
+        if( item.IsInSkipList() ){
+            expected.push_back(item.Key());
+        }
+    }
+    std::sort(expected.begin(), expected.end());
+    CHECK( KeysOf(skipList) == expected );
+
+    for(auto& item : items){
+        if( item.IsInSkipList() ){
+            skipList.Remove(&item);
+        }
+    }
+    CHECK( skipList.IsEmpty() );
+}
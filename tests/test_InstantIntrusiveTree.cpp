@@ -0,0 +1,216 @@
+/** @file tests/test_InstantIntrusiveTree.cpp
+    @brief Unit tests for InstantIntrusiveTree.h
+*/
+
+#include <exception>
+/// Custom exception for testing InstantIntrusiveTree_Panic
+class TestInstantIntrusiveTreeException: public std::exception{
+    const char* what() const noexcept override{
+        return "TestInstantIntrusiveTreeException";
+    }
+};
+//Header will see this definition
+#define InstantIntrusiveTree_Panic() throw TestInstantIntrusiveTreeException()
+#include "InstantIntrusiveTree.h"
+
+#include "doctest/doctest.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace{
+    struct TreeItemLess;
+
+    /// Class for testing purposes
+    class MyTreeItem: public IntrusiveTree<MyTreeItem, TreeItemLess>::Node{
+    public:
+        /// Constructor for testing purposes
+        MyTreeItem(int key, int tag = 0) : storedKey(key), storedTag(tag) {}
+
+        /// Method for testing purposes
+        int Key() const{
+            return storedKey;
+        }
+        /// Tag to distinguish equal keys
+        int Tag() const{
+            return storedTag;
+        }
+    private:
+        int storedKey;
+        int storedTag;
+    };
+
+    /// Compare items with items and with plain int keys
+    struct TreeItemLess{
+        bool operator()(const MyTreeItem& a, const MyTreeItem& b) const { return a.Key() < b.Key(); }
+        bool operator()(const MyTreeItem& a, int key) const { return a.Key() < key; }
+        bool operator()(int key, const MyTreeItem& b) const { return key < b.Key(); }
+    };
+
+    using MyTree = IntrusiveTree<MyTreeItem, TreeItemLess>;
+
+    std::vector<int> KeysOf(const MyTree& tree){
+        std::vector<int> res;
+        for(auto& item : tree){
+            res.push_back(item.Key());
+        }
+        return res;
+    }
+
+    /// Remove all items (tree shall be empty when destroyed)
+    void Clear(MyTree& tree){
+        while( tree.RemoveFirst() ){}
+    }
+
+} //namespace
+
+TEST_CASE("InstantIntrusiveTree basic"){
+    MyTree tree;
+    CHECK( tree.IsEmpty() );
+    CHECK( tree.Count() == 0 );
+    CHECK( tree.First() == nullptr );
+    CHECK( tree.Last() == nullptr );
+    CHECK( tree.begin() == tree.end() );
+    CHECK( tree.LowerBound(1) == nullptr );
+
+    MyTreeItem i30(30), i10(10), i20(20), i40(40);
+    CHECK( !i10.IsInTree() );
+
+    tree.Insert(&i30);
+    tree.Insert(&i10);
+    tree.Insert(&i40);
+    tree.Insert(&i20);
+    CHECK( !tree.IsEmpty() );
+    CHECK( tree.Count() == 4 );
+    CHECK( i10.IsInTree() );
+    CHECK( KeysOf(tree) == std::vector<int>{10, 20, 30, 40} );
+
+    CHECK( tree.First() == &i10 );
+    CHECK( tree.Last() == &i40 );
+
+    SUBCASE("search"){
+        CHECK( tree.LowerBound(5) == &i10 );
+        CHECK( tree.LowerBound(10) == &i10 );
+        CHECK( tree.LowerBound(11) == &i20 );
+        CHECK( tree.LowerBound(41) == nullptr );
+        CHECK( tree.UpperBound(10) == &i20 );
+        CHECK( tree.UpperBound(39) == &i40 );
+        CHECK( tree.UpperBound(40) == nullptr );
+        CHECK( tree.Find(30) == &i30 );
+        CHECK( tree.Find(31) == nullptr );
+    }
+
+    SUBCASE("walk in both directions"){
+        CHECK( i10.NextTreeNode() == &i20 );
+        CHECK( i40.NextTreeNode() == nullptr );
+        CHECK( i40.PrevTreeNode() == &i30 );
+        CHECK( i10.PrevTreeNode() == nullptr );
+
+        auto it = tree.begin();
+        ++it;
+        ++it;
+        CHECK( it->Key() == 30 );
+        --it;
+        CHECK( (*it).Key() == 20 );
+    }
+
+    SUBCASE("remove"){
+        tree.Remove(&i20);
+        CHECK( !i20.IsInTree() );
+        CHECK( tree.Count() == 3 );
+        CHECK( KeysOf(tree) == std::vector<int>{10, 30, 40} );
+        CHECK( tree.LowerBound(11) == &i30 );
+
+        // item can be inserted again
+        tree.Insert(&i20);
+        CHECK( KeysOf(tree) == std::vector<int>{10, 20, 30, 40} );
+
+        CHECK( tree.RemoveFirst() == &i10 );
+        CHECK( tree.First() == &i20 );
+    }
+
+    SUBCASE("misuse panics"){
+        CHECK_THROWS_AS( tree.Insert(&i10), TestInstantIntrusiveTreeException );
+        MyTreeItem outside(1);
+        CHECK_THROWS_AS( tree.Remove(&outside), TestInstantIntrusiveTreeException );
+    }
+
+    Clear(tree);
+    CHECK( tree.IsEmpty() );
+    CHECK( !i30.IsInTree() );
+}
+
+TEST_CASE("InstantIntrusiveTree equal keys keep insertion order"){
+    MyTree tree;
+    MyTreeItem a(5, 1), b(5, 2), c(1), d(5, 3), e(9);
+
+    tree.Insert(&a);
+    tree.Insert(&c);
+    tree.Insert(&b);
+    tree.Insert(&e);
+    tree.Insert(&d);
+
+    std::vector<int> tags;
+    for(auto it = tree.LowerBound(5); it != tree.UpperBound(5); it = it->NextTreeNode()->CastToTreeNode()){
+        tags.push_back(it->Tag());
+    }
+    CHECK( tags == std::vector<int>{1, 2, 3} );
+    CHECK( tree.Find(5) == &a );
+
+    Clear(tree);
+}
+
+TEST_CASE("InstantIntrusiveTree matches sorted reference on random operations"){
+    constexpr int ItemsCount = 300;
+    std::vector<MyTreeItem*> items;
+    for(int i = 0; i < ItemsCount; ++i){
+        items.push_back(new MyTreeItem(i % 97, i));
+    }
+
+    MyTree tree;
+    std::vector<int> reference;
+    std::mt19937 rnd(12345);
+
+    for(int step = 0; step < 3000; ++step){
+        MyTreeItem* item = items[rnd() % ItemsCount];
+        if( item->IsInTree() ){
+            tree.Remove(item);
+            reference.erase(std::find(reference.begin(), reference.end(), item->Key()));
+        }
+        else{
+            tree.Insert(item);
+            reference.insert(std::upper_bound(reference.begin(), reference.end(), item->Key()), item->Key());
+        }
+
+        if( step % 100 == 0 ){
+            REQUIRE( KeysOf(tree) == reference );
+            REQUIRE( tree.Count() == reference.size() );
+
+            const int key = static_cast<int>(rnd() % 100);
+            auto expected = std::lower_bound(reference.begin(), reference.end(), key);
+            MyTreeItem* found = tree.LowerBound(key);
+            if( expected == reference.end() ){
+                CHECK( found == nullptr );
+            }
+            else{
+                REQUIRE( found != nullptr );
+                CHECK( found->Key() == *expected );
+                // the first one among equal keys
+                CHECK( (!found->PrevTreeNode() || found->PrevTreeNode()->CastToTreeNode()->Key() < key) );
+            }
+        }
+    }
+
+    // walking backwards gives reverse order
+    std::vector<int> backwards;
+    for(const MyTree::Node* node = tree.Last(); node; node = node->PrevTreeNode()){
+        backwards.push_back(node->CastToTreeNode()->Key());
+    }
+    std::reverse(backwards.begin(), backwards.end());
+    CHECK( backwards == reference );
+
+    Clear(tree);
+    for(auto item : items){
+        delete item;
+    }
+}
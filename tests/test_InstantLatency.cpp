@@ -0,0 +1,80 @@
+/** @file tests/test_InstantLatency.cpp
+    @brief Unit tests for InstantLatency.h
+*/
+
+#include "InstantLatency.h"
+#include "doctest/doctest.h"
+#include <string>
+
+TEST_CASE("InstantLatency: LatencyHistogram") {
+    using Histogram = LatencyHistogram<8>;
+    Histogram histogram;
+
+    CHECK( histogram.Samples() == 0 );
+    CHECK( histogram.Percentile(50) == 0 );
+
+    SUBCASE("Buckets are powers of two") {
+        CHECK( Histogram::BucketFor(0) == 0 );
+        CHECK( Histogram::BucketFor(1) == 1 );
+        CHECK( Histogram::BucketFor(2) == 2 );
+        CHECK( Histogram::BucketFor(3) == 2 );
+        CHECK( Histogram::BucketFor(4) == 3 );
+        CHECK( Histogram::BucketFor(127) == 7 );
+        CHECK( Histogram::BucketFor(100000) == 7 ); //the last takes the rest
+
+        CHECK( Histogram::BucketUpperBound(0) == 0 );
+        CHECK( Histogram::BucketUpperBound(3) == 7 );
+        CHECK( Histogram::BucketUpperBound(7) == ~Histogram::Ticks(0) );
+    }
+    SUBCASE("Statistics") {
+        for(Histogram::Ticks latency = 1; latency <= 100; ++latency){
+            histogram.Add(latency);
+        }
+        CHECK( histogram.Samples() == 100 );
+        CHECK( histogram.Min() == 1 );
+        CHECK( histogram.Max() == 100 );
+        CHECK( histogram.Average() == 50 );
+        CHECK( histogram.Count(1) == 1 );
+        CHECK( histogram.Count(7) == 37 ); // 64...100
+        CHECK( histogram.Percentile(50) == 63 );
+        CHECK( histogram.Percentile(99) == 100 ); // not more than seen
+
+        histogram.Reset();
+        CHECK( histogram.Samples() == 0 );
+        CHECK( histogram.Count(7) == 0 );
+    }
+}
+
+TEST_CASE("InstantLatency: LatencyProbe") {
+    LatencyProbe<2> probe("button");
+    CHECK( std::string(probe.Name()) == "button" );
+
+    SUBCASE("Stages are measured from Mark") {
+        CHECK( !probe.Stage(0, 5) ); //no Mark yet
+        probe.Mark(1000);
+        CHECK( probe.IsMarked() );
+        CHECK( probe.Stage(0, 1003) );
+        CHECK( probe.Complete(1010) );
+        CHECK( !probe.IsMarked() );
+
+        CHECK( probe.StageHistogram(0).Max() == 3 );
+        CHECK( probe.StageHistogram(1).Max() == 10 );
+    }
+    SUBCASE("The oldest Mark is kept on overrun") {
+        probe.Mark(100);
+        probe.Mark(150);
+        CHECK( probe.Overruns() == 1 );
+        CHECK( probe.Complete(200) );
+        CHECK( probe.StageHistogram(1).Max() == 100 );
+
+        probe.Mark(300);
+        probe.Abandon();
+        CHECK( !probe.Complete(400) );
+        CHECK( probe.StageHistogram(1).Samples() == 1 );
+    }
+    SUBCASE("Ticks overflow") {
+        probe.Mark(~LatencyProbe<2>::Ticks(0) - 1);
+        CHECK( probe.Complete(3) );
+        CHECK( probe.StageHistogram(1).Max() == 5 );
+    }
+}
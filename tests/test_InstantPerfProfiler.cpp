@@ -0,0 +1,99 @@
+/** @file tests/test_InstantPerfProfiler.cpp
+    @brief Unit tests for InstantPerfProfiler.h (Linux host only)
+*/
+
+#include "InstantPerfProfiler.h"
+
+#include "doctest/doctest.h"
+
+#ifdef InstantPerfProfiler_Available
+
+#include <string>
+
+namespace{
+    /// Work that takes measurable CPU time
+    unsigned long long Spin(unsigned long iterations){
+        volatile unsigned long long acc = 0;
+        for(unsigned long i = 0; i < iterations; ++i){
+            acc = acc + i * i;
+        }
+        return acc;
+    }
+} //namespace
+
+TEST_CASE("PerfCounters open with fallbacks"){
+    PerfCounters counters;
+    // time is always there, at least as the thread CPU clock
+    CHECK( counters.Source(PerfMetric::Cycles) != PerfSource::Unavailable );
+    for(unsigned i = 0; i < PerfCounters::MetricsCount; ++i){
+        CHECK( std::string(counters.Name(PerfMetric(i))).size() > 0 );
+    }
+
+    PerfSample before, after;
+    counters.Read(&before);
+    Spin(200000);
+    counters.Read(&after);
+    CHECK( after[PerfMetric::Cycles] > before[PerfMetric::Cycles] );
+}
+
+TEST_CASE("PerfProfiler attributes executions per ActionNode"){
+    Scheduler scheduler;
+    scheduler.Start(0);
+    PerfProfiler profiler;
+    profiler.Attach(scheduler);
+
+    auto light = []{ Spin(1000); };
+    auto heavy = []{ Spin(400000); };
+    ActionNode lightAction, heavyAction, unusedAction;
+    for(int i = 0; i < 3; ++i){
+        lightAction.Set(light).ScheduleNow(scheduler);
+        heavyAction.Set(heavy).ScheduleNow(scheduler);
+        scheduler.ExecuteAll(ActionNode::Ticks(i));
+    }
+
+    const PerfStatistics* lightStatistics = profiler.StatisticsFor(lightAction);
+    const PerfStatistics* heavyStatistics = profiler.StatisticsFor(heavyAction);
+    REQUIRE( lightStatistics );
+    REQUIRE( heavyStatistics );
+    CHECK( profiler.StatisticsFor(unusedAction) == nullptr );
+    CHECK( lightStatistics->Executions() == 3 );
+    CHECK( heavyStatistics->Executions() == 3 );
+    CHECK( heavyStatistics->Total(PerfMetric::Cycles) > lightStatistics->Total(PerfMetric::Cycles) );
+    CHECK( heavyStatistics->Max(PerfMetric::Cycles) >= heavyStatistics->Average(PerfMetric::Cycles) );
+
+    int visited = 0;
+    profiler.ForEach([&](const ActionNode&, const PerfStatistics& statistics){
+        visited += int(statistics.Executions());
+    });
+    CHECK( visited == 6 );
+
+    profiler.Detach(scheduler);
+    lightAction.Set(light).ScheduleNow(scheduler);
+    scheduler.ExecuteAll(10);
+    CHECK( lightStatistics->Executions() == 3 );
+
+    profiler.Reset();
+    CHECK( profiler.StatisticsFor(lightAction) == nullptr );
+}
+
+TEST_CASE("PerfProfiler measures tasks and nested code explicitly"){
+    PerfProfiler profiler;
+    PerfStatistics outer, inner;
+    profiler.Measure(outer, [&]{
+        Spin(100000);
+        profiler.Measure(inner, []{ Spin(100000); });
+    });
+    CHECK( outer.Executions() == 1 );
+    CHECK( inner.Executions() == 1 );
+    CHECK( outer.Total(PerfMetric::Cycles) >= inner.Total(PerfMetric::Cycles) );
+
+    // unbalanced End is ignored
+    profiler.End(inner);
+    CHECK( inner.Executions() == 1 );
+
+    outer.Reset();
+    CHECK( outer.Executions() == 0 );
+    CHECK( outer.Total(PerfMetric::Cycles) == 0 );
+}
+
+#endif
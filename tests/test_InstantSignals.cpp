@@ -0,0 +1,267 @@
+/** @file tests/test_InstantSignals.cpp
+    @brief Unit tests for InstantSignals.h
+*/
+
+#include "InstantSignals.h"
+#include "doctest/doctest.h"
+#include <cstdint>
+
+TEST_CASE("InstantSignals: BitsLocation atomic operations") {
+    BitsLocation::AddressableUnit word = 0x81;
+    BitsLocation bits(&word, 0x0F);
+
+    bits.AtomicSet();
+    CHECK( word == 0x8F );
+
+    bits.AtomicClear();
+    CHECK( word == 0x80 );
+
+    bits.AtomicSet(0x35); // only 0x05 is selected by mask
+    CHECK( word == 0x85 );
+    CHECK( *bits == 0x05 );
+
+    bits.AtomicToggle();
+    CHECK( word == 0x8A );
+}
+
+
+TEST_CASE("InstantSignals: BitsDebounce") {
+    BitsDebounce<std::uint8_t> port(0x0F);
+
+    //Initial state is as provided
+    CHECK(port.Value() == 0x0F);
+
+    SUBCASE("Debouncing when no chatter") {
+        CHECK( port.Discover(0xF0) == 0 ); //counts
+        CHECK( port.Discover(0xF0) == 0 ); //counts
+        CHECK( port.Discover(0xF0) == 0 ); //counts
+        CHECK( port.Value() == 0x0F ); //still old value
+
+        auto changed = port.Discover(0xF0);
+        CHECK( changed == 0xFF ); //all the channels are debounced together
+        CHECK( port.Value() == 0xF0 );
+        CHECK( port.ChangedToOnes(changed) == 0xF0 );
+        CHECK( port.ChangedToZeroes(changed) == 0x0F );
+
+        CHECK( port.Discover(0xF0) == 0 ); //stable now
+        CHECK( port.Value() == 0xF0 );
+    }
+
+    SUBCASE("Debouncing with chatter") {
+        CHECK( port.Discover(0x1F) == 0 ); //channel 4 counts
+        CHECK( port.Discover(0x1F) == 0 ); //channel 4 counts
+        CHECK( port.Discover(0x1F) == 0 ); //channel 4 counts
+        CHECK( port.Discover(0x0F) == 0 ); //chatter, counts from start
+        CHECK( port.Discover(0x1F) == 0 );
+        CHECK( port.Discover(0x1F) == 0 );
+        CHECK( port.Discover(0x1F) == 0 );
+        CHECK( port.Value() == 0x0F );
+        CHECK( port.Discover(0x1F) == 0x10 ); //debounced!
+        CHECK( port.Value() == 0x1F );
+    }
+
+    SUBCASE("Channels are independent") {
+        CHECK( port.Discover(0x0E) == 0 ); //channel 0 starts
+        CHECK( port.Discover(0x0E) == 0 );
+        CHECK( port.Discover(0x8E) == 0 ); //channel 7 starts
+        CHECK( port.Discover(0x8E) == 0x01 ); //only channel 0 is ready
+        CHECK( port.Discover(0x8E) == 0 );
+        CHECK( port.Discover(0x8E) == 0x80 ); //now channel 7 is ready
+        CHECK( port.Value() == 0x8E );
+    }
+
+    SUBCASE("Reset") {
+        port.Discover(0xF0);
+        port.Discover(0xF0);
+        port.Reset(0xF0);
+        CHECK( port.Value() == 0xF0 );
+        CHECK( port.Discover(0xF0) == 0 );
+    }
+}
+
+TEST_CASE("InstantSignals: BitsDebounce wide words") {
+    BitsDebounce<std::uint64_t> port;
+
+    const std::uint64_t raw = 0x8000000000000001ull;
+    for(unsigned i = 1; i < BitsDebounce<std::uint64_t>::SamplesToAccept; ++i){
+        CHECK( port.Discover(raw) == 0 );
+    }
+    CHECK( port.Discover(raw) == raw );
+    CHECK( port.Value() == raw );
+}
+
+
+TEST_CASE("InstantSignals: BitsAccumulator") {
+    // emulate memory mapped registers
+    static volatile std::uint32_t portA = 0;
+    static volatile std::uint32_t portB = 0;
+
+    using Accumulator = BitsAccumulator<std::uint32_t, 2>;
+    static const Accumulator::RegisterMap registers = {
+        {&portA, 0x0000FFFF, 0x00000000}, // "active 1" signals
+        {&portB, 0x000000F0, 0x000000F0}  // "active 0" signals
+    };
+    portA = 0;
+    portB = 0xF0;
+    Accumulator accumulator(registers);
+
+    SUBCASE("Nothing accumulated when inactive") {
+        accumulator.RefreshAll();
+        CHECK( accumulator.Result(0) == 0 );
+        CHECK( accumulator.Result(1) == 0 );
+    }
+    SUBCASE("Short pulses are caught till snapshot") {
+        portA = 0x00010001; // bit 16 is not selected by mask
+        accumulator.Refresh(0);
+        portA = 0;
+        portB = 0xE0; // bit 4 is active
+        accumulator.RefreshAll();
+        portB = 0xF0;
+        accumulator.RefreshAll();
+
+        CHECK( accumulator.Result(0) == 0x0001 );
+        CHECK( accumulator.Result(1) == 0x10 );
+
+        std::uint32_t snapshot[Accumulator::RegistersCount];
+        CHECK( accumulator.SnapshotAll(snapshot) );
+        CHECK( snapshot[0] == 0x0001 );
+        CHECK( snapshot[1] == 0x10 );
+
+        // cleared by snapshot
+        CHECK( !accumulator.SnapshotAll(snapshot) );
+        CHECK( accumulator.Snapshot(0) == 0 );
+    }
+    SUBCASE("Raw values accumulate with the same masks") {
+        accumulator.Accumulate(0, 0xFFFFFFFF);
+        accumulator.Accumulate(1, 0x0F);
+        CHECK( accumulator.Snapshot(0) == 0xFFFF );
+        CHECK( accumulator.Snapshot(1) == 0xF0 );
+        accumulator.Accumulate(1, 0x70);
+        accumulator.Clear();
+        CHECK( accumulator.Result(1) == 0 );
+    }
+}
+
+#ifdef __SIZEOF_INT128__
+TEST_CASE("InstantSignals: BitsAccumulator word not lock free") {
+    // builtins for this Word would be libatomic calls (this links without)
+    using Word = unsigned __int128;
+    const bool usesBuiltins = InstantSignalsDetails::Atomic<Word>::UsesBuiltins;
+    CHECK( usesBuiltins == __atomic_always_lock_free(sizeof(Word), 0) );
+
+    static volatile Word port = 0;
+    using Accumulator = BitsAccumulator<Word, 1>;
+    static const Accumulator::RegisterMap registers = {
+        {&port, ~Word(0), 0}
+    };
+    Accumulator accumulator(registers);
+    const Word high = Word(1) << 100;
+    port = high | 1;
+    accumulator.Refresh(0);
+    port = 2;
+    accumulator.Refresh(0);
+    CHECK( accumulator.Snapshot(0) == (high | 3) );
+    CHECK( accumulator.Result(0) == 0 );
+
+    // the same fallback for operations behind BitsLocation::Atomic...
+    using Atomic = InstantSignalsDetails::Atomic<Word>;
+    volatile Word shared = high | 0xF0;
+    CHECK( Atomic::FetchAnd(&shared, ~high) == (high | 0xF0) );
+    CHECK( Atomic::FetchXor(&shared, high | 0x30) == 0xF0 );
+    CHECK( Atomic::AssignMasked(&shared, 0xFF, 0x0F) == (high | 0xC0) );
+    CHECK( shared == (high | 0x0F) );
+}
+#endif
+
+
+TEST_CASE("InstantSignals: SignalRouter") {
+    static volatile std::uint16_t port0 = 0;
+    static volatile std::uint16_t port1 = 0;
+    static const SignalRouter<std::uint16_t, 2>::Registers registers = {&port0, &port1};
+    port0 = 0x0001;
+    port1 = 0;
+
+    SignalRouter<std::uint16_t, 2> router(registers);
+    CHECK( router.Previous(0) == 0x0001 );
+
+    int calls0 = 0;
+    bool last0 = true;
+    auto onSignal0 = [&](bool newValue){ ++calls0; last0 = newValue; };
+    int calls31 = 0;
+    auto onSignal31 = [&](bool){ ++calls31; };
+    router.Route(0, onSignal0);
+    router.Route(31, onSignal31);
+    CHECK( router.IsRouted(0) );
+    CHECK( !router.IsRouted(1) );
+
+    SUBCASE("Only changed routed bits are dispatched") {
+        CHECK( router.Poll() == 0 );
+
+        port0 = 0x0002; // signal 0 falls, signal 1 rises (not routed)
+        CHECK( router.Poll() == 1 );
+        CHECK( calls0 == 1 );
+        CHECK( last0 == false );
+
+        port1 = 0x8000; // signal 31
+        CHECK( router.Poll() == 1 );
+        CHECK( calls31 == 1 );
+
+        port0 = 0x0001;
+        port1 = 0;
+        CHECK( router.Poll() == 2 );
+        CHECK( calls0 == 2 );
+        CHECK( last0 == true );
+        CHECK( calls31 == 2 );
+    }
+    SUBCASE("Snapshot from elsewhere and unrouting") {
+        const std::uint16_t snapshot[] = {0x0000, 0x8000};
+        CHECK( router.Dispatch(snapshot) == 2 );
+
+        router.Unroute(31);
+        CHECK( router.Dispatch(1, 0) == 0 );
+        CHECK( calls31 == 1 );
+
+        const std::uint16_t known[] = {0x0001, 0x0000};
+        router.Reset(known);
+        CHECK( router.Dispatch(0, 0x0001) == 0 );
+    }
+    SUBCASE("Routing to multicast") {
+        MulticastToActions multicast;
+        SignalRouter<std::uint16_t, 2> plainRouter;
+        plainRouter.Route(5, multicast);
+
+        int triggered = 0;
+        auto onTriggered = [&]{ ++triggered; };
+        ActionNode listener(onTriggered);
+        listener.ListenOnce(multicast);
+
+        CHECK( plainRouter.Dispatch(0, 0x0020) == 1 );
+        CHECK( triggered == 1 );
+    }
+}
+
+#ifdef __SIZEOF_INT128__
+TEST_CASE("InstantSignals: SignalRouter wide words") {
+    using Word = unsigned __int128;
+    static volatile Word port = 0;
+    static const SignalRouter<Word, 1>::Registers registers = {&port};
+    port = 0;
+    SignalRouter<Word, 1> router(registers);
+
+    int calls64 = 0, calls100 = 0;
+    auto onSignal64 = [&](bool){ ++calls64; };
+    auto onSignal100 = [&](bool){ ++calls100; };
+    router.Route(64, onSignal64);
+    router.Route(100, onSignal100);
+
+    port = Word(1) << 100; // lowest changed bit is above 63
+    CHECK( router.Poll() == 1 );
+    CHECK( calls100 == 1 );
+    CHECK( calls64 == 0 );
+
+    port = Word(1) << 64;
+    CHECK( router.Poll() == 2 );
+    CHECK( calls64 == 1 );
+    CHECK( calls100 == 2 );
+}
+#endif
@@ -0,0 +1,94 @@
+/** @file tests/test_InstantTask.cpp
+    @brief Unit tests for InstantTask.h
+*/
+
+#include "InstantTask.h"
+
+#include "doctest/doctest.h"
+
+namespace {
+    /// Fake C API reporting completion via callback with context
+    typedef void (*ReadDone)(void* context, int status, int length);
+
+    ReadDone pendingCallback = nullptr;
+    void* pendingContext = nullptr;
+    int readsStarted = 0;
+
+    /// Asynchronous read: callback is issued later by CompleteRead
+    void StartRead(ReadDone done, void* context){
+        ++readsStarted;
+        pendingCallback = done;
+        pendingContext = context;
+    }
+
+    /// Synchronous read: callback is issued before returning
+    void ReadNow(ReadDone done, void* context, int length){
+        ++readsStarted;
+        done(context, 0, length);
+    }
+
+    void CompleteRead(int status, int length){
+        ReadDone done = pendingCallback;
+        pendingCallback = nullptr;
+        done(pendingContext, status, length);
+    }
+
+    TaskDefine(Reader){
+    public:
+        int status = -1;
+        int length = 0;
+        bool synchronous = false;
+
+        TaskBegin(int){
+            for(;;){
+                if( synchronous ){
+                    TaskAwaitForCallback(
+                        ReadNow(TaskCallback::Trampoline, this, 7),
+                        (void* context, int status, int length),
+                        task.status = status;
+                        task.length = length;
+                    );
+                }
+                else{
+                    TaskAwaitForCallback(
+                        StartRead(TaskCallback::Trampoline, this),
+                        (void* context, int status, int length),
+                        task.status = status;
+                        task.length = length;
+                    );
+                }
+                TaskYield(status == 0 ? length : -1);
+            }
+        }
+        TaskEnd();
+    };
+}
+
+TEST_CASE("TaskAwaitForCallback resumes task from C style callback"){
+    readsStarted = 0;
+    Reader reader;
+    int yielded = 0;
+    auto onYield = [&](const int& value){ yielded = value; };
+
+    reader().Then(onYield);
+    CHECK( readsStarted == 1 );
+    CHECK( yielded == 0 ); // awaits for the callback
+
+    CompleteRead(0, 42); // fields are written, then the task resumes
+    CHECK( reader.length == 42 );
+    CHECK( yielded == 42 );
+
+    reader().Then(onYield);
+    CHECK( readsStarted == 2 );
+    CompleteRead(5, 3);
+    CHECK( reader.status == 5 );
+    CHECK( yielded == -1 );
+
+    SUBCASE("callback issued right from the setup continues without suspending"){
+        reader.synchronous = true;
+        reader().Then(onYield);
+        CHECK( readsStarted == 3 );
+        CHECK( pendingCallback == nullptr );
+        CHECK( yielded == 7 );
+    }
+}
@@ -0,0 +1,364 @@
+/** @file tests/test_InstantThenable.cpp
+    @brief Unit tests for InstantThenable.h
+*/
+
+#include "InstantThenable.h"
+
+#include "doctest/doctest.h"
+#include <atomic>
+#include <string>
+#include <thread>
+
+TEST_CASE("Thenable<void> fires immediately for event that happened before"){
+    ThenableToResolve<void> event;
+    int count = 0;
+    auto increment = [&]{ ++count; };
+
+    event();
+    CHECK( event.UntrackedEventsCount() == 1 );
+    event.Then(increment);
+    CHECK( count == 1 );
+    CHECK( event.UntrackedEventsCount() == 0 );
+
+    event.Then(increment);
+    CHECK( count == 1 );
+    event();
+    CHECK( count == 2 );
+}
+
+TEST_CASE("ThenableLockFree delivers in both orders"){
+    ThenableToResolve<std::string, ThenableLockFree> thenable;
+    std::string received;
+    auto receive = [&](const std::string& value){ received += value; };
+
+    SUBCASE("subscribed first"){
+        thenable.Then(receive);
+        CHECK( !thenable.HasStoredResult() );
+        thenable("a");
+        CHECK( received == "a" );
+        thenable("b"); // no subscription any more
+        CHECK( received == "a" );
+        CHECK( thenable.HasStoredResult() );
+        thenable.Then(receive);
+        CHECK( received == "ab" );
+    }
+    SUBCASE("resolved first, the latest result wins"){
+        thenable("a");
+        thenable("b");
+        thenable("c");
+        CHECK( thenable.HasStoredResult() );
+        thenable.Then(receive);
+        CHECK( received == "c" );
+        CHECK( !thenable.HasStoredResult() );
+    }
+    SUBCASE("subscribe again from inside callback"){
+        int calls = 0;
+        Delegate<void(const std::string&)>* again = nullptr;
+        auto resubscribe = [&](const std::string& value){
+            received += value;
+            if( ++calls < 3 ){
+                thenable.Then(*again);
+            }
+        };
+        Delegate<void(const std::string&)> callback(resubscribe);
+        again = &callback;
+
+        thenable("x");
+        thenable.Then(callback);
+        thenable("y");
+        thenable("z");
+        thenable("w");
+        CHECK( received == "xyz" );
+        CHECK( thenable.HasStoredResult() );
+    }
+    SUBCASE("reset and ignore"){
+        thenable("a");
+        thenable.ResetCallback();
+        CHECK( !thenable.HasStoredResult() );
+        thenable.ExplicitlyIgnore();
+        thenable("b");
+        CHECK( !thenable.HasStoredResult() );
+        CHECK( received.empty() );
+    }
+}
+
+TEST_CASE("ThenableLockFree<void> counts untracked events"){
+    ThenableToResolve<void, ThenableLockFree> event;
+    int count = 0;
+    auto increment = [&]{ ++count; };
+
+    event();
+    event();
+    CHECK( event.UntrackedEventsCount() == 2 );
+    event.Then(increment);
+    CHECK( count == 1 );
+    CHECK( event.UntrackedEventsCount() == 1 );
+    event.Then(increment);
+    CHECK( count == 2 );
+    event.Then(increment);
+    CHECK( event.UntrackedEventsCount() == 0 );
+    event();
+    CHECK( count == 3 );
+}
+
+TEST_CASE("ThenableLockFree does not lose events racing with other thread"){
+    constexpr int Rounds = 20000;
+
+    // ping-pong: each side subscribes and resolves the other side in turn
+    ThenableToResolve<int, ThenableLockFree> ping;
+    ThenableToResolve<void, ThenableLockFree> pong;
+
+    std::atomic<int> pongs(0);
+    auto countPong = [&]{ ++pongs; };
+    long sum = 0;
+    std::atomic<int> pingsReceived(0);
+    auto receivePing = [&](const int& value){ sum += value; ++pingsReceived; };
+
+    std::thread other([&]{
+        for(int i = 1; i <= Rounds; ++i){
+            while( pongs.load() < i - 1 ){
+                std::this_thread::yield();
+            }
+            ping(i);
+            pong.Then(countPong);
+        }
+    });
+    for(int i = 1; i <= Rounds; ++i){
+        ping.Then(receivePing);
+        while( pingsReceived.load() < i ){
+            std::this_thread::yield();
+        }
+        pong();
+    }
+    other.join();
+
+    CHECK( pingsReceived == Rounds );
+    CHECK( sum == long(Rounds) * (Rounds + 1) / 2 );
+    CHECK( pongs == Rounds );
+}
+
+namespace {
+    int ParseDigit(const char& c){ return c - '0'; }
+}
+
+TEST_CASE("ThenableChain fuses Map, Filter and Then into one callback"){
+    ThenableToResolve<char> thenable;
+    std::string received;
+
+    auto isEven = [](const int& value){ return value % 2 == 0; };
+    auto toText = [](const int& value){ return std::string(value, '*'); };
+    auto collect = [&](const std::string& value){ received += value + '|'; };
+
+    auto chain = ThenableChain<>()
+        .Map(ParseDigit)
+        .Filter(isEven)
+        .Map(toText)
+        .Then(collect);
+
+    for(char c : std::string("1234")){
+        thenable.Then(chain);
+        thenable(c);
+    }
+    CHECK( received == "**|****|" );
+
+    SUBCASE("stored result goes through the chain once subscribed"){
+        thenable('6');
+        thenable.Then(chain);
+        CHECK( received == "**|****|******|" );
+    }
+    SUBCASE("chain can be used as plain Delegate"){
+        Delegate<void(const char&)> callback(chain);
+        callback('8');
+        callback('9');
+        CHECK( received == "**|****|********|" );
+    }
+}
+
+TEST_CASE("ThenableChain for Thenable<void> starts from the first Map"){
+    ThenableToResolve<void> event;
+    int count = 0;
+    auto next = [&]{ return ++count; };
+    int lastOdd = 0;
+    auto store = [&](const int& value){ lastOdd = value; };
+
+    auto chain = ThenableChain<>()
+        .Map(next)
+        .Filter([](const int& value){ return value % 2 == 1; })
+        .Then(store);
+    for(int i = 0; i < 4; ++i){
+        event.Then(chain);
+        event();
+    }
+    CHECK( count == 4 );
+    CHECK( lastOdd == 3 );
+}
+
+TEST_CASE("SharedThenable wakes all waiters and late subscribers"){
+    SharedThenableToResolve<std::string> configLoaded;
+    using Waiter = SharedThenable<std::string>::Waiter;
+
+    std::string trace;
+    auto first = [&](const std::string& value){ trace += "1" + value; };
+    auto second = [&](const std::string& value){ trace += "2" + value; };
+    auto third = [&](const std::string& value){ trace += "3" + value; };
+
+    Waiter waiter1(configLoaded), waiter2(configLoaded), waiter3(configLoaded);
+    waiter1.Then(first);
+    waiter2.Then(second);
+    waiter3.Then(third);
+    CHECK( waiter2.IsWaiting() );
+    CHECK( !configLoaded.IsResolved() );
+
+    SUBCASE("all are woken in order of subscription"){
+        configLoaded("a");
+        CHECK( trace == "1a2a3a" );
+        CHECK( !waiter1.IsWaiting() );
+        CHECK( configLoaded.IsResolved() );
+
+        // late subscriber receives stored result right away
+        waiter2.Then(second);
+        CHECK( trace == "1a2a3a2a" );
+        CHECK( !waiter2.IsWaiting() );
+    }
+    SUBCASE("forgotten waiter is not called"){
+        waiter2.Forget();
+        CHECK( !waiter2.IsWaiting() );
+        configLoaded("b");
+        CHECK( trace == "1b3b" );
+    }
+    SUBCASE("destroyed waiter leaves the list"){
+        {
+            Waiter leaving(configLoaded);
+            leaving.Then(second);
+        }
+        configLoaded("c");
+        CHECK( trace == "1c2c3c" );
+    }
+    SUBCASE("reset makes waiters wait again"){
+        configLoaded("d");
+        configLoaded.ResetResult();
+        CHECK( !configLoaded.IsResolved() );
+        waiter1.Then(first);
+        CHECK( trace == "1d2d3d" );
+        configLoaded("e");
+        CHECK( trace == "1d2d3d1e" );
+    }
+}
+
+TEST_CASE("SharedThenable<void> waiter can be forgotten from other callback"){
+    SharedThenableToResolve<void, CriticalSectionSpinLock> event;
+    using Waiter = SharedThenable<void, CriticalSectionSpinLock>::Waiter;
+
+    Waiter waiter1(event), waiter2(event);
+    int calls1 = 0, calls2 = 0;
+    auto onFirst = [&]{ ++calls1; waiter2.Forget(); };
+    auto onSecond = [&]{ ++calls2; };
+    waiter1.Then(onFirst);
+    waiter2.Then(onSecond);
+
+    event();
+    CHECK( calls1 == 1 );
+    CHECK( calls2 == 0 );
+    CHECK( event.IsResolved() );
+
+    waiter2.Then(onSecond);
+    CHECK( calls2 == 1 );
+}
+
+namespace {
+    /// Large result to be kept only in borrowed slots
+    struct Report{
+        long id;
+        char payload[256];
+    };
+    using ReportSlots = BlockPool<sizeof(Report), 2>;
+}
+
+TEST_CASE("ThenableUnstored costs one delegate and drops early result"){
+    static_assert(
+        sizeof(ThenableUnstoredToResolve<Report>) == sizeof(Delegate<void(const Report&)>),
+        "ThenableUnstored shall not embed the result"
+    );
+    ThenableUnstoredToResolve<Report, ThenableUnstoredDrop> thenable;
+    int received = 0;
+    auto receive = [&](const Report& report){ received = report.id; };
+
+    thenable(Report{1, {}}); // nobody listens, dropped
+    CHECK( !thenable.HasStoredResult() );
+    thenable.Then(receive);
+    CHECK( received == 0 );
+    thenable(Report{2, {}});
+    CHECK( received == 2 );
+}
+
+TEST_CASE("ThenablePooled borrows slot only until result is delivered"){
+    static_assert(
+        sizeof(ThenablePooledToResolve<Report, ReportSlots>) == sizeof(Delegate<void(const Report&)>),
+        "ThenablePooled shall keep only the pointer to borrowed slot"
+    );
+    ReportSlots& slots = ThenablePooledSlots<ReportSlots>();
+    ThenablePooledToResolve<Report, ReportSlots, ThenableUnstoredDrop> first, second, third;
+    int received = 0;
+    auto receive = [&](const Report& report){ received = report.id; };
+
+    first.Then(receive);
+    first(Report{1, {}});
+    CHECK( received == 1 );
+    CHECK( slots.BlocksAllocated() == 0 ); // delivered directly
+
+    first(Report{2, {}});
+    first(Report{3, {}}); // replaces result in the same slot
+    second(Report{4, {}});
+    CHECK( slots.BlocksAllocated() == 2 );
+    third(Report{5, {}}); // pool exhausted, dropped by policy
+    CHECK( !third.HasStoredResult() );
+
+    first.Then(receive);
+    CHECK( received == 3 );
+    CHECK( slots.BlocksAllocated() == 1 );
+
+    second.ResetCallback();
+    CHECK( slots.BlocksAllocated() == 0 );
+
+    third(Report{6, {}});
+    CHECK( third.HasStoredResult() );
+    third.ExplicitlyIgnore();
+    CHECK( slots.BlocksAllocated() == 0 );
+    CHECK( received == 3 );
+}
+
+TEST_CASE("ThenablePooled protected instances share protected Slots across threads"){
+    using SharedSlots = BlockPool<
+        sizeof(Report), 2, CommonBlockPool::Metadata, CriticalSectionSpinLock>;
+    using Pooled = ThenablePooledToResolve<
+        Report, SharedSlots, ThenableUnstoredPanic, CriticalSectionSpinLock>;
+    SharedSlots& slots = ThenablePooledSlots<SharedSlots>();
+    Pooled first, second;
+    auto borrowAndReturn = [](Pooled& thenable){
+        for(int i = 0; i < 10000; ++i){
+            thenable(Report{i, {}}); // nobody listens, slot is borrowed
+            thenable.ExplicitlyIgnore(); // slot returns to the pool
+        }
+    };
+
+    std::thread other([&]{ borrowAndReturn(second); });
+    borrowAndReturn(first);
+    other.join();
+    CHECK( slots.BlocksAllocated() == 0 );
+}
+
+TEST_CASE("SharedThenable late subscriber can reset result from callback"){
+    SharedThenableToResolve<std::string> loaded;
+    SharedThenable<std::string>::Waiter waiter(loaded);
+    const std::string expected(100, 'x'); // longer than small string buffer
+    std::string received;
+    auto receiveAndReset = [&](const std::string& value){
+        loaded.ResetResult();
+        received = value; // value shall stay alive
+    };
+
+    loaded(expected);
+    waiter.Then(receiveAndReset);
+    CHECK( received == expected );
+    CHECK( !loaded.IsResolved() );
+}
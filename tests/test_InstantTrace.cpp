@@ -0,0 +1,120 @@
+/** @file tests/test_InstantTrace.cpp
+    @brief Unit tests for InstantTrace.h
+*/
+
+// only this translation unit counts (others see macros expanding to nothing)
+#ifndef InstantTrace_Enable
+#   define InstantTrace_Enable
+#endif
+#include "InstantTrace.h"
+
+#include "doctest/doctest.h"
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("TraceRegistry counts events and enumerates points"){
+    TraceRegistry::Reset();
+    CHECK( TraceRegistry::Total(TracePoint::QueuePush) == 0 );
+
+    InstantTrace_Count(QueuePush);
+    InstantTrace_Count(QueuePush);
+    InstantTrace_Add(SchedulerLateTicks, 40);
+    InstantTrace_Add(SchedulerLateTicks, 2);
+    CHECK( TraceRegistry::Total(TracePoint::QueuePush) == 2 );
+    CHECK( TraceRegistry::Total(TracePoint::SchedulerLateTicks) == 42 );
+    CHECK( TraceRegistry::Total(TracePoint::PoolFree) == 0 );
+    CHECK( TraceRegistry::SlotsUsed() >= 1 );
+
+    CHECK( std::strcmp(TraceRegistry::Name(TracePoint::QueuePush), "MpscQueue.Push") == 0 );
+    CHECK( std::strcmp(TraceRegistry::Name(TracePoint::Count), "") == 0 );
+
+    std::vector<std::string> names;
+    TraceCounter sum = 0;
+    TraceRegistry::Dump([&](const char* name, TraceCounter total){
+        names.push_back(name);
+        sum += total;
+    });
+    CHECK( names.size() == TraceRegistry::PointsCount );
+    CHECK( names.front() == "Scheduler.Schedule" );
+    CHECK( sum == 44 );
+
+    TraceRegistry::Reset();
+    CHECK( TraceRegistry::Total(TracePoint::QueuePush) == 0 );
+    CHECK( TraceRegistry::Total(TracePoint::SchedulerLateTicks) == 0 );
+}
+
+namespace{
+    /// Run threads counting StackPush, all of them stay alive till everyone counted
+    void CountInThreads(int threadsCount, int perThread){
+        std::atomic<int> counted(0);
+        std::vector<std::thread> threads;
+        for(int t = 0; t < threadsCount; ++t){
+            threads.emplace_back([&]{
+                for(int i = 0; i < perThread; ++i){
+                    InstantTrace_Count(StackPush);
+                }
+                ++counted;
+                while( counted.load() < threadsCount ){
+                    std::this_thread::yield();
+                }
+            });
+        }
+        for(auto& thread : threads){
+            thread.join();
+        }
+    }
+}
+
+TEST_CASE("TraceRegistry keeps separate slot per thread"){
+    constexpr int Threads = 4;
+    constexpr int PerThread = 100000;
+
+    TraceRegistry::Reset();
+    InstantTrace_Count(StackPush); // ensure main thread has own slot
+    if( TraceRegistry::SlotsUsed() + Threads >= TraceRegistry::MaxSlots ){
+        return; // threads of other tests took the slots (build with tracing everywhere)
+    }
+
+    CountInThreads(Threads, PerThread);
+
+    // nothing is lost while threads fit into the slots
+    CHECK( TraceRegistry::Total(TracePoint::StackPush) == TraceCounter(Threads) * PerThread + 1 );
+
+    int slotsWithOwnCount = 0;
+    for(unsigned slot = 0; slot < TraceRegistry::MaxSlots; ++slot){
+        slotsWithOwnCount += TraceRegistry::Value(slot, TracePoint::StackPush) == PerThread;
+    }
+    CHECK( slotsWithOwnCount == Threads );
+    TraceRegistry::Reset();
+}
+
+TEST_CASE("TraceRegistry gives slots of finished threads to new ones"){
+    constexpr int Threads = 50;
+
+    TraceRegistry::Reset();
+    InstantTrace_Count(StackPush);
+    const unsigned slotsBefore = TraceRegistry::SlotsUsed();
+
+    for(int t = 0; t < Threads; ++t){
+        std::thread([]{ InstantTrace_Count(StackPush); }).join();
+    }
+
+    CHECK( TraceRegistry::SlotsUsed() <= slotsBefore + 1 );
+    CHECK( TraceRegistry::Total(TracePoint::StackPush) == Threads + 1 );
+    TraceRegistry::Reset();
+}
+
+TEST_CASE("TraceRegistry loses nothing when threads exceed the slots"){
+    constexpr int Threads = 2 * TraceRegistry::MaxSlots;
+    constexpr int PerThread = 20000;
+
+    TraceRegistry::Reset();
+    CountInThreads(Threads, PerThread);
+
+    CHECK( TraceRegistry::SlotsUsed() == TraceRegistry::MaxSlots );
+    CHECK( TraceRegistry::Total(TracePoint::StackPush) == TraceCounter(Threads) * PerThread );
+    TraceRegistry::Reset();
+}